@@ -5,6 +5,7 @@
 #include "FootballAIUtility.h"
 #include "AIParametersData.h"
 #include "AISteeringComponent.h"
+#include "../Gameplay/Ball.h"
 #include "Perception/AIPerceptionComponent.h"
 #include "Perception/AISenseConfig_Sight.h"
 #include "BehaviorTree/BehaviorTreeComponent.h"
@@ -507,10 +508,11 @@ void AAIControllerFootball::DrawDebugInfo()
 	{
 		AActor* Ball = FoundActors[0];
 		UPrimitiveComponent* BallPrimitive = Cast<UPrimitiveComponent>(Ball->GetRootComponent());
+		const ABall* MatchBall = Cast<ABall>(Ball);
 		
-		if (BallPrimitive && BallPrimitive->IsSimulatingPhysics())
+		if (MatchBall || (BallPrimitive && BallPrimitive->IsSimulatingPhysics()))
 		{
-			FVector BallVelocity = BallPrimitive->GetPhysicsLinearVelocity();
+			FVector BallVelocity = MatchBall ? MatchBall->GetBallVelocity() : BallPrimitive->GetPhysicsLinearVelocity();
 			
 			if (BallVelocity.Size() > 50.0f)
 			{
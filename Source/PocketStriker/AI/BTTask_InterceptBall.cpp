@@ -2,6 +2,7 @@
 
 #include "BTTask_InterceptBall.h"
 #include "AIControllerFootball.h"
+#include "../Gameplay/Ball.h"
 #include "BehaviorTree/BlackboardComponent.h"
 #include "GameFramework/Pawn.h"
 #include "Kismet/GameplayStatics.h"
@@ -39,10 +40,14 @@ EBTNodeResult::Type UBTTask_InterceptBall::ExecuteTask(UBehaviorTreeComponent& O
 	AActor* Ball = FoundActors[0];
 	FVector BallLocation = Ball->GetActorLocation();
 	
-	// Get ball velocity (if ball has physics component)
+	// Get ball velocity (from the ball's own simulation, or a physics component)
 	FVector BallVelocity = FVector::ZeroVector;
 	UPrimitiveComponent* BallPrimitive = Cast<UPrimitiveComponent>(Ball->GetRootComponent());
-	if (BallPrimitive && BallPrimitive->IsSimulatingPhysics())
+	if (const ABall* MatchBall = Cast<ABall>(Ball))
+	{
+		BallVelocity = MatchBall->GetBallVelocity();
+	}
+	else if (BallPrimitive && BallPrimitive->IsSimulatingPhysics())
 	{
 		BallVelocity = BallPrimitive->GetPhysicsLinearVelocity();
 	}
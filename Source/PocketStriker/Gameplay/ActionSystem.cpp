@@ -4,7 +4,10 @@
 #include "PlayerStateMachine.h"
 #include "PlayerMovementComponent.h"
 #include "PlayerTuningData.h"
+#include "MovementSimulation.h"
 #include "Ball.h"
+#include "../Network/LagCompensation.h"
+#include "../Network/NetworkSnapshot.h"
 #include "GameFramework/Character.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Kismet/GameplayStatics.h"
@@ -145,7 +148,7 @@ void UActionSystem::UpdateActiveActions(float DeltaTime)
 	for (int32 i = ActiveActions.Num() - 1; i >= 0; --i)
 	{
 		FActiveAction& ActiveAction = ActiveActions[i];
-		ActiveAction.RemainingTime -= DeltaTime;
+		ActiveAction.RemainingTime = FMovementSimulation::AdvanceTimer(ActiveAction.RemainingTime, -DeltaTime);
 
 		// Remove completed actions
 		if (ActiveAction.RemainingTime <= 0.0f)
@@ -274,43 +277,83 @@ void UActionSystem::ApplyTuningData(UPlayerTuningData* TuningData)
 
 bool UActionSystem::ExecuteKickAction(AActor* Instigator, const FVector& Direction, float Force)
 {
-	if (!Instigator)
-	{
-		return false;
-	}
+	return KickBall(Instigator, Direction, Force, nullptr, 0.0);
+}
 
-	// Try to execute kick action first
-	if (!TryExecuteAction(EPlayerAction::Kick, Instigator))
-	{
-		return false;
-	}
+bool UActionSystem::ExecuteTackleAction(AActor* Instigator)
+{
+	return TackleBall(Instigator, nullptr, 0.0);
+}
+
+bool UActionSystem::ExecuteKickActionAt(AActor* Instigator, const FVector& Direction, float Force, const FLagCompensationHistory& History, double ViewTime)
+{
+	return KickBall(Instigator, Direction, Force, &History, ViewTime);
+}
 
+bool UActionSystem::ExecuteTackleActionAt(AActor* Instigator, const FLagCompensationHistory& History, double ViewTime)
+{
+	return TackleBall(Instigator, &History, ViewTime);
+}
+
+ABall* UActionSystem::FindBallInRange(AActor* Instigator, float Range, const FLagCompensationHistory* History, double ViewTime, float& OutDistance) const
+{
 	// Find nearby ball
 	// This is a simplified implementation - in a full game, you'd have a ball manager
 	TArray<AActor*> FoundActors;
 	UGameplayStatics::GetAllActorsOfClass(Instigator->GetWorld(), ABall::StaticClass(), FoundActors);
 
+	// The match has one ball, which is the one the history tracks
+	FVector RewoundPosition;
+	const bool bRewound = History && History->SamplePosition(FWorldSnapshot::BallEntityId, ViewTime, RewoundPosition);
+
 	ABall* NearestBall = nullptr;
-	float NearestDistance = 200.0f; // Max kick distance
+	OutDistance = Range;
 
 	for (AActor* Actor : FoundActors)
 	{
 		ABall* Ball = Cast<ABall>(Actor);
 		if (Ball)
 		{
-			float Distance = FVector::Dist(Instigator->GetActorLocation(), Ball->GetActorLocation());
-			if (Distance < NearestDistance)
+			const FVector BallPosition = bRewound ? RewoundPosition : Ball->GetActorLocation();
+			float Distance = FVector::Dist(Instigator->GetActorLocation(), BallPosition);
+			if (Distance < OutDistance)
 			{
 				NearestBall = Ball;
-				NearestDistance = Distance;
+				OutDistance = Distance;
 			}
 		}
 	}
 
+	return NearestBall;
+}
+
+bool UActionSystem::KickBall(AActor* Instigator, const FVector& Direction, float Force, const FLagCompensationHistory* History, double ViewTime)
+{
+	if (!Instigator)
+	{
+		return false;
+	}
+
+	// Try to execute kick action first
+	if (!TryExecuteAction(EPlayerAction::Kick, Instigator))
+	{
+		return false;
+	}
+
+	float Distance = 0.0f;
+	ABall* NearestBall = FindBallInRange(Instigator, 200.0f, History, ViewTime, Distance); // Max kick distance
+
 	if (NearestBall)
 	{
-		// Kick the ball
-		NearestBall->Kick(Direction, Force);
+		// Kick the ball, from where the kicker saw it when the check was rewound
+		if (History)
+		{
+			NearestBall->KickAtTime(Direction, Force, ViewTime);
+		}
+		else
+		{
+			NearestBall->Kick(Direction, Force);
+		}
 		UE_LOG(LogTemp, Log, TEXT("ActionSystem: Kicked ball with force %.1f"), Force);
 		return true;
 	}
@@ -319,7 +362,7 @@ bool UActionSystem::ExecuteKickAction(AActor* Instigator, const FVector& Directi
 	return false;
 }
 
-bool UActionSystem::ExecuteTackleAction(AActor* Instigator)
+bool UActionSystem::TackleBall(AActor* Instigator, const FLagCompensationHistory* History, double ViewTime)
 {
 	if (!Instigator)
 	{
@@ -332,31 +375,14 @@ bool UActionSystem::ExecuteTackleAction(AActor* Instigator)
 		return false;
 	}
 
-	// Find nearby ball
-	TArray<AActor*> FoundActors;
-	UGameplayStatics::GetAllActorsOfClass(Instigator->GetWorld(), ABall::StaticClass(), FoundActors);
-
-	ABall* NearestBall = nullptr;
-	float NearestDistance = 150.0f; // Tackle range
-
-	for (AActor* Actor : FoundActors)
-	{
-		ABall* Ball = Cast<ABall>(Actor);
-		if (Ball)
-		{
-			float Distance = FVector::Dist(Instigator->GetActorLocation(), Ball->GetActorLocation());
-			if (Distance < NearestDistance)
-			{
-				NearestBall = Ball;
-				NearestDistance = Distance;
-			}
-		}
-	}
+	float Distance = 0.0f;
+	ABall* NearestBall = FindBallInRange(Instigator, 150.0f, History, ViewTime, Distance); // Tackle range
 
 	if (NearestBall)
 	{
-		// Try to gain possession
-		if (NearestBall->TryGainPossession(Instigator))
+		// Try to gain possession; a rewound check has already settled the range
+		const bool bGained = History ? NearestBall->GrantPossession(Instigator) : NearestBall->TryGainPossession(Instigator);
+		if (bGained)
 		{
 			UE_LOG(LogTemp, Log, TEXT("ActionSystem: Tackle successful - gained possession"));
 			return true;
@@ -60,6 +60,8 @@ struct FActionDefinition
 
 class ACharacter;
 class UPlayerMovementComponent;
+class ABall;
+class FLagCompensationHistory;
 
 USTRUCT()
 struct FActiveAction
@@ -109,6 +111,11 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Actions")
 	bool ExecutePassAction(AActor* Instigator, AActor* TargetActor);
 
+	// Server-side, lag compensated: the ball is checked for range where the attacker saw it, at ViewTime
+	// (server clock) in History, rather than where it is by the time the input is simulated
+	bool ExecuteKickActionAt(AActor* Instigator, const FVector& Direction, float Force, const FLagCompensationHistory& History, double ViewTime);
+	bool ExecuteTackleActionAt(AActor* Instigator, const FLagCompensationHistory& History, double ViewTime);
+
 protected:
 	void InitializeDefaultActions();
 	const FActionDefinition* FindActionDefinition(EPlayerAction Action) const;
@@ -116,6 +123,13 @@ protected:
 	void ExecuteActionEffects(const FActionDefinition& ActionDef, ACharacter* Character, UPlayerMovementComponent* MovementComp);
 	void OnActionCompleted(const FActiveAction& CompletedAction);
 
+	// Kick and tackle bodies; History is null for an unrewound check against the ball's current position
+	bool KickBall(AActor* Instigator, const FVector& Direction, float Force, const FLagCompensationHistory* History, double ViewTime);
+	bool TackleBall(AActor* Instigator, const FLagCompensationHistory* History, double ViewTime);
+
+	// Nearest ball within Range of the instigator, with its distance
+	ABall* FindBallInRange(AActor* Instigator, float Range, const FLagCompensationHistory* History, double ViewTime, float& OutDistance) const;
+
 	UPROPERTY()
 	TArray<FActionDefinition> RegisteredActions;
 
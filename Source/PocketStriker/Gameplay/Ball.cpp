@@ -1,12 +1,32 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "Ball.h"
+#include "PocketStrikerPlayerController.h"
 #include "Components/SphereComponent.h"
 #include "Components/StaticMeshComponent.h"
 #include "Particles/ParticleSystemComponent.h"
 #include "GameFramework/Character.h"
 #include "Net/UnrealNetwork.h"
 #include "Engine/World.h"
+#include "GameFramework/GameStateBase.h"
+
+namespace
+{
+	// Kick times travel in input packets at millisecond resolution; rounding here makes a client's
+	// predicted launch start exactly where the server's will
+	double QuantizeKickTime(double Time)
+	{
+		return FMath::RoundToDouble(Time * 1000.0) / 1000.0;
+	}
+
+	FBallFlightState ToSimState(const FBallLaunch& Launch)
+	{
+		FBallFlightState State;
+		State.Position = Launch.Position;
+		State.Velocity = Launch.Velocity;
+		return State;
+	}
+}
 
 ABall::ABall()
 {
@@ -16,11 +36,13 @@ ABall::ABall()
 	SphereComponent = CreateDefaultSubobject<USphereComponent>(TEXT("SphereComponent"));
 	RootComponent = SphereComponent;
 	SphereComponent->InitSphereRadius(15.0f);
-	SphereComponent->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-	SphereComponent->SetCollisionProfileName(TEXT("PhysicsActor"));
-	SphereComponent->SetSimulatePhysics(true);
-	SphereComponent->SetEnableGravity(true);
-	SphereComponent->SetNotifyRigidBodyCollision(true);
+
+	// Movement comes from FBallSimulation; the sphere only detects players for possession
+	SphereComponent->SetCollisionProfileName(TEXT("OverlapAllDynamic"));
+	SphereComponent->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	SphereComponent->SetSimulatePhysics(false);
+	SphereComponent->SetEnableGravity(false);
+	SphereComponent->SetGenerateOverlapEvents(true);
 	SphereComponent->OnComponentBeginOverlap.AddDynamic(this, &ABall::OnBallOverlap);
 
 	// Create mesh component
@@ -40,6 +62,17 @@ ABall::ABall()
 	BallRestitution = 0.6f;
 	BallLinearDamping = 0.5f;
 	BallAngularDamping = 0.3f;
+	BallRollingDamping = 1.0f;
+	BallBounceFriction = 0.1f;
+	PitchMin = FVector2D(-6000.0f, -4000.0f);
+	PitchMax = FVector2D(6000.0f, 4000.0f);
+
+	// Default prediction properties
+	CorrectionKeyframeInterval = 1.0f;
+	MaxKickRewind = 0.25f;
+	KickPredictionTimeout = 0.5f;
+	CorrectionSmoothingRate = 10.0f;
+	CorrectionSnapDistance = 300.0f;
 
 	// Default possession properties
 	PossessionRadius = 100.0f;
@@ -53,10 +86,10 @@ ABall::ABall()
 	PossessionHighlightColor = FLinearColor(0.0f, 1.0f, 0.0f, 1.0f);
 	bShowPossessionEffect = true;
 
-	// Replication
+	// Replication: only launches and possession; kicks and possession changes force an update
 	bReplicates = true;
-	SetReplicateMovement(true);
-	NetUpdateFrequency = 60.0f;
+	SetReplicateMovement(false);
+	NetUpdateFrequency = 10.0f;
 
 	PossessingActor = nullptr;
 }
@@ -64,14 +97,13 @@ ABall::ABall()
 void ABall::BeginPlay()
 {
 	Super::BeginPlay();
-	
-	// Configure physics properties
-	if (SphereComponent)
+
+	// The ball starts at rest where it was placed
+	if (HasAuthority())
 	{
-		SphereComponent->SetMassOverrideInKg(NAME_None, BallMass, true);
-		SphereComponent->SetPhysMaterialOverride(nullptr); // Use default physics material
-		SphereComponent->SetLinearDamping(BallLinearDamping);
-		SphereComponent->SetAngularDamping(BallAngularDamping);
+		FBallFlightState Start;
+		Start.Position = GetActorLocation();
+		Relaunch(FBallSimulation::Kick(Start, FVector::ZeroVector, 0.0f, GetSimTuning()), GetSimulationTime(), false);
 	}
 
 	UpdateVisualFeedback();
@@ -81,12 +113,25 @@ void ABall::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	UpdateSimulation(DeltaTime);
 	UpdatePossession(DeltaTime);
 }
 
 void ABall::Kick(const FVector& Direction, float Force)
 {
-	if (!SphereComponent)
+	if (HasAuthority())
+	{
+		KickAtTime(Direction, Force, GetSimulationTime());
+	}
+	else
+	{
+		PredictKick(Direction, Force, GetSimulationTime());
+	}
+}
+
+void ABall::KickAtTime(const FVector& Direction, float Force, double KickTime)
+{
+	if (!HasAuthority())
 	{
 		return;
 	}
@@ -94,15 +139,172 @@ void ABall::Kick(const FVector& Direction, float Force)
 	// Clamp force to max
 	float ClampedForce = FMath::Min(Force, MaxKickForce);
 
-	// Apply impulse
-	FVector Impulse = Direction.GetSafeNormal() * ClampedForce;
-	SphereComponent->AddImpulse(Impulse, NAME_None, true);
+	// Honour when the kicker saw the ball, but never before the launch it saw or further back than allowed
+	const double Now = GetSimulationTime();
+	const double Earliest = FMath::Min(Now, FMath::Max(Now - MaxKickRewind, Launch.ServerTime));
+	KickTime = FMath::Clamp(QuantizeKickTime(KickTime), Earliest, Now);
+
+	const FBallSimTuning Tuning = GetSimTuning();
+	FBallFlightState Origin;
+	if (PossessingActor)
+	{
+		Origin.Position = GetActorLocation();
+	}
+	else
+	{
+		Origin = FBallSimulation::Evaluate(ToSimState(Launch), KickTime - Launch.ServerTime, Tuning);
+	}
 
 	// Release possession
 	ReleasePossession();
+	Relaunch(FBallSimulation::Kick(Origin, Direction, ClampedForce, Tuning), KickTime, true);
+
+	UE_LOG(LogTemp, Log, TEXT("Ball: Kicked with force %.1f in direction %s, %.0f ms back"), 
+		ClampedForce, *Direction.ToString(), (Now - KickTime) * 1000.0);
+}
+
+void ABall::PredictKick(const FVector& Direction, float Force, double KickTime)
+{
+	if (HasAuthority())
+	{
+		return;
+	}
+
+	const FVector DisplayedPosition = GetActorLocation();
+	const FBallSimTuning Tuning = GetSimTuning();
+	KickTime = QuantizeKickTime(KickTime);
+
+	FBallFlightState Origin;
+	if (PossessingActor && !bHasPredictedKick)
+	{
+		Origin.Position = DisplayedPosition - VisualErrorOffset;
+	}
+	else
+	{
+		const FBallLaunch& Followed = bHasPredictedKick ? PredictedLaunch : Launch;
+		Origin = FBallSimulation::Evaluate(ToSimState(Followed), KickTime - Followed.ServerTime, Tuning);
+	}
+
+	const FBallFlightState Kicked = FBallSimulation::Kick(Origin, Direction, FMath::Min(Force, MaxKickForce), Tuning);
+	PredictedLaunch.Position = Kicked.Position;
+	PredictedLaunch.Velocity = Kicked.Velocity;
+	PredictedLaunch.ServerTime = KickTime;
+	PredictedLaunch.KickCount = Launch.KickCount + 1;
+	bHasPredictedKick = true;
+	PredictedKickWallTime = GetWorld()->GetRealTimeSeconds();
+
+	BlendToFollowedLaunch(DisplayedPosition);
+}
+
+void ABall::Relaunch(const FBallFlightState& State, double ServerTime, bool bKick)
+{
+	Launch.Position = State.Position;
+	Launch.Velocity = State.Velocity;
+	Launch.ServerTime = ServerTime;
+	Launch.KickCount += bKick ? 1 : 0;
+	NextKeyframeTime = ServerTime + CorrectionKeyframeInterval;
+	CurrentVelocity = State.Velocity;
+	ForceNetUpdate();
+}
+
+void ABall::UpdateSimulation(float DeltaTime)
+{
+	VisualErrorOffset *= FMath::Exp(-CorrectionSmoothingRate * DeltaTime);
+	if (VisualErrorOffset.SizeSquared() < FMath::Square(0.1f))
+	{
+		VisualErrorOffset = FVector::ZeroVector;
+	}
+
+	// A kick the server never confirmed (out of range there, or lost to a tackle) falls back to its launch
+	if (bHasPredictedKick && GetWorld()->GetRealTimeSeconds() - PredictedKickWallTime > KickPredictionTimeout)
+	{
+		bHasPredictedKick = false;
+		BlendToFollowedLaunch(GetActorLocation());
+	}
+
+	// A held ball follows its possessor instead
+	if (PossessingActor && !bHasPredictedKick)
+	{
+		CurrentVelocity = FVector::ZeroVector;
+		return;
+	}
+
+	const double Now = GetSimulationTime();
+	const FBallLaunch& Followed = bHasPredictedKick ? PredictedLaunch : Launch;
+	const FBallSimTuning Tuning = GetSimTuning();
+	const FBallFlightState State = FBallSimulation::Evaluate(ToSimState(Followed), Now - Followed.ServerTime, Tuning);
+	CurrentVelocity = State.Velocity;
+	SetActorLocation(State.Position + VisualErrorOffset);
+
+	// Rebase the launch now and then while it moves, and once when it settles, so clients that drifted line back up
+	if (HasAuthority() && Now >= NextKeyframeTime && (!FBallSimulation::IsAtRest(State, Tuning) || !Launch.Velocity.IsZero()))
+	{
+		Relaunch(State, Now, false);
+	}
+}
+
+void ABall::BlendToFollowedLaunch(const FVector& DisplayedPosition)
+{
+	if (PossessingActor && !bHasPredictedKick)
+	{
+		VisualErrorOffset = FVector::ZeroVector;
+		return;
+	}
+
+	const FBallLaunch& Followed = bHasPredictedKick ? PredictedLaunch : Launch;
+	const FBallFlightState State = FBallSimulation::Evaluate(ToSimState(Followed), GetSimulationTime() - Followed.ServerTime, GetSimTuning());
+	const FVector Error = DisplayedPosition - State.Position;
+	VisualErrorOffset = Error.SizeSquared() > FMath::Square(CorrectionSnapDistance) ? FVector::ZeroVector : Error;
+}
+
+void ABall::OnRep_Launch()
+{
+	const FVector DisplayedPosition = GetActorLocation();
+
+	// The server's copy of our kick (or any later one) supersedes the prediction; earlier keyframes do not
+	if (bHasPredictedKick && Launch.KickCount < PredictedLaunch.KickCount)
+	{
+		return;
+	}
 
-	UE_LOG(LogTemp, Log, TEXT("Ball: Kicked with force %.1f in direction %s"), 
-		ClampedForce, *Direction.ToString());
+	bHasPredictedKick = false;
+	BlendToFollowedLaunch(DisplayedPosition);
+}
+
+double ABall::GetSimulationTime() const
+{
+	UWorld* World = GetWorld();
+	if (!World)
+	{
+		return 0.0;
+	}
+
+	if (HasAuthority())
+	{
+		return World->GetTimeSeconds();
+	}
+
+	// Launches are stamped on the server clock; the local controller's synced estimate reads it
+	if (const APocketStrikerPlayerController* Controller = Cast<APocketStrikerPlayerController>(World->GetFirstPlayerController()))
+	{
+		return Controller->GetServerTime();
+	}
+
+	const AGameStateBase* GameState = World->GetGameState();
+	return GameState ? GameState->GetServerWorldTimeSeconds() : World->GetTimeSeconds();
+}
+
+FBallSimTuning ABall::GetSimTuning() const
+{
+	FBallSimTuning Tuning;
+	Tuning.Gravity = GetWorld() ? -GetWorld()->GetGravityZ() : 980.0f;
+	Tuning.Radius = SphereComponent ? SphereComponent->GetUnscaledSphereRadius() : 15.0f;
+	Tuning.LinearDamping = BallLinearDamping;
+	Tuning.RollingDamping = BallRollingDamping;
+	Tuning.Restitution = BallRestitution;
+	Tuning.BounceFriction = BallBounceFriction;
+	Tuning.PitchBounds = FBox2D(PitchMin, PitchMax);
+	return Tuning;
 }
 
 void ABall::Pass(AActor* TargetActor, float Force)
@@ -139,16 +341,26 @@ bool ABall::TryGainPossession(AActor* NewOwner)
 		return false;
 	}
 
-	// Check if ball is moving too fast to be possessed
-	FVector Velocity = GetBallVelocity();
-	if (Velocity.Size() > PossessionMinVelocity && PossessingActor != nullptr)
+	// Check distance to ball
+	float Distance = FVector::Dist(GetActorLocation(), NewOwner->GetActorLocation());
+	if (Distance > PossessionRadius)
 	{
 		return false;
 	}
 
-	// Check distance to ball
-	float Distance = FVector::Dist(GetActorLocation(), NewOwner->GetActorLocation());
-	if (Distance > PossessionRadius)
+	return GrantPossession(NewOwner);
+}
+
+bool ABall::GrantPossession(AActor* NewOwner)
+{
+	if (!NewOwner)
+	{
+		return false;
+	}
+
+	// Check if ball is moving too fast to be possessed
+	FVector Velocity = GetBallVelocity();
+	if (Velocity.Size() > PossessionMinVelocity && PossessingActor != nullptr)
 	{
 		return false;
 	}
@@ -156,6 +368,7 @@ bool ABall::TryGainPossession(AActor* NewOwner)
 	// Gain possession
 	PossessingActor = NewOwner;
 	UpdateVisualFeedback();
+	ForceNetUpdate();
 
 	UE_LOG(LogTemp, Log, TEXT("Ball: Possession gained by %s"), *NewOwner->GetName());
 	return true;
@@ -168,40 +381,40 @@ void ABall::ReleasePossession()
 		UE_LOG(LogTemp, Log, TEXT("Ball: Possession released by %s"), *PossessingActor->GetName());
 		PossessingActor = nullptr;
 		UpdateVisualFeedback();
+
+		// A dropped ball rests where it was let go (a kick relaunches it straight after)
+		if (HasAuthority())
+		{
+			FBallFlightState Dropped;
+			Dropped.Position = GetActorLocation();
+			Relaunch(FBallSimulation::Kick(Dropped, FVector::ZeroVector, 0.0f, GetSimTuning()), GetSimulationTime(), false);
+		}
 	}
 }
 
 FVector ABall::GetBallVelocity() const
 {
-	if (SphereComponent)
-	{
-		return SphereComponent->GetPhysicsLinearVelocity();
-	}
-	return FVector::ZeroVector;
+	return CurrentVelocity;
 }
 
 FVector ABall::PredictPositionAtTime(float Time) const
 {
-	if (!SphereComponent)
+	if (PossessingActor && !bHasPredictedKick)
 	{
 		return GetActorLocation();
 	}
 
-	// Simple ballistic prediction
-	FVector CurrentLocation = GetActorLocation();
-	FVector CurrentVelocity = GetBallVelocity();
-	FVector Gravity = FVector(0.0f, 0.0f, GetWorld()->GetGravityZ());
-
-	// Position = Current + Velocity*Time + 0.5*Gravity*Time^2
-	FVector PredictedPosition = CurrentLocation + (CurrentVelocity * Time) + (0.5f * Gravity * Time * Time);
-
-	return PredictedPosition;
+	// The same model the ball moves by, so the answer holds through bounces and the roll
+	const FBallLaunch& Followed = bHasPredictedKick ? PredictedLaunch : Launch;
+	const double Elapsed = GetSimulationTime() + Time - Followed.ServerTime;
+	return FBallSimulation::Evaluate(ToSimState(Followed), Elapsed, GetSimTuning()).Position;
 }
 
 void ABall::OnBallOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, 
 	UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
-	if (!OtherActor || OtherActor == this)
+	// Possession is the server's call; clients learn it through replication
+	if (!OtherActor || OtherActor == this || !HasAuthority())
 	{
 		return;
 	}
@@ -217,14 +430,15 @@ void ABall::OnBallOverlap(UPrimitiveComponent* OverlappedComponent, AActor* Othe
 
 void ABall::UpdatePossession(float DeltaTime)
 {
-	if (!PossessingActor)
+	// A kick predicted out of possession already carries the ball away
+	if (!PossessingActor || bHasPredictedKick)
 	{
 		return;
 	}
 
 	// Check if possessing actor is still valid and close enough
 	float Distance = FVector::Dist(GetActorLocation(), PossessingActor->GetActorLocation());
-	if (Distance > PossessionRadius * 1.5f)
+	if (Distance > PossessionRadius * 1.5f && HasAuthority())
 	{
 		// Lost possession due to distance
 		ReleasePossession();
@@ -236,12 +450,7 @@ void ABall::UpdatePossession(float DeltaTime)
 	FVector CurrentLocation = GetActorLocation();
 	FVector NewLocation = FMath::VInterpTo(CurrentLocation, TargetLocation, DeltaTime, 10.0f);
 	
-	if (SphereComponent)
-	{
-		SphereComponent->SetWorldLocation(NewLocation);
-		// Dampen velocity while possessed
-		SphereComponent->SetPhysicsLinearVelocity(FVector::ZeroVector);
-	}
+	SetActorLocation(NewLocation);
 }
 
 void ABall::UpdateVisualFeedback()
@@ -277,4 +486,5 @@ void ABall::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimePro
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
 	DOREPLIFETIME(ABall, PossessingActor);
+	DOREPLIFETIME(ABall, Launch);
 }
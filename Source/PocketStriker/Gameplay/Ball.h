@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "BallSimulation.h"
 #include "Ball.generated.h"
 
 class USphereComponent;
@@ -11,8 +12,33 @@ class UStaticMeshComponent;
 class UParticleSystemComponent;
 
 /**
- * Ball actor with physics simulation and possession system
+ * The ball's last launch: where and how fast it left, on the server clock
+ * Everything the ball does until the next launch follows from this through FBallSimulation
+ */
+USTRUCT(BlueprintType)
+struct FBallLaunch
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Ball")
+	FVector Position = FVector::ZeroVector;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Ball")
+	FVector Velocity = FVector::ZeroVector;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Ball")
+	double ServerTime = 0.0;
+
+	// Kicks so far; a launch with the same count as the previous one is a correction keyframe rather than a kick
+	UPROPERTY(BlueprintReadOnly, Category = "Ball")
+	int32 KickCount = 0;
+};
+
+/**
+ * Ball actor with a deterministic simulation and possession system
  * Handles kick, tackle, and pass interactions
+ * Server and clients evaluate the same FBallSimulation from the replicated launch, so movement is not replicated;
+ * a client shows its own kicks straight away and blends onto the server's launch when it arrives
  */
 UCLASS()
 class POCKETSTRIKER_API ABall : public AActor
@@ -32,6 +58,12 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Ball")
 	void Kick(const FVector& Direction, float Force);
 
+	/** Kick as of KickTime on the server clock (when the kicker saw it), limited to MaxKickRewind; server only */
+	void KickAtTime(const FVector& Direction, float Force, double KickTime);
+
+	/** Show a local player's kick before the server confirms it; the server's launch replaces it when it arrives */
+	void PredictKick(const FVector& Direction, float Force, double KickTime);
+
 	/** Apply pass impulse with aim assist */
 	UFUNCTION(BlueprintCallable, Category = "Ball")
 	void Pass(AActor* TargetActor, float Force);
@@ -40,6 +72,10 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Ball")
 	bool TryGainPossession(AActor* NewOwner);
 
+	/** Possession for a claimant whose range the caller has already checked (lag-compensated tackles) */
+	UFUNCTION(BlueprintCallable, Category = "Ball")
+	bool GrantPossession(AActor* NewOwner);
+
 	/** Release possession of the ball */
 	UFUNCTION(BlueprintCallable, Category = "Ball")
 	void ReleasePossession();
@@ -72,6 +108,23 @@ protected:
 	/** Update visual feedback for possession */
 	void UpdateVisualFeedback();
 
+	/** Move the ball along the launch it follows (the predicted one while a kick is pending) */
+	void UpdateSimulation(float DeltaTime);
+
+	/** New launch from the ball's state at ServerTime; a kick bumps KickCount, a keyframe keeps it */
+	void Relaunch(const FBallFlightState& State, double ServerTime, bool bKick);
+
+	/** Time the launches are measured on: the world clock on the server, the synced server clock on clients */
+	double GetSimulationTime() const;
+
+	FBallSimTuning GetSimTuning() const;
+
+	/** Blend from where the ball is drawn onto the launch it now follows, or snap if that is too far */
+	void BlendToFollowedLaunch(const FVector& DisplayedPosition);
+
+	UFUNCTION()
+	void OnRep_Launch();
+
 protected:
 	/** Sphere collision component */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
@@ -85,6 +138,10 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
 	UParticleSystemComponent* PossessionEffect;
 
+	/** Last launch from the server; replicated only on kicks and correction keyframes */
+	UPROPERTY(ReplicatedUsing = OnRep_Launch, BlueprintReadOnly, Category = "Ball")
+	FBallLaunch Launch;
+
 	/** Actor currently possessing the ball */
 	UPROPERTY(Replicated, BlueprintReadOnly, Category = "Ball")
 	AActor* PossessingActor;
@@ -105,6 +162,34 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Physics")
 	float BallAngularDamping;
 
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Physics", meta = (ToolTip = "Extra damping per second while rolling, on top of linear damping"))
+	float BallRollingDamping;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Physics", meta = (ToolTip = "Fraction of horizontal speed lost on each bounce"))
+	float BallBounceFriction;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Physics", meta = (ToolTip = "Corners of the pitch the ball rebounds inside, cm"))
+	FVector2D PitchMin;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Physics")
+	FVector2D PitchMax;
+
+	/** Prediction properties */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Prediction", meta = (ToolTip = "Seconds between correction keyframes while the ball moves"))
+	float CorrectionKeyframeInterval;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Prediction", meta = (ToolTip = "Furthest back in seconds the server honours a kick's timestamp"))
+	float MaxKickRewind;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Prediction", meta = (ToolTip = "Seconds a predicted kick waits for the server's launch before it is dropped"))
+	float KickPredictionTimeout;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Prediction", meta = (ToolTip = "Rate the visible error of a correction decays at, per second"))
+	float CorrectionSmoothingRate;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Prediction", meta = (ToolTip = "Corrections larger than this snap instead of blending, cm"))
+	float CorrectionSnapDistance;
+
 	/** Possession properties */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Possession")
 	float PossessionRadius;
@@ -126,6 +211,20 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Visual")
 	bool bShowPossessionEffect;
 
+	/** Local kick shown ahead of the server, and when it was made (client clock) */
+	FBallLaunch PredictedLaunch;
+	bool bHasPredictedKick = false;
+	double PredictedKickWallTime = 0.0;
+
+	/** Offset between where the ball is drawn and where its launch puts it, decayed to zero after a correction */
+	FVector VisualErrorOffset = FVector::ZeroVector;
+
+	/** Velocity of the followed launch this frame */
+	FVector CurrentVelocity = FVector::ZeroVector;
+
+	/** Server time of the next correction keyframe */
+	double NextKeyframeTime = 0.0;
+
 	// Replication
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 };
@@ -0,0 +1,190 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "BallSimulation.h"
+
+namespace
+{
+	// Newton steps on the landing time; the start is past the landing, so each step closes in from the same side
+	constexpr int32 LandingIterations = 8;
+
+	// Velocity and height T seconds into a flight under drag K and gravity G (dv/dt = -K v - G z)
+	void Fly(FVector& Position, FVector& Velocity, double T, double K, double G)
+	{
+		if (K > UE_KINDA_SMALL_NUMBER)
+		{
+			const double Decay = FMath::Exp(-K * T);
+			const double Travel = (1.0 - Decay) / K;
+			const double Terminal = G / K;
+			Position.X += Velocity.X * Travel;
+			Position.Y += Velocity.Y * Travel;
+			Position.Z += (Velocity.Z + Terminal) * Travel - Terminal * T;
+			Velocity.X *= Decay;
+			Velocity.Y *= Decay;
+			Velocity.Z = (Velocity.Z + Terminal) * Decay - Terminal;
+		}
+		else
+		{
+			Position += Velocity * T;
+			Position.Z -= 0.5 * G * T * T;
+			Velocity.Z -= G * T;
+		}
+	}
+
+	// Seconds until a ball Height above its rest height, rising at VelocityZ, comes back down to it
+	double FindLandingTime(double Height, double VelocityZ, double K, double G)
+	{
+		if (G <= UE_KINDA_SMALL_NUMBER)
+		{
+			return TNumericLimits<double>::Max();
+		}
+
+		auto HeightAt = [=](double T, double& OutVelocityZ)
+		{
+			FVector Position(0.0, 0.0, Height);
+			FVector Velocity(0.0, 0.0, VelocityZ);
+			Fly(Position, Velocity, T, K, G);
+			OutVelocityZ = Velocity.Z;
+			return Position.Z;
+		};
+
+		// Drag-free landing as the first guess, pushed out until it is past the real one
+		double T = (VelocityZ + FMath::Sqrt(VelocityZ * VelocityZ + 2.0 * G * Height)) / G;
+		double SlopeZ = 0.0;
+		for (int32 Attempt = 0; Attempt < 32 && HeightAt(T, SlopeZ) > 0.0; ++Attempt)
+		{
+			T = T * 2.0 + UE_KINDA_SMALL_NUMBER;
+		}
+
+		// Height is concave in time, so Newton from past the landing never overshoots it
+		for (int32 Iteration = 0; Iteration < LandingIterations; ++Iteration)
+		{
+			const double Z = HeightAt(T, SlopeZ);
+			if (SlopeZ >= 0.0)
+			{
+				break;
+			}
+			T = FMath::Max(0.0, T - Z / SlopeZ);
+		}
+		return T;
+	}
+
+	// Ground roll T seconds on, stopping for good once slower than StopSpeed
+	void Roll(FVector& Position, FVector& Velocity, double T, double K, double StopSpeed)
+	{
+		const double Speed = Velocity.Size2D();
+		if (Speed <= StopSpeed)
+		{
+			Velocity = FVector::ZeroVector;
+			return;
+		}
+
+		if (K <= UE_KINDA_SMALL_NUMBER)
+		{
+			Position.X += Velocity.X * T;
+			Position.Y += Velocity.Y * T;
+			return;
+		}
+
+		const double StopTime = FMath::Loge(Speed / FMath::Max(StopSpeed, UE_KINDA_SMALL_NUMBER)) / K;
+		const double Decay = FMath::Exp(-K * FMath::Min(T, StopTime));
+		Position.X += Velocity.X * (1.0 - Decay) / K;
+		Position.Y += Velocity.Y * (1.0 - Decay) / K;
+		Velocity = T >= StopTime ? FVector::ZeroVector : Velocity * Decay;
+	}
+
+	// Flights are solved as if the pitch went on forever; an elastic edge mirrors that path back inside
+	void FoldAxis(double& Position, double& Velocity, double Min, double Max)
+	{
+		const double Length = Max - Min;
+		if (Length <= 0.0)
+		{
+			return;
+		}
+
+		double Offset = FMath::Fmod(Position - Min, 2.0 * Length);
+		Offset += Offset < 0.0 ? 2.0 * Length : 0.0;
+		if (Offset <= Length)
+		{
+			Position = Min + Offset;
+		}
+		else
+		{
+			Position = Min + 2.0 * Length - Offset;
+			Velocity = -Velocity;
+		}
+	}
+
+	void FoldIntoPitch(FBallFlightState& State, const FBallSimTuning& Tuning)
+	{
+		if (!Tuning.PitchBounds.bIsValid)
+		{
+			return;
+		}
+		FoldAxis(State.Position.X, State.Velocity.X, Tuning.PitchBounds.Min.X + Tuning.Radius, Tuning.PitchBounds.Max.X - Tuning.Radius);
+		FoldAxis(State.Position.Y, State.Velocity.Y, Tuning.PitchBounds.Min.Y + Tuning.Radius, Tuning.PitchBounds.Max.Y - Tuning.Radius);
+	}
+}
+
+FBallFlightState FBallSimulation::Evaluate(const FBallFlightState& Launch, double Elapsed, const FBallSimTuning& Tuning)
+{
+	const double G = Tuning.Gravity;
+	const double K = FMath::Max(Tuning.LinearDamping, 0.0f);
+	const double RestZ = Tuning.GetRestHeight();
+
+	FBallFlightState State = Launch;
+	State.Position.Z = FMath::Max(State.Position.Z, RestZ);
+	double Remaining = FMath::Max(Elapsed, 0.0);
+
+	// Air: fly to each landing and bounce until the hop is too small to leave the ground
+	for (int32 Bounce = 0; Bounce < MaxBounces; ++Bounce)
+	{
+		if (State.Position.Z <= RestZ && State.Velocity.Z < Tuning.MinBounceSpeed)
+		{
+			break;
+		}
+
+		const double Landing = FindLandingTime(State.Position.Z - RestZ, State.Velocity.Z, K, G);
+		if (Remaining < Landing)
+		{
+			Fly(State.Position, State.Velocity, Remaining, K, G);
+			FoldIntoPitch(State, Tuning);
+			return State;
+		}
+
+		Fly(State.Position, State.Velocity, Landing, K, G);
+		Remaining -= Landing;
+
+		// Horizontal scaling commutes with the pitch-edge mirror, so bouncing in unfolded space is exact
+		State.Position.Z = RestZ;
+		State.Velocity.Z = -State.Velocity.Z * Tuning.Restitution;
+		State.Velocity.X *= 1.0f - Tuning.BounceFriction;
+		State.Velocity.Y *= 1.0f - Tuning.BounceFriction;
+	}
+
+	// Ground: a damped roll that comes to a stop
+	State.Position.Z = RestZ;
+	State.Velocity.Z = 0.0;
+	Roll(State.Position, State.Velocity, Remaining, K + FMath::Max(Tuning.RollingDamping, 0.0f), Tuning.StopSpeed);
+	FoldIntoPitch(State, Tuning);
+	return State;
+}
+
+FBallFlightState FBallSimulation::Kick(const FBallFlightState& State, const FVector& Direction, float Speed, const FBallSimTuning& Tuning)
+{
+	FBallFlightState Result = State;
+	Result.Velocity += Direction.GetSafeNormal() * Speed;
+
+	// A launch has to start on the pitch for the edge mirror to hold
+	Result.Position.Z = FMath::Max(Result.Position.Z, static_cast<double>(Tuning.GetRestHeight()));
+	if (Tuning.PitchBounds.bIsValid)
+	{
+		Result.Position.X = FMath::Clamp(Result.Position.X, Tuning.PitchBounds.Min.X + Tuning.Radius, Tuning.PitchBounds.Max.X - Tuning.Radius);
+		Result.Position.Y = FMath::Clamp(Result.Position.Y, Tuning.PitchBounds.Min.Y + Tuning.Radius, Tuning.PitchBounds.Max.Y - Tuning.Radius);
+	}
+	return Result;
+}
+
+bool FBallSimulation::IsAtRest(const FBallFlightState& State, const FBallSimTuning& Tuning)
+{
+	return State.Position.Z <= Tuning.GetRestHeight() && State.Velocity.IsNearlyZero();
+}
@@ -0,0 +1,61 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Ball rules as plain data, copied out of ABall
+ */
+struct POCKETSTRIKER_API FBallSimTuning
+{
+	float Gravity = 980.0f;
+	float Radius = 15.0f;
+	float GroundZ = 0.0f;
+
+	// Air drag, and the extra drag of rolling on the grass, per second
+	float LinearDamping = 0.5f;
+	float RollingDamping = 1.0f;
+
+	// Vertical speed kept by a bounce, and horizontal speed kept through the contact
+	float Restitution = 0.6f;
+	float BounceFriction = 0.1f;
+
+	// Bounces slower than this settle into a roll; rolls slower than StopSpeed stop
+	float MinBounceSpeed = 60.0f;
+	float StopSpeed = 2.0f;
+
+	// Edges the ball rebounds off, elastically; a zero-size box disables them
+	FBox2D PitchBounds = FBox2D(FVector2D(-6000.0f, -4000.0f), FVector2D(6000.0f, 4000.0f));
+
+	float GetRestHeight() const { return GroundZ + Radius; }
+};
+
+/**
+ * Where the ball is and where it is heading (FMatchSimState keeps its own rollback ball)
+ */
+struct POCKETSTRIKER_API FBallFlightState
+{
+	FVector Position = FVector::ZeroVector;
+	FVector Velocity = FVector::ZeroVector;
+};
+
+/**
+ * Deterministic ball flight: drag, gravity, ground bounces with restitution, a damped roll and pitch-edge rebounds
+ * Solved in closed form from the last launch rather than integrated, so the state at a time depends only on the
+ * launch and the elapsed time: server and clients agree at any frame rate, and a client can start a kick itself
+ * and line up with the server once it hears the same launch. Touches no UObjects
+ */
+struct POCKETSTRIKER_API FBallSimulation
+{
+	// State Elapsed seconds after Launch
+	static FBallFlightState Evaluate(const FBallFlightState& Launch, double Elapsed, const FBallSimTuning& Tuning);
+
+	// Launch state for a kick: Speed along Direction added to the ball's velocity, starting from a point on the pitch
+	static FBallFlightState Kick(const FBallFlightState& State, const FVector& Direction, float Speed, const FBallSimTuning& Tuning);
+
+	static bool IsAtRest(const FBallFlightState& State, const FBallSimTuning& Tuning);
+
+	// Bounces solved per Evaluate before the rest of the flight is treated as a roll
+	static constexpr int32 MaxBounces = 16;
+};
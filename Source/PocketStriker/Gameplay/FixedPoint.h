@@ -0,0 +1,123 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Set from PocketStriker.Build.cs; 1 runs the player simulation on FFixed64 instead of float math
+#ifndef POCKETSTRIKER_DETERMINISTIC_SIM
+#define POCKETSTRIKER_DETERMINISTIC_SIM 0
+#endif
+
+/**
+ * Signed Q47.16 fixed-point number
+ * Every operation is integer-only with explicitly specified rounding, so results are bit-identical
+ * across compilers, optimization levels and CPU architectures
+ */
+struct FFixed64
+{
+	static constexpr int32 FractionBits = 16;
+	static constexpr int64 OneRaw = int64(1) << FractionBits;
+
+	int64 Raw = 0;
+
+	static constexpr FFixed64 FromRaw(int64 InRaw) { FFixed64 Result; Result.Raw = InRaw; return Result; }
+
+	// Round half up; exact for any double that came from ToDouble
+	static FFixed64 FromDouble(double Value) { return FromRaw(static_cast<int64>(FMath::FloorToDouble(Value * OneRaw + 0.5))); }
+
+	// Exact while |Value| < 2^37, which covers every simulated quantity
+	double ToDouble() const { return static_cast<double>(Raw) / OneRaw; }
+	float ToFloat() const { return static_cast<float>(ToDouble()); }
+
+	FFixed64 operator+(FFixed64 Other) const { return FromRaw(Raw + Other.Raw); }
+	FFixed64 operator-(FFixed64 Other) const { return FromRaw(Raw - Other.Raw); }
+	FFixed64 operator-() const { return FromRaw(-Raw); }
+
+	// Round half up (arithmetic shift)
+	FFixed64 operator*(FFixed64 Other) const { return FromRaw((Raw * Other.Raw + (OneRaw >> 1)) >> FractionBits); }
+
+	// Truncates towards zero; callers guard against a zero divisor
+	FFixed64 operator/(FFixed64 Other) const { return FromRaw((Raw * OneRaw) / Other.Raw); }
+
+	FFixed64& operator+=(FFixed64 Other) { Raw += Other.Raw; return *this; }
+	FFixed64& operator-=(FFixed64 Other) { Raw -= Other.Raw; return *this; }
+
+	bool operator==(FFixed64 Other) const { return Raw == Other.Raw; }
+	bool operator!=(FFixed64 Other) const { return Raw != Other.Raw; }
+	bool operator<(FFixed64 Other) const { return Raw < Other.Raw; }
+	bool operator<=(FFixed64 Other) const { return Raw <= Other.Raw; }
+	bool operator>(FFixed64 Other) const { return Raw > Other.Raw; }
+	bool operator>=(FFixed64 Other) const { return Raw >= Other.Raw; }
+
+	static FFixed64 Min(FFixed64 A, FFixed64 B) { return A < B ? A : B; }
+	static FFixed64 Max(FFixed64 A, FFixed64 B) { return A > B ? A : B; }
+
+	// Floor of the exact square root; negative inputs return zero
+	static FFixed64 Sqrt(FFixed64 Value)
+	{
+		if (Value.Raw <= 0)
+		{
+			return FFixed64();
+		}
+
+		// sqrt(Raw / 2^16) * 2^16 == sqrt(Raw * 2^16), computed bit by bit
+		uint64 Remainder = static_cast<uint64>(Value.Raw) << FractionBits;
+		uint64 Root = 0;
+		uint64 Bit = uint64(1) << 62;
+		while (Bit > Remainder)
+		{
+			Bit >>= 2;
+		}
+		while (Bit != 0)
+		{
+			if (Remainder >= Root + Bit)
+			{
+				Remainder -= Root + Bit;
+				Root = (Root >> 1) + Bit;
+			}
+			else
+			{
+				Root >>= 1;
+			}
+			Bit >>= 2;
+		}
+		return FromRaw(static_cast<int64>(Root));
+	}
+};
+
+/**
+ * Three-component FFixed64 vector with the handful of operations the simulation needs
+ */
+struct FFixedVector
+{
+	FFixed64 X;
+	FFixed64 Y;
+	FFixed64 Z;
+
+	static FFixedVector FromVector(const FVector& Vector)
+	{
+		return { FFixed64::FromDouble(Vector.X), FFixed64::FromDouble(Vector.Y), FFixed64::FromDouble(Vector.Z) };
+	}
+
+	FVector ToVector() const { return FVector(X.ToDouble(), Y.ToDouble(), Z.ToDouble()); }
+
+	FFixedVector operator+(const FFixedVector& Other) const { return { X + Other.X, Y + Other.Y, Z + Other.Z }; }
+	FFixedVector operator-(const FFixedVector& Other) const { return { X - Other.X, Y - Other.Y, Z - Other.Z }; }
+	FFixedVector operator*(FFixed64 Scale) const { return { X * Scale, Y * Scale, Z * Scale }; }
+
+	bool IsZero() const { return X.Raw == 0 && Y.Raw == 0 && Z.Raw == 0; }
+
+	FFixed64 SizeSquared() const { return X * X + Y * Y + Z * Z; }
+	FFixed64 Size() const { return FFixed64::Sqrt(SizeSquared()); }
+
+	FFixedVector GetSafeNormal() const
+	{
+		const FFixed64 Length = Size();
+		if (Length.Raw == 0)
+		{
+			return FFixedVector();
+		}
+		return { X / Length, Y / Length, Z / Length };
+	}
+};
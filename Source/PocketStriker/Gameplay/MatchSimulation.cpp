@@ -0,0 +1,170 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "MatchSimulation.h"
+
+namespace
+{
+	FVector GetFacing(const FPlayerSimState& Player)
+	{
+		const FVector Facing = Player.Movement.Velocity.GetSafeNormal2D();
+		return Facing.IsNearlyZero() ? FVector::ForwardVector : Facing;
+	}
+
+	bool IsCommittedState(EPlayerState State)
+	{
+		return State == EPlayerState::Tackle || State == EPlayerState::Kick || State == EPlayerState::Pass;
+	}
+
+	float GetCommittedDuration(EPlayerState State, const FMatchSimTuning& Tuning)
+	{
+		switch (State)
+		{
+			case EPlayerState::Tackle: return Tuning.TackleDuration;
+			case EPlayerState::Kick: return Tuning.KickDuration;
+			case EPlayerState::Pass: return Tuning.PassDuration;
+			default: return 0.0f;
+		}
+	}
+
+	void EnterState(FPlayerSimState& Player, EPlayerState NewState)
+	{
+		if (Player.State != NewState)
+		{
+			Player.State = NewState;
+			Player.StateTimer = 0.0f;
+		}
+	}
+
+	void ReleaseBall(FBallSimState& Ball, const FVector& Velocity)
+	{
+		Ball.PossessorIndex = INDEX_NONE;
+		Ball.Velocity = Velocity;
+	}
+}
+
+void FMatchSimulation::Step(FMatchSimState& State, const FInputCommand* Inputs, float DeltaTime, const FMatchSimTuning& Tuning)
+{
+	const FBoundsCollisionResolver Resolver(Tuning.PitchBounds);
+	FBallSimState& Ball = State.Ball;
+
+	// Players: movement, stamina, then actions in player order
+	for (int32 i = 0; i < State.NumPlayers; ++i)
+	{
+		FPlayerSimState& Player = State.Players[i];
+		const FInputCommand& Input = Inputs[i];
+
+		Player.Movement = FMovementSimulation::Step(Player.Movement, Input, DeltaTime, Tuning.Movement, &Resolver);
+		Player.Movement = FMovementSimulation::RegenerateStamina(Player.Movement, DeltaTime, Tuning.Movement);
+		Player.StateTimer = FMovementSimulation::AdvanceTimer(Player.StateTimer, DeltaTime);
+
+		// Committed actions run to completion
+		if (IsCommittedState(Player.State))
+		{
+			if (Player.StateTimer >= GetCommittedDuration(Player.State, Tuning))
+			{
+				EnterState(Player, EPlayerState::Idle);
+			}
+			continue;
+		}
+
+		if (Input.ActionFlags & FInputCommand::FLAG_TACKLE)
+		{
+			EnterState(Player, EPlayerState::Tackle);
+
+			// Knock the ball loose from an opponent in range
+			if (Ball.PossessorIndex != INDEX_NONE && Ball.PossessorIndex != i)
+			{
+				const FPlayerSimState& Possessor = State.Players[Ball.PossessorIndex];
+				if (FVector::Dist(Player.Movement.Position, Possessor.Movement.Position) <= Tuning.TackleRange)
+				{
+					ReleaseBall(Ball, Player.Movement.Velocity);
+				}
+			}
+		}
+		else if ((Input.ActionFlags & FInputCommand::FLAG_KICK) && Ball.PossessorIndex == i)
+		{
+			EnterState(Player, EPlayerState::Kick);
+			ReleaseBall(Ball, GetFacing(Player) * Tuning.KickSpeed);
+		}
+		else if ((Input.ActionFlags & FInputCommand::FLAG_PASS) && Ball.PossessorIndex == i)
+		{
+			EnterState(Player, EPlayerState::Pass);
+			ReleaseBall(Ball, GetFacing(Player) * Tuning.PassSpeed);
+		}
+		else if (Player.Movement.bIsSprinting)
+		{
+			EnterState(Player, EPlayerState::Sprint);
+		}
+		else
+		{
+			EnterState(Player, Player.Movement.Velocity.SizeSquared() > 1.0f ? EPlayerState::Move : EPlayerState::Idle);
+		}
+	}
+
+	// Ball: carried by its possessor, otherwise rolls with damping and bounces off the pitch edges
+	if (Ball.PossessorIndex != INDEX_NONE)
+	{
+		const FPlayerSimState& Possessor = State.Players[Ball.PossessorIndex];
+		Ball.Position = Possessor.Movement.Position + GetFacing(Possessor) * Tuning.DribbleDistance;
+		Ball.Velocity = Possessor.Movement.Velocity;
+	}
+	else
+	{
+		Ball.Position += Ball.Velocity * DeltaTime;
+		Ball.Velocity *= FMath::Max(0.0f, 1.0f - Tuning.BallLinearDamping * DeltaTime);
+
+		for (int32 Axis = 0; Axis < 2; ++Axis)
+		{
+			if (Ball.Position[Axis] < Tuning.PitchBounds.Min[Axis] || Ball.Position[Axis] > Tuning.PitchBounds.Max[Axis])
+			{
+				Ball.Position[Axis] = FMath::Clamp(Ball.Position[Axis], Tuning.PitchBounds.Min[Axis], Tuning.PitchBounds.Max[Axis]);
+				Ball.Velocity[Axis] = -Ball.Velocity[Axis];
+			}
+		}
+
+		// Slow balls go to the nearest player in reach who is not mid-action
+		if (Ball.Velocity.SizeSquared() <= FMath::Square(Tuning.PossessionMaxBallSpeed))
+		{
+			float BestDistanceSq = FMath::Square(Tuning.PossessionRadius);
+			for (int32 i = 0; i < State.NumPlayers; ++i)
+			{
+				if (IsCommittedState(State.Players[i].State))
+				{
+					continue;
+				}
+
+				const float DistanceSq = FVector::DistSquared2D(State.Players[i].Movement.Position, Ball.Position);
+				if (DistanceSq <= BestDistanceSq)
+				{
+					BestDistanceSq = DistanceSq;
+					Ball.PossessorIndex = i;
+				}
+			}
+		}
+	}
+
+	State.Frame++;
+}
+
+uint64 FMatchSimulation::HashState(const FMatchSimState& State)
+{
+	uint64 Hash = 0xcbf29ce484222325ull;
+	for (int32 i = 0; i < State.NumPlayers; ++i)
+	{
+		Hash = FMovementSimulation::HashState(State.Players[i].Movement, Hash);
+		Hash = (Hash ^ static_cast<uint8>(State.Players[i].State)) * 0x100000001b3ull;
+
+		// The timer decides when an action ends, so two states that differ only here diverge later
+		const uint64 StateTimer = static_cast<uint64>(FFixed64::FromDouble(State.Players[i].StateTimer).Raw);
+		for (int32 Byte = 0; Byte < 8; ++Byte)
+		{
+			Hash = (Hash ^ ((StateTimer >> (Byte * 8)) & 0xFF)) * 0x100000001b3ull;
+		}
+	}
+
+	FMovementSimState BallAsState;
+	BallAsState.Position = State.Ball.Position;
+	BallAsState.Velocity = State.Ball.Velocity;
+	BallAsState.Stamina = static_cast<float>(State.Ball.PossessorIndex);
+	return FMovementSimulation::HashState(BallAsState, Hash);
+}
@@ -0,0 +1,81 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTypes.h"
+#include "MovementSimulation.h"
+#include "PlayerStateMachine.h"
+#include <type_traits>
+
+/**
+ * One player inside the match simulation
+ */
+struct POCKETSTRIKER_API FPlayerSimState
+{
+	FMovementSimState Movement;
+	EPlayerState State = EPlayerState::Idle;
+	float StateTimer = 0.0f;
+};
+
+/**
+ * The ball inside the match simulation
+ */
+struct POCKETSTRIKER_API FBallSimState
+{
+	FVector Position = FVector::ZeroVector;
+	FVector Velocity = FVector::ZeroVector;
+	int32 PossessorIndex = INDEX_NONE;
+};
+
+/**
+ * Complete match simulation state for one frame: players, ball and action timers
+ * Trivially copyable with a fixed size, so snapshot and restore are a single memcpy
+ */
+struct POCKETSTRIKER_API FMatchSimState
+{
+	static constexpr int32 MaxPlayers = 8;
+
+	// Next frame to simulate
+	int32 Frame = 0;
+	int32 NumPlayers = 0;
+	FPlayerSimState Players[MaxPlayers];
+	FBallSimState Ball;
+};
+
+static_assert(std::is_trivially_copyable<FMatchSimState>::value, "FMatchSimState is snapshotted with memcpy");
+
+/**
+ * Match rules as plain data
+ */
+struct POCKETSTRIKER_API FMatchSimTuning
+{
+	FMovementSimTuning Movement;
+	FBox PitchBounds = FBox(FVector(-6000.0f, -4000.0f, 0.0f), FVector(6000.0f, 4000.0f, 0.0f));
+
+	float TackleRange = 150.0f;
+	float TackleDuration = 0.5f;
+	float KickDuration = 0.4f;
+	float PassDuration = 0.3f;
+
+	float KickSpeed = 2000.0f;
+	float PassSpeed = 1200.0f;
+
+	float PossessionRadius = 100.0f;
+	float PossessionMaxBallSpeed = 600.0f;
+	float DribbleDistance = 50.0f;
+	float BallLinearDamping = 0.5f;
+};
+
+/**
+ * Advances a whole match by one fixed step from one input per player
+ * Pure function of (state, inputs, tuning), so rollback can re-run frames freely
+ */
+struct POCKETSTRIKER_API FMatchSimulation
+{
+	// Inputs holds State.NumPlayers commands
+	static void Step(FMatchSimState& State, const FInputCommand* Inputs, float DeltaTime, const FMatchSimTuning& Tuning);
+
+	// Field-wise hash for desync checks (memory hashing would include padding)
+	static uint64 HashState(const FMatchSimState& State);
+};
@@ -0,0 +1,218 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "MovementSimulation.h"
+#include "GameplayTypes.h"
+#include "PlayerTuningData.h"
+
+// Produced by RunHashSequence(GoldenSeed, GoldenSteps) in the deterministic build; update only on intended simulation changes
+const uint64 FMovementSimulation::GoldenHash = 0xeabab0f694243263ull;
+
+FMovementSimTuning FMovementSimTuning::FromTuningData(const UPlayerTuningData& TuningData)
+{
+	FMovementSimTuning Tuning;
+	Tuning.MaxWalkSpeed = TuningData.MaxWalkSpeed;
+	Tuning.MaxSprintSpeed = TuningData.MaxSprintSpeed;
+	Tuning.Acceleration = TuningData.Acceleration;
+	Tuning.Deceleration = TuningData.Deceleration;
+	Tuning.MaxStamina = TuningData.MaxStamina;
+	Tuning.SprintStaminaCost = TuningData.SprintStaminaCost;
+	Tuning.StaminaRegenRate = TuningData.StaminaRegenRate;
+	return Tuning;
+}
+
+FVector FBoundsCollisionResolver::ResolveMove(const FVector& Start, const FVector& Delta) const
+{
+	return ClampVector(Start + Delta, Bounds.Min, Bounds.Max);
+}
+
+FMovementSimState FMovementSimulation::Step(const FMovementSimState& State, const FInputCommand& Input, float DeltaTime,
+	const FMovementSimTuning& Tuning, const IMovementCollisionResolver* Resolver)
+{
+	FMovementSimState Result = State;
+
+#if POCKETSTRIKER_DETERMINISTIC_SIM
+	// Same algorithm as the float path below, on integer math only
+	const FFixed64 Dt = FFixed64::FromDouble(DeltaTime);
+	const FFixed64 Zero;
+	FFixedVector Position = FFixedVector::FromVector(State.Position);
+	FFixedVector Velocity = FFixedVector::FromVector(State.Velocity);
+	FFixed64 Stamina = FFixed64::FromDouble(State.Stamina);
+
+	FFixedVector InputVector = { FFixed64::FromDouble(Input.MovementInput.Y), FFixed64::FromDouble(Input.MovementInput.X), Zero };
+	if (InputVector.SizeSquared() > FFixed64::FromRaw(FFixed64::OneRaw))
+	{
+		InputVector = InputVector.GetSafeNormal();
+	}
+
+	Result.bIsSprinting = (Input.ActionFlags & FInputCommand::FLAG_SPRINT) != 0 && Stamina > Zero;
+
+	FFixed64 TargetSpeed = FFixed64::FromDouble(Tuning.MaxWalkSpeed);
+	if (Result.bIsSprinting)
+	{
+		TargetSpeed = FFixed64::FromDouble(Tuning.MaxSprintSpeed);
+		Stamina = FFixed64::Max(Zero, Stamina - FFixed64::FromDouble(Tuning.SprintStaminaCost) * Dt);
+
+		if (Stamina <= Zero)
+		{
+			Result.bIsSprinting = false;
+		}
+	}
+
+	const FFixedVector DesiredVelocity = InputVector * TargetSpeed;
+	FFixedVector VelocityDelta = DesiredVelocity - Velocity;
+
+	const FFixed64 AccelRate = FFixed64::FromDouble(InputVector.SizeSquared() > Zero ? Tuning.Acceleration : Tuning.Deceleration);
+	const FFixed64 MaxVelocityChange = AccelRate * Dt;
+	if (VelocityDelta.SizeSquared() > MaxVelocityChange * MaxVelocityChange)
+	{
+		VelocityDelta = VelocityDelta.GetSafeNormal() * MaxVelocityChange;
+	}
+
+	Velocity = Velocity + VelocityDelta;
+
+	if (Velocity.SizeSquared() > TargetSpeed * TargetSpeed)
+	{
+		Velocity = Velocity.GetSafeNormal() * TargetSpeed;
+	}
+
+	const FFixedVector Delta = Velocity * Dt;
+	if (!Delta.IsZero())
+	{
+		Position = Resolver ? FFixedVector::FromVector(Resolver->ResolveMove(Position.ToVector(), Delta.ToVector())) : Position + Delta;
+	}
+
+	Result.Position = Position.ToVector();
+	Result.Velocity = Velocity.ToVector();
+	Result.Stamina = Stamina.ToFloat();
+#else
+	// Get movement input direction
+	FVector InputVector = FVector(Input.MovementInput.Y, Input.MovementInput.X, 0.0f);
+	if (InputVector.SizeSquared() > 1.0f)
+	{
+		InputVector.Normalize();
+	}
+
+	// Determine target speed based on sprint state; can't sprint without stamina
+	Result.bIsSprinting = (Input.ActionFlags & FInputCommand::FLAG_SPRINT) != 0 && Result.Stamina > 0.0f;
+
+	float TargetSpeed = Tuning.MaxWalkSpeed;
+	if (Result.bIsSprinting)
+	{
+		TargetSpeed = Tuning.MaxSprintSpeed;
+		Result.Stamina = FMath::Max(0.0f, Result.Stamina - Tuning.SprintStaminaCost * DeltaTime);
+
+		if (Result.Stamina <= 0.0f)
+		{
+			Result.bIsSprinting = false;
+		}
+	}
+
+	// Apply acceleration/deceleration towards the desired velocity
+	const FVector DesiredVelocity = InputVector * TargetSpeed;
+	FVector VelocityDelta = DesiredVelocity - Result.Velocity;
+
+	const float AccelRate = (InputVector.SizeSquared() > 0.0f) ? Tuning.Acceleration : Tuning.Deceleration;
+	const float MaxVelocityChange = AccelRate * DeltaTime;
+	if (VelocityDelta.SizeSquared() > MaxVelocityChange * MaxVelocityChange)
+	{
+		VelocityDelta = VelocityDelta.GetSafeNormal() * MaxVelocityChange;
+	}
+
+	Result.Velocity += VelocityDelta;
+
+	// Clamp velocity to max speed
+	if (Result.Velocity.SizeSquared() > TargetSpeed * TargetSpeed)
+	{
+		Result.Velocity = Result.Velocity.GetSafeNormal() * TargetSpeed;
+	}
+
+	// Apply velocity to position
+	const FVector Delta = Result.Velocity * DeltaTime;
+	if (!Delta.IsNearlyZero())
+	{
+		Result.Position = Resolver ? Resolver->ResolveMove(Result.Position, Delta) : Result.Position + Delta;
+	}
+#endif
+
+	return Result;
+}
+
+FMovementSimState FMovementSimulation::RegenerateStamina(const FMovementSimState& State, float DeltaTime, const FMovementSimTuning& Tuning)
+{
+	FMovementSimState Result = State;
+	if (!Result.bIsSprinting)
+	{
+#if POCKETSTRIKER_DETERMINISTIC_SIM
+		const FFixed64 Regenerated = FFixed64::FromDouble(State.Stamina) + FFixed64::FromDouble(Tuning.StaminaRegenRate) * FFixed64::FromDouble(DeltaTime);
+		Result.Stamina = FFixed64::Min(FFixed64::FromDouble(Tuning.MaxStamina), Regenerated).ToFloat();
+#else
+		Result.Stamina = FMath::Min(Tuning.MaxStamina, Result.Stamina + Tuning.StaminaRegenRate * DeltaTime);
+#endif
+	}
+	return Result;
+}
+
+float FMovementSimulation::AdvanceTimer(float Timer, float DeltaTime)
+{
+#if POCKETSTRIKER_DETERMINISTIC_SIM
+	return (FFixed64::FromDouble(Timer) + FFixed64::FromDouble(DeltaTime)).ToFloat();
+#else
+	return Timer + DeltaTime;
+#endif
+}
+
+uint64 FMovementSimulation::HashState(const FMovementSimState& State, uint64 Hash)
+{
+	const int64 Values[] =
+	{
+		FFixed64::FromDouble(State.Position.X).Raw,
+		FFixed64::FromDouble(State.Position.Y).Raw,
+		FFixed64::FromDouble(State.Position.Z).Raw,
+		FFixed64::FromDouble(State.Velocity.X).Raw,
+		FFixed64::FromDouble(State.Velocity.Y).Raw,
+		FFixed64::FromDouble(State.Velocity.Z).Raw,
+		FFixed64::FromDouble(State.Stamina).Raw,
+		State.bIsSprinting ? 1 : 0
+	};
+
+	// Byte order is fixed (least significant first) so the hash does not depend on endianness
+	for (int64 Value : Values)
+	{
+		for (int32 Byte = 0; Byte < 8; ++Byte)
+		{
+			Hash ^= (static_cast<uint64>(Value) >> (Byte * 8)) & 0xFF;
+			Hash *= 0x100000001b3ull;
+		}
+	}
+	return Hash;
+}
+
+uint64 FMovementSimulation::RunHashSequence(uint32 Seed, int32 NumSteps)
+{
+	const FMovementSimTuning Tuning;
+	const FBoundsCollisionResolver Resolver(FBox(FVector(-6000.0f, -4000.0f, 0.0f), FVector(6000.0f, 4000.0f, 0.0f)));
+	const float DeltaTime = 1.0f / 60.0f;
+
+	FMovementSimState State;
+	FInputCommand Input;
+	uint32 Random = Seed;
+	uint64 Hash = HashState(State);
+
+	for (int32 i = 0; i < NumSteps; ++i)
+	{
+		// A new stick direction every 8 steps; sprint held three quarters of the time so stamina runs out and recovers
+		if (i % 8 == 0)
+		{
+			Random = Random * 1664525u + 1013904223u;
+			Input.MovementInput.X = (static_cast<int32>((Random >> 24) & 0xFF) - 128) / 128.0;
+			Input.MovementInput.Y = (static_cast<int32>((Random >> 16) & 0xFF) - 128) / 128.0;
+			Input.ActionFlags = ((Random >> 8) & 3) != 0 ? FInputCommand::FLAG_SPRINT : 0;
+		}
+
+		State = Step(State, Input, DeltaTime, Tuning, &Resolver);
+		State = RegenerateStamina(State, DeltaTime, Tuning);
+		Hash = HashState(State, Hash);
+	}
+
+	return Hash;
+}
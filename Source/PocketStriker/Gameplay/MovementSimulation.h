@@ -0,0 +1,93 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FixedPoint.h"
+
+struct FInputCommand;
+class UPlayerTuningData;
+
+/**
+ * Movement tuning as plain data, copied out of UPlayerTuningData or the movement component
+ */
+struct POCKETSTRIKER_API FMovementSimTuning
+{
+	float MaxWalkSpeed = 600.0f;
+	float MaxSprintSpeed = 900.0f;
+	float Acceleration = 2000.0f;
+	float Deceleration = 4000.0f;
+	float MaxStamina = 100.0f;
+	float SprintStaminaCost = 20.0f;
+	float StaminaRegenRate = 15.0f;
+
+	static FMovementSimTuning FromTuningData(const UPlayerTuningData& TuningData);
+};
+
+/**
+ * Everything one movement step reads and writes
+ */
+struct POCKETSTRIKER_API FMovementSimState
+{
+	FVector Position = FVector::ZeroVector;
+	FVector Velocity = FVector::ZeroVector;
+	float Stamina = 100.0f;
+	bool bIsSprinting = false;
+};
+
+/**
+ * Resolves a desired move against the world
+ * The simulation only computes the delta; what it collides with is up to the caller
+ */
+class POCKETSTRIKER_API IMovementCollisionResolver
+{
+public:
+	virtual ~IMovementCollisionResolver() = default;
+
+	// Returns where a body at Start ends up after trying to move by Delta
+	virtual FVector ResolveMove(const FVector& Start, const FVector& Delta) const = 0;
+};
+
+/**
+ * Keeps players inside an axis-aligned box (the pitch); no world queries
+ */
+class POCKETSTRIKER_API FBoundsCollisionResolver : public IMovementCollisionResolver
+{
+public:
+	explicit FBoundsCollisionResolver(const FBox& InBounds) : Bounds(InBounds) {}
+
+	virtual FVector ResolveMove(const FVector& Start, const FVector& Delta) const override;
+
+private:
+	FBox Bounds;
+};
+
+/**
+ * Deterministic player movement: acceleration, speed clamp and stamina
+ * Touches no UObjects, so replays, server validation and benchmarks can run it in bulk
+ * With POCKETSTRIKER_DETERMINISTIC_SIM the math runs on FFixed64 and is bit-identical on every platform;
+ * state stays in the float types and round-trips through fixed point exactly
+ */
+struct POCKETSTRIKER_API FMovementSimulation
+{
+	// Advances State by one input; moves freely when Resolver is null
+	static FMovementSimState Step(const FMovementSimState& State, const FInputCommand& Input, float DeltaTime,
+		const FMovementSimTuning& Tuning, const IMovementCollisionResolver* Resolver = nullptr);
+
+	// Stamina recovery while not sprinting (applied per frame, independent of input)
+	static FMovementSimState RegenerateStamina(const FMovementSimState& State, float DeltaTime, const FMovementSimTuning& Tuning);
+
+	// Count a timer up or down by DeltaTime (fixed point in the deterministic build)
+	static float AdvanceTimer(float Timer, float DeltaTime);
+
+	// FNV-1a over the state in 16.16 fixed-point units, chained through Hash
+	static uint64 HashState(const FMovementSimState& State, uint64 Hash = 0xcbf29ce484222325ull);
+
+	// Runs NumSteps of a seeded pseudo-random input stream inside the pitch bounds and returns the chained hash
+	static uint64 RunHashSequence(uint32 Seed, int32 NumSteps);
+
+	// Expected RunHashSequence(GoldenSeed, GoldenSteps) in the deterministic build
+	static constexpr uint32 GoldenSeed = 1;
+	static constexpr int32 GoldenSteps = 100000;
+	static const uint64 GoldenHash;
+};
@@ -5,6 +5,27 @@
 #include "PlayerTuningData.h"
 #include "GameFramework/Character.h"
 
+namespace
+{
+	// Routes the simulation's moves through the component's swept movement
+	class FComponentCollisionResolver : public IMovementCollisionResolver
+	{
+	public:
+		explicit FComponentCollisionResolver(UPlayerMovementComponent& InMovementComponent)
+			: MovementComponent(InMovementComponent)
+		{
+		}
+
+		virtual FVector ResolveMove(const FVector& Start, const FVector& Delta) const override
+		{
+			return MovementComponent.SweepAndSlide(Delta);
+		}
+
+	private:
+		UPlayerMovementComponent& MovementComponent;
+	};
+}
+
 UPlayerMovementComponent::UPlayerMovementComponent()
 {
 	PrimaryComponentTick.bCanEverTick = true;
@@ -40,71 +61,69 @@ void UPlayerMovementComponent::TickComponent(float DeltaTime, ELevelTick TickTyp
 void UPlayerMovementComponent::SimulateMovement(const FInputCommand& Input, float DeltaTime)
 {
 	// Deterministic movement simulation for network prediction
-	// This method processes input and updates velocity/position
+	// The kinematics live in FMovementSimulation; this only supplies world collision
 	
 	if (!UpdatedComponent)
 	{
 		return;
 	}
 
-	// Get movement input direction
-	FVector InputVector = FVector(Input.MovementInput.Y, Input.MovementInput.X, 0.0f);
-	
-	if (InputVector.SizeSquared() > 1.0f)
-	{
-		InputVector.Normalize();
-	}
+	FComponentCollisionResolver Resolver(*this);
+	ApplySimState(FMovementSimulation::Step(GetSimState(), Input, DeltaTime, GetSimTuning(), &Resolver));
+}
 
-	// Check if sprinting
-	bIsSprinting = (Input.ActionFlags & FInputCommand::FLAG_SPRINT) != 0;
-	
-	// Determine target speed based on sprint state
-	float TargetSpeed = MaxWalkSpeed;
-	if (bIsSprinting && CurrentStamina > 0.0f)
-	{
-		TargetSpeed = MaxSprintSpeed;
-		ConsumeStamina(SprintStaminaCostPerSecond * DeltaTime);
-	}
-	else
+FMovementSimState UPlayerMovementComponent::GetSimState() const
+{
+	FMovementSimState State;
+	State.Position = UpdatedComponent ? UpdatedComponent->GetComponentLocation() : FVector::ZeroVector;
+	State.Velocity = Velocity;
+	State.Stamina = CurrentStamina;
+	State.bIsSprinting = bIsSprinting;
+	return State;
+}
+
+void UPlayerMovementComponent::ApplySimState(const FMovementSimState& State)
+{
+	// Position is only written when it differs, so resolver-driven moves are not undone
+	if (UpdatedComponent && !UpdatedComponent->GetComponentLocation().Equals(State.Position))
 	{
-		bIsSprinting = false; // Can't sprint without stamina
+		UpdatedComponent->SetWorldLocation(State.Position);
 	}
 
-	// Calculate desired velocity
-	FVector DesiredVelocity = InputVector * TargetSpeed;
-	
-	// Apply acceleration/deceleration
-	FVector CurrentVelocity = Velocity;
-	FVector VelocityDelta = DesiredVelocity - CurrentVelocity;
-	
-	float AccelRate = (InputVector.SizeSquared() > 0.0f) ? MaxAcceleration : BrakingDecelerationWalking;
-	float MaxVelocityChange = AccelRate * DeltaTime;
-	
-	if (VelocityDelta.SizeSquared() > MaxVelocityChange * MaxVelocityChange)
+	Velocity = State.Velocity;
+	CurrentStamina = State.Stamina;
+	bIsSprinting = State.bIsSprinting;
+}
+
+FMovementSimTuning UPlayerMovementComponent::GetSimTuning() const
+{
+	FMovementSimTuning Tuning;
+	Tuning.MaxWalkSpeed = MaxWalkSpeed;
+	Tuning.MaxSprintSpeed = MaxSprintSpeed;
+	Tuning.Acceleration = MaxAcceleration;
+	Tuning.Deceleration = BrakingDecelerationWalking;
+	Tuning.MaxStamina = MaxStamina;
+	Tuning.SprintStaminaCost = SprintStaminaCostPerSecond;
+	Tuning.StaminaRegenRate = StaminaRegenRate;
+	return Tuning;
+}
+
+FVector UPlayerMovementComponent::SweepAndSlide(const FVector& Delta)
+{
+	if (!UpdatedComponent)
 	{
-		VelocityDelta = VelocityDelta.GetSafeNormal() * MaxVelocityChange;
+		return FVector::ZeroVector;
 	}
+
+	FHitResult Hit;
+	SafeMoveUpdatedComponent(Delta, UpdatedComponent->GetComponentQuat(), true, Hit);
 	
-	Velocity = CurrentVelocity + VelocityDelta;
-	
-	// Clamp velocity to max speed
-	if (Velocity.SizeSquared() > TargetSpeed * TargetSpeed)
+	if (Hit.IsValidBlockingHit())
 	{
-		Velocity = Velocity.GetSafeNormal() * TargetSpeed;
+		SlideAlongSurface(Delta, 1.0f - Hit.Time, Hit.Normal, Hit);
 	}
 
-	// Apply velocity to position
-	FVector Delta = Velocity * DeltaTime;
-	if (!Delta.IsNearlyZero())
-	{
-		FHitResult Hit;
-		SafeMoveUpdatedComponent(Delta, UpdatedComponent->GetComponentQuat(), true, Hit);
-		
-		if (Hit.IsValidBlockingHit())
-		{
-			SlideAlongSurface(Delta, 1.0f - Hit.Time, Hit.Normal, Hit);
-		}
-	}
+	return UpdatedComponent->GetComponentLocation();
 }
 
 void UPlayerMovementComponent::ConsumeStamina(float Amount)
@@ -120,7 +139,8 @@ void UPlayerMovementComponent::ConsumeStamina(float Amount)
 
 void UPlayerMovementComponent::RegenerateStamina(float DeltaTime)
 {
-	CurrentStamina = FMath::Min(MaxStamina, CurrentStamina + (StaminaRegenRate * DeltaTime));
+	// Same arithmetic as the simulation, so the deterministic build regenerates on fixed point here too
+	CurrentStamina = FMovementSimulation::RegenerateStamina(GetSimState(), DeltaTime, GetSimTuning()).Stamina;
 }
 
 void UPlayerMovementComponent::ApplyRootMotionToVelocity(float DeltaTime)
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/CharacterMovementComponent.h"
+#include "MovementSimulation.h"
 #include "PlayerMovementComponent.generated.h"
 
 struct FInputCommand;
@@ -21,8 +22,16 @@ class POCKETSTRIKER_API UPlayerMovementComponent : public UCharacterMovementComp
 public:
 	UPlayerMovementComponent();
 
-	// Movement simulation (deterministic for prediction)
+	// Movement simulation (deterministic for prediction); runs FMovementSimulation::Step with world collision
 	void SimulateMovement(const FInputCommand& Input, float DeltaTime);
+
+	// Plain-data view of the simulated state and tuning, for running FMovementSimulation off the actor
+	FMovementSimState GetSimState() const;
+	void ApplySimState(const FMovementSimState& State);
+	FMovementSimTuning GetSimTuning() const;
+
+	// Sweep the updated component by Delta, sliding along whatever it hits; returns the new location
+	FVector SweepAndSlide(const FVector& Delta);
 	
 	// Stamina system
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Stamina")
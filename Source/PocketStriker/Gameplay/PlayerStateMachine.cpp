@@ -1,6 +1,7 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "PlayerStateMachine.h"
+#include "MovementSimulation.h"
 
 UPlayerStateMachine::UPlayerStateMachine()
 	: CurrentState(EPlayerState::Idle)
@@ -131,7 +132,7 @@ void UPlayerStateMachine::ExitState(EPlayerState State)
 
 void UPlayerStateMachine::UpdateState(float DeltaTime)
 {
-	StateTimer += DeltaTime;
+	StateTimer = FMovementSimulation::AdvanceTimer(StateTimer, DeltaTime);
 
 	// Update current state logic
 	switch (CurrentState)
@@ -6,9 +6,12 @@
 #include "PlayerTuningData.h"
 #include "../Network/NetworkPrediction.h"
 #include "../Network/NetworkReconciler.h"
+#include "../Network/NetworkInterpolation.h"
 #include "../Network/NetworkParamsData.h"
+#include "../Network/NetworkGameState.h"
 #include "Components/CapsuleComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
+#include "EngineUtils.h"
 
 APocketStrikerCharacter::APocketStrikerCharacter(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer.SetDefaultSubobjectClass<UPlayerMovementComponent>(ACharacter::CharacterMovementComponentName))
@@ -28,6 +31,7 @@ APocketStrikerCharacter::APocketStrikerCharacter(const FObjectInitializer& Objec
 	// Create network components
 	NetworkPrediction = CreateDefaultSubobject<UNetworkPrediction>(TEXT("NetworkPrediction"));
 	NetworkReconciler = CreateDefaultSubobject<UNetworkReconciler>(TEXT("NetworkReconciler"));
+	NetworkInterpolation = CreateDefaultSubobject<UNetworkInterpolation>(TEXT("NetworkInterpolation"));
 
 	// Configure replication
 	bReplicates = true;
@@ -40,6 +44,16 @@ void APocketStrikerCharacter::BeginPlay()
 {
 	Super::BeginPlay();
 	
+	// World snapshots drive remote characters; replicated movement would fight UNetworkInterpolation's SetActorLocation
+	if (HasAuthority())
+	{
+		TActorIterator<ANetworkGameState> It(GetWorld());
+		if (It)
+		{
+			SetReplicateMovement(false);
+		}
+	}
+
 	// Apply tuning data
 	ApplyTuningData();
 }
@@ -85,7 +99,18 @@ void APocketStrikerCharacter::ApplyTuningData()
 	// Apply network parameters
 	if (NetworkParams && NetworkReconciler)
 	{
-		// Network parameters would be applied to network components here
+		NetworkReconciler->ApplyNetworkParams(NetworkParams->CorrectionThreshold, NetworkParams->SmoothingSpeed,
+			NetworkParams->VelocityCorrectionThreshold, NetworkParams->StaminaCorrectionThreshold);
+		NetworkReconciler->ApplyCorrectionShiftParams(NetworkParams->bShiftSmallCorrections, NetworkParams->MaxShiftPositionDelta,
+			NetworkParams->MaxShiftVelocityDelta, NetworkParams->ServerTickRate);
+
+		if (NetworkInterpolation)
+		{
+			NetworkInterpolation->ApplyNetworkParams(NetworkParams->InterpolationDelay, NetworkParams->StateBufferSize);
+			NetworkInterpolation->ApplyAdaptiveDelayParams(NetworkParams->bAdaptiveInterpolationDelay, NetworkParams->MinInterpolationDelay,
+				NetworkParams->MaxInterpolationDelay, NetworkParams->TargetBufferedPackets, NetworkParams->JitterSafetyFactor, NetworkParams->MaxTimeDilation);
+		}
+
 		UE_LOG(LogTemp, Log, TEXT("PocketStrikerCharacter: Applied network parameters"));
 	}
 }
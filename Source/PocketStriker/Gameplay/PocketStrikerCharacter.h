@@ -10,6 +10,7 @@ class UPlayerMovementComponent;
 class UPlayerStateMachine;
 class UNetworkPrediction;
 class UNetworkReconciler;
+class UNetworkInterpolation;
 class UPlayerTuningData;
 class UNetworkParamsData;
 
@@ -42,6 +43,9 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Character")
 	UNetworkReconciler* GetNetworkReconciler() const { return NetworkReconciler; }
 
+	UFUNCTION(BlueprintCallable, Category = "Character")
+	UNetworkInterpolation* GetNetworkInterpolation() const { return NetworkInterpolation; }
+
 	// Data asset getters
 	UFUNCTION(BlueprintCallable, Category = "Character")
 	UPlayerTuningData* GetPlayerTuning() const { return PlayerTuning; }
@@ -62,6 +66,10 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
 	UNetworkReconciler* NetworkReconciler;
 
+	/** Network interpolation component (renders this character when it is a remote player) */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	UNetworkInterpolation* NetworkInterpolation;
+
 	/** Player tuning data asset */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Tuning")
 	UPlayerTuningData* PlayerTuning;
@@ -5,12 +5,69 @@
 #include "PlayerTuningData.h"
 #include "PlayerStateMachine.h"
 #include "PlayerMovementComponent.h"
+#include "PocketStrikerCharacter.h"
 #include "ActionSystem.h"
 #include "EnhancedInputComponent.h"
 #include "EnhancedInputSubsystems.h"
 #include "InputActionValue.h"
 #include "GameFramework/Character.h"
 #include "Tools/PerformanceProfiler.h"
+#include "Ball.h"
+#include "../Network/NetworkDebugger.h"
+#include "../Network/NetworkGameState.h"
+#include "../Network/NetworkInterpolation.h"
+#include "../Network/NetPacketChecksum.h"
+#include "../Network/NetworkParamsData.h"
+#include "../Network/NetworkPrediction.h"
+#include "../Network/NetworkReconciler.h"
+#include "EngineUtils.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerState.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+
+namespace
+{
+	FInputPacket MakeInputPacket(const FInputCommand& Command)
+	{
+		FInputPacket Packet;
+		Packet.SequenceNumber = Command.SequenceNumber;
+		Packet.ClientTimestamp = Command.ClientTimestamp;
+		Packet.MovementInput = Command.MovementInput;
+		Packet.LookInput = Command.LookInput;
+		Packet.ActionFlags = Command.ActionFlags;
+		return Packet;
+	}
+
+	FInputCommand MakeInputCommand(const FInputPacket& Packet)
+	{
+		FInputCommand Command;
+		Command.SequenceNumber = Packet.SequenceNumber;
+		Command.ClientTimestamp = Packet.ClientTimestamp;
+		Command.MovementInput = Packet.MovementInput;
+		Command.LookInput = Packet.LookInput;
+		Command.ActionFlags = Packet.ActionFlags;
+		return Command;
+	}
+
+	// Plain values carried through the conditioner's byte queues
+	template<typename T>
+	void AppendValue(TArray<uint8>& Payload, const T& Value)
+	{
+		Payload.Append(reinterpret_cast<const uint8*>(&Value), sizeof(T));
+	}
+
+	template<typename T>
+	T ReadValue(const TArray<uint8>& Payload, int32 Offset)
+	{
+		T Value {};
+		if (Payload.Num() >= Offset + static_cast<int32>(sizeof(T)))
+		{
+			FMemory::Memcpy(&Value, Payload.GetData() + Offset, sizeof(T));
+		}
+		return Value;
+	}
+}
 
 APocketStrikerPlayerController::APocketStrikerPlayerController()
 {
@@ -18,6 +75,7 @@ APocketStrikerPlayerController::APocketStrikerPlayerController()
 
 	// Create action system
 	ActionSystem = CreateDefaultSubobject<UActionSystem>(TEXT("ActionSystem"));
+	NetworkDebugger = nullptr;
 }
 
 void APocketStrikerPlayerController::BeginPlay()
@@ -36,6 +94,11 @@ void APocketStrikerPlayerController::BeginPlay()
 		PerformanceProfiler = ControlledPawn->FindComponentByClass<UPerformanceProfiler>();
 	}
 
+	if (IsLocalController())
+	{
+		NetworkDebugger = NewObject<UNetworkDebugger>(this);
+	}
+
 	// Apply tuning data on begin play
 	ApplyTuningData();
 
@@ -53,6 +116,12 @@ void APocketStrikerPlayerController::Tick(float DeltaTime)
 	Super::Tick(DeltaTime);
 	
 	ProcessInput(DeltaTime);
+
+	// Remote clients' inputs are simulated at the fixed server rate when no game state does it
+	if (HasAuthority() && !IsLocalController() && !GetNetworkGameState())
+	{
+		SimulateFallbackInputs(DeltaTime);
+	}
 	
 	// Record display timestamp for latency measurement (end of frame)
 	if (PerformanceProfiler)
@@ -63,34 +132,337 @@ void APocketStrikerPlayerController::Tick(float DeltaTime)
 
 void APocketStrikerPlayerController::ProcessInput(float DeltaTime)
 {
-	// This will be called every frame to process and buffer input
-	// Input buffering for network prediction will be implemented here
+	// Owning clients stream their buffered input to the server every frame
+	if (IsLocalController() && !HasAuthority())
+	{
+		UpdateNetworkConditioner();
+		UpdateClockSync(DeltaTime);
+		RecordPredictedStates();
+		SendRedundantInputs();
+	}
 }
 
-void APocketStrikerPlayerController::BufferInputCommand(const FInputCommand& Command)
+void APocketStrikerPlayerController::UpdateClockSync(float DeltaTime)
 {
-	// Store input command in buffer for network prediction
-	InputBuffer.Add(Command);
-	
-	// Keep buffer size manageable (last 60 frames = 1 second at 60fps)
-	const int32 MaxBufferSize = 60;
-	if (InputBuffer.Num() > MaxBufferSize)
+	const double Now = GetWorld()->GetTimeSeconds();
+	ClockSync.Update(Now, DeltaTime);
+
+	TimeUntilClockPing -= DeltaTime;
+	if (TimeUntilClockPing <= 0.0f)
 	{
-		InputBuffer.RemoveAt(0, InputBuffer.Num() - MaxBufferSize);
+		TArray<uint8> Payload;
+		AppendValue(Payload, Now);
+		SendToServer(EConditionedRpc::ClockPing, Payload);
+
+		// Ping in a quick burst until the filter has enough samples, then settle to the maintenance rate
+		const UNetworkParamsData* Params = GetNetworkParams();
+		TimeUntilClockPing = ClockSync.GetNumSamples() < Params->ClockSyncBurstPings ? Params->ClockSyncBurstInterval : Params->ClockSyncInterval;
 	}
 }
 
-TArray<FInputCommand> APocketStrikerPlayerController::GetUnacknowledgedInputs() const
+void APocketStrikerPlayerController::ServerClockPing_Implementation(double ClientSendTime)
 {
-	TArray<FInputCommand> UnacknowledgedInputs;
-	
-	for (const FInputCommand& Input : InputBuffer)
+	if (ANetworkGameState* NetworkGameState = GetNetworkGameState())
+	{
+		NetworkGameState->RecordClientTraffic(this, ENetTrafficDirection::Received, FNetPacketSample::MakeUnencoded(ENetPacketType::ClockPing, sizeof(double)));
+		NetworkGameState->RecordClientTraffic(this, ENetTrafficDirection::Sent, FNetPacketSample::MakeUnencoded(ENetPacketType::ClockPong, sizeof(double) * 2));
+	}
+
+	ClientClockPong(ClientSendTime, GetWorld()->GetTimeSeconds());
+}
+
+void APocketStrikerPlayerController::ClientClockPong_Implementation(double ClientSendTime, double ServerTime)
+{
+	TArray<uint8> Payload;
+	AppendValue(Payload, ClientSendTime);
+	AppendValue(Payload, ServerTime);
+	if (!ConditionInbound(EConditionedRpc::ClockPong, Payload))
+	{
+		DeliverConditionedPacket(ENetConditionerDirection::Inbound, static_cast<uint8>(EConditionedRpc::ClockPong), Payload);
+	}
+}
+
+void APocketStrikerPlayerController::UpdateNetworkConditioner()
+{
+	if (!NetworkDebugger)
+	{
+		return;
+	}
+
+	// Follow the shared parameters when they change, so designer edits apply live without overriding
+	// SetSimulatedLatency/SetPacketLossPercentage every frame; the random stream only restarts on a new seed
+	const FNetworkConditionerSettings& ParamsConditions = GetNetworkParams()->NetworkConditions;
+	if (!bParamsConditionsApplied
+		|| !FNetworkConditionerSettings::StaticStruct()->CompareScriptStruct(&AppliedParamsConditions, &ParamsConditions, PPF_None))
+	{
+		AppliedParamsConditions = ParamsConditions;
+		bParamsConditionsApplied = true;
+
+		const bool bWasConditioning = NetworkDebugger->IsConditioning();
+		NetworkDebugger->SetConditions(ParamsConditions);
+		if (bWasConditioning != NetworkDebugger->IsConditioning())
+		{
+			UE_LOG(LogTemp, Log, TEXT("Network conditioner %s"), NetworkDebugger->IsConditioning() ? TEXT("enabled") : TEXT("disabled"));
+		}
+	}
+
+	// Packets still queued after the conditions are cleared drain on schedule
+	NetworkDebugger->ProcessDelayedPackets(GetWorld()->GetTimeSeconds(),
+		[this](ENetConditionerDirection Direction, uint8 Channel, const TArray<uint8>& Payload)
+		{
+			DeliverConditionedPacket(Direction, Channel, Payload);
+		});
+}
+
+void APocketStrikerPlayerController::SendToServer(EConditionedRpc Rpc, const TArray<uint8>& Payload, const FNetPacketSample* Sample)
+{
+	static_assert(static_cast<uint8>(EConditionedRpc::Snapshot) == static_cast<uint8>(ENetPacketType::Snapshot)
+		&& static_cast<uint8>(EConditionedRpc::ClockPong) == static_cast<uint8>(ENetPacketType::ClockPong),
+		"Conditioned RPC tags double as traffic stats packet types");
+
+	if (NetworkDebugger)
+	{
+		const ENetPacketType Type = static_cast<ENetPacketType>(Rpc);
+		NetworkDebugger->RecordTraffic(ENetTrafficDirection::Sent, Sample ? *Sample : FNetPacketSample::MakeUnencoded(Type, Payload.Num()),
+			GetWorld()->GetTimeSeconds());
+	}
+
+	if (NetworkDebugger && NetworkDebugger->IsConditioning())
+	{
+		NetworkDebugger->SubmitPacket(ENetConditionerDirection::Outbound, static_cast<uint8>(Rpc), Payload, GetWorld()->GetTimeSeconds());
+		return;
+	}
+
+	DeliverConditionedPacket(ENetConditionerDirection::Outbound, static_cast<uint8>(Rpc), Payload);
+}
+
+bool APocketStrikerPlayerController::ConditionInbound(EConditionedRpc Rpc, const TArray<uint8>& Payload)
+{
+	if (!NetworkDebugger || !NetworkDebugger->IsConditioning() || HasAuthority())
+	{
+		return false;
+	}
+
+	NetworkDebugger->SubmitPacket(ENetConditionerDirection::Inbound, static_cast<uint8>(Rpc), Payload, GetWorld()->GetTimeSeconds());
+	return true;
+}
+
+void APocketStrikerPlayerController::DeliverConditionedPacket(ENetConditionerDirection Direction, uint8 Channel, const TArray<uint8>& Payload)
+{
+	switch (static_cast<EConditionedRpc>(Channel))
+	{
+	case EConditionedRpc::Inputs:
+		ServerSendInputs(Payload);
+		break;
+
+	case EConditionedRpc::SnapshotAck:
+		ServerAcknowledgeSnapshot(ReadValue<uint32>(Payload, 0));
+		break;
+
+	case EConditionedRpc::ClockPing:
+		ServerClockPing(ReadValue<double>(Payload, 0));
+		break;
+
+	case EConditionedRpc::Snapshot:
+		ReceiveSnapshot(Payload);
+		break;
+
+	case EConditionedRpc::ClockPong:
+	{
+		const double ClientSendTime = ReadValue<double>(Payload, 0);
+		const double Now = GetWorld()->GetTimeSeconds();
+		ClockSync.AddSample(ClientSendTime, ReadValue<double>(Payload, sizeof(double)), Now);
+		if (NetworkDebugger)
+		{
+			NetworkDebugger->UpdateRTT(static_cast<float>((Now - ClientSendTime) * 1000.0));
+			NetworkDebugger->RecordTraffic(ENetTrafficDirection::Received, FNetPacketSample::MakeUnencoded(ENetPacketType::ClockPong, Payload.Num()), Now);
+		}
+		break;
+	}
+	}
+}
+
+double APocketStrikerPlayerController::GetServerTime() const
+{
+	const double Now = GetWorld() ? GetWorld()->GetTimeSeconds() : 0.0;
+	return HasAuthority() ? Now : ClockSync.GetServerTime(Now);
+}
+
+void APocketStrikerPlayerController::RecordPredictedStates()
+{
+	// The controller ticks after input processing but before the pawn moves, so inputs buffered
+	// last frame have had their movement applied and this frame's have not
+	APocketStrikerCharacter* PocketStrikerCharacter = Cast<APocketStrikerCharacter>(GetPawn());
+	if (UNetworkPrediction* Prediction = PocketStrikerCharacter ? PocketStrikerCharacter->GetNetworkPrediction() : nullptr)
+	{
+		for (uint32 Sequence = LastRecordedPredictionSequence + 1; Sequence <= PendingPredictionSequence; ++Sequence)
+		{
+			Prediction->SavePredictionState(Sequence);
+		}
+	}
+
+	LastRecordedPredictionSequence = FMath::Max(LastRecordedPredictionSequence, PendingPredictionSequence);
+	PendingPredictionSequence = CurrentInputSequence;
+}
+
+void APocketStrikerPlayerController::SendRedundantInputs()
+{
+	const UNetworkParamsData* Params = GetNetworkParams();
+	const int32 Window = FMath::Clamp(Params->InputRedundancyWindow, 1, static_cast<int32>(MaxRedundantInputs));
+
+	// The buffer already holds runs, so the window goes out without being expanded
+	TArray<FInputRun> Runs;
+	const int32 NumInputs = InputBuffer.GetRunsAfter(LastAcknowledgedSequence, Window, Runs);
+	if (NumInputs == 0)
+	{
+		return;
+	}
+
+	FNetPacketSample Sample;
+	Sample.Type = ENetPacketType::Inputs;
+	Sample.RawBytes = FNetTrafficStats::GetRawInputBytes(NumInputs);
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	const TArray<uint8> Payload = PackInputRuns(Runs, Params->Quantization, &Sample.FieldBits);
+	Sample.Cycles = FPlatformTime::Cycles64() - StartCycles;
+	Sample.Bytes = Payload.Num();
+
+	SendToServer(EConditionedRpc::Inputs, Payload, &Sample);
+}
+
+TArray<uint8> APocketStrikerPlayerController::PackInputs(TArrayView<const FInputCommand> Inputs, const FNetQuantizationSettings& Settings,
+	FNetFieldBits* OutFieldBits)
+{
+	TArray<FInputRun, TInlineAllocator<MaxRedundantInputs>> Runs;
+	for (int32 i = FMath::Max(0, Inputs.Num() - static_cast<int32>(MaxRedundantInputs)); i < Inputs.Num(); ++i)
+	{
+		const FInputPacket Packet = MakeInputPacket(Inputs[i]);
+		if (Runs.Num() > 0 && Runs.Last().CanAppend(Packet))
+		{
+			Runs.Last().Append(Packet);
+		}
+		else
+		{
+			Runs.Add(FInputRun::FromInput(Packet));
+		}
+	}
+
+	return PackInputRuns(Runs, Settings, OutFieldBits);
+}
+
+TArray<uint8> APocketStrikerPlayerController::PackInputRuns(TArrayView<const FInputRun> Runs, const FNetQuantizationSettings& Settings,
+	FNetFieldBits* OutFieldBits)
+{
+	SCOPE_CYCLE_COUNTER(STAT_NetInputPack);
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(InputPack, NetTrafficChannel);
+
+	FBitWriter Writer(0, true);
+	FNetFieldBits LocalFieldBits;
+	FNetFieldBitCounter Counter(Writer, OutFieldBits ? *OutFieldBits : LocalFieldBits);
+	FNetPacketChecksum::Reserve(Writer);
+	Counter.Mark(ENetFieldGroup::Checksum);
+
+	// Runs beyond the input limit are dropped from the old end; the newest inputs matter most
+	int32 FirstRun = Runs.Num();
+	for (uint32 NumInputs = 0; FirstRun > 0 && NumInputs + Runs[FirstRun - 1].Count <= MaxRedundantInputs; --FirstRun)
+	{
+		NumInputs += Runs[FirstRun - 1].Count;
+	}
+
+	uint32 Count = Runs.Num() - FirstRun;
+	Writer.SerializeInt(Count, MaxRedundantInputs + 1);
+	Counter.Mark(ENetFieldGroup::Header);
+
+	// Runs are consecutive, so each first sequence after the first run costs a single byte
+	uint32 BaseSequence = 0;
+	for (int32 i = FirstRun; i < Runs.Num(); ++i)
+	{
+		FInputRun Run = Runs[i];
+		Run.NetSerializeQuantized(Writer, Settings, BaseSequence, &Counter);
+		BaseSequence = Run.GetLastSequence();
+	}
+
+	// One CRC over every redundant input instead of a checksum per input
+	FNetPacketChecksum::Seal(Writer);
+	return TArray<uint8>(Writer.GetData(), Writer.GetNumBytes());
+}
+
+bool APocketStrikerPlayerController::UnpackInputs(const TArray<uint8>& InputData, const FNetQuantizationSettings& Settings, TArray<FInputPacket>& OutPackets,
+	FNetFieldBits* OutFieldBits)
+{
+	if (!FNetPacketChecksum::Verify(InputData))
+	{
+		return false;
+	}
+
+	UnpackVerifiedInputs(InputData, Settings, OutPackets, OutFieldBits);
+	return true;
+}
+
+void APocketStrikerPlayerController::UnpackVerifiedInputs(const TArray<uint8>& InputData, const FNetQuantizationSettings& Settings, TArray<FInputPacket>& OutPackets,
+	FNetFieldBits* OutFieldBits)
+{
+	SCOPE_CYCLE_COUNTER(STAT_NetInputUnpack);
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(InputUnpack, NetTrafficChannel);
+
+	FBitReader Reader(const_cast<uint8*>(InputData.GetData()), InputData.Num() * 8);
+	FNetFieldBits LocalFieldBits;
+	FNetFieldBitCounter Counter(Reader, OutFieldBits ? *OutFieldBits : LocalFieldBits);
+	FNetPacketChecksum::Skip(Reader);
+	Counter.Mark(ENetFieldGroup::Checksum);
+
+	uint32 Count = 0;
+	Reader.SerializeInt(Count, MaxRedundantInputs + 1);
+	Counter.Mark(ENetFieldGroup::Header);
+
+	// Expanded back into one input per sequence, as the server's input queue consumes them
+	uint32 BaseSequence = 0;
+	uint32 NumInputs = 0;
+	for (uint32 i = 0; i < Count && !Reader.IsError(); ++i)
+	{
+		FInputRun Run;
+		if (!Run.NetSerializeQuantized(Reader, Settings, BaseSequence, &Counter)
+			|| Run.Count == 0 || Run.Count > MaxRedundantInputs - NumInputs)
+		{
+			// Later runs are delta coded against this one, so the rest of the packet is unusable
+			break;
+		}
+		BaseSequence = Run.GetLastSequence();
+		NumInputs += Run.Count;
+		for (uint32 Sequence = Run.FirstSequence; Sequence <= Run.GetLastSequence(); ++Sequence)
+		{
+			OutPackets.Add(Run.GetInput(Sequence));
+		}
+	}
+}
+
+void APocketStrikerPlayerController::BufferInputCommand(const FInputCommand& Command)
+{
+	// Snap to the wire resolution so local prediction runs on the values the server will see
+	FInputPacket Packet = MakeInputPacket(Command);
+	Packet.Quantize(GetNetworkParams()->Quantization);
+
+	// Store input command in buffer for network prediction; a repeat of the last one only extends its run
+	InputBuffer.Add(Packet);
+
+	// The prediction component replays these on correction
+	if (APocketStrikerCharacter* PocketStrikerCharacter = Cast<APocketStrikerCharacter>(GetPawn()))
 	{
-		if (Input.SequenceNumber > LastAcknowledgedSequence)
+		if (UNetworkPrediction* Prediction = PocketStrikerCharacter->GetNetworkPrediction())
 		{
-			UnacknowledgedInputs.Add(Input);
+			Prediction->BufferInput(Packet);
 		}
 	}
+}
+
+TArray<FInputCommand> APocketStrikerPlayerController::GetUnacknowledgedInputs() const
+{
+	TArray<FInputCommand> UnacknowledgedInputs;
+	UnacknowledgedInputs.Reserve(InputBuffer.Num());
+
+	InputBuffer.ForEachAfter(LastAcknowledgedSequence, [&UnacknowledgedInputs](const FInputPacket& Input)
+	{
+		UnacknowledgedInputs.Add(MakeInputCommand(Input));
+	});
 	
 	return UnacknowledgedInputs;
 }
@@ -99,11 +471,8 @@ void APocketStrikerPlayerController::AcknowledgeInput(uint32 SequenceNumber)
 {
 	LastAcknowledgedSequence = SequenceNumber;
 	
-	// Remove old acknowledged inputs from buffer
-	InputBuffer.RemoveAll([SequenceNumber](const FInputCommand& Input)
-	{
-		return Input.SequenceNumber <= SequenceNumber;
-	});
+	// Release old acknowledged inputs from buffer
+	InputBuffer.ReleaseUpTo(SequenceNumber);
 }
 
 void APocketStrikerPlayerController::SetupInputComponent()
@@ -144,7 +513,7 @@ void APocketStrikerPlayerController::Move(const FInputActionValue& Value)
 		// Buffer input for network prediction
 		FInputCommand Command;
 		Command.SequenceNumber = ++CurrentInputSequence;
-		Command.ClientTimestamp = GetWorld()->GetTimeSeconds();
+		Command.ClientTimestamp = GetServerTime();
 		Command.MovementInput = MovementVector;
 		
 		BufferInputCommand(Command);
@@ -167,7 +536,7 @@ void APocketStrikerPlayerController::Sprint()
 	// Buffer sprint action
 	FInputCommand Command;
 	Command.SequenceNumber = ++CurrentInputSequence;
-	Command.ClientTimestamp = GetWorld()->GetTimeSeconds();
+	Command.ClientTimestamp = GetServerTime();
 	Command.ActionFlags |= FInputCommand::FLAG_SPRINT;
 	
 	BufferInputCommand(Command);
@@ -183,7 +552,7 @@ void APocketStrikerPlayerController::Tackle()
 	// Buffer tackle action
 	FInputCommand Command;
 	Command.SequenceNumber = ++CurrentInputSequence;
-	Command.ClientTimestamp = GetWorld()->GetTimeSeconds();
+	Command.ClientTimestamp = GetServerTime();
 	Command.ActionFlags |= FInputCommand::FLAG_TACKLE;
 	
 	BufferInputCommand(Command);
@@ -200,7 +569,7 @@ void APocketStrikerPlayerController::Kick()
 	// Buffer kick action
 	FInputCommand Command;
 	Command.SequenceNumber = ++CurrentInputSequence;
-	Command.ClientTimestamp = GetWorld()->GetTimeSeconds();
+	Command.ClientTimestamp = GetServerTime();
 	Command.ActionFlags |= FInputCommand::FLAG_KICK;
 	
 	BufferInputCommand(Command);
@@ -209,6 +578,14 @@ void APocketStrikerPlayerController::Kick()
 	if (ACharacter* Character = GetCharacter())
 	{
 		// State machine integration will be added when wiring systems together
+
+		// Show the kick straight away when the ball is in reach; the server kicks from the same timestamp
+		TActorIterator<ABall> BallIt(GetWorld());
+		if (!HasAuthority() && BallIt && FVector::Dist(BallIt->GetActorLocation(), Character->GetActorLocation()) < 200.0f)
+		{
+			const float KickForce = TuningData ? TuningData->KickForce : 2000.0f;
+			BallIt->PredictKick(Character->GetActorForwardVector(), KickForce, Command.ClientTimestamp);
+		}
 	}
 }
 
@@ -217,7 +594,7 @@ void APocketStrikerPlayerController::Pass()
 	// Buffer pass action
 	FInputCommand Command;
 	Command.SequenceNumber = ++CurrentInputSequence;
-	Command.ClientTimestamp = GetWorld()->GetTimeSeconds();
+	Command.ClientTimestamp = GetServerTime();
 	Command.ActionFlags |= FInputCommand::FLAG_PASS;
 	
 	BufferInputCommand(Command);
@@ -272,111 +649,263 @@ void APocketStrikerPlayerController::OnDataAssetPropertyChanged(UObject* Object,
 #endif
 
 // Network RPC implementations
-void APocketStrikerPlayerController::ServerSendInput_Implementation(const FInputCommand& Input)
+void APocketStrikerPlayerController::ServerSendInputs_Implementation(const TArray<uint8>& InputData)
 {
-	// Server receives input from client
-	// Process input on server using authoritative simulation
-	
-	if (ACharacter* Character = GetCharacter())
+	// Server receives the client's newest inputs; most of them were already seen in earlier packets
+	if (ANetworkGameState* NetworkGameState = GetNetworkGameState())
 	{
-		if (UPlayerMovementComponent* MovementComp = Cast<UPlayerMovementComponent>(Character->GetCharacterMovement()))
-		{
-			// Simulate movement on server
-			float DeltaTime = 1.0f / 60.0f; // Fixed timestep
-			MovementComp->SimulateMovement(Input, DeltaTime);
-		}
+		// Checked together with every other packet that arrived this frame, then deduplicated, validated
+		// and buffered by the authoritative game state
+		NetworkGameState->QueueClientInputPacket(this, InputData);
+		return;
 	}
 
-	// Send state update back to client
-	if (ACharacter* Character = GetCharacter())
+	// No game state in the level: queue here (duplicates are rejected) and drain in Tick
+	TArray<FInputPacket> Packets;
+	UnpackInputs(InputData, GetNetworkParams()->Quantization, Packets);
+	for (const FInputPacket& Packet : Packets)
 	{
-		FVector Position = Character->GetActorLocation();
-		FVector Velocity = FVector::ZeroVector;
-		float Stamina = 100.0f;
-		uint8 State = 0;
+		FallbackInputBuffer.Add(MakeInputCommand(Packet));
+	}
+}
 
-		if (UPlayerMovementComponent* MovementComp = Cast<UPlayerMovementComponent>(Character->GetCharacterMovement()))
+void APocketStrikerPlayerController::SimulateFallbackInputs(float DeltaTime)
+{
+	const UNetworkParamsData* Params = GetNetworkParams();
+	const float SimulationInterval = 1.0f / FMath::Max(Params->ServerTickRate, 1.0f);
+	FallbackInputBuffer.Configure(Params->InputBufferTargetDepth, Params->InputBufferMaxExtraDepth);
+
+	FallbackSimulationAccumulator += DeltaTime;
+	bool bSimulated = false;
+	for (int32 Step = 0; Step < ANetworkGameState::MaxSimulationStepsPerFrame && FallbackSimulationAccumulator >= SimulationInterval; ++Step)
+	{
+		FallbackSimulationAccumulator -= SimulationInterval;
+
+		FInputCommand Commands[FInputJitterBuffer::MaxInputsPerTick];
+		const int32 NumCommands = FallbackInputBuffer.Consume(Commands);
+		if (NumCommands == 0)
 		{
-			Velocity = MovementComp->Velocity;
-			Stamina = MovementComp->CurrentStamina;
+			continue;
 		}
 
-		if (UPlayerStateMachine* StateMachine = Character->FindComponentByClass<UPlayerStateMachine>())
+		if (ACharacter* Character = GetCharacter())
 		{
-			State = static_cast<uint8>(StateMachine->CurrentState);
+			if (UPlayerMovementComponent* MovementComp = Cast<UPlayerMovementComponent>(Character->GetCharacterMovement()))
+			{
+				// Simulate movement on server; two inputs share one step, as on the game state's path
+				const float InputDeltaTime = FInputJitterBuffer::GetStepPerInput(SimulationInterval, NumCommands);
+				for (int32 CommandIndex = 0; CommandIndex < NumCommands; ++CommandIndex)
+				{
+					MovementComp->SimulateMovement(Commands[CommandIndex], InputDeltaTime);
+				}
+			}
 		}
+		bSimulated = true;
+	}
+	FallbackSimulationAccumulator = FMath::Min(FallbackSimulationAccumulator, SimulationInterval);
+
+	// Without a game state there are no snapshots, so reply with the state directly
+	if (bSimulated)
+	{
+		if (ACharacter* Character = GetCharacter())
+		{
+			FVector Position = Character->GetActorLocation();
+			FVector Velocity = FVector::ZeroVector;
+			float Stamina = 100.0f;
+			uint8 State = 0;
+
+			if (UPlayerMovementComponent* MovementComp = Cast<UPlayerMovementComponent>(Character->GetCharacterMovement()))
+			{
+				Velocity = MovementComp->Velocity;
+				Stamina = MovementComp->CurrentStamina;
+			}
+
+			if (UPlayerStateMachine* StateMachine = Character->FindComponentByClass<UPlayerStateMachine>())
+			{
+				State = static_cast<uint8>(StateMachine->CurrentState);
+			}
 
-		ClientReceiveStateUpdate(Position, Velocity, Stamina, State, Input.SequenceNumber);
+			ClientReceiveStateUpdate(Position, Velocity, Stamina, State, FallbackInputBuffer.GetLastConsumedSequence());
+		}
 	}
 }
 
-bool APocketStrikerPlayerController::ServerSendInput_Validate(const FInputCommand& Input)
+void APocketStrikerPlayerController::ClientReceiveStateUpdate_Implementation(const FVector& Position, const FVector& Velocity, float Stamina, uint8 State, uint32 AckedSequence)
 {
-	// Validate input on server to prevent cheating
-	
-	// Check input ranges
-	if (FMath::Abs(Input.MovementInput.X) > 1.0f || FMath::Abs(Input.MovementInput.Y) > 1.0f)
+	// Client receives authoritative state from server; reconcile it exactly as a snapshot's own entity,
+	// so the reconciler's thresholds and the server's fixed step apply here too
+	FStateUpdatePacket StateUpdate;
+	StateUpdate.AcknowledgedSequence = AckedSequence;
+	StateUpdate.AuthoritativePosition = Position;
+	StateUpdate.AuthoritativeVelocity = Velocity;
+	StateUpdate.AuthoritativeState = State;
+	StateUpdate.AuthoritativeStamina = Stamina;
+	ApplyStateUpdate(StateUpdate);
+}
+
+void APocketStrikerPlayerController::ClientReceiveSnapshot_Implementation(const TArray<uint8>& SnapshotData)
+{
+	if (!ConditionInbound(EConditionedRpc::Snapshot, SnapshotData))
 	{
-		return false;
+		ReceiveSnapshot(SnapshotData);
 	}
+}
+
+void APocketStrikerPlayerController::ReceiveSnapshot(const TArray<uint8>& SnapshotData)
+{
+	FBitReader Reader(const_cast<uint8*>(SnapshotData.GetData()), SnapshotData.Num() * 8);
+
+	FNetPacketSample Sample;
+	Sample.Type = ENetPacketType::Snapshot;
+	Sample.Bytes = SnapshotData.Num();
 
-	if (FMath::Abs(Input.LookInput.X) > 1.0f || FMath::Abs(Input.LookInput.Y) > 1.0f)
+	uint32 SnapshotId = 0;
+	FWorldSnapshot Snapshot;
+	bool bDecoded = false;
 	{
-		return false;
+		SCOPE_CYCLE_COUNTER(STAT_NetSnapshotDecode);
+		TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(SnapshotDecode, NetTrafficChannel);
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		bDecoded = FWorldSnapshotCodec::Decode(Reader, ReceivedSnapshots, GetNetworkParams()->Quantization, SnapshotId, Snapshot, &Sample.FieldBits);
+		Sample.Cycles = FPlatformTime::Cycles64() - StartCycles;
 	}
 
-	// Validate action flags
-	const uint32 ValidFlags = FInputCommand::FLAG_SPRINT | FInputCommand::FLAG_TACKLE | 
-		FInputCommand::FLAG_KICK | FInputCommand::FLAG_PASS;
-	if ((Input.ActionFlags & ~ValidFlags) != 0)
+	if (NetworkDebugger)
 	{
-		return false;
+		Sample.RawBytes = FNetTrafficStats::GetRawSnapshotBytes(Snapshot.Entities.Num());
+		NetworkDebugger->RecordTraffic(ENetTrafficDirection::Received, Sample, GetWorld()->GetTimeSeconds());
 	}
 
-	return true;
+	if (!bDecoded)
+	{
+		// Corrupt, or delta against a baseline we no longer hold; the server falls back to a full snapshot
+		UE_LOG(LogTemp, Verbose, TEXT("Dropped undecodable world snapshot"));
+		return;
+	}
+
+	ReceivedSnapshots.Add(SnapshotId, Snapshot);
+
+	TArray<uint8> AckPayload;
+	AppendValue(AckPayload, SnapshotId);
+	SendToServer(EConditionedRpc::SnapshotAck, AckPayload);
+
+	// Unreliable delivery can reorder; never apply an older state over a newer one
+	if (SnapshotId <= LastReceivedSnapshotId)
+	{
+		return;
+	}
+	LastReceivedSnapshotId = SnapshotId;
+
+	ApplyWorldSnapshot(Snapshot);
 }
 
-void APocketStrikerPlayerController::ClientReceiveStateUpdate_Implementation(const FVector& Position, const FVector& Velocity, float Stamina, uint8 State, uint32 AckedSequence)
+void APocketStrikerPlayerController::ApplyWorldSnapshot(const FWorldSnapshot& Snapshot)
 {
-	// Client receives authoritative state from server
-	// This triggers reconciliation if needed
-	
-	AcknowledgeInput(AckedSequence);
+	const uint32 OwnEntityId = PlayerState ? FWorldSnapshot::MakePlayerEntityId(PlayerState->GetPlayerId()) : FWorldSnapshot::InvalidEntityId;
 
-	// Check if we need reconciliation
-	if (ACharacter* Character = GetCharacter())
+	for (const FEntitySnapshotState& Entity : Snapshot.Entities)
 	{
-		FVector CurrentPosition = Character->GetActorLocation();
-		float PositionError = FVector::Dist(CurrentPosition, Position);
+		if (Entity.EntityId == OwnEntityId)
+		{
+			ApplyStateUpdate(Snapshot.MakeStateUpdate(Entity));
+			continue;
+		}
 
-		// If error is significant, reconcile
-		const float CorrectionThreshold = 10.0f; // 10cm
-		if (PositionError > CorrectionThreshold)
+		// Remote players (and the ball, if it interpolates) render from the buffered states
+		AActor* EntityActor = FindSnapshotEntityActor(Entity.EntityId);
+		if (!EntityActor)
 		{
-			// Apply server correction
-			Character->SetActorLocation(Position);
+			continue;
+		}
 
-			if (UPlayerMovementComponent* MovementComp = Cast<UPlayerMovementComponent>(Character->GetCharacterMovement()))
-			{
-				MovementComp->Velocity = Velocity;
-				MovementComp->CurrentStamina = Stamina;
-			}
+		if (UNetworkInterpolation* Interpolation = EntityActor->FindComponentByClass<UNetworkInterpolation>())
+		{
+			Interpolation->AddServerState(Snapshot.MakeStateUpdate(Entity));
+		}
+	}
+}
 
-			if (UPlayerStateMachine* StateMachine = Character->FindComponentByClass<UPlayerStateMachine>())
-			{
-				StateMachine->CurrentState = static_cast<EPlayerState>(State);
-			}
+AActor* APocketStrikerPlayerController::FindSnapshotEntityActor(uint32 EntityId) const
+{
+	UWorld* World = GetWorld();
+	if (!World || EntityId == FWorldSnapshot::InvalidEntityId)
+	{
+		return nullptr;
+	}
+
+	if (EntityId == FWorldSnapshot::BallEntityId)
+	{
+		TActorIterator<ABall> BallIt(World);
+		return BallIt ? *BallIt : nullptr;
+	}
 
-			// Replay unacknowledged inputs
-			TArray<FInputCommand> UnackedInputs = GetUnacknowledgedInputs();
-			for (const FInputCommand& UnackedInput : UnackedInputs)
+	if (AGameStateBase* GameState = World->GetGameState())
+	{
+		for (APlayerState* EntityPlayerState : GameState->PlayerArray)
+		{
+			if (EntityPlayerState && FWorldSnapshot::MakePlayerEntityId(EntityPlayerState->GetPlayerId()) == EntityId)
 			{
-				if (UPlayerMovementComponent* MovementComp = Cast<UPlayerMovementComponent>(Character->GetCharacterMovement()))
-				{
-					float DeltaTime = 1.0f / 60.0f;
-					MovementComp->SimulateMovement(UnackedInput, DeltaTime);
-				}
+				return EntityPlayerState->GetPawn();
 			}
 		}
 	}
+
+	return nullptr;
+}
+
+void APocketStrikerPlayerController::ServerAcknowledgeSnapshot_Implementation(uint32 SnapshotId)
+{
+	if (ANetworkGameState* NetworkGameState = GetNetworkGameState())
+	{
+		NetworkGameState->RecordClientTraffic(this, ENetTrafficDirection::Received, FNetPacketSample::MakeUnencoded(ENetPacketType::SnapshotAck, sizeof(SnapshotId)));
+		NetworkGameState->AcknowledgeSnapshot(this, SnapshotId);
+	}
+}
+
+void APocketStrikerPlayerController::ApplyStateUpdate(const FStateUpdatePacket& StateUpdate)
+{
+	// Route through the reconciler when the character has one, so replay and smoothing apply
+	if (APawn* ControlledPawn = GetPawn())
+	{
+		if (UNetworkReconciler* Reconciler = ControlledPawn->FindComponentByClass<UNetworkReconciler>())
+		{
+			Reconciler->OnServerCorrection(StateUpdate);
+			return;
+		}
+	}
+
+	AcknowledgeInput(StateUpdate.AcknowledgedSequence);
+}
+
+const UNetworkParamsData* APocketStrikerPlayerController::GetNetworkParams() const
+{
+	// Snapshots are encoded with the game state's parameters, so they take precedence
+	if (const ANetworkGameState* NetworkGameState = GetNetworkGameState())
+	{
+		return NetworkGameState->GetNetworkParams();
+	}
+
+	if (const APocketStrikerCharacter* PocketStrikerCharacter = Cast<APocketStrikerCharacter>(GetPawn()))
+	{
+		if (const UNetworkParamsData* Params = PocketStrikerCharacter->GetNetworkParams())
+		{
+			return Params;
+		}
+	}
+
+	return GetDefault<UNetworkParamsData>();
+}
+
+ANetworkGameState* APocketStrikerPlayerController::GetNetworkGameState() const
+{
+	if (!CachedNetworkGameState.IsValid())
+	{
+		if (UWorld* World = GetWorld())
+		{
+			TActorIterator<ANetworkGameState> It(World);
+			CachedNetworkGameState = It ? *It : nullptr;
+		}
+	}
+
+	return CachedNetworkGameState.Get();
 }
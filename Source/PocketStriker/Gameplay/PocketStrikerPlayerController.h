@@ -5,13 +5,22 @@
 #include "CoreMinimal.h"
 #include "GameFramework/PlayerController.h"
 #include "InputActionValue.h"
+#include "../Network/NetworkSnapshot.h"
+#include "../Network/InputRunBuffer.h"
+#include "../Network/ClockSync.h"
+#include "../Network/InputJitterBuffer.h"
+#include "../Network/NetworkConditioner.h"
 #include "PocketStrikerPlayerController.generated.h"
 
 class UPlayerTuningData;
+class UNetworkParamsData;
+class ANetworkGameState;
 class UInputAction;
 class UInputMappingContext;
 class UActionSystem;
 class UPerformanceProfiler;
+class UNetworkDebugger;
+enum class ENetConditionerDirection : uint8;
 struct FInputCommand;
 
 /**
@@ -34,12 +43,59 @@ public:
 	TArray<FInputCommand> GetUnacknowledgedInputs() const;
 	void AcknowledgeInput(uint32 SequenceNumber);
 
+	// Wire format of ServerSendInputs: a CRC32C of the rest (FNetPacketChecksum), a run count, then each run of
+	// repeated input (FInputRun) quantized with its first sequence delta coded against the previous run's last;
+	// Unpack expands runs back into one packet per sequence and stops at the first malformed run
+	// OutFieldBits, if given, receives the packet's bits per field group
+	static TArray<uint8> PackInputRuns(TArrayView<const FInputRun> Runs, const FNetQuantizationSettings& Settings,
+		FNetFieldBits* OutFieldBits = nullptr);
+
+	// Coalesces consecutive inputs into runs and packs them; at most the newest MaxRedundantInputs are sent
+	static TArray<uint8> PackInputs(TArrayView<const FInputCommand> Inputs, const FNetQuantizationSettings& Settings,
+		FNetFieldBits* OutFieldBits = nullptr);
+
+	// Returns false, with nothing unpacked, if the packet fails its checksum
+	static bool UnpackInputs(const TArray<uint8>& InputData, const FNetQuantizationSettings& Settings, TArray<FInputPacket>& OutPackets,
+		FNetFieldBits* OutFieldBits = nullptr);
+
+	// For packets already checked, e.g. in a batch with FNetPacketChecksum::VerifyMany
+	static void UnpackVerifiedInputs(const TArray<uint8>& InputData, const FNetQuantizationSettings& Settings, TArray<FInputPacket>& OutPackets,
+		FNetFieldBits* OutFieldBits = nullptr);
+
+	// Upper bound on inputs per packet, independent of the tunable redundancy window
+	static constexpr uint32 MaxRedundantInputs = 32;
+
 	// Network RPCs for client-server communication
-	UFUNCTION(Server, Reliable, WithValidation)
-	void ServerSendInput(const FInputCommand& Input);
+	// Unreliable input stream: each packet repeats the newest unacknowledged inputs, bit-packed
+	UFUNCTION(Server, Unreliable)
+	void ServerSendInputs(const TArray<uint8>& InputData);
 
 	UFUNCTION(Client, Reliable)
 	void ClientReceiveStateUpdate(const FVector& Position, const FVector& Velocity, float Stamina, uint8 State, uint32 AckedSequence);
+
+	// Bit-packed world snapshot (all players, ball and possession) from ANetworkGameState
+	UFUNCTION(Client, Unreliable)
+	void ClientReceiveSnapshot(const TArray<uint8>& SnapshotData);
+
+	UFUNCTION(Server, Unreliable)
+	void ServerAcknowledgeSnapshot(uint32 SnapshotId);
+
+	// Clock sync exchange; each side stamps with its own GetTimeSeconds()
+	UFUNCTION(Server, Unreliable)
+	void ServerClockPing(double ClientSendTime);
+
+	UFUNCTION(Client, Unreliable)
+	void ClientClockPong(double ClientSendTime, double ServerTime);
+
+	// Estimated server clock on owning clients (local clock until the first pong); the world clock on the server
+	double GetServerTime() const;
+	const FClockSync& GetClockSync() const { return ClockSync; }
+
+	// Network parameters shared with the server: the game state's, then the character's, then the class defaults
+	const UNetworkParamsData* GetNetworkParams() const;
+
+	// Network stats and the packet conditioner on owning clients
+	UNetworkDebugger* GetNetworkDebugger() const { return NetworkDebugger; }
 	
 	// Exposed parameters
 	UPROPERTY(EditDefaultsOnly, Category = "Tuning", meta = (ToolTip = "Player tuning data asset for gameplay parameters"))
@@ -53,6 +109,10 @@ public:
 	UPROPERTY()
 	UPerformanceProfiler* PerformanceProfiler;
 
+	// Created for local controllers; conditions this client's RPC traffic when NetworkConditions are set
+	UPROPERTY()
+	UNetworkDebugger* NetworkDebugger;
+
 	// Apply tuning data to gameplay systems
 	UFUNCTION(BlueprintCallable, Category = "Tuning")
 	void ApplyTuningData();
@@ -98,14 +158,73 @@ protected:
 	void Pass();
 
 private:
-	// Input buffering for network prediction
-	TArray<FInputCommand> InputBuffer;
+	// Input buffering for network prediction, as runs of repeated input (last 64 frames, ~1 second at 60fps)
+	FInputRunBuffer InputBuffer { 64 };
 	uint32 CurrentInputSequence = 0;
 	uint32 LastAcknowledgedSequence = 0;
+
+	// Send the newest unacknowledged inputs to the server
+	void SendRedundantInputs();
+
+	// Store the predicted state for every input whose movement has been applied locally,
+	// so reconciliation can compare the server's result against the same input
+	void RecordPredictedStates();
+	uint32 LastRecordedPredictionSequence = 0;
+	uint32 PendingPredictionSequence = 0;
+
+	// Server clock estimate, refreshed by periodic pings
+	FClockSync ClockSync;
+	float TimeUntilClockPing = 0.0f;
+	void UpdateClockSync(float DeltaTime);
+
+	// RPCs that pass through the network conditioner, tagged so they can be dispatched on delivery
+	// Values match ENetPacketType, which the traffic stats are kept by
+	enum class EConditionedRpc : uint8
+	{
+		Inputs,
+		SnapshotAck,
+		ClockPing,
+		Snapshot,
+		ClockPong
+	};
+
+	// Sends or receives through the conditioner when it is active, directly otherwise
+	// Sample carries the serialization measurements; without one the payload counts as raw header bytes
+	void SendToServer(EConditionedRpc Rpc, const TArray<uint8>& Payload, const FNetPacketSample* Sample = nullptr);
+	bool ConditionInbound(EConditionedRpc Rpc, const TArray<uint8>& Payload);
+	void UpdateNetworkConditioner();
+
+	// NetworkConditions as last applied from the params asset; the debugger's own setters win until the asset changes
+	FNetworkConditionerSettings AppliedParamsConditions;
+	bool bParamsConditionsApplied = false;
+	void DeliverConditionedPacket(ENetConditionerDirection Direction, uint8 Channel, const TArray<uint8>& Payload);
+
+	// Decode and apply a world snapshot once it has arrived
+	void ReceiveSnapshot(const TArray<uint8>& SnapshotData);
+
+	// Server-side input queue when no ANetworkGameState is present, drained at the fixed server rate
+	FInputJitterBuffer FallbackInputBuffer;
+	float FallbackSimulationAccumulator = 0.0f;
+	void SimulateFallbackInputs(float DeltaTime);
 	
 	// Input state
 	bool bIsSprintPressed = false;
 
+	// Received snapshots, kept so later deltas can resolve their baseline
+	FWorldSnapshotHistory ReceivedSnapshots;
+	uint32 LastReceivedSnapshotId = 0;
+
+	// Game state that processes this client's traffic (level-placed, so it exists on both ends)
+	mutable TWeakObjectPtr<ANetworkGameState> CachedNetworkGameState;
+	ANetworkGameState* GetNetworkGameState() const;
+
+	// Distribute a world snapshot to the local character, remote players and the ball
+	void ApplyWorldSnapshot(const FWorldSnapshot& Snapshot);
+	AActor* FindSnapshotEntityActor(uint32 EntityId) const;
+
+	// Apply an authoritative state for the controlled character
+	void ApplyStateUpdate(const FStateUpdatePacket& StateUpdate);
+
 #if WITH_EDITOR
 	// Hot-reload support for DataAsset changes
 	void OnDataAssetPropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent);
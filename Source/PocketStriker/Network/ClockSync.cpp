@@ -0,0 +1,115 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ClockSync.h"
+
+void FClockSync::AddSample(double ClientSendTime, double ServerTime, double ClientReceiveTime)
+{
+	const double RTT = ClientReceiveTime - ClientSendTime;
+	if (RTT < 0.0)
+	{
+		return;
+	}
+
+	// The server stamped the pong halfway through the round trip on a symmetric path
+	FSample Sample;
+	Sample.ClientTime = ClientReceiveTime;
+	Sample.Offset = ServerTime + RTT * 0.5 - ClientReceiveTime;
+	Sample.RTT = RTT;
+
+	if (Samples.Num() < MaxSamples)
+	{
+		Samples.Add(Sample);
+	}
+	else
+	{
+		Samples[NextSampleIndex] = Sample;
+	}
+	NextSampleIndex = (NextSampleIndex + 1) % MaxSamples;
+
+	SmoothedRTT = SmoothedRTT > 0.0 ? SmoothedRTT + (RTT - SmoothedRTT) * 0.125 : RTT;
+
+	RefitEstimate();
+
+	if (!bSynchronized)
+	{
+		// First estimate: step straight to it
+		AppliedOffset = EstimateOffset(ClientReceiveTime);
+		bSynchronized = true;
+	}
+}
+
+void FClockSync::RefitEstimate()
+{
+	MinRTT = Samples[0].RTT;
+	for (const FSample& Sample : Samples)
+	{
+		MinRTT = FMath::Min(MinRTT, Sample.RTT);
+	}
+
+	// Queuing only ever adds delay, so the fastest exchanges have the least asymmetric error
+	const double CleanRTT = MinRTT * CleanRTTFactor + 0.002;
+
+	int32 NumClean = 0;
+	double MeanTime = 0.0;
+	double MeanOffset = 0.0;
+	for (const FSample& Sample : Samples)
+	{
+		if (Sample.RTT <= CleanRTT)
+		{
+			MeanTime += Sample.ClientTime;
+			MeanOffset += Sample.Offset;
+			++NumClean;
+		}
+	}
+	MeanTime /= NumClean;
+	MeanOffset /= NumClean;
+
+	// Least-squares slope of offset over time among the clean samples
+	double Covariance = 0.0;
+	double Variance = 0.0;
+	for (const FSample& Sample : Samples)
+	{
+		if (Sample.RTT <= CleanRTT)
+		{
+			const double DeltaTime = Sample.ClientTime - MeanTime;
+			Covariance += DeltaTime * (Sample.Offset - MeanOffset);
+			Variance += DeltaTime * DeltaTime;
+		}
+	}
+
+	// Needs a few seconds of spread before the slope means anything
+	Drift = (NumClean >= 3 && Variance > NumClean * 1.0) ? FMath::Clamp(Covariance / Variance, -MaxDrift, MaxDrift) : 0.0;
+	FitOffset = MeanOffset;
+	FitReferenceTime = MeanTime;
+}
+
+void FClockSync::Update(double ClientTime, float DeltaTime)
+{
+	if (!bSynchronized)
+	{
+		return;
+	}
+
+	const double Error = EstimateOffset(ClientTime) - AppliedOffset;
+	if (FMath::Abs(Error) > StepThreshold)
+	{
+		AppliedOffset += Error;
+		return;
+	}
+
+	const double MaxStep = MaxSlewRate * DeltaTime;
+	AppliedOffset += FMath::Clamp(Error, -MaxStep, MaxStep);
+}
+
+void FClockSync::Reset()
+{
+	Samples.Reset();
+	NextSampleIndex = 0;
+	MinRTT = 0.0;
+	SmoothedRTT = 0.0;
+	FitOffset = 0.0;
+	FitReferenceTime = 0.0;
+	Drift = 0.0;
+	AppliedOffset = 0.0;
+	bSynchronized = false;
+}
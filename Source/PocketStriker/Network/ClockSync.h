@@ -0,0 +1,78 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * NTP-style estimate of the server clock from ping exchanges
+ * Each sample is (client send time, server time when handled, client receive time); the offset assumes a
+ * symmetric path, so only the lowest-RTT samples in the window (least queuing) are trusted. Drift is the
+ * least-squares slope of those offsets over time. The offset handed out slews towards the estimate at a
+ * bounded rate so server time never jumps, except for a step on the first sync or a large error
+ */
+class POCKETSTRIKER_API FClockSync
+{
+public:
+	// Call from the client when a pong arrives; all times in seconds
+	void AddSample(double ClientSendTime, double ServerTime, double ClientReceiveTime);
+
+	// Slews the applied offset; call once per frame with the local clock
+	void Update(double ClientTime, float DeltaTime);
+
+	// Estimated server clock at the given local time (the local time itself until synchronized)
+	double GetServerTime(double ClientTime) const { return ClientTime + AppliedOffset; }
+
+	bool IsSynchronized() const { return bSynchronized; }
+	int32 GetNumSamples() const { return Samples.Num(); }
+
+	// Seconds
+	double GetOffset() const { return AppliedOffset; }
+	double GetMinRTT() const { return MinRTT; }
+	double GetSmoothedRTT() const { return SmoothedRTT; }
+
+	// Seconds of server clock per second of client clock, minus one
+	double GetDrift() const { return Drift; }
+
+	void Reset();
+
+	// Window of recent samples used for the filter and the drift fit
+	static constexpr int32 MaxSamples = 32;
+
+	// Samples within this factor of the window's minimum RTT (plus 2 ms) count as clean
+	static constexpr double CleanRTTFactor = 1.5;
+
+	// Offsets further than this from the estimate step instead of slewing
+	static constexpr double StepThreshold = 0.1;
+
+	// Largest slew of the applied offset, seconds per second
+	static constexpr double MaxSlewRate = 0.01;
+
+	// Drift beyond this is treated as noise (500 ppm)
+	static constexpr double MaxDrift = 0.0005;
+
+private:
+	struct FSample
+	{
+		double ClientTime = 0.0;
+		double Offset = 0.0;
+		double RTT = 0.0;
+	};
+
+	void RefitEstimate();
+	double EstimateOffset(double ClientTime) const { return FitOffset + Drift * (ClientTime - FitReferenceTime); }
+
+	TArray<FSample> Samples;
+	int32 NextSampleIndex = 0;
+
+	double MinRTT = 0.0;
+	double SmoothedRTT = 0.0;
+
+	// Offset(t) = FitOffset + Drift * (t - FitReferenceTime)
+	double FitOffset = 0.0;
+	double FitReferenceTime = 0.0;
+	double Drift = 0.0;
+
+	double AppliedOffset = 0.0;
+	bool bSynchronized = false;
+};
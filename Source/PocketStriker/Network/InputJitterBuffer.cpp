@@ -0,0 +1,113 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "InputJitterBuffer.h"
+
+FInputJitterBuffer::FInputJitterBuffer(uint32 MinCapacity)
+{
+	const uint32 Capacity = FMath::RoundUpToPowerOfTwo(FMath::Max(MinCapacity, 2u));
+	Slots.SetNum(Capacity);
+	Mask = Capacity - 1;
+}
+
+void FInputJitterBuffer::Configure(int32 InTargetDepth, int32 InMaxExtraDepth)
+{
+	TargetDepth = FMath::Max(0, InTargetDepth);
+	MaxExtraDepth = FMath::Max(1, InMaxExtraDepth);
+}
+
+bool FInputJitterBuffer::Add(const FInputCommand& Input)
+{
+	const uint32 Sequence = Input.SequenceNumber;
+	if (Sequence <= LastConsumedSequence || Sequence - LastConsumedSequence > Mask + 1 || Find(Sequence))
+	{
+		return false;
+	}
+
+	FSlot& Slot = Slots[Sequence & Mask];
+	Slot.Sequence = Sequence;
+	Slot.Input = Input;
+	NewestSequence = FMath::Max(NewestSequence, Sequence);
+	return true;
+}
+
+const FInputCommand* FInputJitterBuffer::Find(uint32 Sequence) const
+{
+	const FSlot& Slot = Slots[Sequence & Mask];
+	return Sequence > LastConsumedSequence && Slot.Sequence == Sequence ? &Slot.Input : nullptr;
+}
+
+int32 FInputJitterBuffer::GetDepth() const
+{
+	return NewestSequence > LastConsumedSequence ? static_cast<int32>(NewestSequence - LastConsumedSequence) : 0;
+}
+
+int32 FInputJitterBuffer::Consume(FInputCommand (&OutInputs)[MaxInputsPerTick])
+{
+	if (!ConsumeNext(OutInputs[0]))
+	{
+		return 0;
+	}
+
+	// Too deep: run the following input in this tick as well, so latency drains back towards the target.
+	// Both share the tick's step, so simulated time keeps pace with real time however fast inputs arrive
+	if (GetDepth() > TargetDepth + MaxExtraDepth && Find(LastConsumedSequence + 1))
+	{
+		ConsumeNext(OutInputs[1]);
+		Overflows++;
+		return 2;
+	}
+
+	return 1;
+}
+
+bool FInputJitterBuffer::ConsumeNext(FInputCommand& OutInput)
+{
+	if (!bPrimed)
+	{
+		if (GetDepth() < FMath::Max(1, TargetDepth))
+		{
+			return false;
+		}
+		bPrimed = true;
+	}
+
+	const uint32 NextSequence = LastConsumedSequence + 1;
+	const FInputCommand* Next = Find(NextSequence);
+
+	if (!Next)
+	{
+		if (GetDepth() == 0)
+		{
+			// Nothing has arrived: hold the last input for a tick and keep waiting for NextSequence
+			Underflows++;
+			if (++ConsecutiveUnderflows >= ReprimeAfterUnderflows)
+			{
+				bPrimed = false;
+			}
+			OutInput = MakeRepeatedInput();
+			return true;
+		}
+
+		// Newer inputs are queued, so NextSequence fell outside every redundant resend: stand in for it
+		MissingInputs++;
+		ConsecutiveUnderflows = 0;
+		LastInput = MakeRepeatedInput();
+		LastInput.SequenceNumber = NextSequence;
+		LastConsumedSequence = NextSequence;
+		OutInput = LastInput;
+		return true;
+	}
+
+	ConsecutiveUnderflows = 0;
+	LastConsumedSequence = NextSequence;
+	LastInput = *Next;
+	OutInput = LastInput;
+	return true;
+}
+
+FInputCommand FInputJitterBuffer::MakeRepeatedInput() const
+{
+	FInputCommand Repeated = LastInput;
+	Repeated.ActionFlags &= FInputCommand::FLAG_SPRINT;
+	return Repeated;
+}
@@ -0,0 +1,81 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "../Gameplay/GameplayTypes.h"
+
+/**
+ * Server-side queue of one client's inputs, drained one per fixed simulation tick
+ * Arrival is bursty; consumption is not. The queue primes to TargetDepth before the first input is used,
+ * so a late packet finds inputs still waiting instead of starving the simulation
+ */
+class POCKETSTRIKER_API FInputJitterBuffer
+{
+public:
+	// Capacity is rounded up to a power of two; inputs further ahead than that are dropped
+	explicit FInputJitterBuffer(uint32 MinCapacity = 64);
+
+	// A tick runs two inputs when the queue is too deep, never more
+	static constexpr int32 MaxInputsPerTick = 2;
+
+	// Depth the queue primes to, and how many extra inputs may pile up before a tick runs two
+	void Configure(int32 InTargetDepth, int32 InMaxExtraDepth);
+
+	// Queues Input; false if its sequence was already consumed or queued (redundant resend) or is too far ahead
+	bool Add(const FInputCommand& Input);
+
+	// Produces this tick's inputs in sequence order and returns how many: one normally, two while the queue is deeper
+	// than TargetDepth + MaxExtraDepth, zero while priming. The tick's one fixed step is split evenly between them
+	// (GetStepPerInput), so a client that floods the queue sheds latency but never gains movement
+	int32 Consume(FInputCommand (&OutInputs)[MaxInputsPerTick]);
+
+	// Simulation time each of NumInputs consumed inputs gets out of one tick of TickInterval
+	static float GetStepPerInput(float TickInterval, int32 NumInputs) { return TickInterval / FMath::Max(NumInputs, 1); }
+
+	// Newest sequence whose input has been simulated (or replaced); what the server acknowledges
+	uint32 GetLastConsumedSequence() const { return LastConsumedSequence; }
+
+	// Inputs waiting to be simulated
+	int32 GetDepth() const;
+
+	// Ticks that found the queue empty and repeated the previous input
+	int32 Underflows = 0;
+
+	// Ticks that ran two queued inputs to shed excess depth
+	int32 Overflows = 0;
+
+	// Sequences that never arrived (a gap with newer inputs queued) and were replaced by the previous input
+	int32 MissingInputs = 0;
+
+	// Consecutive empty ticks after which the queue primes again
+	static constexpr int32 ReprimeAfterUnderflows = 8;
+
+private:
+	// The next input in sequence, a stand-in for a missing one, or the held input on an empty queue
+	bool ConsumeNext(FInputCommand& OutInput);
+
+	// The previous input held for one more tick; one-shot actions are not repeated
+	FInputCommand MakeRepeatedInput() const;
+
+	struct FSlot
+	{
+		uint32 Sequence = 0;
+		FInputCommand Input;
+	};
+
+	// Slot Sequence & Mask; a slot is queued while its Sequence is newer than LastConsumedSequence.
+	// Late inputs fill gaps in place, which a window that only grows forward could not take
+	const FInputCommand* Find(uint32 Sequence) const;
+
+	TArray<FSlot> Slots;
+	uint32 Mask = 0;
+	uint32 NewestSequence = 0;
+
+	FInputCommand LastInput;
+	uint32 LastConsumedSequence = 0;
+	int32 TargetDepth = 2;
+	int32 MaxExtraDepth = 4;
+	int32 ConsecutiveUnderflows = 0;
+	bool bPrimed = false;
+};
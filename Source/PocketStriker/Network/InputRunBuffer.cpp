@@ -0,0 +1,162 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "InputRunBuffer.h"
+
+namespace
+{
+	// Runs the ring starts with; a stick held for a few ticks at a time stays well under this for a normal window
+	constexpr uint32 InitialRunSlots = 16;
+}
+
+void FInputRunBuffer::SetCapacity(int32 InCapacity)
+{
+	Capacity = FMath::Max(InCapacity, 1);
+
+	// Starts small and doubles only when the runs fill it (Grow). It never has to pass one slot per sequence
+	// plus one for the run Add appends before it slides the window
+	const uint32 NumSlots = FMath::Min(InitialRunSlots, FMath::RoundUpToPowerOfTwo(static_cast<uint32>(Capacity) + 1));
+	Slots.Empty(NumSlots);
+	Slots.SetNum(NumSlots);
+	Mask = NumSlots - 1;
+	Reset();
+}
+
+void FInputRunBuffer::Grow()
+{
+	// Unwrap into a ring twice the size, oldest run first
+	TArray<FInputRun> Grown;
+	Grown.SetNum(Slots.Num() * 2);
+	for (int32 Index = 0; Index < NumHeldRuns; ++Index)
+	{
+		Grown[Index] = GetRun(Index);
+	}
+	Slots = MoveTemp(Grown);
+	Mask = Slots.Num() - 1;
+	OldestSlot = 0;
+}
+
+void FInputRunBuffer::Reset()
+{
+	OldestSlot = 0;
+	NumHeldRuns = 0;
+	NumInputs = 0;
+}
+
+void FInputRunBuffer::Add(const FInputPacket& Input)
+{
+	if (!IsEmpty() && Input.SequenceNumber <= GetNewestSequence())
+	{
+		return;
+	}
+
+	if (!IsEmpty() && GetRun(NumHeldRuns - 1).CanAppend(Input))
+	{
+		GetRun(NumHeldRuns - 1).Append(Input);
+	}
+	else
+	{
+		if (NumHeldRuns == Slots.Num())
+		{
+			Grow();
+		}
+		++NumHeldRuns;
+		GetRun(NumHeldRuns - 1) = FInputRun::FromInput(Input);
+	}
+	++NumInputs;
+
+	// Slide the window forward past whatever falls outside the capacity
+	const uint32 Newest = GetNewestSequence();
+	if (Newest - GetOldestSequence() >= static_cast<uint32>(Capacity))
+	{
+		ReleaseUpTo(Newest - Capacity);
+	}
+}
+
+int32 FInputRunBuffer::FindFirstRunAfter(uint32 Sequence) const
+{
+	int32 Low = 0;
+	int32 High = NumHeldRuns;
+	while (Low < High)
+	{
+		const int32 Middle = Low + (High - Low) / 2;
+		if (GetRun(Middle).GetLastSequence() <= Sequence)
+		{
+			Low = Middle + 1;
+		}
+		else
+		{
+			High = Middle;
+		}
+	}
+	return Low;
+}
+
+bool FInputRunBuffer::Find(uint32 Sequence, FInputPacket& OutInput) const
+{
+	if (IsEmpty() || Sequence < GetOldestSequence())
+	{
+		return false;
+	}
+
+	const int32 Index = Sequence > 0 ? FindFirstRunAfter(Sequence - 1) : 0;
+	if (Index < NumHeldRuns && GetRun(Index).Contains(Sequence))
+	{
+		OutInput = GetRun(Index).GetInput(Sequence);
+		return true;
+	}
+	return false;
+}
+
+void FInputRunBuffer::ReleaseUpTo(uint32 Sequence)
+{
+	const int32 NumReleased = FindFirstRunAfter(Sequence);
+	for (int32 Index = 0; Index < NumReleased; ++Index)
+	{
+		NumInputs -= GetRun(Index).Count;
+	}
+	OldestSlot = (OldestSlot + NumReleased) & Mask;
+	NumHeldRuns -= NumReleased;
+
+	if (!IsEmpty() && GetRun(0).FirstSequence <= Sequence)
+	{
+		NumInputs -= Sequence + 1 - GetRun(0).FirstSequence;
+		GetRun(0).TrimFront(Sequence + 1);
+	}
+}
+
+int32 FInputRunBuffer::GetRunsAfter(uint32 AfterSequence, int32 MaxInputs, TArray<FInputRun>& OutRuns) const
+{
+	OutRuns.Reset();
+
+	// Walk back from the newest run until the window is full
+	int32 NumCovered = 0;
+	int32 FirstIndex = NumHeldRuns;
+	while (FirstIndex > 0 && NumCovered < MaxInputs && GetRun(FirstIndex - 1).GetLastSequence() > AfterSequence)
+	{
+		--FirstIndex;
+		NumCovered += GetRun(FirstIndex).Count;
+	}
+
+	for (int32 Index = FirstIndex; Index < NumHeldRuns; ++Index)
+	{
+		OutRuns.Add(GetRun(Index));
+	}
+
+	if (OutRuns.Num() > 0)
+	{
+		// The oldest run may reach back past the acknowledgement or past the window
+		FInputRun& Oldest = OutRuns[0];
+		if (Oldest.FirstSequence <= AfterSequence)
+		{
+			NumCovered -= AfterSequence + 1 - Oldest.FirstSequence;
+			Oldest.TrimFront(AfterSequence + 1);
+		}
+		if (NumCovered > MaxInputs)
+		{
+			Oldest.TrimFront(Oldest.FirstSequence + (NumCovered - MaxInputs));
+			NumCovered = MaxInputs;
+		}
+	}
+
+	return NumCovered;
+}
@@ -0,0 +1,89 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NetworkTypes.h"
+
+/**
+ * Unacknowledged inputs kept as runs (FInputRun) instead of one slot per sequence
+ * A held stick is one run however long it is held, so the number of runs follows how often the input changes.
+ * Retains at most the newest Capacity sequences, like TSequenceRingBuffer; sequences are expected to increase,
+ * and a gap just starts a new run. Runs sit in a power-of-two ring that starts at a few slots and doubles when
+ * the held runs fill it, so its size follows the most runs ever held at once rather than Capacity. Releasing
+ * acknowledged runs only moves the oldest index and never shifts or reallocates
+ */
+class POCKETSTRIKER_API FInputRunBuffer
+{
+public:
+	explicit FInputRunBuffer(int32 InCapacity = 128)
+	{
+		SetCapacity(InCapacity);
+	}
+
+	// Reallocates the ring at its starting size and clears; only call outside of the hot path
+	void SetCapacity(int32 InCapacity);
+	int32 GetCapacity() const { return Capacity; }
+
+	// Extends the newest run or starts one; an input not newer than the newest held one is ignored
+	void Add(const FInputPacket& Input);
+
+	bool Find(uint32 Sequence, FInputPacket& OutInput) const;
+
+	// Drops every sequence up to and including Sequence
+	void ReleaseUpTo(uint32 Sequence);
+
+	void Reset();
+
+	bool IsEmpty() const { return NumHeldRuns == 0; }
+
+	// Inputs held, and the runs holding them
+	int32 Num() const { return NumInputs; }
+	int32 NumRuns() const { return NumHeldRuns; }
+
+	uint32 GetOldestSequence() const { return IsEmpty() ? 0 : GetRun(0).FirstSequence; }
+	uint32 GetNewestSequence() const { return IsEmpty() ? 0 : GetRun(NumHeldRuns - 1).GetLastSequence(); }
+
+	// Visits held inputs with sequence > AfterSequence, oldest first, expanded from their runs
+	template<typename FunctorType>
+	void ForEachAfter(uint32 AfterSequence, FunctorType&& Functor) const
+	{
+		for (int32 Index = 0; Index < NumHeldRuns; ++Index)
+		{
+			const FInputRun& Run = GetRun(Index);
+			if (Run.GetLastSequence() <= AfterSequence)
+			{
+				continue;
+			}
+
+			for (uint32 Sequence = FMath::Max(Run.FirstSequence, AfterSequence + 1); Sequence <= Run.GetLastSequence(); ++Sequence)
+			{
+				Functor(Run.GetInput(Sequence));
+			}
+		}
+	}
+
+	// The newest MaxInputs held inputs with sequence > AfterSequence, as runs (the first one trimmed to fit)
+	// Returns the number of inputs they cover
+	int32 GetRunsAfter(uint32 AfterSequence, int32 MaxInputs, TArray<FInputRun>& OutRuns) const;
+
+	SIZE_T GetAllocatedSize() const { return Slots.GetAllocatedSize(); }
+
+private:
+	// Index 0 is the oldest held run
+	const FInputRun& GetRun(int32 Index) const { return Slots[(OldestSlot + Index) & Mask]; }
+	FInputRun& GetRun(int32 Index) { return Slots[(OldestSlot + Index) & Mask]; }
+
+	// Doubles the ring, keeping the held runs in order; Add calls it when every slot holds a run
+	void Grow();
+
+	// Index of the first run still holding sequences after Sequence (NumRuns if none); runs are ordered, so a binary search
+	int32 FindFirstRunAfter(uint32 Sequence) const;
+
+	TArray<FInputRun> Slots;
+	uint32 Mask = 0;
+	uint32 OldestSlot = 0;
+	int32 NumHeldRuns = 0;
+	int32 Capacity = 0;
+	int32 NumInputs = 0;
+};
@@ -0,0 +1,143 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "LagCompensation.h"
+
+void FLagCompensationHistory::Init(float InTickInterval, float MaxRewindSeconds, int32 InMaxEntities)
+{
+	TickInterval = FMath::Max(InTickInterval, UE_KINDA_SMALL_NUMBER);
+	MaxEntities = FMath::Max(1, InMaxEntities);
+
+	// One extra row so a query at the far end of the window still has a tick on either side
+	Capacity = FMath::Max(2, FMath::CeilToInt(MaxRewindSeconds / TickInterval) + 1);
+	NumRows = 0;
+	NewestRow = INDEX_NONE;
+
+	const int32 NumCells = Capacity * MaxEntities;
+	RowTimes.SetNumZeroed(Capacity);
+	PositionX.SetNumZeroed(NumCells);
+	PositionY.SetNumZeroed(NumCells);
+	PositionZ.SetNumZeroed(NumCells);
+	Present.SetNumZeroed(NumCells);
+	Columns.Reset();
+	ColumnEntities.Reset(MaxEntities);
+	ColumnLastTicks.Reset(MaxEntities);
+	TickCount = 0;
+}
+
+void FLagCompensationHistory::BeginTick(double Time)
+{
+	check(IsInitialized());
+
+	NewestRow = (NewestRow + 1) % Capacity;
+	NumRows = FMath::Min(NumRows + 1, Capacity);
+	RowTimes[NewestRow] = Time;
+	++TickCount;
+	FMemory::Memzero(Present.GetData() + NewestRow * MaxEntities, MaxEntities);
+}
+
+void FLagCompensationHistory::RecordPosition(uint32 EntityId, const FVector& Position)
+{
+	if (NewestRow == INDEX_NONE)
+	{
+		return;
+	}
+
+	const int32* Found = Columns.Find(EntityId);
+	const int32 Column = Found ? *Found : AssignColumn(EntityId);
+	if (Column == INDEX_NONE)
+	{
+		return;
+	}
+	ColumnLastTicks[Column] = TickCount;
+
+	const int32 Cell = NewestRow * MaxEntities + Column;
+	PositionX[Cell] = static_cast<float>(Position.X);
+	PositionY[Cell] = static_cast<float>(Position.Y);
+	PositionZ[Cell] = static_cast<float>(Position.Z);
+	Present[Cell] = 1;
+}
+
+int32 FLagCompensationHistory::AssignColumn(uint32 EntityId)
+{
+	if (ColumnEntities.Num() < MaxEntities)
+	{
+		ColumnEntities.Add(EntityId);
+		ColumnLastTicks.Add(TickCount);
+		return Columns.Add(EntityId, ColumnEntities.Num() - 1);
+	}
+
+	// Every row that held a stale entity has since been reused and cleared, so its column is empty
+	for (int32 Column = 0; Column < MaxEntities; ++Column)
+	{
+		if (TickCount - ColumnLastTicks[Column] >= Capacity)
+		{
+			Columns.Remove(ColumnEntities[Column]);
+			ColumnEntities[Column] = EntityId;
+			return Columns.Add(EntityId, Column);
+		}
+	}
+	return INDEX_NONE;
+}
+
+double FLagCompensationHistory::ClampTime(double Time) const
+{
+	return NumRows > 0 ? FMath::Clamp(Time, GetOldestTime(), GetNewestTime()) : Time;
+}
+
+int32 FLagCompensationHistory::FindAge(double Time) const
+{
+	// Rows are a tick apart, so the age is a division; the simulation can fall behind or drop a backlog,
+	// which only ever leaves the estimate a row or two off
+	int32 Age = FMath::Clamp(FMath::FloorToInt((GetNewestTime() - Time) / TickInterval), 0, NumRows - 1);
+	while (Age < NumRows - 1 && RowTimes[GetRow(Age)] > Time)
+	{
+		++Age;
+	}
+	while (Age > 0 && RowTimes[GetRow(Age - 1)] <= Time)
+	{
+		--Age;
+	}
+	return Age;
+}
+
+bool FLagCompensationHistory::SamplePosition(uint32 EntityId, double Time, FVector& OutPosition) const
+{
+	const int32* Column = Columns.Find(EntityId);
+	if (!Column || NumRows == 0)
+	{
+		return false;
+	}
+
+	Time = ClampTime(Time);
+	const int32 Age = FindAge(Time);
+	const int32 Before = GetRow(Age) * MaxEntities + *Column;
+	const int32 After = Age > 0 ? GetRow(Age - 1) * MaxEntities + *Column : Before;
+
+	const bool bHasBefore = Present[Before] != 0;
+	const bool bHasAfter = Present[After] != 0;
+	if (!bHasBefore && !bHasAfter)
+	{
+		return false;
+	}
+
+	const FVector BeforePosition(PositionX[Before], PositionY[Before], PositionZ[Before]);
+	const FVector AfterPosition(PositionX[After], PositionY[After], PositionZ[After]);
+	if (!bHasBefore || !bHasAfter || Before == After)
+	{
+		OutPosition = bHasBefore ? BeforePosition : AfterPosition;
+		return true;
+	}
+
+	const double BeforeTime = RowTimes[GetRow(Age)];
+	const double Span = RowTimes[GetRow(Age - 1)] - BeforeTime;
+	const double Alpha = Span > 0.0 ? FMath::Clamp((Time - BeforeTime) / Span, 0.0, 1.0) : 1.0;
+	OutPosition = FMath::Lerp(BeforePosition, AfterPosition, Alpha);
+	return true;
+}
+
+SIZE_T FLagCompensationHistory::GetAllocatedSize() const
+{
+	return RowTimes.GetAllocatedSize() + PositionX.GetAllocatedSize() + PositionY.GetAllocatedSize()
+		+ PositionZ.GetAllocatedSize() + Present.GetAllocatedSize() + Columns.GetAllocatedSize()
+		+ ColumnEntities.GetAllocatedSize() + ColumnLastTicks.GetAllocatedSize();
+}
@@ -0,0 +1,67 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Recent positions of every player and the ball, one row per server simulation tick, for rewinding range checks
+ * Structure of arrays: X, Y and Z sit in separate flat arrays indexed [row][entity column], so recording a tick
+ * writes three contiguous rows and a rewind reads two. Rows are a fixed tick apart, so the rows around a time
+ * are found by arithmetic rather than a search, and nothing in the world is moved to answer a query
+ */
+class POCKETSTRIKER_API FLagCompensationHistory
+{
+public:
+	// Keeps MaxRewindSeconds of ticks for up to MaxEntities entities at a time; clears any history.
+	// An entity that goes unrecorded for the whole window gives its column up to the next new entity
+	void Init(float InTickInterval, float MaxRewindSeconds, int32 InMaxEntities);
+	bool IsInitialized() const { return Capacity > 0; }
+
+	// Starts the row for a server tick simulated up to Time (server clock); positions recorded after belong to it
+	void BeginTick(double Time);
+	void RecordPosition(uint32 EntityId, const FVector& Position);
+
+	// Where an entity was at Time, interpolated between the ticks around it; Time is clamped into the window.
+	// False if the entity has no position in either tick
+	bool SamplePosition(uint32 EntityId, double Time, FVector& OutPosition) const;
+
+	// Time limited to what the history covers
+	double ClampTime(double Time) const;
+
+	int32 GetNumTicks() const { return NumRows; }
+	double GetNewestTime() const { return NumRows > 0 ? RowTimes[NewestRow] : 0.0; }
+	double GetOldestTime() const { return NumRows > 0 ? RowTimes[GetRow(NumRows - 1)] : 0.0; }
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	// Ring index of the row Age ticks before the newest
+	int32 GetRow(int32 Age) const { return (NewestRow - Age + Capacity) % Capacity; }
+
+	// A column for an entity seen for the first time: a free one, else one whose entity has left the window
+	int32 AssignColumn(uint32 EntityId);
+
+	// Age of the newest row at or before Time (clamped to the window)
+	int32 FindAge(double Time) const;
+
+	float TickInterval = 1.0f / 60.0f;
+	int32 Capacity = 0;
+	int32 MaxEntities = 0;
+	int32 NumRows = 0;
+	int32 NewestRow = INDEX_NONE;
+
+	TArray<double> RowTimes;
+	TArray<float> PositionX;
+	TArray<float> PositionY;
+	TArray<float> PositionZ;
+
+	// Non-zero where the entity was recorded in that row
+	TArray<uint8> Present;
+
+	TMap<uint32, int32> Columns;
+
+	// Per column: its entity and the tick it was last recorded in
+	TArray<uint32> ColumnEntities;
+	TArray<int64> ColumnLastTicks;
+	int64 TickCount = 0;
+};
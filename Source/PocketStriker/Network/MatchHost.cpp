@@ -0,0 +1,306 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "MatchHost.h"
+#include "NetworkParamsData.h"
+#include "../Gameplay/PlayerTuningData.h"
+#include "../Gameplay/PocketStrikerPlayerController.h"
+#include "Async/ParallelFor.h"
+
+FHeadlessMatch::FHeadlessMatch(int32 InMatchId, const FMatchHostSharedData& InShared)
+	: MatchId(InMatchId)
+	, Shared(InShared)
+{
+	MatchTick.Init(*Shared.Params, Shared.TickRate);
+	BallLaunch.Position = FVector(0.0, 0.0, Shared.Ball.GetRestHeight());
+	Ball = BallLaunch;
+}
+
+int32 FHeadlessMatch::AddConnection(const FVector& SpawnPosition)
+{
+	if (Connections.Num() >= MaxConnections)
+	{
+		return INDEX_NONE;
+	}
+
+	const int32 Index = Connections.Num();
+	FConnection& Connection = Connections.AddDefaulted_GetRef();
+	Connection.EntityId = FWorldSnapshot::MakePlayerEntityId(Index);
+	Connection.State.Position = SpawnPosition;
+	Jobs.SetNum(Connections.Num());
+	return Index;
+}
+
+void FHeadlessMatch::Receive(int32 ConnectionIndex, uint8 Channel, TArray<uint8>&& Payload)
+{
+	if (Connections.IsValidIndex(ConnectionIndex))
+	{
+		Connections[ConnectionIndex].Received.Emplace(Channel, MoveTemp(Payload));
+	}
+}
+
+double FHeadlessMatch::GetTime() const
+{
+	return MatchTick.GetTickCount() / static_cast<double>(Shared.TickRate);
+}
+
+FHeadlessMatch::FConnection* FHeadlessMatch::FindConnection(uint32 EntityId)
+{
+	// Entity ids are handed out in connection order
+	const int32 Index = static_cast<int32>(EntityId - FWorldSnapshot::MakePlayerEntityId(0));
+	return Connections.IsValidIndex(Index) ? &Connections[Index] : nullptr;
+}
+
+bool FHeadlessMatch::Tick(bool bParallelEncoding)
+{
+	const UNetworkParamsData& Params = *Shared.Params;
+	const float TickInterval = MatchTick.GetTickInterval();
+	const float SnapshotInterval = 1.0f / FMath::Max(Shared.SnapshotRate, 1.0f);
+	const double TickStart = FPlatformTime::Seconds();
+	StepStartTime = GetTime();
+
+	// Check every input payload of the tick in one batch
+	InputPacketViews.Reset();
+	for (const FConnection& Connection : Connections)
+	{
+		for (const TPair<uint8, TArray<uint8>>& Received : Connection.Received)
+		{
+			if (Received.Key == ChannelInputs)
+			{
+				InputPacketViews.Add(Received.Value);
+			}
+		}
+	}
+	InputPacketsIntact.SetNumUninitialized(InputPacketViews.Num());
+	MatchTick.VerifyInputPackets(InputPacketViews, InputPacketsIntact);
+
+	int32 InputPacketIndex = 0;
+	for (FConnection& Connection : Connections)
+	{
+		for (const TPair<uint8, TArray<uint8>>& Received : Connection.Received)
+		{
+			if (Received.Key == ChannelSnapshotAck)
+			{
+				uint32 SnapshotId = 0;
+				FMemory::Memcpy(&SnapshotId, Received.Value.GetData(), FMath::Min<int32>(sizeof(SnapshotId), Received.Value.Num()));
+				ANetworkGameState::ApplySnapshotAck(Connection.Channel, SnapshotId);
+			}
+			else if (InputPacketsIntact[InputPacketIndex++])
+			{
+				ReceiveInputs(Connection, Received.Value);
+			}
+		}
+		Connection.Received.Reset();
+	}
+
+	MatchTick.Step(*this, StepStartTime + TickInterval);
+
+	SnapshotAccumulator += TickInterval;
+	const bool bBroadcast = SnapshotAccumulator >= SnapshotInterval;
+	bLastTickBroadcast = bBroadcast;
+	LastEncodeMs = 0.0;
+	if (bBroadcast)
+	{
+		SnapshotAccumulator -= SnapshotInterval;
+		const double EncodeStart = FPlatformTime::Seconds();
+
+		FWorldSnapshot World;
+		GatherWorldAt(World, GetTime());
+
+		FWorldSnapshotEncodeCache SharedEncodings(World, Params.Quantization);
+		for (int32 Index = 0; Index < Connections.Num(); ++Index)
+		{
+			const FConnection& Connection = Connections[Index];
+			ANetworkGameState::FClientSnapshotJob& Job = Jobs[Index];
+			Job.Channel = &Connections[Index].Channel;
+			Job.OwnEntityId = Connection.EntityId;
+			Job.AcknowledgedSequence = MatchTick.GetAcknowledgedSequence(Connection.EntityId);
+			Job.bHasReceiverLocation = true;
+			Job.ReceiverLocation = Connection.State.Position;
+		}
+		ANetworkGameState::EncodeClientSnapshots(Jobs, World, SharedEncodings, Params, SnapshotInterval, bParallelEncoding);
+
+		LastEncodeMs = (FPlatformTime::Seconds() - EncodeStart) * 1000.0;
+	}
+
+	LastTickMs = (FPlatformTime::Seconds() - TickStart) * 1000.0;
+	return bBroadcast;
+}
+
+void FHeadlessMatch::ReceiveInputs(const FConnection& Connection, const TArray<uint8>& Payload)
+{
+	TArray<FInputPacket> Packets;
+	APocketStrikerPlayerController::UnpackVerifiedInputs(Payload, Shared.Params->Quantization, Packets);
+	for (const FInputPacket& Packet : Packets)
+	{
+		MatchTick.QueueInput(Connection.EntityId, Packet);
+	}
+}
+
+bool FHeadlessMatch::SimulateInput(uint32 EntityId, const FInputCommand& Command, float DeltaTime)
+{
+	FConnection* Connection = FindConnection(EntityId);
+	if (!Connection)
+	{
+		return false;
+	}
+
+	const FNetQuantizationSettings& Settings = Shared.Params->Quantization;
+	const FBoundsCollisionResolver Resolver(FBox(Settings.PitchMin, Settings.PitchMax));
+	Connection->State = FMovementSimulation::RegenerateStamina(
+		FMovementSimulation::Step(Connection->State, Command, DeltaTime, Shared.Movement, &Resolver), DeltaTime, Shared.Movement);
+	return true;
+}
+
+void FHeadlessMatch::ExecuteActions(uint32 EntityId, const FInputCommand& Command, const FLagCompensationHistory* History)
+{
+	const FConnection* Connection = FindConnection(EntityId);
+	const bool bKick = (Command.ActionFlags & FInputCommand::FLAG_KICK) != 0;
+	const bool bPass = (Command.ActionFlags & FInputCommand::FLAG_PASS) != 0;
+	if (!Connection || (!bKick && !bPass))
+	{
+		return;
+	}
+
+	// Range is judged against the ball where the kicker saw it; nobody holds a headless ball, so that is the input's own time
+	FVector BallPosition = Ball.Position;
+	if (History)
+	{
+		History->SamplePosition(FWorldSnapshot::BallEntityId, MatchTick.EstimateClientViewTime(Command, false), BallPosition);
+	}
+	if (FVector::DistSquared2D(Connection->State.Position, BallPosition) > FMath::Square(Shared.KickRange))
+	{
+		return;
+	}
+
+	// Along the stick (X right, Y forward, as FMovementSimulation reads it), or the way the player is running
+	// when the stick is centred
+	FVector Direction(Command.MovementInput.Y, Command.MovementInput.X, 0.0);
+	if (Direction.IsNearlyZero())
+	{
+		Direction = Connection->State.Velocity.GetSafeNormal2D();
+	}
+	if (Direction.IsNearlyZero())
+	{
+		return;
+	}
+
+	const FBallFlightState Current = FBallSimulation::Evaluate(BallLaunch, StepStartTime - BallLaunchTime, Shared.Ball);
+	BallLaunch = FBallSimulation::Kick(Current, Direction, bKick ? Shared.KickSpeed : Shared.PassSpeed, Shared.Ball);
+	BallLaunchTime = StepStartTime;
+	++KickCount;
+}
+
+void FHeadlessMatch::FinishStep(float DeltaTime)
+{
+	Ball = FBallSimulation::Evaluate(BallLaunch, StepStartTime + DeltaTime - BallLaunchTime, Shared.Ball);
+}
+
+void FHeadlessMatch::GatherWorldAt(FWorldSnapshot& OutWorld, double Now) const
+{
+	OutWorld.ServerTimestamp = static_cast<float>(Now);
+	OutWorld.Entities.Reset(Connections.Num() + 1);
+	for (const FConnection& Connection : Connections)
+	{
+		FEntitySnapshotState& Entity = OutWorld.Entities.AddDefaulted_GetRef();
+		Entity.EntityId = Connection.EntityId;
+		Entity.Position = Connection.State.Position;
+		Entity.Velocity = Connection.State.Velocity;
+		Entity.Stamina = Connection.State.Stamina;
+	}
+
+	FEntitySnapshotState& BallEntity = OutWorld.Entities.AddDefaulted_GetRef();
+	BallEntity.EntityId = FWorldSnapshot::BallEntityId;
+	BallEntity.Position = Ball.Position;
+	BallEntity.Velocity = Ball.Velocity;
+}
+
+SIZE_T FHeadlessMatch::GetAllocatedSize() const
+{
+	// The match tick holds the input queues (fixed rings) and the rewind history
+	SIZE_T Size = sizeof(FHeadlessMatch) + MatchTick.GetAllocatedSize() + Connections.GetAllocatedSize() + Jobs.GetAllocatedSize()
+		+ InputPacketViews.GetAllocatedSize() + InputPacketsIntact.GetAllocatedSize();
+
+	// The sent history holds full entity arrays
+	for (const FConnection& Connection : Connections)
+	{
+		Size += Connection.Channel.EntityPriorities.GetAllocatedSize()
+			+ FWorldSnapshotHistory::Capacity * (Connections.Num() + 1) * sizeof(FEntitySnapshotState);
+	}
+	for (const ANetworkGameState::FClientSnapshotJob& Job : Jobs)
+	{
+		Size += Job.Packet.GetAllocatedSize() + Job.EntityIndices.GetAllocatedSize();
+	}
+	return Size;
+}
+
+FMatchHost::FMatchHost(const FMatchHostSharedData& InShared)
+	: Shared(InShared)
+{
+	check(Shared.Params);
+	const FNetQuantizationSettings& Settings = Shared.Params->Quantization;
+
+	if (Shared.TuningData)
+	{
+		Shared.Movement = FMovementSimTuning::FromTuningData(*Shared.TuningData);
+		Shared.KickSpeed = Shared.TuningData->KickForce;
+	}
+	if (Shared.TickRate <= 0.0f)
+	{
+		Shared.TickRate = Shared.Params->ServerTickRate;
+	}
+	Shared.TickRate = FMath::Max(Shared.TickRate, 1.0f);
+	Shared.Ball.PitchBounds = FBox2D(FVector2D(Settings.PitchMin), FVector2D(Settings.PitchMax));
+}
+
+FMatchHost::~FMatchHost()
+{
+	for (const TUniquePtr<FHeadlessMatch>& Match : Matches)
+	{
+		Match->StopRecording();
+	}
+}
+
+FHeadlessMatch& FMatchHost::CreateMatch()
+{
+	return *Matches.Add_GetRef(MakeUnique<FHeadlessMatch>(NextMatchId++, Shared));
+}
+
+void FMatchHost::DestroyMatch(int32 MatchId)
+{
+	Matches.RemoveAll([MatchId](const TUniquePtr<FHeadlessMatch>& Match)
+	{
+		if (Match->GetMatchId() != MatchId)
+		{
+			return false;
+		}
+		Match->StopRecording();
+		return true;
+	});
+}
+
+int32 FMatchHost::Tick(bool bParallel)
+{
+	const double TickStart = FPlatformTime::Seconds();
+
+	// One task per match; splitting a lone match's encoding is still worth it, nesting it under many is not
+	const bool bParallelEncoding = bParallel && Matches.Num() == 1;
+	ParallelFor(Matches.Num(), [this, bParallelEncoding](int32 Index)
+	{
+		Matches[Index]->Tick(bParallelEncoding);
+	}, bParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+
+	LastTickMs = (FPlatformTime::Seconds() - TickStart) * 1000.0;
+
+	int32 NumBroadcast = 0;
+	for (const TUniquePtr<FHeadlessMatch>& Match : Matches)
+	{
+		NumBroadcast += Match->DidLastTickBroadcast() ? 1 : 0;
+	}
+	return NumBroadcast;
+}
+
+void FMatchHost::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	Collector.AddReferencedObject(Shared.Params);
+	Collector.AddReferencedObject(Shared.TuningData);
+}
@@ -0,0 +1,180 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/GCObject.h"
+#include "NetworkGameState.h"
+#include "ServerMatchTick.h"
+#include "../Gameplay/MovementSimulation.h"
+#include "../Gameplay/BallSimulation.h"
+
+class UNetworkParamsData;
+class UPlayerTuningData;
+
+/**
+ * Read-only data every match on a host runs on, loaded once per process
+ * Matches only read it while they tick, so worker threads share it without locks
+ */
+struct POCKETSTRIKER_API FMatchHostSharedData
+{
+	// Required
+	const UNetworkParamsData* Params = nullptr;
+
+	// Optional: default movement tuning without it
+	const UPlayerTuningData* TuningData = nullptr;
+
+	// Simulation ticks per second (zero takes Params->ServerTickRate) and snapshot broadcasts per second
+	float TickRate = 0.0f;
+	float SnapshotRate = 60.0f;
+
+	// Plain-data rules, filled by FMatchHost from the assets above
+	FMovementSimTuning Movement;
+	FBallSimTuning Ball;
+	float KickRange = 200.0f;
+	float KickSpeed = 2000.0f;
+	float PassSpeed = 1200.0f;
+};
+
+/**
+ * One match on a multi-match server: its connections, players and ball
+ * The headless server model: inputs arrive as the controller's packed payloads and go through the same
+ * FServerMatchTick as ANetworkGameState (validation, jitter buffers, recording, lag-compensated kicks). Players
+ * step through FMovementSimulation against the pitch bounds, the ball follows FBallSimulation, and snapshots are
+ * encoded with ANetworkGameState::EncodeClientSnapshots. A tick touches only the match and the host's shared data
+ */
+class POCKETSTRIKER_API FHeadlessMatch : public IServerMatchWorld
+{
+public:
+	// Uplink channels
+	static constexpr uint8 ChannelInputs = 0;
+	static constexpr uint8 ChannelSnapshotAck = 1;
+
+	// Every player and the ball must fit in one snapshot
+	static constexpr int32 MaxConnections = 64;
+
+	// The server's view of one client
+	struct FConnection
+	{
+		uint32 EntityId = 0;
+		FMovementSimState State;
+		FClientSnapshotChannel Channel;
+
+		// Uplink payloads received since the last tick
+		TArray<TPair<uint8, TArray<uint8>>> Received;
+	};
+
+	FHeadlessMatch(int32 InMatchId, const FMatchHostSharedData& InShared);
+
+	int32 GetMatchId() const { return MatchId; }
+
+	// Adds a player at SpawnPosition; returns its connection index, or INDEX_NONE when the match is full
+	int32 AddConnection(const FVector& SpawnPosition);
+	int32 NumConnections() const { return Connections.Num(); }
+	const FConnection& GetConnection(int32 Index) const { return Connections[Index]; }
+
+	// Queues an uplink payload for the next tick; call between host ticks, never while matches tick
+	void Receive(int32 ConnectionIndex, uint8 Channel, TArray<uint8>&& Payload);
+
+	bool StartRecording(const FString& Filename) { return MatchTick.StartRecording(Filename); }
+	void StopRecording() { MatchTick.StopRecording(); }
+
+	// One fixed step: check, unpack and queue inputs, run the match tick, and encode every connection's snapshot
+	// when a broadcast is due. Returns whether it broadcast
+	bool Tick(bool bParallelEncoding);
+
+	bool DidLastTickBroadcast() const { return bLastTickBroadcast; }
+
+	// The newest broadcast, one job per connection in connection order
+	TConstArrayView<ANetworkGameState::FClientSnapshotJob> GetSnapshotJobs() const { return Jobs; }
+
+	int32 GetTickCount() const { return MatchTick.GetTickCount(); }
+	double GetTime() const;
+	const FServerMatchTickStats& GetTickStats() const { return MatchTick.GetStats(); }
+	const FBallFlightState& GetBall() const { return Ball; }
+	int32 GetKickCount() const { return KickCount; }
+
+	// Cost of the last tick and of its snapshot encoding (zero when it did not broadcast), ms
+	double GetLastTickMs() const { return LastTickMs; }
+	double GetLastEncodeMs() const { return LastEncodeMs; }
+
+	// Per-match heap: connections, their queues and snapshot histories, the rewind history, and the encode buffers
+	SIZE_T GetAllocatedSize() const;
+
+	// IServerMatchWorld
+	virtual bool SimulateInput(uint32 EntityId, const FInputCommand& Command, float DeltaTime) override;
+	virtual void ExecuteActions(uint32 EntityId, const FInputCommand& Command, const FLagCompensationHistory* History) override;
+	virtual void FinishStep(float DeltaTime) override;
+	virtual void GatherWorld(FWorldSnapshot& OutWorld) const override { GatherWorldAt(OutWorld, StepStartTime); }
+
+private:
+	void ReceiveInputs(const FConnection& Connection, const TArray<uint8>& Payload);
+	void GatherWorldAt(FWorldSnapshot& OutWorld, double Now) const;
+	FConnection* FindConnection(uint32 EntityId);
+
+	int32 MatchId = 0;
+	const FMatchHostSharedData& Shared;
+
+	FServerMatchTick MatchTick;
+	TArray<FConnection> Connections;
+	TArray<ANetworkGameState::FClientSnapshotJob> Jobs;
+
+	// Input payloads this tick, checked as one batch
+	TArray<TArrayView<const uint8>> InputPacketViews;
+	TArray<bool> InputPacketsIntact;
+
+	// The ball is evaluated from its last launch, as ABall does
+	FBallFlightState BallLaunch;
+	double BallLaunchTime = 0.0;
+	FBallFlightState Ball;
+	int32 KickCount = 0;
+
+	// Server time at the start of the step being run
+	double StepStartTime = 0.0;
+	float SnapshotAccumulator = 0.0f;
+	bool bLastTickBroadcast = false;
+	double LastTickMs = 0.0;
+	double LastEncodeMs = 0.0;
+};
+
+/**
+ * Runs many independent matches in one server process
+ * A process per two-player match pays for a whole engine each time; here matches share one copy of the immutable
+ * assets (network params, tuning) and tick side by side, each as one task on the task graph.
+ * A match never reads another match's state, so the only synchronization is the join at the end of Tick.
+ * Holds references to the shared assets so they stay loaded while any match runs
+ */
+class POCKETSTRIKER_API FMatchHost : public FGCObject
+{
+public:
+	explicit FMatchHost(const FMatchHostSharedData& InShared);
+	virtual ~FMatchHost();
+
+	FMatchHost(const FMatchHost&) = delete;
+	FMatchHost& operator=(const FMatchHost&) = delete;
+
+	FHeadlessMatch& CreateMatch();
+	void DestroyMatch(int32 MatchId);
+
+	int32 NumMatches() const { return Matches.Num(); }
+	FHeadlessMatch& GetMatch(int32 Index) { return *Matches[Index]; }
+	const FHeadlessMatch& GetMatch(int32 Index) const { return *Matches[Index]; }
+
+	// Ticks every match once, across the task graph when bParallel is set; returns how many broadcast
+	int32 Tick(bool bParallel);
+
+	const FMatchHostSharedData& GetSharedData() const { return Shared; }
+
+	// Wall time of the last Tick, all matches, ms
+	double GetLastTickMs() const { return LastTickMs; }
+
+	// FGCObject
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
+	virtual FString GetReferencerName() const override { return TEXT("FMatchHost"); }
+
+private:
+	FMatchHostSharedData Shared;
+	TArray<TUniquePtr<FHeadlessMatch>> Matches;
+	int32 NextMatchId = 1;
+	double LastTickMs = 0.0;
+};
@@ -0,0 +1,527 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "MatchRecording.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/BitWriter.h"
+#include "Serialization/BitReader.h"
+
+namespace
+{
+	// "PSMR" read as a little-endian uint32
+	constexpr uint32 RecordingMagic = 0x524D5350;
+	constexpr uint32 RecordingVersion = 1;
+
+	// Record tags; an input record sets the top bit and carries its change mask in the other seven
+	constexpr uint8 TagTick = 0x01;
+	constexpr uint8 TagKeyframe = 0x02;
+	constexpr uint8 TagEnd = 0x03;
+	constexpr uint8 TagInput = 0x80;
+
+	constexpr uint8 InputSequenceChanged = 1 << 0;
+	constexpr uint8 InputTimestampChanged = 1 << 1;
+	constexpr uint8 InputAxisChangedShift = 2;
+	constexpr uint8 InputFlagsChanged = 1 << 6;
+
+	// Keyframes hold the ball and the players, so anything larger is corrupt
+	constexpr uint32 MaxKeyframeBytes = 64 * 1024;
+
+	void WriteVarUInt(TArray<uint8>& Out, uint64 Value)
+	{
+		while (Value >= 0x80)
+		{
+			Out.Add(static_cast<uint8>(Value) | 0x80);
+			Value >>= 7;
+		}
+		Out.Add(static_cast<uint8>(Value));
+	}
+
+	// Zigzag keeps small negative deltas small
+	void WriteVarInt(TArray<uint8>& Out, int64 Value)
+	{
+		WriteVarUInt(Out, (static_cast<uint64>(Value) << 1) ^ static_cast<uint64>(Value >> 63));
+	}
+
+	template<typename T>
+	void WriteRaw(TArray<uint8>& Out, T Value)
+	{
+		Out.Append(reinterpret_cast<const uint8*>(&Value), sizeof(T));
+	}
+
+	// Bounds-checked reads over the loaded file; any overrun sets bError and returns zero from then on
+	struct FRecordingCursor
+	{
+		const TArray<uint8>& Data;
+		int64& Offset;
+		bool& bError;
+
+		bool AtEnd() const { return Offset >= Data.Num(); }
+
+		uint8 ReadByte()
+		{
+			if (bError || Offset >= Data.Num())
+			{
+				bError = true;
+				return 0;
+			}
+			return Data[Offset++];
+		}
+
+		uint64 ReadVarUInt()
+		{
+			uint64 Value = 0;
+			for (int32 Shift = 0; Shift < 64 && !bError; Shift += 7)
+			{
+				const uint8 Byte = ReadByte();
+				Value |= static_cast<uint64>(Byte & 0x7F) << Shift;
+				if ((Byte & 0x80) == 0)
+				{
+					return Value;
+				}
+			}
+			bError = true;
+			return 0;
+		}
+
+		int64 ReadVarInt()
+		{
+			const uint64 Value = ReadVarUInt();
+			return static_cast<int64>(Value >> 1) ^ -static_cast<int64>(Value & 1);
+		}
+
+		template<typename T>
+		T ReadRaw()
+		{
+			T Value{};
+			if (bError || Offset + static_cast<int64>(sizeof(T)) > Data.Num())
+			{
+				bError = true;
+				return Value;
+			}
+			FMemory::Memcpy(&Value, Data.GetData() + Offset, sizeof(T));
+			Offset += sizeof(T);
+			return Value;
+		}
+	};
+
+	FMatchRecordingInputState MakeInitialInputState(const FNetQuantizationSettings& Settings)
+	{
+		// A centred stick is the most likely first input, so it is what an entity's first input is coded against
+		FMatchRecordingInputState State;
+		const uint32 CentreCode = FNetQuantize::QuantizeAxis(0.0, Settings);
+		for (uint32& Code : State.AxisCodes)
+		{
+			Code = CentreCode;
+		}
+		return State;
+	}
+
+	void WriteHeader(TArray<uint8>& Out, const FMatchRecordingHeader& Header)
+	{
+		const FNetQuantizationSettings& Q = Header.Quantization;
+		WriteRaw<uint32>(Out, RecordingMagic);
+		WriteVarUInt(Out, RecordingVersion);
+		WriteRaw<float>(Out, Header.TickRate);
+		WriteVarUInt(Out, static_cast<uint32>(Header.KeyframeIntervalTicks));
+		WriteRaw<int64>(Out, Header.StartTime.GetTicks());
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			WriteRaw<float>(Out, static_cast<float>(Q.PitchMin[Axis]));
+			WriteRaw<float>(Out, static_cast<float>(Q.PitchMax[Axis]));
+		}
+		WriteRaw<float>(Out, Q.PositionResolution);
+		WriteRaw<float>(Out, Q.MaxQuantizedSpeed);
+		WriteRaw<float>(Out, Q.VelocityResolution);
+		WriteRaw<float>(Out, Q.MaxQuantizedStamina);
+		WriteVarUInt(Out, static_cast<uint32>(Q.AxisBits));
+		WriteVarUInt(Out, static_cast<uint32>(Q.StaminaBits));
+	}
+
+	bool ReadHeader(FRecordingCursor& Cursor, FMatchRecordingHeader& Header)
+	{
+		if (Cursor.ReadRaw<uint32>() != RecordingMagic || Cursor.ReadVarUInt() != RecordingVersion)
+		{
+			return false;
+		}
+
+		FNetQuantizationSettings& Q = Header.Quantization;
+		Header.TickRate = Cursor.ReadRaw<float>();
+		Header.KeyframeIntervalTicks = static_cast<int32>(Cursor.ReadVarUInt());
+		Header.StartTime = FDateTime(Cursor.ReadRaw<int64>());
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			Q.PitchMin[Axis] = Cursor.ReadRaw<float>();
+			Q.PitchMax[Axis] = Cursor.ReadRaw<float>();
+		}
+		Q.PositionResolution = Cursor.ReadRaw<float>();
+		Q.MaxQuantizedSpeed = Cursor.ReadRaw<float>();
+		Q.VelocityResolution = Cursor.ReadRaw<float>();
+		Q.MaxQuantizedStamina = Cursor.ReadRaw<float>();
+		Q.AxisBits = static_cast<int32>(Cursor.ReadVarUInt());
+		Q.StaminaBits = static_cast<int32>(Cursor.ReadVarUInt());
+
+		return !Cursor.bError && Header.TickRate > 0.0f && Header.KeyframeIntervalTicks > 0;
+	}
+
+	void GetAxisCodes(const FInputCommand& Input, const FNetQuantizationSettings& Settings, uint32 (&OutCodes)[4])
+	{
+		OutCodes[0] = FNetQuantize::QuantizeAxis(Input.MovementInput.X, Settings);
+		OutCodes[1] = FNetQuantize::QuantizeAxis(Input.MovementInput.Y, Settings);
+		OutCodes[2] = FNetQuantize::QuantizeAxis(Input.LookInput.X, Settings);
+		OutCodes[3] = FNetQuantize::QuantizeAxis(Input.LookInput.Y, Settings);
+	}
+}
+
+FMatchRecorder::~FMatchRecorder()
+{
+	Close();
+}
+
+bool FMatchRecorder::Open(const FString& InFilename, const FMatchRecordingHeader& InHeader)
+{
+	Close();
+
+	FileWriter.Reset(IFileManager::Get().CreateFileWriter(*InFilename));
+	if (!FileWriter.IsValid())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("MatchRecorder: Could not open %s for writing"), *InFilename);
+		return false;
+	}
+	WriteTask = MakeUnique<FAsyncTask<FMatchRecordingWriteTask>>(FileWriter.Get());
+
+	Filename = InFilename;
+	Header = InHeader;
+	Header.KeyframeIntervalTicks = FMath::Max(1, Header.KeyframeIntervalTicks);
+	Pending.Reset();
+	BytesFlushed = 0;
+	CurrentTick = 0;
+	LastWrittenTick = 0;
+	NextKeyframeTick = 0;
+	bTickWritten = false;
+	NumTicks = 0;
+	NumInputs = 0;
+	NumKeyframes = 0;
+	InputStates.Reset();
+
+	WriteHeader(Pending, Header);
+	Flush();
+	return true;
+}
+
+void FMatchRecorder::Close()
+{
+	if (!FileWriter.IsValid())
+	{
+		return;
+	}
+
+	Pending.Add(TagEnd);
+	WriteVarUInt(Pending, static_cast<uint32>(NumTicks));
+	Flush();
+	WriteTask->EnsureCompletion();
+	WriteTask.Reset();
+	FileWriter->Close();
+	FileWriter.Reset();
+
+	UE_LOG(LogTemp, Log, TEXT("MatchRecorder: Wrote %s (%d ticks, %lld inputs, %d keyframes, %lld bytes)"),
+		*Filename, NumTicks, NumInputs, NumKeyframes, BytesFlushed);
+}
+
+void FMatchRecorder::BeginTick(int32 Tick)
+{
+	ensure(Tick >= CurrentTick);
+	CurrentTick = Tick;
+	bTickWritten = false;
+}
+
+void FMatchRecorder::RecordKeyframe(const FWorldSnapshot& World)
+{
+	if (!IsOpen())
+	{
+		return;
+	}
+
+	// The snapshot entity encoding, without the per-client baseline and ack fields
+	FBitWriter Writer(0, true);
+	uint32 PossessingEntityId = World.PossessingEntityId;
+	float ServerTimestamp = World.ServerTimestamp;
+	uint32 EntityCount = static_cast<uint32>(World.Entities.Num());
+	Writer.SerializeIntPacked(PossessingEntityId);
+	FNetQuantize::SerializeTimestamp(Writer, ServerTimestamp);
+	Writer.SerializeIntPacked(EntityCount);
+	for (const FEntitySnapshotState& Source : World.Entities)
+	{
+		FEntitySnapshotState Entity = Source;
+		Writer.SerializeIntPacked(Entity.EntityId);
+		Entity.NetSerialize(Writer, Header.Quantization);
+	}
+
+	if (!bTickWritten)
+	{
+		Pending.Add(TagTick);
+		WriteVarUInt(Pending, static_cast<uint32>(CurrentTick - LastWrittenTick));
+		LastWrittenTick = CurrentTick;
+		bTickWritten = true;
+		++NumTicks;
+	}
+
+	Pending.Add(TagKeyframe);
+	WriteVarUInt(Pending, static_cast<uint64>(Writer.GetNumBytes()));
+	Pending.Append(Writer.GetData(), static_cast<int32>(Writer.GetNumBytes()));
+
+	NextKeyframeTick = CurrentTick + Header.KeyframeIntervalTicks;
+	++NumKeyframes;
+	Flush();
+}
+
+void FMatchRecorder::RecordInput(uint32 EntityId, const FInputCommand& Input)
+{
+	if (!IsOpen())
+	{
+		return;
+	}
+
+	if (!bTickWritten)
+	{
+		Pending.Add(TagTick);
+		WriteVarUInt(Pending, static_cast<uint32>(CurrentTick - LastWrittenTick));
+		LastWrittenTick = CurrentTick;
+		bTickWritten = true;
+		++NumTicks;
+	}
+
+	FMatchRecordingInputState* State = InputStates.Find(EntityId);
+	if (!State)
+	{
+		State = &InputStates.Add(EntityId, MakeInitialInputState(Header.Quantization));
+	}
+
+	const uint32 TimestampMs = FNetQuantize::QuantizeTimestamp(Input.ClientTimestamp);
+	const int32 TimestampStepMs = static_cast<int32>(static_cast<int64>(TimestampMs) - State->TimestampMs);
+	uint32 AxisCodes[4];
+	GetAxisCodes(Input, Header.Quantization, AxisCodes);
+
+	uint8 Mask = 0;
+	Mask |= Input.SequenceNumber != State->SequenceNumber + 1 ? InputSequenceChanged : 0;
+	Mask |= TimestampStepMs != State->TimestampStepMs ? InputTimestampChanged : 0;
+	for (int32 Axis = 0; Axis < 4; ++Axis)
+	{
+		Mask |= AxisCodes[Axis] != State->AxisCodes[Axis] ? (1 << (InputAxisChangedShift + Axis)) : 0;
+	}
+	Mask |= Input.ActionFlags != State->ActionFlags ? InputFlagsChanged : 0;
+
+	Pending.Add(TagInput | Mask);
+	WriteVarUInt(Pending, EntityId);
+	if (Mask & InputSequenceChanged)
+	{
+		WriteVarInt(Pending, static_cast<int64>(Input.SequenceNumber) - (static_cast<int64>(State->SequenceNumber) + 1));
+	}
+	if (Mask & InputTimestampChanged)
+	{
+		WriteVarInt(Pending, static_cast<int64>(TimestampStepMs) - State->TimestampStepMs);
+	}
+	for (int32 Axis = 0; Axis < 4; ++Axis)
+	{
+		if (Mask & (1 << (InputAxisChangedShift + Axis)))
+		{
+			WriteVarUInt(Pending, AxisCodes[Axis]);
+		}
+	}
+	if (Mask & InputFlagsChanged)
+	{
+		WriteVarUInt(Pending, Input.ActionFlags);
+	}
+
+	State->SequenceNumber = Input.SequenceNumber;
+	State->TimestampMs = TimestampMs;
+	State->TimestampStepMs = TimestampStepMs;
+	FMemory::Memcpy(State->AxisCodes, AxisCodes, sizeof(AxisCodes));
+	State->ActionFlags = Input.ActionFlags;
+	++NumInputs;
+
+	if (Pending.Num() >= FlushBytes)
+	{
+		Flush();
+	}
+}
+
+void FMatchRecordingWriteTask::DoWork()
+{
+	Writer->Serialize(Buffer.GetData(), Buffer.Num());
+	Writer->Flush();
+}
+
+void FMatchRecorder::Flush()
+{
+	if (WriteTask.IsValid() && Pending.Num() > 0)
+	{
+		// One block in flight at a time; swapping hands the written block's allocation back for the next one
+		WriteTask->EnsureCompletion();
+		TArray<uint8>& Buffer = WriteTask->GetTask().Buffer;
+		Swap(Buffer, Pending);
+		BytesFlushed += Buffer.Num();
+		WriteTask->StartBackgroundTask();
+	}
+	Pending.Reset();
+}
+
+bool FMatchRecordingReader::Open(const FString& InFilename)
+{
+	Data.Reset();
+	Offset = 0;
+	bError = false;
+	LastTick = 0;
+	InputStates.Reset();
+
+	if (!FFileHelper::LoadFileToArray(Data, *InFilename))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("MatchRecordingReader: Could not read %s"), *InFilename);
+		return false;
+	}
+
+	FRecordingCursor Cursor{ Data, Offset, bError };
+	if (!ReadHeader(Cursor, Header))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("MatchRecordingReader: %s is not a match recording"), *InFilename);
+		bError = true;
+		return false;
+	}
+	return true;
+}
+
+bool FMatchRecordingReader::ReadFrame(FMatchRecordingFrame& OutFrame)
+{
+	FRecordingCursor Cursor{ Data, Offset, bError };
+	if (bError || Cursor.AtEnd())
+	{
+		// A file without an end record was cut short
+		bError = true;
+		return false;
+	}
+
+	const uint8 FirstTag = Cursor.ReadByte();
+	if (FirstTag == TagEnd)
+	{
+		Cursor.ReadVarUInt();
+		return false;
+	}
+	if (FirstTag != TagTick)
+	{
+		bError = true;
+		return false;
+	}
+
+	OutFrame.Tick = LastTick + static_cast<int32>(Cursor.ReadVarUInt());
+	OutFrame.Inputs.Reset();
+	OutFrame.bHasKeyframe = false;
+
+	// A tick runs until the next tick or end record; a record cut off mid-way drops the whole tick
+	while (!bError && !Cursor.AtEnd())
+	{
+		const uint8 Tag = Data[Offset];
+		if (Tag == TagTick || Tag == TagEnd)
+		{
+			break;
+		}
+		Cursor.ReadByte();
+
+		if (Tag == TagKeyframe)
+		{
+			const uint64 NumBytes = Cursor.ReadVarUInt();
+			if (bError || NumBytes > MaxKeyframeBytes || Offset + static_cast<int64>(NumBytes) > Data.Num())
+			{
+				bError = true;
+				break;
+			}
+
+			FBitReader Reader(Data.GetData() + Offset, static_cast<int64>(NumBytes) * 8);
+			Offset += static_cast<int64>(NumBytes);
+
+			FWorldSnapshot& World = OutFrame.Keyframe;
+			World.Entities.Reset();
+			World.AcknowledgedSequence = 0;
+			uint32 EntityCount = 0;
+			Reader.SerializeIntPacked(World.PossessingEntityId);
+			FNetQuantize::SerializeTimestamp(Reader, World.ServerTimestamp);
+			Reader.SerializeIntPacked(EntityCount);
+			if (Reader.IsError() || EntityCount > FWorldSnapshotCodec::MaxEntities)
+			{
+				bError = true;
+				break;
+			}
+
+			World.Entities.Reserve(EntityCount);
+			for (uint32 i = 0; i < EntityCount && !Reader.IsError(); ++i)
+			{
+				FEntitySnapshotState& Entity = World.Entities.AddDefaulted_GetRef();
+				Reader.SerializeIntPacked(Entity.EntityId);
+				Entity.NetSerialize(Reader, Header.Quantization);
+			}
+			bError = Reader.IsError();
+			OutFrame.bHasKeyframe = !bError;
+		}
+		else if (Tag & TagInput)
+		{
+			const uint8 Mask = Tag & ~TagInput;
+			const uint32 EntityId = static_cast<uint32>(Cursor.ReadVarUInt());
+
+			FMatchRecordingInputState* State = InputStates.Find(EntityId);
+			if (!State)
+			{
+				State = &InputStates.Add(EntityId, MakeInitialInputState(Header.Quantization));
+			}
+
+			FMatchRecordingInputState Next = *State;
+			Next.SequenceNumber = State->SequenceNumber + 1;
+			if (Mask & InputSequenceChanged)
+			{
+				Next.SequenceNumber = static_cast<uint32>(static_cast<int64>(Next.SequenceNumber) + Cursor.ReadVarInt());
+			}
+			if (Mask & InputTimestampChanged)
+			{
+				Next.TimestampStepMs = static_cast<int32>(State->TimestampStepMs + Cursor.ReadVarInt());
+			}
+			Next.TimestampMs = static_cast<uint32>(static_cast<int64>(State->TimestampMs) + Next.TimestampStepMs);
+			for (int32 Axis = 0; Axis < 4; ++Axis)
+			{
+				if (Mask & (1 << (InputAxisChangedShift + Axis)))
+				{
+					Next.AxisCodes[Axis] = static_cast<uint32>(Cursor.ReadVarUInt());
+				}
+			}
+			if (Mask & InputFlagsChanged)
+			{
+				Next.ActionFlags = static_cast<uint32>(Cursor.ReadVarUInt());
+			}
+			if (bError)
+			{
+				break;
+			}
+			*State = Next;
+
+			FInputCommand Input;
+			Input.SequenceNumber = Next.SequenceNumber;
+			Input.ClientTimestamp = Next.TimestampMs / 1000.0f;
+			Input.MovementInput.X = FNetQuantize::DequantizeAxis(Next.AxisCodes[0], Header.Quantization);
+			Input.MovementInput.Y = FNetQuantize::DequantizeAxis(Next.AxisCodes[1], Header.Quantization);
+			Input.LookInput.X = FNetQuantize::DequantizeAxis(Next.AxisCodes[2], Header.Quantization);
+			Input.LookInput.Y = FNetQuantize::DequantizeAxis(Next.AxisCodes[3], Header.Quantization);
+			Input.ActionFlags = Next.ActionFlags;
+			OutFrame.Inputs.Emplace(EntityId, Input);
+		}
+		else
+		{
+			bError = true;
+		}
+	}
+
+	if (bError || Cursor.AtEnd())
+	{
+		// Nothing after the last tick means the end record never made it to disk
+		bError = true;
+		return false;
+	}
+
+	LastTick = OutFrame.Tick;
+	return true;
+}
@@ -0,0 +1,165 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/AsyncWork.h"
+#include "NetworkTypes.h"
+#include "NetworkSnapshot.h"
+#include "../Gameplay/GameplayTypes.h"
+
+/**
+ * Fixed facts about a recording, written once at the start of the file
+ */
+struct POCKETSTRIKER_API FMatchRecordingHeader
+{
+	// Server simulation ticks per second; every recorded input belongs to one tick
+	float TickRate = 60.0f;
+
+	// Ticks between keyframes
+	int32 KeyframeIntervalTicks = 300;
+
+	// Grid for stick axes and keyframe entities; inputs the server consumed are already on it, so they round-trip exactly
+	FNetQuantizationSettings Quantization;
+
+	FDateTime StartTime;
+};
+
+/**
+ * One server tick read back from a recording
+ */
+struct POCKETSTRIKER_API FMatchRecordingFrame
+{
+	int32 Tick = 0;
+
+	// Every input the simulation consumed this tick, by entity id
+	TArray<TPair<uint32, FInputCommand>> Inputs;
+
+	// World state at the start of the tick, before its inputs were simulated
+	bool bHasKeyframe = false;
+	FWorldSnapshot Keyframe;
+};
+
+/**
+ * What the next input of one entity is coded against; the recorder and the reader keep identical copies
+ */
+struct FMatchRecordingInputState
+{
+	uint32 SequenceNumber = 0;
+	uint32 TimestampMs = 0;
+	int32 TimestampStepMs = 0;
+	uint32 AxisCodes[4] = {};
+	uint32 ActionFlags = 0;
+};
+
+/**
+ * Writes one block of a recording on a worker thread, so the match tick never waits on disk
+ */
+class FMatchRecordingWriteTask : public FNonAbandonableTask
+{
+	friend class FAsyncTask<FMatchRecordingWriteTask>;
+
+public:
+	FMatchRecordingWriteTask(FArchive* InWriter)
+		: Writer(InWriter)
+	{
+	}
+
+	void DoWork();
+
+	FORCEINLINE TStatId GetStatId() const
+	{
+		RETURN_QUICK_DECLARE_CYCLE_STAT(FMatchRecordingWriteTask, STATGROUP_ThreadPoolAsyncTasks);
+	}
+
+	// Only touched while the task is idle
+	TArray<uint8> Buffer;
+
+private:
+	FArchive* Writer;
+};
+
+/**
+ * Streams a live match to a compact binary file: every input the server simulated plus periodic keyframes
+ * Records are one tag byte followed by varints. Inputs are delta coded against the same entity's previous input:
+ * a change mask in the tag, then only the sequence, timestamp step, stick codes or flags that differ from what
+ * was expected, so a held stick costs two bytes. Keyframes reuse the bit-packed snapshot entity encoding.
+ * Writes are buffered and handed to a background writer every FlushBytes and at each keyframe, so a crash loses
+ * at most one interval. The tick only waits if the previous block is still being written
+ */
+class POCKETSTRIKER_API FMatchRecorder
+{
+public:
+	~FMatchRecorder();
+
+	bool Open(const FString& InFilename, const FMatchRecordingHeader& InHeader);
+	void Close();
+	bool IsOpen() const { return FileWriter.IsValid(); }
+
+	// Starts a server tick; ticks must increase. Inputs and a keyframe recorded after this belong to it
+	void BeginTick(int32 Tick);
+
+	// True when the current tick is due a keyframe
+	bool NeedsKeyframe() const { return IsOpen() && CurrentTick >= NextKeyframeTick; }
+
+	void RecordKeyframe(const FWorldSnapshot& World);
+
+	// The input the simulation consumed for an entity this tick
+	void RecordInput(uint32 EntityId, const FInputCommand& Input);
+
+	const FString& GetFilename() const { return Filename; }
+	int64 GetBytesWritten() const { return BytesFlushed + Pending.Num(); }
+	int32 GetNumTicks() const { return NumTicks; }
+	int64 GetNumInputs() const { return NumInputs; }
+	int32 GetNumKeyframes() const { return NumKeyframes; }
+
+	static constexpr int32 FlushBytes = 64 * 1024;
+
+private:
+	void Flush();
+
+	FString Filename;
+	FMatchRecordingHeader Header;
+	TUniquePtr<FArchive> FileWriter;
+	TUniquePtr<FAsyncTask<FMatchRecordingWriteTask>> WriteTask;
+	TArray<uint8> Pending;
+	int64 BytesFlushed = 0;
+
+	int32 CurrentTick = 0;
+	int32 LastWrittenTick = 0;
+	int32 NextKeyframeTick = 0;
+	bool bTickWritten = false;
+
+	int32 NumTicks = 0;
+	int64 NumInputs = 0;
+	int32 NumKeyframes = 0;
+
+	TMap<uint32, FMatchRecordingInputState> InputStates;
+};
+
+/**
+ * Reads a recording tick by tick
+ * The whole file is loaded up front so decoding never waits on disk. A recording cut short by a crash
+ * reads up to its last complete tick
+ */
+class POCKETSTRIKER_API FMatchRecordingReader
+{
+public:
+	bool Open(const FString& InFilename);
+
+	const FMatchRecordingHeader& GetHeader() const { return Header; }
+	int64 GetNumBytes() const { return Data.Num(); }
+
+	// False at the end of the recording; IsError tells a truncated or corrupt record from a clean end
+	bool ReadFrame(FMatchRecordingFrame& OutFrame);
+	bool IsError() const { return bError; }
+
+private:
+	TArray<uint8> Data;
+	int64 Offset = 0;
+	bool bError = false;
+	int32 LastTick = 0;
+
+	FMatchRecordingHeader Header;
+	TMap<uint32, FMatchRecordingInputState> InputStates;
+};
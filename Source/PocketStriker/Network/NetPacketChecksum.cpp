@@ -0,0 +1,294 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "NetPacketChecksum.h"
+#include "Serialization/BitWriter.h"
+#include "Serialization/BitReader.h"
+
+// The hardware path is compiled wherever the instruction can exist and taken only when the CPU reports it
+#if PLATFORM_CPU_X86_FAMILY && PLATFORM_64BITS
+	#include <nmmintrin.h>
+#if defined(_MSC_VER)
+		#include <intrin.h>
+#endif
+#if defined(__clang__) || defined(__GNUC__)
+		#define NET_CRC32C_TARGET __attribute__((target("sse4.2")))
+#else
+		#define NET_CRC32C_TARGET
+#endif
+	#define NET_CRC32C_HARDWARE 1
+	#define NET_CRC32C_WORD(Crc, Word) static_cast<uint32>(_mm_crc32_u64(Crc, Word))
+	#define NET_CRC32C_BYTE(Crc, Byte) _mm_crc32_u8(Crc, Byte)
+#elif PLATFORM_CPU_ARM_FAMILY && PLATFORM_64BITS && defined(__ARM_FEATURE_CRC32)
+	#include <arm_acle.h>
+	#define NET_CRC32C_TARGET
+	#define NET_CRC32C_HARDWARE 1
+	#define NET_CRC32C_WORD(Crc, Word) __crc32cd(Crc, Word)
+	#define NET_CRC32C_BYTE(Crc, Byte) __crc32cb(Crc, Byte)
+#else
+	#define NET_CRC32C_HARDWARE 0
+#endif
+
+// Both the word loads and the instructions consume bytes in memory order
+static_assert(PLATFORM_LITTLE_ENDIAN, "CRC32C word paths assume a little-endian target");
+
+namespace
+{
+	// 0x1EDC6F41 bit-reversed
+	constexpr uint32 Crc32CPolynomial = 0x82F63B78;
+
+	struct FCrc32CTables
+	{
+		// Table[k][b]: CRC of byte b followed by k zero bytes
+		uint32 Table[8][256];
+
+		FCrc32CTables()
+		{
+			for (uint32 Byte = 0; Byte < 256; ++Byte)
+			{
+				uint32 Crc = Byte;
+				for (int32 Bit = 0; Bit < 8; ++Bit)
+				{
+					Crc = (Crc >> 1) ^ ((Crc & 1) ? Crc32CPolynomial : 0);
+				}
+				Table[0][Byte] = Crc;
+			}
+
+			for (int32 Slice = 1; Slice < 8; ++Slice)
+			{
+				for (uint32 Byte = 0; Byte < 256; ++Byte)
+				{
+					const uint32 Previous = Table[Slice - 1][Byte];
+					Table[Slice][Byte] = (Previous >> 8) ^ Table[0][Previous & 0xFF];
+				}
+			}
+		}
+	};
+
+	const FCrc32CTables& GetTables()
+	{
+		static const FCrc32CTables Tables;
+		return Tables;
+	}
+
+	// Slicing-by-8: one table lookup per byte, eight independent lookups per step
+	uint32 ComputeWithTables(const uint8* Data, int64 Length, uint32 Crc)
+	{
+		const FCrc32CTables& Tables = GetTables();
+		for (; Length >= 8; Data += 8, Length -= 8)
+		{
+			uint32 Low = 0;
+			uint32 High = 0;
+			FMemory::Memcpy(&Low, Data, sizeof(Low));
+			FMemory::Memcpy(&High, Data + 4, sizeof(High));
+			Low ^= Crc;
+			Crc = Tables.Table[7][Low & 0xFF] ^ Tables.Table[6][(Low >> 8) & 0xFF]
+				^ Tables.Table[5][(Low >> 16) & 0xFF] ^ Tables.Table[4][Low >> 24]
+				^ Tables.Table[3][High & 0xFF] ^ Tables.Table[2][(High >> 8) & 0xFF]
+				^ Tables.Table[1][(High >> 16) & 0xFF] ^ Tables.Table[0][High >> 24];
+		}
+
+		for (; Length > 0; ++Data, --Length)
+		{
+			Crc = Tables.Table[0][(Crc ^ *Data) & 0xFF] ^ (Crc >> 8);
+		}
+		return Crc;
+	}
+
+#if NET_CRC32C_HARDWARE
+	NET_CRC32C_TARGET uint32 ComputeWithHardware(const uint8* Data, int64 Length, uint32 Crc)
+	{
+		for (; Length >= 8; Data += 8, Length -= 8)
+		{
+			uint64 Word = 0;
+			FMemory::Memcpy(&Word, Data, sizeof(Word));
+			Crc = NET_CRC32C_WORD(Crc, Word);
+		}
+
+		for (; Length > 0; ++Data, --Length)
+		{
+			Crc = NET_CRC32C_BYTE(Crc, *Data);
+		}
+		return Crc;
+	}
+
+	// The instruction has a latency of several cycles but issues every cycle, so three independent
+	// streams run at close to three times the speed of one. Length is a multiple of 8
+	NET_CRC32C_TARGET void ComputeWithHardwareInterleaved(const uint8* DataA, const uint8* DataB, const uint8* DataC, int64 Length,
+		uint32& CrcA, uint32& CrcB, uint32& CrcC)
+	{
+		uint32 RunA = CrcA;
+		uint32 RunB = CrcB;
+		uint32 RunC = CrcC;
+		for (int64 Offset = 0; Offset < Length; Offset += 8)
+		{
+			uint64 WordA = 0;
+			uint64 WordB = 0;
+			uint64 WordC = 0;
+			FMemory::Memcpy(&WordA, DataA + Offset, sizeof(WordA));
+			FMemory::Memcpy(&WordB, DataB + Offset, sizeof(WordB));
+			FMemory::Memcpy(&WordC, DataC + Offset, sizeof(WordC));
+			RunA = NET_CRC32C_WORD(RunA, WordA);
+			RunB = NET_CRC32C_WORD(RunB, WordB);
+			RunC = NET_CRC32C_WORD(RunC, WordC);
+		}
+		CrcA = RunA;
+		CrcB = RunB;
+		CrcC = RunC;
+	}
+#endif
+
+	bool DetectHardwareCrc()
+	{
+#if NET_CRC32C_HARDWARE && PLATFORM_CPU_X86_FAMILY
+#if defined(PLATFORM_ALWAYS_HAS_SSE4_2) && PLATFORM_ALWAYS_HAS_SSE4_2
+		return true;
+#elif defined(_MSC_VER)
+		int32 CpuInfo[4];
+		__cpuid(CpuInfo, 1);
+		return (CpuInfo[2] & (1 << 20)) != 0;
+#else
+		return __builtin_cpu_supports("sse4.2");
+#endif
+#else
+		return NET_CRC32C_HARDWARE != 0;
+#endif
+	}
+
+	bool UseHardwareCrc()
+	{
+		static const bool bHardware = DetectHardwareCrc();
+		return bHardware;
+	}
+
+	uint32 ReadStoredChecksum(TArrayView<const uint8> Packet)
+	{
+		uint32 Stored = 0;
+		for (int32 i = 0; i < FNetPacketChecksum::NumBytes; ++i)
+		{
+			Stored |= static_cast<uint32>(Packet[i]) << (8 * i);
+		}
+		return Stored;
+	}
+}
+
+uint32 FNetCrc32C::Compute(const void* Data, int64 Length, uint32 Crc)
+{
+	const uint8* Bytes = static_cast<const uint8*>(Data);
+#if NET_CRC32C_HARDWARE
+	if (UseHardwareCrc())
+	{
+		return ~ComputeWithHardware(Bytes, Length, ~Crc);
+	}
+#endif
+	return ~ComputeWithTables(Bytes, Length, ~Crc);
+}
+
+void FNetCrc32C::ComputeMany(TArrayView<const TArrayView<const uint8>> Buffers, TArrayView<uint32> OutCrcs)
+{
+	check(OutCrcs.Num() >= Buffers.Num());
+
+	int32 Index = 0;
+#if NET_CRC32C_HARDWARE
+	if (UseHardwareCrc())
+	{
+		// Packets of one kind are close in size, so most of each triple runs interleaved
+		for (; Index + 3 <= Buffers.Num(); Index += 3)
+		{
+			const TArrayView<const uint8>& A = Buffers[Index];
+			const TArrayView<const uint8>& B = Buffers[Index + 1];
+			const TArrayView<const uint8>& C = Buffers[Index + 2];
+			const int64 Shared = FMath::Min3(A.Num(), B.Num(), C.Num()) & ~7;
+
+			uint32 CrcA = ~0u;
+			uint32 CrcB = ~0u;
+			uint32 CrcC = ~0u;
+			ComputeWithHardwareInterleaved(A.GetData(), B.GetData(), C.GetData(), Shared, CrcA, CrcB, CrcC);
+
+			OutCrcs[Index] = ~ComputeWithHardware(A.GetData() + Shared, A.Num() - Shared, CrcA);
+			OutCrcs[Index + 1] = ~ComputeWithHardware(B.GetData() + Shared, B.Num() - Shared, CrcB);
+			OutCrcs[Index + 2] = ~ComputeWithHardware(C.GetData() + Shared, C.Num() - Shared, CrcC);
+		}
+	}
+#endif
+
+	for (; Index < Buffers.Num(); ++Index)
+	{
+		OutCrcs[Index] = Compute(Buffers[Index].GetData(), Buffers[Index].Num());
+	}
+}
+
+bool FNetCrc32C::IsHardwareAccelerated()
+{
+	return UseHardwareCrc();
+}
+
+const TCHAR* FNetCrc32C::GetImplementationName()
+{
+#if NET_CRC32C_HARDWARE
+	if (UseHardwareCrc())
+	{
+		return PLATFORM_CPU_X86_FAMILY ? TEXT("SSE4.2") : TEXT("ARMv8 CRC");
+	}
+#endif
+	return TEXT("slicing-by-8 tables");
+}
+
+void FNetPacketChecksum::Reserve(FBitWriter& Writer)
+{
+	check(Writer.GetNumBits() == 0);
+	uint32 Placeholder = 0;
+	Writer.SerializeBits(&Placeholder, NumBytes * 8);
+}
+
+void FNetPacketChecksum::Seal(FBitWriter& Writer)
+{
+	// The checksum is byte aligned at the front, so it never covers itself
+	uint8* Data = Writer.GetData();
+	const int64 Length = Writer.GetNumBytes();
+	check(Length >= NumBytes);
+
+	const uint32 Crc = FNetCrc32C::Compute(Data + NumBytes, Length - NumBytes);
+	for (int32 i = 0; i < NumBytes; ++i)
+	{
+		Data[i] = static_cast<uint8>(Crc >> (8 * i));
+	}
+}
+
+bool FNetPacketChecksum::Verify(TArrayView<const uint8> Packet)
+{
+	if (Packet.Num() < NumBytes)
+	{
+		return false;
+	}
+	return ReadStoredChecksum(Packet) == FNetCrc32C::Compute(Packet.GetData() + NumBytes, Packet.Num() - NumBytes);
+}
+
+int32 FNetPacketChecksum::VerifyMany(TArrayView<const TArrayView<const uint8>> Packets, TArrayView<bool> OutValid)
+{
+	check(OutValid.Num() >= Packets.Num());
+
+	TArray<TArrayView<const uint8>, TInlineAllocator<64>> Bodies;
+	Bodies.Reserve(Packets.Num());
+	for (const TArrayView<const uint8>& Packet : Packets)
+	{
+		Bodies.Add(Packet.Num() >= NumBytes ? Packet.Slice(NumBytes, Packet.Num() - NumBytes) : TArrayView<const uint8>());
+	}
+
+	TArray<uint32, TInlineAllocator<64>> Crcs;
+	Crcs.SetNumUninitialized(Packets.Num());
+	FNetCrc32C::ComputeMany(Bodies, Crcs);
+
+	int32 NumFailed = 0;
+	for (int32 i = 0; i < Packets.Num(); ++i)
+	{
+		OutValid[i] = Packets[i].Num() >= NumBytes && ReadStoredChecksum(Packets[i]) == Crcs[i];
+		NumFailed += OutValid[i] ? 0 : 1;
+	}
+	return NumFailed;
+}
+
+void FNetPacketChecksum::Skip(FBitReader& Reader)
+{
+	uint32 Stored = 0;
+	Reader.SerializeBits(&Stored, NumBytes * 8);
+}
@@ -0,0 +1,52 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FBitWriter;
+class FBitReader;
+
+/**
+ * CRC32C (Castagnoli polynomial) over byte buffers
+ * Runs on the SSE4.2 / ARMv8 CRC32C instructions when the CPU has them and on slicing-by-8 tables otherwise;
+ * every path produces the same value. Chain calls by passing the previous result as Crc
+ */
+struct POCKETSTRIKER_API FNetCrc32C
+{
+	static uint32 Compute(const void* Data, int64 Length, uint32 Crc = 0);
+
+	// One CRC per buffer; OutCrcs must have as many entries as Buffers
+	// The hardware path runs three buffers through interleaved streams, which hides the instruction's latency
+	static void ComputeMany(TArrayView<const TArrayView<const uint8>> Buffers, TArrayView<uint32> OutCrcs);
+
+	static bool IsHardwareAccelerated();
+	static const TCHAR* GetImplementationName();
+
+	// Known answer for the ASCII string "123456789"
+	static constexpr uint32 CheckValue = 0xE3069283;
+};
+
+/**
+ * Integrity check for the bit-packed RPC payloads (input windows and world snapshots)
+ * A packet opens with the CRC32C of every byte after it, so the receiver checks the whole serialized buffer
+ * in one pass before parsing a single field, and packets that arrive together can be checked together
+ */
+struct POCKETSTRIKER_API FNetPacketChecksum
+{
+	static constexpr int32 NumBytes = 4;
+
+	// Leaves room for the checksum; must be the first thing written
+	static void Reserve(FBitWriter& Writer);
+
+	// Fills in the checksum once the rest of the packet has been written
+	static void Seal(FBitWriter& Writer);
+
+	static bool Verify(TArrayView<const uint8> Packet);
+
+	// OutValid gets one entry per packet; returns how many failed
+	static int32 VerifyMany(TArrayView<const TArrayView<const uint8>> Packets, TArrayView<bool> OutValid);
+
+	// Moves a reader at the start of a verified packet past the checksum
+	static void Skip(FBitReader& Reader);
+};
@@ -0,0 +1,324 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "NetTrafficStats.h"
+#include "ProfilingDebugging/CountersTrace.h"
+#include "Serialization/BitWriter.h"
+#include "Serialization/BitReader.h"
+
+DEFINE_STAT(STAT_NetSnapshotEncode);
+DEFINE_STAT(STAT_NetSnapshotDecode);
+DEFINE_STAT(STAT_NetInputPack);
+DEFINE_STAT(STAT_NetInputUnpack);
+DEFINE_STAT(STAT_NetPacketVerify);
+DEFINE_STAT(STAT_NetLagCompensation);
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bytes Sent"), STAT_NetBytesSent, STATGROUP_PocketStrikerNet);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bytes Received"), STAT_NetBytesReceived, STATGROUP_PocketStrikerNet);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Snapshot Bytes"), STAT_NetSnapshotBytes, STATGROUP_PocketStrikerNet);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Input Bytes"), STAT_NetInputBytes, STATGROUP_PocketStrikerNet);
+
+UE_TRACE_CHANNEL_DEFINE(NetTrafficChannel);
+
+TRACE_DECLARE_INT_COUNTER(NetSnapshotBytesSent, TEXT("PocketStriker/Net/SnapshotBytesSent"));
+TRACE_DECLARE_INT_COUNTER(NetSnapshotBytesReceived, TEXT("PocketStriker/Net/SnapshotBytesReceived"));
+TRACE_DECLARE_INT_COUNTER(NetInputBytesSent, TEXT("PocketStriker/Net/InputBytesSent"));
+TRACE_DECLARE_INT_COUNTER(NetInputBytesReceived, TEXT("PocketStriker/Net/InputBytesReceived"));
+
+namespace
+{
+	// Trace counters are cumulative; their slope in Insights is the rate
+	void TraceBytes(ENetTrafficDirection Direction, ENetPacketType Type, int32 Bytes)
+	{
+		const bool bSent = Direction == ENetTrafficDirection::Sent;
+		if (Type == ENetPacketType::Snapshot)
+		{
+			if (bSent)
+			{
+				TRACE_COUNTER_ADD(NetSnapshotBytesSent, Bytes);
+			}
+			else
+			{
+				TRACE_COUNTER_ADD(NetSnapshotBytesReceived, Bytes);
+			}
+		}
+		else if (Type == ENetPacketType::Inputs)
+		{
+			if (bSent)
+			{
+				TRACE_COUNTER_ADD(NetInputBytesSent, Bytes);
+			}
+			else
+			{
+				TRACE_COUNTER_ADD(NetInputBytesReceived, Bytes);
+			}
+		}
+	}
+}
+
+int64 FNetFieldBits::GetTotal() const
+{
+	int64 Total = 0;
+	for (int64 GroupBits : Bits)
+	{
+		Total += GroupBits;
+	}
+	return Total;
+}
+
+void FNetFieldBits::Add(const FNetFieldBits& Other)
+{
+	for (int32 Group = 0; Group < static_cast<int32>(ENetFieldGroup::Count); ++Group)
+	{
+		Bits[Group] += Other.Bits[Group];
+	}
+	DeltaSavedBits += Other.DeltaSavedBits;
+}
+
+FNetFieldBitCounter::FNetFieldBitCounter(const FBitWriter& InWriter, FNetFieldBits& InBits)
+	: Writer(&InWriter)
+	, Bits(InBits)
+{
+	LastMark = GetPosition();
+}
+
+FNetFieldBitCounter::FNetFieldBitCounter(const FBitReader& InReader, FNetFieldBits& InBits)
+	: Reader(&InReader)
+	, Bits(InBits)
+{
+	LastMark = GetPosition();
+}
+
+int64 FNetFieldBitCounter::GetPosition() const
+{
+	return Writer ? Writer->GetNumBits() : Reader->GetPosBits();
+}
+
+void FNetFieldBitCounter::Mark(ENetFieldGroup Group)
+{
+	const int64 Position = GetPosition();
+	Bits[Group] += Position - LastMark;
+	LastMark = Position;
+}
+
+void FNetFieldBitCounter::Add(const FNetFieldBits& Other)
+{
+	Bits.Add(Other);
+	LastMark = GetPosition();
+}
+
+FNetPacketSample FNetPacketSample::MakeUnencoded(ENetPacketType Type, int32 Bytes)
+{
+	FNetPacketSample Sample;
+	Sample.Type = Type;
+	Sample.Bytes = Bytes;
+	Sample.FieldBits[ENetFieldGroup::Header] = Bytes * 8;
+	Sample.RawBytes = Bytes;
+	return Sample;
+}
+
+FNetTrafficStats::FNetTrafficStats()
+{
+	Reset();
+}
+
+void FNetTrafficStats::Reset()
+{
+	for (auto& DirectionChannels : Channels)
+	{
+		for (FChannel& Channel : DirectionChannels)
+		{
+			Channel.Totals = FNetPacketTypeStats();
+			Channel.Recent.Reset(RollingSamples);
+			Channel.Next = 0;
+		}
+	}
+}
+
+void FNetTrafficStats::Record(ENetTrafficDirection Direction, const FNetPacketSample& Sample, double Now)
+{
+	FChannel& Channel = Channels[static_cast<int32>(Direction)][static_cast<int32>(Sample.Type)];
+	const double Seconds = FPlatformTime::ToSeconds64(Sample.Cycles);
+
+	FNetPacketTypeStats& Totals = Channel.Totals;
+	Totals.Packets++;
+	Totals.Bytes += Sample.Bytes;
+	Totals.RawBytes += Sample.RawBytes;
+	Totals.FieldBits.Add(Sample.FieldBits);
+	Totals.SerializeSeconds += Seconds;
+
+	FRollingEntry Entry;
+	Entry.Time = Now;
+	Entry.Bytes = Sample.Bytes;
+	Entry.Micros = static_cast<float>(Seconds * 1e6);
+	if (Channel.Recent.Num() < RollingSamples)
+	{
+		Channel.Recent.Add(Entry);
+	}
+	else
+	{
+		Channel.Recent[Channel.Next] = Entry;
+		Channel.Next = (Channel.Next + 1) % RollingSamples;
+	}
+
+	if (Direction == ENetTrafficDirection::Sent)
+	{
+		INC_DWORD_STAT_BY(STAT_NetBytesSent, Sample.Bytes);
+	}
+	else
+	{
+		INC_DWORD_STAT_BY(STAT_NetBytesReceived, Sample.Bytes);
+	}
+
+	if (Sample.Type == ENetPacketType::Snapshot)
+	{
+		INC_DWORD_STAT_BY(STAT_NetSnapshotBytes, Sample.Bytes);
+	}
+	else if (Sample.Type == ENetPacketType::Inputs)
+	{
+		INC_DWORD_STAT_BY(STAT_NetInputBytes, Sample.Bytes);
+	}
+
+	TraceBytes(Direction, Sample.Type, Sample.Bytes);
+}
+
+FNetRollingTrafficStats FNetTrafficStats::GetRolling(ENetTrafficDirection Direction, ENetPacketType Type, double Now) const
+{
+	const FChannel& Channel = Channels[static_cast<int32>(Direction)][static_cast<int32>(Type)];
+
+	FNetRollingTrafficStats Rolling;
+	TArray<double> Sizes;
+	TArray<double> Micros;
+	Sizes.Reserve(Channel.Recent.Num());
+	Micros.Reserve(Channel.Recent.Num());
+
+	int64 WindowBytes = 0;
+	int32 WindowPackets = 0;
+	for (const FRollingEntry& Entry : Channel.Recent)
+	{
+		Sizes.Add(Entry.Bytes);
+		Micros.Add(Entry.Micros);
+		if (Entry.Time > Now - RateWindowSeconds)
+		{
+			WindowBytes += Entry.Bytes;
+			WindowPackets++;
+		}
+	}
+
+	Sizes.Sort();
+	Micros.Sort();
+	Rolling.BytesPerSecond = WindowBytes / RateWindowSeconds;
+	Rolling.PacketsPerSecond = WindowPackets / RateWindowSeconds;
+	Rolling.SizeP50 = GetPercentile(Sizes, 0.5);
+	Rolling.SizeP99 = GetPercentile(Sizes, 0.99);
+	Rolling.SerializeP50Us = GetPercentile(Micros, 0.5);
+	Rolling.SerializeP99Us = GetPercentile(Micros, 0.99);
+	return Rolling;
+}
+
+double FNetTrafficStats::GetBytesPerSecond(ENetTrafficDirection Direction, double Now) const
+{
+	int64 WindowBytes = 0;
+	for (const FChannel& Channel : Channels[static_cast<int32>(Direction)])
+	{
+		for (const FRollingEntry& Entry : Channel.Recent)
+		{
+			if (Entry.Time > Now - RateWindowSeconds)
+			{
+				WindowBytes += Entry.Bytes;
+			}
+		}
+	}
+	return WindowBytes / RateWindowSeconds;
+}
+
+void FNetTrafficStats::Log(const FString& Label, double Now) const
+{
+	for (int32 DirectionIndex = 0; DirectionIndex < static_cast<int32>(ENetTrafficDirection::Count); ++DirectionIndex)
+	{
+		const ENetTrafficDirection Direction = static_cast<ENetTrafficDirection>(DirectionIndex);
+		for (int32 TypeIndex = 0; TypeIndex < static_cast<int32>(ENetPacketType::Count); ++TypeIndex)
+		{
+			const ENetPacketType Type = static_cast<ENetPacketType>(TypeIndex);
+			const FNetPacketTypeStats& Totals = GetTotals(Direction, Type);
+			if (Totals.Packets == 0)
+			{
+				continue;
+			}
+
+			const bool bSent = Direction == ENetTrafficDirection::Sent;
+			const FNetRollingTrafficStats Rolling = GetRolling(Direction, Type, Now);
+			const FString Split = bSent
+				? FString::Printf(TEXT(" (quantization %.2fx, delta %.2fx)"), Totals.GetQuantizationRatio(), Totals.GetDeltaRatio())
+				: FString();
+			UE_LOG(LogTemp, Log, TEXT("%s %s %s: %lld packets, %lld bytes, %.0f B/s, size p50/p99 %.0f/%.0f B, %s p50/p99 %.1f/%.1f us, raw/wire %.2fx%s"),
+				*Label, bSent ? TEXT("sent") : TEXT("received"), GetPacketTypeName(Type),
+				Totals.Packets, Totals.Bytes, Rolling.BytesPerSecond, Rolling.SizeP50, Rolling.SizeP99,
+				bSent ? TEXT("serialize") : TEXT("deserialize"), Rolling.SerializeP50Us, Rolling.SerializeP99Us,
+				Totals.GetCompressionRatio(), *Split);
+
+			// Where the bits went, for the packet types that have more than one field group
+			const int64 TotalBits = Totals.FieldBits.GetTotal();
+			if (TotalBits > 0 && Totals.FieldBits[ENetFieldGroup::Header] < TotalBits)
+			{
+				FString Fields;
+				for (int32 Group = 0; Group < static_cast<int32>(ENetFieldGroup::Count); ++Group)
+				{
+					const int64 GroupBits = Totals.FieldBits.Bits[Group];
+					if (GroupBits > 0)
+					{
+						Fields += FString::Printf(TEXT(" %s %.1f%%"), GetFieldGroupName(static_cast<ENetFieldGroup>(Group)), 100.0 * GroupBits / TotalBits);
+					}
+				}
+				UE_LOG(LogTemp, Log, TEXT("%s   fields:%s"), *Label, *Fields);
+			}
+		}
+	}
+}
+
+const TCHAR* FNetTrafficStats::GetPacketTypeName(ENetPacketType Type)
+{
+	switch (Type)
+	{
+	case ENetPacketType::Inputs:		return TEXT("Inputs");
+	case ENetPacketType::SnapshotAck:	return TEXT("SnapshotAck");
+	case ENetPacketType::ClockPing:		return TEXT("ClockPing");
+	case ENetPacketType::Snapshot:		return TEXT("Snapshot");
+	case ENetPacketType::ClockPong:		return TEXT("ClockPong");
+	default:							return TEXT("Unknown");
+	}
+}
+
+const TCHAR* FNetTrafficStats::GetFieldGroupName(ENetFieldGroup Group)
+{
+	switch (Group)
+	{
+	case ENetFieldGroup::Header:	return TEXT("Header");
+	case ENetFieldGroup::Position:	return TEXT("Position");
+	case ENetFieldGroup::Velocity:	return TEXT("Velocity");
+	case ENetFieldGroup::State:		return TEXT("State");
+	case ENetFieldGroup::Stamina:	return TEXT("Stamina");
+	case ENetFieldGroup::Input:		return TEXT("Input");
+	case ENetFieldGroup::Checksum:	return TEXT("Checksum");
+	default:						return TEXT("Unknown");
+	}
+}
+
+int64 FNetTrafficStats::GetRawSnapshotBytes(int32 NumEntities)
+{
+	// Snapshot id, baseline id, acked sequence, timestamp, possessing entity, entity count, checksum
+	const int64 HeaderBytes = sizeof(uint32) * 5 + sizeof(float) + sizeof(uint32);
+	const int64 EntityBytes = sizeof(uint32) + sizeof(FVector) * 2 + sizeof(uint8) + sizeof(float);
+	return HeaderBytes + EntityBytes * NumEntities;
+}
+
+int64 FNetTrafficStats::GetRawInputBytes(int32 NumInputs)
+{
+	// Sequence, timestamp, two sticks, action flags, checksum
+	const int64 InputBytes = sizeof(uint32) + sizeof(float) + sizeof(FVector2D) * 2 + sizeof(uint32) + sizeof(uint32);
+	return sizeof(uint32) + InputBytes * NumInputs;
+}
+
+double FNetTrafficStats::GetPercentile(const TArray<double>& Sorted, double Fraction)
+{
+	return Sorted.Num() > 0 ? Sorted[FMath::Min(Sorted.Num() - 1, FMath::FloorToInt(Sorted.Num() * Fraction))] : 0.0;
+}
@@ -0,0 +1,217 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+class FBitWriter;
+class FBitReader;
+
+DECLARE_STATS_GROUP(TEXT("PocketStriker Network"), STATGROUP_PocketStrikerNet, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Snapshot Encode"), STAT_NetSnapshotEncode, STATGROUP_PocketStrikerNet, POCKETSTRIKER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Snapshot Decode"), STAT_NetSnapshotDecode, STATGROUP_PocketStrikerNet, POCKETSTRIKER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Input Pack"), STAT_NetInputPack, STATGROUP_PocketStrikerNet, POCKETSTRIKER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Input Unpack"), STAT_NetInputUnpack, STATGROUP_PocketStrikerNet, POCKETSTRIKER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Packet Verify"), STAT_NetPacketVerify, STATGROUP_PocketStrikerNet, POCKETSTRIKER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Lag Compensation"), STAT_NetLagCompensation, STATGROUP_PocketStrikerNet, POCKETSTRIKER_API);
+
+// Insights channel for packet serialization scopes and byte counters (-trace=cpu,NetTraffic)
+UE_TRACE_CHANNEL_EXTERN(NetTrafficChannel, POCKETSTRIKER_API);
+
+// Every packet the game sends, in the controller's conditioned RPC order
+enum class ENetPacketType : uint8
+{
+	Inputs,
+	SnapshotAck,
+	ClockPing,
+	Snapshot,
+	ClockPong,
+	Count
+};
+
+// What the bits of a packet were spent on
+enum class ENetFieldGroup : uint8
+{
+	Header,		// Ids, sequences, timestamps, counts and delta field masks
+	Position,
+	Velocity,
+	State,
+	Stamina,
+	Input,		// Stick axes and action flags
+	Checksum,
+	Count
+};
+
+enum class ENetTrafficDirection : uint8
+{
+	Sent,
+	Received,
+	Count
+};
+
+/**
+ * Bits one packet spent per field group
+ */
+struct POCKETSTRIKER_API FNetFieldBits
+{
+	int64 Bits[static_cast<int32>(ENetFieldGroup::Count)] = {};
+
+	// Full encoding of the delta-coded entities minus what their deltas cost; negative when a delta lost
+	// Only the encoder holds the full encodings, so received packets leave this at zero
+	int64 DeltaSavedBits = 0;
+
+	int64& operator[](ENetFieldGroup Group) { return Bits[static_cast<int32>(Group)]; }
+	int64 operator[](ENetFieldGroup Group) const { return Bits[static_cast<int32>(Group)]; }
+
+	int64 GetTotal() const;
+	void Add(const FNetFieldBits& Other);
+};
+
+/**
+ * Charges a bit stream's growth to field groups while a packet is written or read
+ * Each Mark attributes everything serialized since the previous mark, so a skipped field costs nothing
+ */
+class POCKETSTRIKER_API FNetFieldBitCounter
+{
+public:
+	// Counting starts at the stream's current position
+	FNetFieldBitCounter(const FBitWriter& InWriter, FNetFieldBits& InBits);
+	FNetFieldBitCounter(const FBitReader& InReader, FNetFieldBits& InBits);
+
+	void Mark(ENetFieldGroup Group);
+
+	// Adds bits written in one go (a cached encoding) and moves the mark past them
+	void Add(const FNetFieldBits& Other);
+
+	void AddDeltaSaved(int64 InBits) { Bits.DeltaSavedBits += InBits; }
+
+	int64 GetPosition() const;
+
+private:
+	const FBitWriter* Writer = nullptr;
+	const FBitReader* Reader = nullptr;
+	FNetFieldBits& Bits;
+	int64 LastMark = 0;
+};
+
+/**
+ * One packet as measured where it was serialized or deserialized
+ */
+struct POCKETSTRIKER_API FNetPacketSample
+{
+	ENetPacketType Type = ENetPacketType::Inputs;
+	int32 Bytes = 0;
+	FNetFieldBits FieldBits;
+
+	// In-memory size of the values carried, before quantization and delta encoding
+	int64 RawBytes = 0;
+
+	// Time spent serializing or deserializing, in FPlatformTime cycles
+	uint64 Cycles = 0;
+
+	// A packet with no field-level encoding: raw values copied as they are
+	static FNetPacketSample MakeUnencoded(ENetPacketType Type, int32 Bytes);
+};
+
+/**
+ * Running totals for one packet type in one direction
+ */
+struct POCKETSTRIKER_API FNetPacketTypeStats
+{
+	int64 Packets = 0;
+	int64 Bytes = 0;
+	int64 RawBytes = 0;
+	FNetFieldBits FieldBits;
+	double SerializeSeconds = 0.0;
+
+	// What the packets would have cost with every entity sent in full
+	double GetFullBytes() const { return Bytes + FieldBits.DeltaSavedBits / 8.0; }
+
+	// Raw values against the full encoding: what quantization and bit packing buy (sent packets only)
+	double GetQuantizationRatio() const { return GetFullBytes() > 0.0 ? RawBytes / GetFullBytes() : 0.0; }
+
+	// Full encoding against what went out: what delta encoding buys (sent packets only)
+	double GetDeltaRatio() const { return Bytes > 0 ? GetFullBytes() / Bytes : 0.0; }
+
+	double GetCompressionRatio() const { return Bytes > 0 ? static_cast<double>(RawBytes) / Bytes : 0.0; }
+};
+
+/**
+ * Recent traffic for one packet type in one direction
+ */
+struct FNetRollingTrafficStats
+{
+	double BytesPerSecond = 0.0;
+	double PacketsPerSecond = 0.0;
+
+	// Packet size and serialization time over the last RollingSamples packets
+	double SizeP50 = 0.0;
+	double SizeP99 = 0.0;
+	double SerializeP50Us = 0.0;
+	double SerializeP99Us = 0.0;
+};
+
+/**
+ * Bytes, field groups, serialization cost and compression per packet type for one connection
+ * Totals cover the connection's lifetime; rolling figures cover the last second (rates) or the last
+ * RollingSamples packets (percentiles). Recording also feeds the stat group and the trace channel
+ */
+class POCKETSTRIKER_API FNetTrafficStats
+{
+public:
+	FNetTrafficStats();
+
+	void Record(ENetTrafficDirection Direction, const FNetPacketSample& Sample, double Now);
+	void Reset();
+
+	const FNetPacketTypeStats& GetTotals(ENetTrafficDirection Direction, ENetPacketType Type) const
+	{
+		return Channels[static_cast<int32>(Direction)][static_cast<int32>(Type)].Totals;
+	}
+
+	FNetRollingTrafficStats GetRolling(ENetTrafficDirection Direction, ENetPacketType Type, double Now) const;
+
+	// Every packet type in one direction, bytes per second over the rate window
+	double GetBytesPerSecond(ENetTrafficDirection Direction, double Now) const;
+
+	// One line per packet type that carried traffic, and its split by field group where it has one
+	void Log(const FString& Label, double Now) const;
+
+	static const TCHAR* GetPacketTypeName(ENetPacketType Type);
+	static const TCHAR* GetFieldGroupName(ENetFieldGroup Group);
+
+	// Unquantized size of a snapshot: header plus id, position, velocity, state and stamina per entity
+	static int64 GetRawSnapshotBytes(int32 NumEntities);
+
+	// Unquantized size of a redundant input packet
+	static int64 GetRawInputBytes(int32 NumInputs);
+
+	// Nearest-rank percentile of ascending samples, zero when there are none; the load and replay reports use it too
+	static double GetPercentile(const TArray<double>& Sorted, double Fraction);
+
+	static constexpr int32 RollingSamples = 256;
+	static constexpr double RateWindowSeconds = 1.0;
+
+private:
+	struct FRollingEntry
+	{
+		double Time = 0.0;
+		int32 Bytes = 0;
+		float Micros = 0.0f;
+	};
+
+	struct FChannel
+	{
+		FNetPacketTypeStats Totals;
+
+		// Ring of the newest packets; Next is the oldest once full
+		TArray<FRollingEntry> Recent;
+		int32 Next = 0;
+	};
+
+	FChannel Channels[static_cast<int32>(ENetTrafficDirection::Count)][static_cast<int32>(ENetPacketType::Count)];
+};
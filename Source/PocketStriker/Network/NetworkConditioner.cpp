@@ -0,0 +1,158 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "NetworkConditioner.h"
+
+FNetworkConditioner::FNetworkConditioner()
+{
+	Reset();
+}
+
+void FNetworkConditioner::Configure(const FNetworkConditionerSettings& InSettings)
+{
+	Settings = InSettings;
+	if (Settings.Seed != ActiveSeed)
+	{
+		Reset();
+	}
+}
+
+void FNetworkConditioner::Reset()
+{
+	ActiveSeed = Settings.Seed;
+	Random.Initialize(ActiveSeed);
+	Queue.Reset();
+	NextOrder = 0;
+	bInLossBurst = false;
+	LinkBusyUntil = 0.0;
+	LastInOrderDelivery = 0.0;
+	Stats = FNetworkConditionerStats();
+}
+
+void FNetworkConditioner::Submit(uint8 Channel, const TArray<uint8>& Payload, double Now)
+{
+	Stats.PacketsSubmitted++;
+	Stats.BytesSubmitted += Payload.Num();
+
+	// The link serializes packets one after another; a full queue tail-drops
+	double SendTime = Now;
+	if (Settings.BandwidthKbps > 0.0f)
+	{
+		SendTime = FMath::Max(Now, LinkBusyUntil);
+		if (SendTime - Now > Settings.MaxQueueDelayMs * 0.001)
+		{
+			Stats.PacketsQueueDropped++;
+			return;
+		}
+
+		const double BitsPerSecond = Settings.BandwidthKbps * 1000.0;
+		SendTime += (Payload.Num() + PacketHeaderBytes) * 8.0 / BitsPerSecond;
+		LinkBusyUntil = SendTime;
+	}
+
+	if (SampleLoss())
+	{
+		Stats.PacketsLost++;
+		return;
+	}
+
+	double DeliveryTime = SendTime + SampleLatency();
+	if (Chance(Settings.ReorderPercentage))
+	{
+		// Held back past the packets sent after it; the in-order floor is left alone so they do overtake
+		DeliveryTime += Settings.ReorderDelayMs * 0.001;
+		Stats.PacketsReordered++;
+	}
+	else
+	{
+		DeliveryTime = FMath::Max(DeliveryTime, LastInOrderDelivery);
+		LastInOrderDelivery = DeliveryTime;
+	}
+	Enqueue(Channel, Payload, Now, DeliveryTime);
+
+	// The copy travels its own path, so it gets its own latency
+	if (Chance(Settings.DuplicatePercentage))
+	{
+		Stats.PacketsDuplicated++;
+		Enqueue(Channel, Payload, Now, SendTime + SampleLatency());
+	}
+}
+
+void FNetworkConditioner::Drain(double Now, TFunctionRef<void(uint8 Channel, const TArray<uint8>& Payload)> Deliver)
+{
+	while (Queue.Num() > 0 && Queue.HeapTop().DeliveryTime <= Now)
+	{
+		FQueuedPacket Packet;
+		Queue.HeapPop(Packet, FDeliveryOrder(), EAllowShrinking::No);
+
+		const double Delay = Packet.DeliveryTime - Packet.SubmitTime;
+		Stats.PacketsDelivered++;
+		Stats.TotalDelay += Delay;
+		Stats.MaxDelay = FMath::Max(Stats.MaxDelay, Delay);
+
+		Deliver(Packet.Channel, Packet.Payload);
+	}
+}
+
+double FNetworkConditioner::SampleLatency()
+{
+	const double Base = Settings.LatencyMs * 0.001;
+	const double Jitter = Settings.JitterMs * 0.001;
+	if (Jitter <= 0.0)
+	{
+		return Base;
+	}
+
+	double Offset = 0.0;
+	switch (Settings.JitterDistribution)
+	{
+	case ENetJitterDistribution::Uniform:
+		Offset = Jitter * (2.0 * Random.GetFraction() - 1.0);
+		break;
+
+	case ENetJitterDistribution::Normal:
+	{
+		// Box-Muller; the first draw is kept away from zero so the log stays finite
+		const double U1 = FMath::Max(static_cast<double>(Random.GetFraction()), 1e-7);
+		const double U2 = Random.GetFraction();
+		Offset = Jitter * FMath::Sqrt(-2.0 * FMath::Loge(U1)) * FMath::Cos(UE_DOUBLE_TWO_PI * U2);
+		break;
+	}
+
+	case ENetJitterDistribution::LongTail:
+	{
+		const double U = FMath::Max(static_cast<double>(Random.GetFraction()), 1e-7);
+		Offset = Jitter * (FMath::Pow(U, -1.0 / ParetoAlpha) - 1.0);
+		break;
+	}
+
+	default:
+		break;
+	}
+
+	return FMath::Max(0.0, Base + Offset);
+}
+
+bool FNetworkConditioner::SampleLoss()
+{
+	if (bInLossBurst)
+	{
+		bInLossBurst = !Chance(Settings.BurstEndPercentage);
+	}
+	else
+	{
+		bInLossBurst = Chance(Settings.BurstStartPercentage);
+	}
+
+	return Chance(bInLossBurst ? Settings.BurstLossPercentage : Settings.PacketLossPercentage);
+}
+
+void FNetworkConditioner::Enqueue(uint8 Channel, const TArray<uint8>& Payload, double SubmitTime, double DeliveryTime)
+{
+	FQueuedPacket Packet;
+	Packet.DeliveryTime = DeliveryTime;
+	Packet.SubmitTime = SubmitTime;
+	Packet.Order = NextOrder++;
+	Packet.Channel = Channel;
+	Packet.Payload = Payload;
+	Queue.HeapPush(MoveTemp(Packet), FDeliveryOrder());
+}
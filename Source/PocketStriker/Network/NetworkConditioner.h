@@ -0,0 +1,176 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/RandomStream.h"
+#include "NetworkConditioner.generated.h"
+
+/**
+ * Shape of the per-packet latency variation around the base latency
+ */
+UENUM(BlueprintType)
+enum class ENetJitterDistribution : uint8
+{
+	None,
+	Uniform,	// Evenly spread over +-Jitter
+	Normal,		// Jitter is the standard deviation
+	LongTail	// Pareto: mostly small, occasionally several times Jitter; only ever adds delay
+};
+
+/**
+ * Conditions applied to one direction of a connection
+ * All probabilities are per packet. Loss follows a Gilbert-Elliott model: a good state with PacketLossPercentage
+ * and a bad state with BurstLossPercentage, so losses cluster the way they do on congested links
+ */
+USTRUCT(BlueprintType)
+struct FNetworkConditionerSettings
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Conditioner", meta = (ToolTip = "One-way base latency in ms", ClampMin = "0"))
+	float LatencyMs = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Conditioner", meta = (ToolTip = "Latency variation scale in ms", ClampMin = "0"))
+	float JitterMs = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Conditioner", meta = (ToolTip = "How latency varies between packets"))
+	ENetJitterDistribution JitterDistribution = ENetJitterDistribution::Normal;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Conditioner", meta = (ToolTip = "Loss percentage outside bursts (0-100)", ClampMin = "0", ClampMax = "100"))
+	float PacketLossPercentage = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Conditioner", meta = (ToolTip = "Chance per packet (0-100) of entering a loss burst", ClampMin = "0", ClampMax = "100"))
+	float BurstStartPercentage = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Conditioner", meta = (ToolTip = "Chance per packet (0-100) of leaving a loss burst; mean burst length is 100 / this", ClampMin = "0", ClampMax = "100"))
+	float BurstEndPercentage = 25.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Conditioner", meta = (ToolTip = "Loss percentage inside a burst (0-100)", ClampMin = "0", ClampMax = "100"))
+	float BurstLossPercentage = 75.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Conditioner", meta = (ToolTip = "Chance (0-100) a packet is held back and overtaken by later ones", ClampMin = "0", ClampMax = "100"))
+	float ReorderPercentage = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Conditioner", meta = (ToolTip = "Extra delay in ms for a reordered packet", ClampMin = "0"))
+	float ReorderDelayMs = 30.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Conditioner", meta = (ToolTip = "Chance (0-100) a packet arrives twice", ClampMin = "0", ClampMax = "100"))
+	float DuplicatePercentage = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Conditioner", meta = (ToolTip = "Link capacity in kbit/s including 28 bytes of UDP/IP header per packet; 0 = unlimited", ClampMin = "0"))
+	float BandwidthKbps = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Conditioner", meta = (ToolTip = "Packets that would wait longer than this in ms for the link are dropped", ClampMin = "0"))
+	float MaxQueueDelayMs = 200.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Conditioner", meta = (ToolTip = "Random seed; the same seed and traffic give the same drops, delays and order"))
+	int32 Seed = 1;
+
+	// True when any condition would change delivery
+	bool IsActive() const
+	{
+		return LatencyMs > 0.0f || JitterMs > 0.0f || PacketLossPercentage > 0.0f || BurstStartPercentage > 0.0f
+			|| ReorderPercentage > 0.0f || DuplicatePercentage > 0.0f || BandwidthKbps > 0.0f;
+	}
+};
+
+/**
+ * Counters for one direction
+ */
+struct FNetworkConditionerStats
+{
+	int32 PacketsSubmitted = 0;
+	int32 PacketsDelivered = 0;
+	int32 PacketsLost = 0;
+	int32 PacketsQueueDropped = 0;
+	int32 PacketsReordered = 0;
+	int32 PacketsDuplicated = 0;
+	int64 BytesSubmitted = 0;
+
+	// Sum of delivered packets' submit-to-delivery delay, seconds
+	double TotalDelay = 0.0;
+	double MaxDelay = 0.0;
+
+	double GetAverageDelay() const { return PacketsDelivered > 0 ? TotalDelay / PacketsDelivered : 0.0; }
+};
+
+/**
+ * Packet-level conditioner for one direction of a connection
+ * Submitted payloads wait in a queue ordered by delivery time and come out of Drain once that time has passed.
+ * Every random decision is drawn from a seeded stream in submission order, so a run with the same seed and
+ * the same traffic reproduces exactly. Jitter alone never reorders; only ReorderPercentage does
+ */
+class POCKETSTRIKER_API FNetworkConditioner
+{
+public:
+	FNetworkConditioner();
+
+	// Takes new settings; the random stream restarts only when the seed changes
+	void Configure(const FNetworkConditionerSettings& InSettings);
+
+	// Drops everything queued and restarts the random stream from the seed
+	void Reset();
+
+	// Queues a payload sent at Now (seconds); Channel is handed back on delivery so one queue can carry several RPCs
+	void Submit(uint8 Channel, const TArray<uint8>& Payload, double Now);
+
+	// Delivers every payload due by Now, in delivery order
+	void Drain(double Now, TFunctionRef<void(uint8 Channel, const TArray<uint8>& Payload)> Deliver);
+
+	int32 GetNumQueued() const { return Queue.Num(); }
+	const FNetworkConditionerSettings& GetSettings() const { return Settings; }
+	const FNetworkConditionerStats& GetStats() const { return Stats; }
+
+	// Per-packet UDP/IP overhead counted against the bandwidth cap
+	static constexpr int32 PacketHeaderBytes = 28;
+
+	// Shape of the long-tail distribution; its mean is Jitter / (Alpha - 1)
+	static constexpr float ParetoAlpha = 3.0f;
+
+private:
+	struct FQueuedPacket
+	{
+		double DeliveryTime = 0.0;
+		double SubmitTime = 0.0;
+		uint64 Order = 0;
+		uint8 Channel = 0;
+		TArray<uint8> Payload;
+	};
+
+	struct FDeliveryOrder
+	{
+		bool operator()(const FQueuedPacket& A, const FQueuedPacket& B) const
+		{
+			return A.DeliveryTime != B.DeliveryTime ? A.DeliveryTime < B.DeliveryTime : A.Order < B.Order;
+		}
+	};
+
+	// Base latency plus one draw from the jitter distribution, seconds
+	double SampleLatency();
+
+	// Advances the Gilbert-Elliott chain and decides whether this packet is lost
+	bool SampleLoss();
+
+	bool Chance(float Percentage) { return Percentage > 0.0f && Random.GetFraction() * 100.0f < Percentage; }
+
+	void Enqueue(uint8 Channel, const TArray<uint8>& Payload, double SubmitTime, double DeliveryTime);
+
+	FNetworkConditionerSettings Settings;
+	FRandomStream Random;
+	int32 ActiveSeed = 0;
+
+	// Min-heap on (DeliveryTime, Order)
+	TArray<FQueuedPacket> Queue;
+	uint64 NextOrder = 0;
+
+	bool bInLossBurst = false;
+
+	// Time the link finishes sending what it has accepted
+	double LinkBusyUntil = 0.0;
+
+	// Latest in-order delivery time, so jitter cannot let a packet overtake an earlier one
+	double LastInOrderDelivery = 0.0;
+
+	FNetworkConditionerStats Stats;
+};
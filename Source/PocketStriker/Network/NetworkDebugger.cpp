@@ -6,83 +6,67 @@
 
 UNetworkDebugger::UNetworkDebugger()
 {
-	SimulatedInboundLatency = 0.0f;
-	SimulatedOutboundLatency = 0.0f;
-	PacketLossPercentage = 0.0f;
 	bEnableDebugDisplay = true;
 	bEnableLagSimulation = false;
 }
 
 void UNetworkDebugger::SetSimulatedLatency(float InboundMs, float OutboundMs)
 {
-	SimulatedInboundLatency = FMath::Max(0.0f, InboundMs);
-	SimulatedOutboundLatency = FMath::Max(0.0f, OutboundMs);
-	bEnableLagSimulation = (SimulatedInboundLatency > 0.0f || SimulatedOutboundLatency > 0.0f);
+	InboundConditions.LatencyMs = FMath::Max(0.0f, InboundMs);
+	OutboundConditions.LatencyMs = FMath::Max(0.0f, OutboundMs);
+	ApplyConditions();
 }
 
 void UNetworkDebugger::SetPacketLossPercentage(float Percentage)
 {
-	PacketLossPercentage = FMath::Clamp(Percentage, 0.0f, 100.0f);
-	bEnableLagSimulation = (PacketLossPercentage > 0.0f);
+	InboundConditions.PacketLossPercentage = FMath::Clamp(Percentage, 0.0f, 100.0f);
+	OutboundConditions.PacketLossPercentage = InboundConditions.PacketLossPercentage;
+	ApplyConditions();
 }
 
-void UNetworkDebugger::DelayPacket(const TArray<uint8>& PacketData, float DelayMs, bool bIsInput)
+void UNetworkDebugger::SetConditions(const FNetworkConditionerSettings& Settings)
 {
-	if (!bEnableLagSimulation || DelayMs <= 0.0f)
-	{
-		// No delay, process immediately
-		return;
-	}
-
-	FDelayedPacket DelayedPacket;
-	DelayedPacket.PacketData = PacketData;
-	DelayedPacket.ReleaseTime = FPlatformTime::Seconds() + (DelayMs / 1000.0f);
-	DelayedPacket.bIsInputPacket = bIsInput;
+	OutboundConditions = Settings;
+	InboundConditions = Settings;
+	InboundConditions.Seed = Settings.Seed + 1;
+	ApplyConditions();
+}
 
-	DelayedPackets.Add(DelayedPacket);
+void UNetworkDebugger::ApplyConditions()
+{
+	OutboundConditioner.Configure(OutboundConditions);
+	InboundConditioner.Configure(InboundConditions);
+	bEnableLagSimulation = OutboundConditions.IsActive() || InboundConditions.IsActive();
 }
 
-void UNetworkDebugger::ProcessDelayedPackets(float DeltaTime)
+void UNetworkDebugger::SubmitPacket(ENetConditionerDirection Direction, uint8 Channel, const TArray<uint8>& Payload, double Now)
 {
-	if (!bEnableLagSimulation)
-	{
-		return;
-	}
+	FNetworkConditioner& Conditioner = Direction == ENetConditionerDirection::Outbound ? OutboundConditioner : InboundConditioner;
+	const FNetworkConditionerStats& ConditionerStats = Conditioner.GetStats();
+	const int32 DroppedBefore = ConditionerStats.PacketsLost + ConditionerStats.PacketsQueueDropped;
 
-	float CurrentTime = FPlatformTime::Seconds();
+	Stats.TotalPacketsSent++;
+	Conditioner.Submit(Channel, Payload, Now);
 
-	// Process packets that are ready to be released
-	for (int32 i = DelayedPackets.Num() - 1; i >= 0; --i)
-	{
-		if (DelayedPackets[i].ReleaseTime <= CurrentTime)
-		{
-			// Packet is ready to be processed
-			// In a real implementation, this would deserialize and process the packet
-			// For now, we just remove it from the queue
-			
-			RecordPacketReceived();
-			DelayedPackets.RemoveAt(i);
-		}
-	}
+	const int32 DroppedAfter = ConditionerStats.PacketsLost + ConditionerStats.PacketsQueueDropped;
+	Stats.TotalPacketsDropped += DroppedAfter - DroppedBefore;
+	UpdatePacketLossPercentage();
 }
 
-bool UNetworkDebugger::ShouldDropPacket()
+void UNetworkDebugger::ProcessDelayedPackets(double Now, TFunctionRef<void(ENetConditionerDirection Direction, uint8 Channel, const TArray<uint8>& Payload)> Deliver)
 {
-	if (!bEnableLagSimulation || PacketLossPercentage <= 0.0f)
+	// Inbound first, so a snapshot due this frame is applied before this frame's inputs go out
+	InboundConditioner.Drain(Now, [this, &Deliver](uint8 Channel, const TArray<uint8>& Payload)
 	{
-		return false;
-	}
-
-	// Random chance based on packet loss percentage
-	float RandomValue = FMath::FRand() * 100.0f;
-	bool bDrop = RandomValue < PacketLossPercentage;
+		RecordPacketReceived();
+		Deliver(ENetConditionerDirection::Inbound, Channel, Payload);
+	});
 
-	if (bDrop)
+	OutboundConditioner.Drain(Now, [this, &Deliver](uint8 Channel, const TArray<uint8>& Payload)
 	{
-		RecordPacketDropped();
-	}
-
-	return bDrop;
+		RecordPacketReceived();
+		Deliver(ENetConditionerDirection::Outbound, Channel, Payload);
+	});
 }
 
 void UNetworkDebugger::RecordPacketSent()
@@ -131,10 +115,9 @@ void UNetworkDebugger::UpdateRTT(float RTT)
 
 void UNetworkDebugger::UpdatePacketLossPercentage()
 {
-	int32 TotalPackets = Stats.TotalPacketsSent + Stats.TotalPacketsReceived;
-	if (TotalPackets > 0)
+	if (Stats.TotalPacketsSent > 0)
 	{
-		Stats.PacketLoss = (float)Stats.TotalPacketsDropped / (float)TotalPackets * 100.0f;
+		Stats.PacketLoss = (float)Stats.TotalPacketsDropped / (float)Stats.TotalPacketsSent * 100.0f;
 	}
 }
 
@@ -168,8 +151,9 @@ void UNetworkDebugger::DrawNetworkStats(UCanvas* Canvas, float X, float Y)
 	FString RTTText = FString::Printf(TEXT("RTT: %s"), *FormatLatency(Stats.AverageRTT));
 	if (bEnableLagSimulation)
 	{
-		float SimulatedRTT = SimulatedInboundLatency + SimulatedOutboundLatency;
-		RTTText += FString::Printf(TEXT(" (Simulated: %s)"), *FormatLatency(SimulatedRTT));
+		float SimulatedRTT = InboundConditions.LatencyMs + OutboundConditions.LatencyMs;
+		RTTText += FString::Printf(TEXT(" (Simulated: %s +- %s)"), *FormatLatency(SimulatedRTT),
+			*FormatLatency(InboundConditions.JitterMs + OutboundConditions.JitterMs));
 	}
 	TextItem.Text = FText::FromString(RTTText);
 	Canvas->DrawItem(TextItem, X, CurrentY);
@@ -177,14 +161,27 @@ void UNetworkDebugger::DrawNetworkStats(UCanvas* Canvas, float X, float Y)
 
 	// Packet Loss
 	FString PacketLossText = FString::Printf(TEXT("Packet Loss: %.2f%%"), Stats.PacketLoss);
-	if (bEnableLagSimulation && PacketLossPercentage > 0.0f)
+	if (bEnableLagSimulation && (OutboundConditions.PacketLossPercentage > 0.0f || OutboundConditions.BurstStartPercentage > 0.0f))
 	{
-		PacketLossText += FString::Printf(TEXT(" (Simulated: %.1f%%)"), PacketLossPercentage);
+		PacketLossText += FString::Printf(TEXT(" (Simulated: %.1f%%, bursts %.1f%%)"),
+			OutboundConditions.PacketLossPercentage, OutboundConditions.BurstStartPercentage);
 	}
 	TextItem.Text = FText::FromString(PacketLossText);
 	Canvas->DrawItem(TextItem, X, CurrentY);
 	CurrentY += LineHeight;
 
+	// Conditioner queues
+	if (bEnableLagSimulation)
+	{
+		const FNetworkConditionerStats& Out = OutboundConditioner.GetStats();
+		const FNetworkConditionerStats& In = InboundConditioner.GetStats();
+		TextItem.Text = FText::FromString(FString::Printf(TEXT("Reordered=%d Duplicated=%d QueueDropped=%d Queued=%d"),
+			Out.PacketsReordered + In.PacketsReordered, Out.PacketsDuplicated + In.PacketsDuplicated,
+			Out.PacketsQueueDropped + In.PacketsQueueDropped, OutboundConditioner.GetNumQueued() + InboundConditioner.GetNumQueued()));
+		Canvas->DrawItem(TextItem, X, CurrentY);
+		CurrentY += LineHeight;
+	}
+
 	// Packets
 	FString PacketsText = FString::Printf(TEXT("Packets: Sent=%d Recv=%d Dropped=%d"), 
 		Stats.TotalPacketsSent, Stats.TotalPacketsReceived, Stats.TotalPacketsDropped);
@@ -5,32 +5,17 @@
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
 #include "NetworkTypes.h"
+#include "NetworkConditioner.h"
+#include "NetTrafficStats.h"
 #include "NetworkDebugger.generated.h"
 
 class UCanvas;
 
-/**
- * Delayed packet structure for lag simulation
- */
-USTRUCT()
-struct FDelayedPacket
+// Direction of a conditioned packet, seen from the owning client
+enum class ENetConditionerDirection : uint8
 {
-	GENERATED_BODY()
-
-	UPROPERTY()
-	TArray<uint8> PacketData;
-
-	UPROPERTY()
-	float ReleaseTime = 0.0f;
-
-	UPROPERTY()
-	bool bIsInputPacket = false;
-
-	FDelayedPacket()
-		: ReleaseTime(0.0f)
-		, bIsInputPacket(false)
-	{
-	}
+	Outbound,
+	Inbound
 };
 
 /**
@@ -93,12 +78,20 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Network Debug")
 	void SetPacketLossPercentage(float Percentage);
 
-	// Packet delay
-	void DelayPacket(const TArray<uint8>& PacketData, float DelayMs, bool bIsInput);
-	void ProcessDelayedPackets(float DeltaTime);
+	// Same conditions both ways; the inbound direction draws from its own seed so the two are independent
+	void SetConditions(const FNetworkConditionerSettings& Settings);
+
+	// True when packets should go through SubmitPacket instead of straight to their RPC
+	bool IsConditioning() const { return bEnableLagSimulation; }
+
+	// Packet delay, loss, reordering and duplication; Channel identifies the RPC on delivery
+	void SubmitPacket(ENetConditionerDirection Direction, uint8 Channel, const TArray<uint8>& Payload, double Now);
+	void ProcessDelayedPackets(double Now, TFunctionRef<void(ENetConditionerDirection Direction, uint8 Channel, const TArray<uint8>& Payload)> Deliver);
 
-	// Packet loss
-	bool ShouldDropPacket();
+	const FNetworkConditioner& GetConditioner(ENetConditionerDirection Direction) const
+	{
+		return Direction == ENetConditionerDirection::Outbound ? OutboundConditioner : InboundConditioner;
+	}
 
 	// Statistics
 	void RecordPacketSent();
@@ -110,39 +103,45 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Network Debug")
 	FNetworkStats GetNetworkStats() const { return Stats; }
 
+	// Bytes, field groups and serialization cost per packet type for this client's connection
+	void RecordTraffic(ENetTrafficDirection Direction, const FNetPacketSample& Sample, double Now) { TrafficStats.Record(Direction, Sample, Now); }
+	const FNetTrafficStats& GetTrafficStats() const { return TrafficStats; }
+	void ResetTrafficStats() { TrafficStats.Reset(); }
+
 	// Visualization
 	void DrawNetworkStats(UCanvas* Canvas, float X, float Y);
 
 	// Configuration
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network Debug")
-	float SimulatedInboundLatency = 0.0f; // In milliseconds
+	FNetworkConditionerSettings OutboundConditions;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network Debug")
-	float SimulatedOutboundLatency = 0.0f; // In milliseconds
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network Debug")
-	float PacketLossPercentage = 0.0f; // 0-100
+	FNetworkConditionerSettings InboundConditions;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network Debug")
 	bool bEnableDebugDisplay = true;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network Debug")
+	// Set while either direction has active conditions
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Network Debug")
 	bool bEnableLagSimulation = false;
 
 private:
-	// Delayed packet queue
-	UPROPERTY()
-	TArray<FDelayedPacket> DelayedPackets;
+	// Client-to-server and server-to-client queues
+	FNetworkConditioner OutboundConditioner;
+	FNetworkConditioner InboundConditioner;
 
 	// Statistics
 	UPROPERTY()
 	FNetworkStats Stats;
 
+	FNetTrafficStats TrafficStats;
+
 	// RTT tracking
 	TArray<float> RTTSamples;
 	static constexpr int32 MaxRTTSamples = 60;
 
 	// Helper functions
+	void ApplyConditions();
 	void UpdatePacketLossPercentage();
 	FString FormatLatency(float Ms) const;
 };
@@ -4,14 +4,47 @@
 #include "../Gameplay/PocketStrikerPlayerController.h"
 #include "../Gameplay/PlayerMovementComponent.h"
 #include "../Gameplay/PlayerStateMachine.h"
+#include "../Gameplay/PocketStrikerCharacter.h"
+#include "../Gameplay/Ball.h"
+#include "../Gameplay/ActionSystem.h"
+#include "../Gameplay/PlayerTuningData.h"
+#include "NetworkParamsData.h"
 #include "GameFramework/Character.h"
+#include "GameFramework/PlayerState.h"
 #include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Serialization/BitWriter.h"
+#include "Async/ParallelFor.h"
+#include "Misc/Paths.h"
+#include "NetworkDebugger.h"
+#include "HAL/IConsoleManager.h"
 
 ANetworkGameState::ANetworkGameState()
 {
 	PrimaryActorTick.bCanEverTick = true;
 	TimeSinceLastUpdate = 0.0f;
 	UpdateInterval = 1.0f / StateUpdateRate;
+	NetworkParams = nullptr;
+	SendRateWindowTime = 0.0f;
+}
+
+namespace
+{
+	// Upper edges of the send-rate histogram buckets in Hz; the last bucket is open ended
+	constexpr int32 NumSendRateEdges = 5;
+	const float SendRateBucketEdges[NumSendRateEdges] = { 5.0f, 10.0f, 20.0f, 30.0f, 45.0f };
+}
+
+const UNetworkParamsData* ANetworkGameState::GetNetworkParams() const
+{
+	return NetworkParams ? NetworkParams : GetDefault<UNetworkParamsData>();
+}
+
+float ANetworkGameState::GetEntitySendRate(APocketStrikerPlayerController* Controller, uint32 EntityId) const
+{
+	const FClientSnapshotChannel* Channel = ClientSnapshotChannels.Find(Controller);
+	const FEntitySendPriority* Priority = Channel ? Channel->EntityPriorities.Find(EntityId) : nullptr;
+	return Priority ? Priority->SendRate : 0.0f;
 }
 
 void ANetworkGameState::BeginPlay()
@@ -19,6 +52,56 @@ void ANetworkGameState::BeginPlay()
 	Super::BeginPlay();
 	
 	UpdateInterval = 1.0f / StateUpdateRate;
+
+	const UNetworkParamsData* Params = GetNetworkParams();
+	MatchTick.Init(*Params, Params->ServerTickRate);
+
+	if (HasAuthority())
+	{
+		// Characters that began play before this actor still have replicated movement on; snapshots replace it
+		for (TActorIterator<APocketStrikerCharacter> It(GetWorld()); It; ++It)
+		{
+			It->SetReplicateMovement(false);
+		}
+	}
+
+	if (HasAuthority() && Params->bRecordMatches)
+	{
+		StartMatchRecording();
+	}
+}
+
+void ANetworkGameState::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	StopMatchRecording();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+bool ANetworkGameState::StartMatchRecording(const FString& Filename)
+{
+	if (!HasAuthority())
+	{
+		return false;
+	}
+
+	const FString Path = Filename.IsEmpty()
+		? FPaths::ProjectSavedDir() / TEXT("Recordings") / FString::Printf(TEXT("Match-%s.psrec"), *FDateTime::UtcNow().ToString())
+		: Filename;
+
+	if (!MatchTick.StartRecording(Path))
+	{
+		return false;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("NetworkGameState: Recording match to %s"), *Path);
+	return true;
+}
+
+void ANetworkGameState::StopMatchRecording()
+{
+	// Closing writes the end record
+	MatchTick.StopRecording();
 }
 
 void ANetworkGameState::Tick(float DeltaTime)
@@ -31,6 +114,30 @@ void ANetworkGameState::Tick(float DeltaTime)
 		return;
 	}
 
+	// Packets from this frame's RPCs, so they are queued before the simulation consumes inputs
+	ProcessPendingInputPackets();
+
+	// Players who left stop being simulated; their lag-compensation columns free up once out of the window
+	for (auto It = EntityControllers.CreateIterator(); It; ++It)
+	{
+		if (!It.Value().IsValid())
+		{
+			MatchTick.RemoveClient(It.Key());
+			It.RemoveCurrent();
+		}
+	}
+
+	// Simulate queued client inputs at the fixed server rate, however they arrived
+	const float SimulationInterval = MatchTick.GetTickInterval();
+	SimulationAccumulator += DeltaTime;
+	for (int32 Step = 0; Step < MaxSimulationStepsPerFrame && SimulationAccumulator >= SimulationInterval; ++Step)
+	{
+		SimulationAccumulator -= SimulationInterval;
+		MatchTick.Step(*this, GetWorld()->GetTimeSeconds() - SimulationAccumulator);
+	}
+	SimulationAccumulator = FMath::Min(SimulationAccumulator, SimulationInterval);
+	CopyMatchTickStats();
+
 	// Accumulate time
 	TimeSinceLastUpdate += DeltaTime;
 
@@ -44,16 +151,12 @@ void ANetworkGameState::Tick(float DeltaTime)
 
 bool ANetworkGameState::ValidateInput(const FInputPacket& Input) const
 {
-	if (!bEnableInputValidation)
-	{
-		return true;
-	}
+	return !bEnableInputValidation || IsInputPacketValid(Input);
+}
 
-	// Validate packet integrity
-	if (!Input.IsValid())
-	{
-		return false;
-	}
+bool ANetworkGameState::IsInputPacketValid(const FInputPacket& Input)
+{
+	// Packet integrity was checked once per packet (FNetPacketChecksum) before any input was unpacked
 
 	// Validate input ranges
 	if (FMath::Abs(Input.MovementInput.X) > 1.0f || FMath::Abs(Input.MovementInput.Y) > 1.0f)
@@ -77,50 +180,119 @@ bool ANetworkGameState::ValidateInput(const FInputPacket& Input) const
 	return true;
 }
 
-void ANetworkGameState::ProcessClientInput(APocketStrikerPlayerController* Controller, const FInputPacket& Input)
+void ANetworkGameState::QueueClientInputPacket(APocketStrikerPlayerController* Controller, const TArray<uint8>& InputData)
 {
 	if (!Controller || !HasAuthority())
 	{
 		return;
 	}
 
-	// Validate input
-	if (!ValidateInput(Input))
+	FPendingInputPacket& Pending = PendingInputPackets.AddDefaulted_GetRef();
+	Pending.Controller = Controller;
+	Pending.Data = InputData;
+}
+
+void ANetworkGameState::ProcessPendingInputPackets()
+{
+	if (PendingInputPackets.Num() == 0)
 	{
-		InvalidInputsRejected++;
 		return;
 	}
 
-	TotalInputsProcessed++;
+	TArray<TArrayView<const uint8>, TInlineAllocator<64>> PacketViews;
+	PacketViews.Reserve(PendingInputPackets.Num());
+	for (const FPendingInputPacket& Pending : PendingInputPackets)
+	{
+		PacketViews.Add(Pending.Data);
+	}
+
+	TArray<bool, TInlineAllocator<64>> Intact;
+	Intact.SetNumUninitialized(PendingInputPackets.Num());
+	const uint64 VerifyStartCycles = FPlatformTime::Cycles64();
+	MatchTick.VerifyInputPackets(PacketViews, Intact);
+	const uint64 VerifyCycles = (FPlatformTime::Cycles64() - VerifyStartCycles) / PendingInputPackets.Num();
 
-	// Get the controlled character
-	ACharacter* Character = Controller->GetCharacter();
-	if (!Character)
+	const FNetQuantizationSettings& Settings = GetNetworkParams()->Quantization;
+	TArray<FInputPacket> Packets;
+	for (int32 PacketIndex = 0; PacketIndex < PendingInputPackets.Num(); ++PacketIndex)
 	{
-		return;
+		const FPendingInputPacket& Pending = PendingInputPackets[PacketIndex];
+		APocketStrikerPlayerController* Controller = Pending.Controller.Get();
+		if (!Controller)
+		{
+			continue;
+		}
+
+		// Each packet is charged its share of the batch check
+		FNetPacketSample Sample;
+		Sample.Type = ENetPacketType::Inputs;
+		Sample.Bytes = Pending.Data.Num();
+		Packets.Reset();
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		if (Intact[PacketIndex])
+		{
+			APocketStrikerPlayerController::UnpackVerifiedInputs(Pending.Data, Settings, Packets, &Sample.FieldBits);
+		}
+		Sample.Cycles = FPlatformTime::Cycles64() - StartCycles + VerifyCycles;
+		Sample.RawBytes = FNetTrafficStats::GetRawInputBytes(Packets.Num());
+		RecordClientTraffic(Controller, ENetTrafficDirection::Received, Sample);
+
+		for (const FInputPacket& Packet : Packets)
+		{
+			ProcessClientInput(Controller, Packet);
+		}
 	}
 
-	// Get movement component
-	UPlayerMovementComponent* MovementComp = Character->FindComponentByClass<UPlayerMovementComponent>();
-	if (!MovementComp)
+	PendingInputPackets.Reset();
+	CopyMatchTickStats();
+}
+
+void ANetworkGameState::ProcessClientInput(APocketStrikerPlayerController* Controller, const FInputPacket& Input)
+{
+	// Players are simulated, recorded and rewound by entity id, which needs the player state
+	if (!Controller || !HasAuthority() || !Controller->PlayerState)
 	{
 		return;
 	}
 
-	// Convert to FInputCommand for simulation
-	FInputCommand Command;
-	Command.SequenceNumber = Input.SequenceNumber;
-	Command.ClientTimestamp = Input.ClientTimestamp;
-	Command.MovementInput = Input.MovementInput;
-	Command.LookInput = Input.LookInput;
-	Command.ActionFlags = Input.ActionFlags;
+	const uint32 EntityId = FWorldSnapshot::MakePlayerEntityId(Controller->PlayerState->GetPlayerId());
+	EntityControllers.Add(EntityId, Controller);
+	MatchTick.bValidateInputs = bEnableInputValidation;
+	MatchTick.QueueInput(EntityId, Input);
+}
+
+APocketStrikerPlayerController* ANetworkGameState::FindEntityController(uint32 EntityId) const
+{
+	const TWeakObjectPtr<APocketStrikerPlayerController>* Controller = EntityControllers.Find(EntityId);
+	return Controller ? Controller->Get() : nullptr;
+}
+
+bool ANetworkGameState::SimulateInput(uint32 EntityId, const FInputCommand& Command, float DeltaTime)
+{
+	APocketStrikerPlayerController* Controller = FindEntityController(EntityId);
+	ACharacter* Character = Controller ? Controller->GetCharacter() : nullptr;
+	UPlayerMovementComponent* MovementComp = Character ? Character->FindComponentByClass<UPlayerMovementComponent>() : nullptr;
+	if (!MovementComp)
+	{
+		return false;
+	}
 
 	// Simulate movement on server using same logic as client
-	float DeltaTime = UpdateInterval; // Use fixed timestep
 	MovementComp->SimulateMovement(Command, DeltaTime);
+	return true;
+}
 
-	// Update acknowledged sequence for this client
-	ClientAcknowledgedSequences.Add(Controller, Input.SequenceNumber);
+void ANetworkGameState::CopyMatchTickStats()
+{
+	const FServerMatchTickStats& Stats = MatchTick.GetStats();
+	TotalInputsProcessed = Stats.TotalInputsProcessed;
+	InvalidInputsRejected = Stats.InvalidInputsRejected;
+	DuplicateInputsDropped = Stats.DuplicateInputsDropped;
+	CorruptInputPacketsDropped = Stats.CorruptInputPacketsDropped;
+	InputBufferUnderflows = Stats.InputBufferUnderflows;
+	InputBufferOverflows = Stats.InputBufferOverflows;
+	InputsReplaced = Stats.InputsReplaced;
+	MaxInputBufferDepth = Stats.MaxInputBufferDepth;
 }
 
 void ANetworkGameState::BroadcastStateUpdates()
@@ -137,7 +309,16 @@ void ANetworkGameState::BroadcastStateUpdates()
 		return;
 	}
 
-	// Iterate through all player controllers
+	PruneDepartedClients();
+
+	// Gather and encode the world once; every client's packet is assembled from the shared encodings
+	const UNetworkParamsData* Params = GetNetworkParams();
+	FWorldSnapshot WorldSnapshot;
+	GatherWorldSnapshot(WorldSnapshot);
+	FWorldSnapshotEncodeCache SharedEncodings(WorldSnapshot, Params->Quantization);
+
+	// Copy what each client's packet depends on out of the actors
+	int32 NumJobs = 0;
 	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
 	{
 		APocketStrikerPlayerController* PC = Cast<APocketStrikerPlayerController>(It->Get());
@@ -146,54 +327,451 @@ void ANetworkGameState::BroadcastStateUpdates()
 			continue;
 		}
 
-		// Get acknowledged sequence for this client
-		uint32* AckedSeq = ClientAcknowledgedSequences.Find(PC);
-		uint32 AcknowledgedSequence = AckedSeq ? *AckedSeq : 0;
+		if (SnapshotJobs.Num() <= NumJobs)
+		{
+			SnapshotJobs.AddDefaulted();
+		}
+		FClientSnapshotJob& Job = SnapshotJobs[NumJobs++];
+		Job.Controller = PC;
+		ClientSnapshotChannels.FindOrAdd(PC);
+
+		Job.OwnEntityId = PC->PlayerState ? FWorldSnapshot::MakePlayerEntityId(PC->PlayerState->GetPlayerId()) : FWorldSnapshot::InvalidEntityId;
+		Job.AcknowledgedSequence = MatchTick.GetAcknowledgedSequence(Job.OwnEntityId);
+		const APawn* ReceiverPawn = PC->GetPawn();
+		Job.bHasReceiverLocation = ReceiverPawn != nullptr;
+		Job.ReceiverLocation = ReceiverPawn ? ReceiverPawn->GetActorLocation() : FVector::ZeroVector;
+	}
+
+	// Adding a channel can grow the map, so the jobs point into it only once every channel exists;
+	// nothing adds to it again until the workers are done
+	for (int32 JobIndex = 0; JobIndex < NumJobs; ++JobIndex)
+	{
+		SnapshotJobs[JobIndex].Channel = ClientSnapshotChannels.Find(SnapshotJobs[JobIndex].Controller);
+	}
+
+	// Relevancy, delta encoding and serialization per client, fanned out across the task graph
+	EncodeClientSnapshots(MakeArrayView(SnapshotJobs.GetData(), NumJobs), WorldSnapshot, SharedEncodings, *Params,
+		UpdateInterval, bParallelSnapshotEncoding);
 
-		// Create state update packet
-		FStateUpdatePacket StateUpdate = CreateStateUpdate(PC, AcknowledgedSequence);
+	// RPCs go out from the game thread
+	for (int32 JobIndex = 0; JobIndex < NumJobs; ++JobIndex)
+	{
+		FClientSnapshotJob& Job = SnapshotJobs[JobIndex];
+		if (Job.bDelta)
+		{
+			DeltaSnapshotsSent++;
+		}
+		else
+		{
+			FullSnapshotsSent++;
+		}
+		EntitiesDeferred += Job.EntitiesDeferred;
+		RecordClientTraffic(Job.Controller, ENetTrafficDirection::Sent, Job.MakeSample());
 
-		// Send to client (in a real implementation, this would use RPC or replication)
-		// For now, we'll call a method on the controller directly
-		// TODO: Implement proper network replication or RPC
-		
-		// This is a placeholder - in production, you'd use:
-		// PC->ClientReceiveStateUpdate(StateUpdate);
+		Job.Controller->ClientReceiveSnapshot(Job.Packet);
+		Job.Controller = nullptr;
+		Job.Channel = nullptr;
 	}
+
+	UpdateSendRateHistogram();
 }
 
-FStateUpdatePacket ANetworkGameState::CreateStateUpdate(APocketStrikerPlayerController* Controller, uint32 AckedSequence) const
+void ANetworkGameState::EncodeClientSnapshots(TArrayView<FClientSnapshotJob> Jobs, const FWorldSnapshot& World,
+	const FWorldSnapshotEncodeCache& SharedEncodings, const UNetworkParamsData& Params, float UpdateInterval, bool bParallel)
 {
-	FStateUpdatePacket Packet;
-	Packet.AcknowledgedSequence = AckedSequence;
-	
-	if (UWorld* World = GetWorld())
+	ParallelFor(Jobs.Num(), [&Jobs, &World, &SharedEncodings, &Params, UpdateInterval](int32 JobIndex)
+	{
+		FClientSnapshotJob& Job = Jobs[JobIndex];
+		SelectSnapshotEntities(Job, World, SharedEncodings, Params, UpdateInterval);
+
+		SCOPE_CYCLE_COUNTER(STAT_NetSnapshotEncode);
+		TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(SnapshotEncode, NetTrafficChannel);
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+
+		// One packet per client per tick, delta encoded against the newest snapshot it acknowledged
+		FBitWriter Writer(0, true);
+		Job.FieldBits = FNetFieldBits();
+		Job.bDelta = FWorldSnapshotCodec::Encode(Writer, *Job.Channel, World, SharedEncodings, Job.EntityIndices,
+			Job.AcknowledgedSequence, Params.MaxBaselineAge, Params.Quantization, &Job.FieldBits);
+		Job.Packet.Reset();
+		Job.Packet.Append(Writer.GetData(), Writer.GetNumBytes());
+		Job.EncodeCycles = FPlatformTime::Cycles64() - StartCycles;
+	}, bParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+}
+
+void ANetworkGameState::SelectSnapshotEntities(FClientSnapshotJob& Job, const FWorldSnapshot& World,
+	const FWorldSnapshotEncodeCache& SharedEncodings, const UNetworkParamsData& Params, float UpdateInterval)
+{
+	FClientSnapshotChannel& Channel = *Job.Channel;
+	TArray<int32>& OutEntityIndices = Job.EntityIndices;
+	OutEntityIndices.Reset();
+	Job.EntitiesDeferred = 0;
+
+	// Forget entities that left the match
+	for (auto It = Channel.EntityPriorities.CreateIterator(); It; ++It)
 	{
-		Packet.ServerTimestamp = World->GetTimeSeconds();
+		if (!World.FindEntity(It.Key()))
+		{
+			It.RemoveCurrent();
+		}
 	}
 
-	// Get character state
-	ACharacter* Character = Controller->GetCharacter();
-	if (Character)
+	const FEntitySnapshotState* BallEntity = World.FindEntity(FWorldSnapshot::BallEntityId);
+	const float Falloff = FMath::Max(Params.PriorityDistanceFalloff, 1.0f);
+
+	// Grow every accumulator; near the receiver, near the ball and long unsent all raise priority
+	TArray<float> Accumulators;
+	TArray<int32> Candidates;
+	Accumulators.SetNumUninitialized(World.Entities.Num());
+	Candidates.Reserve(World.Entities.Num());
+
+	for (int32 i = 0; i < World.Entities.Num(); ++i)
 	{
-		Packet.AuthoritativePosition = Character->GetActorLocation();
+		const FEntitySnapshotState& Entity = World.Entities[i];
+		FEntitySendPriority& Priority = Channel.EntityPriorities.FindOrAdd(Entity.EntityId);
+		Priority.TimeSinceLastSent += UpdateInterval;
 
-		UPlayerMovementComponent* MovementComp = Character->FindComponentByClass<UPlayerMovementComponent>();
-		if (MovementComp)
+		float Growth = Params.PriorityStalenessWeight * Priority.TimeSinceLastSent;
+		if (Job.bHasReceiverLocation)
+		{
+			const float Distance = FVector::Dist(Entity.Position, Job.ReceiverLocation);
+			Growth += Params.PriorityReceiverDistanceWeight * Falloff / (Falloff + Distance);
+		}
+		if (BallEntity)
 		{
-			Packet.AuthoritativeVelocity = MovementComp->Velocity;
-			Packet.AuthoritativeStamina = MovementComp->CurrentStamina;
+			const float Distance = FVector::Dist(Entity.Position, BallEntity->Position);
+			Growth += Params.PriorityBallDistanceWeight * Falloff / (Falloff + Distance);
 		}
 
-		UPlayerStateMachine* StateMachine = Character->FindComponentByClass<UPlayerStateMachine>();
-		if (StateMachine)
+		Priority.Accumulator += Growth;
+		Accumulators[i] = Priority.Accumulator;
+
+		// The receiver's own character is always sent; reconciliation depends on it
+		if (Entity.EntityId == Job.OwnEntityId)
+		{
+			OutEntityIndices.Add(i);
+		}
+		else
 		{
-			Packet.AuthoritativeState = static_cast<uint8>(StateMachine->CurrentState);
+			Candidates.Add(i);
 		}
 	}
 
-	// Calculate checksum
-	Packet.Checksum = Packet.CalculateChecksum();
+	Candidates.Sort([&Accumulators](int32 A, int32 B)
+	{
+		return Accumulators[A] > Accumulators[B];
+	});
+
+	// Pack by priority using the full encoding size, an upper bound on what a delta costs
+	int64 BudgetBits = static_cast<int64>(Params.ClientBytesPerSecond * UpdateInterval) * 8 - FWorldSnapshotCodec::HeaderBitsEstimate;
+	for (int32 EntityIndex : OutEntityIndices)
+	{
+		BudgetBits -= SharedEncodings.GetFullEntityBits(EntityIndex) + FWorldSnapshotCodec::EntityOverheadBitsEstimate;
+	}
+
+	for (int32 i = 0; i < Candidates.Num(); ++i)
+	{
+		const int64 Cost = SharedEncodings.GetFullEntityBits(Candidates[i]) + FWorldSnapshotCodec::EntityOverheadBitsEstimate;
+		if (Cost > BudgetBits)
+		{
+			Job.EntitiesDeferred = Candidates.Num() - i;
+			break;
+		}
+
+		BudgetBits -= Cost;
+		OutEntityIndices.Add(Candidates[i]);
+	}
+
+	for (int32 EntityIndex : OutEntityIndices)
+	{
+		FEntitySendPriority& Priority = Channel.EntityPriorities.FindChecked(World.Entities[EntityIndex].EntityId);
+		Priority.Accumulator = 0.0f;
+		Priority.TimeSinceLastSent = 0.0f;
+		Priority.SendsInWindow++;
+	}
+}
+
+void ANetworkGameState::PruneDepartedClients()
+{
+	for (auto It = ClientSnapshotChannels.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	for (auto It = ClientTrafficStats.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void ANetworkGameState::UpdateSendRateHistogram()
+{
+	SendRateWindowTime += UpdateInterval;
+	if (SendRateWindowTime < 1.0f)
+	{
+		return;
+	}
+
+	EntitySendRateHistogram.Init(0, NumSendRateEdges + 1);
+
+	for (TPair<TWeakObjectPtr<APocketStrikerPlayerController>, FClientSnapshotChannel>& ChannelPair : ClientSnapshotChannels)
+	{
+		for (TPair<uint32, FEntitySendPriority>& PriorityPair : ChannelPair.Value.EntityPriorities)
+		{
+			FEntitySendPriority& Priority = PriorityPair.Value;
+			Priority.SendRate = Priority.SendsInWindow / SendRateWindowTime;
+			Priority.SendsInWindow = 0;
+
+			int32 Bucket = 0;
+			while (Bucket < NumSendRateEdges && Priority.SendRate >= SendRateBucketEdges[Bucket])
+			{
+				Bucket++;
+			}
+			EntitySendRateHistogram[Bucket]++;
+		}
+	}
+
+	SendRateWindowTime = 0.0f;
+}
+
+void ANetworkGameState::AcknowledgeSnapshot(APocketStrikerPlayerController* Controller, uint32 SnapshotId)
+{
+	if (FClientSnapshotChannel* Channel = ClientSnapshotChannels.Find(Controller))
+	{
+		ApplySnapshotAck(*Channel, SnapshotId);
+	}
+}
+
+void ANetworkGameState::ApplySnapshotAck(FClientSnapshotChannel& Channel, uint32 SnapshotId)
+{
+	// Ignore stale (reordered) acks and ids we never sent
+	if (SnapshotId > Channel.LastAckedSnapshotId && SnapshotId < Channel.NextSnapshotId)
+	{
+		Channel.LastAckedSnapshotId = SnapshotId;
+	}
+}
+
+FNetPacketSample ANetworkGameState::FClientSnapshotJob::MakeSample() const
+{
+	FNetPacketSample Sample;
+	Sample.Type = ENetPacketType::Snapshot;
+	Sample.Bytes = Packet.Num();
+	Sample.FieldBits = FieldBits;
+	Sample.RawBytes = FNetTrafficStats::GetRawSnapshotBytes(FMath::Min(EntityIndices.Num(), static_cast<int32>(FWorldSnapshotCodec::MaxEntities)));
+	Sample.Cycles = EncodeCycles;
+	return Sample;
+}
+
+void ANetworkGameState::RecordClientTraffic(APocketStrikerPlayerController* Controller, ENetTrafficDirection Direction, const FNetPacketSample& Sample)
+{
+	if (Controller)
+	{
+		ClientTrafficStats.FindOrAdd(Controller).Record(Direction, Sample, GetWorld()->GetTimeSeconds());
+	}
+}
+
+void ANetworkGameState::ExecuteActions(uint32 EntityId, const FInputCommand& Command, const FLagCompensationHistory* History)
+{
+	APocketStrikerPlayerController* Controller = FindEntityController(EntityId);
+	ACharacter* Character = Controller ? Controller->GetCharacter() : nullptr;
+	UActionSystem* ActionSystem = Controller ? Controller->ActionSystem : nullptr;
+	if (!ActionSystem || !Character)
+	{
+		return;
+	}
+
+	// A free ball runs the same launch on the client's synced clock, so it is seen at the input's own time;
+	// one held by another player follows that player's interpolated position
+	const ABall* Ball = CachedBall.Get();
+	const AActor* Possessor = Ball ? Ball->GetPossessingActor() : nullptr;
+	const double ViewTime = EstimateClientViewTime(Command, Possessor && Possessor != Character);
+
+	if (Command.ActionFlags & FInputCommand::FLAG_TACKLE)
+	{
+		if (History)
+		{
+			ActionSystem->ExecuteTackleActionAt(Character, *History, ViewTime);
+		}
+		else
+		{
+			ActionSystem->ExecuteTackleAction(Character);
+		}
+	}
+
+	if (Command.ActionFlags & FInputCommand::FLAG_KICK)
+	{
+		const float KickForce = Controller->TuningData ? Controller->TuningData->KickForce : 2000.0f;
+		const FVector Direction = Character->GetActorForwardVector();
+		if (History)
+		{
+			ActionSystem->ExecuteKickActionAt(Character, Direction, KickForce, *History, ViewTime);
+		}
+		else
+		{
+			ActionSystem->ExecuteKickAction(Character, Direction, KickForce);
+		}
+	}
+}
+
+void ANetworkGameState::GatherWorldSnapshot(FWorldSnapshot& OutSnapshot) const
+{
+	UWorld* World = GetWorld();
+	if (!World)
+	{
+		return;
+	}
+
+	OutSnapshot.ServerTimestamp = World->GetTimeSeconds();
+
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PC = It->Get();
+		ACharacter* Character = PC ? PC->GetCharacter() : nullptr;
+		if (!Character || !PC->PlayerState)
+		{
+			continue;
+		}
+
+		FEntitySnapshotState& Entity = OutSnapshot.Entities.AddDefaulted_GetRef();
+		Entity.EntityId = FWorldSnapshot::MakePlayerEntityId(PC->PlayerState->GetPlayerId());
+		Entity.Position = Character->GetActorLocation();
+
+		if (UPlayerMovementComponent* MovementComp = Cast<UPlayerMovementComponent>(Character->GetCharacterMovement()))
+		{
+			Entity.Velocity = MovementComp->Velocity;
+			Entity.Stamina = MovementComp->CurrentStamina;
+		}
+
+		if (APocketStrikerCharacter* PocketStrikerCharacter = Cast<APocketStrikerCharacter>(Character))
+		{
+			if (UPlayerStateMachine* StateMachine = PocketStrikerCharacter->GetStateMachine())
+			{
+				Entity.State = static_cast<uint8>(StateMachine->CurrentState);
+			}
+		}
+	}
+
+	// The match has a single ball; look it up once
+	if (!CachedBall.IsValid())
+	{
+		TActorIterator<ABall> BallIt(World);
+		CachedBall = BallIt ? *BallIt : nullptr;
+	}
+
+	if (ABall* Ball = CachedBall.Get())
+	{
+		FEntitySnapshotState& Entity = OutSnapshot.Entities.AddDefaulted_GetRef();
+		Entity.EntityId = FWorldSnapshot::BallEntityId;
+		Entity.Position = Ball->GetActorLocation();
+		Entity.Velocity = Ball->GetBallVelocity();
+
+		const APawn* Possessor = Cast<APawn>(Ball->GetPossessingActor());
+		if (Possessor && Possessor->GetPlayerState())
+		{
+			OutSnapshot.PossessingEntityId = FWorldSnapshot::MakePlayerEntityId(Possessor->GetPlayerState()->GetPlayerId());
+		}
+	}
+}
+
+namespace
+{
+	void LogNetTraffic(const TArray<FString>& Args, UWorld* World)
+	{
+		if (!World)
+		{
+			return;
+		}
+
+		const bool bReset = Args.Num() > 0 && Args[0] == TEXT("reset");
+		const double Now = World->GetTimeSeconds();
+
+		for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+		{
+			APocketStrikerPlayerController* PC = Cast<APocketStrikerPlayerController>(It->Get());
+			if (UNetworkDebugger* NetworkDebugger = PC ? PC->GetNetworkDebugger() : nullptr)
+			{
+				NetworkDebugger->GetTrafficStats().Log(TEXT("Client"), Now);
+			}
+		}
+
+		for (TActorIterator<ANetworkGameState> It(World); It; ++It)
+		{
+			for (const auto& Pair : It->GetAllClientTrafficStats())
+			{
+				const APocketStrikerPlayerController* ClientController = Pair.Key.Get();
+				const APlayerState* ClientPlayerState = ClientController ? ClientController->PlayerState.Get() : nullptr;
+				Pair.Value.Log(FString::Printf(TEXT("Server[%d]"), ClientPlayerState ? ClientPlayerState->GetPlayerId() : -1), Now);
+			}
+		}
+
+		if (bReset)
+		{
+			for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+			{
+				APocketStrikerPlayerController* PC = Cast<APocketStrikerPlayerController>(It->Get());
+				if (UNetworkDebugger* NetworkDebugger = PC ? PC->GetNetworkDebugger() : nullptr)
+				{
+					NetworkDebugger->ResetTrafficStats();
+				}
+			}
+
+			for (TActorIterator<ANetworkGameState> It(World); It; ++It)
+			{
+				It->ResetClientTrafficStats();
+			}
+			UE_LOG(LogTemp, Log, TEXT("Network traffic stats reset"));
+		}
+	}
+
+	void ControlMatchRecording(const TArray<FString>& Args, UWorld* World)
+	{
+		if (!World)
+		{
+			return;
+		}
+
+		const bool bStop = Args.Num() > 0 && Args[0] == TEXT("stop");
+		const FString Filename = Args.Num() > 1 ? Args[1] : FString();
+
+		for (TActorIterator<ANetworkGameState> It(World); It; ++It)
+		{
+			if (!It->HasAuthority())
+			{
+				continue;
+			}
+
+			if (bStop)
+			{
+				It->StopMatchRecording();
+			}
+			else if (const FMatchRecorder* Recorder = It->GetMatchRecorder())
+			{
+				UE_LOG(LogTemp, Log, TEXT("Match recording: %s, %d ticks, %lld inputs, %d keyframes, %lld bytes"),
+					*Recorder->GetFilename(), Recorder->GetNumTicks(), Recorder->GetNumInputs(), Recorder->GetNumKeyframes(), Recorder->GetBytesWritten());
+			}
+			else
+			{
+				It->StartMatchRecording(Filename);
+			}
+			return;
+		}
+
+		UE_LOG(LogTemp, Warning, TEXT("Match recording: no server game state in this world"));
+	}
+
+	FAutoConsoleCommandWithWorldAndArgs LogNetTrafficCommand(
+		TEXT("perf.nettraffic"),
+		TEXT("Log bytes, field-group split, serialization p50/p99 and compression per packet type for the local client and every server connection. Usage: perf.nettraffic [reset]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&LogNetTraffic));
 
-	return Packet;
+	FAutoConsoleCommandWithWorldAndArgs ControlMatchRecordingCommand(
+		TEXT("perf.matchrecord"),
+		TEXT("Start or stop recording the server's simulated inputs and keyframes. Usage: perf.matchrecord [start [file]|stop]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ControlMatchRecording));
 }
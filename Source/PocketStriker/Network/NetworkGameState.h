@@ -5,38 +5,122 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "NetworkTypes.h"
+#include "NetworkSnapshot.h"
+#include "ServerMatchTick.h"
 #include "NetworkGameState.generated.h"
 
 class APocketStrikerPlayerController;
+class UNetworkParamsData;
+class ABall;
 
 /**
  * Authoritative server game state manager
- * Handles server-side simulation and state broadcasting
+ * Handles server-side simulation and state broadcasting; the per-match input and simulation tick is
+ * FServerMatchTick, run against this world's characters and ball
  */
 UCLASS()
-class POCKETSTRIKER_API ANetworkGameState : public AActor
+class POCKETSTRIKER_API ANetworkGameState : public AActor, public IServerMatchWorld
 {
 	GENERATED_BODY()
 	
 public:	
 	ANetworkGameState();
 
-	// Server-side input processing
+	// Simulation steps allowed in one frame before the backlog is dropped
+	static constexpr int32 MaxSimulationStepsPerFrame = 4;
+
+	// Server-side input processing: validates and queues; inputs are simulated by the fixed-rate tick
 	void ProcessClientInput(APocketStrikerPlayerController* Controller, const FInputPacket& Input);
+
+	// Holds a client's input packet until Tick, which checksums every packet that arrived this frame in one batch
+	// and passes the inputs of the intact ones to ProcessClientInput
+	void QueueClientInputPacket(APocketStrikerPlayerController* Controller, const TArray<uint8>& InputData);
 	
 	// State broadcasting
 	void BroadcastStateUpdates();
+
+	// Client acknowledged receipt of a snapshot, making it usable as a delta baseline
+	void AcknowledgeSnapshot(APocketStrikerPlayerController* Controller, uint32 SnapshotId);
 	
 	// Input validation (anti-cheat)
 	bool ValidateInput(const FInputPacket& Input) const;
+
+	// The checks ValidateInput applies when validation is enabled
+	static bool IsInputPacketValid(const FInputPacket& Input);
+
+	// Take a client's snapshot ack as the new delta baseline, ignoring stale (reordered) acks and unsent ids
+	static void ApplySnapshotAck(FClientSnapshotChannel& Channel, uint32 SnapshotId);
+
+	// One client's share of a broadcast: everything read from actors is copied in on the game thread,
+	// so the worker that selects and encodes touches only this job, its channel and the shared world
+	struct FClientSnapshotJob
+	{
+		APocketStrikerPlayerController* Controller = nullptr;
+		FClientSnapshotChannel* Channel = nullptr;
+		uint32 OwnEntityId = 0;
+		uint32 AcknowledgedSequence = 0;
+		bool bHasReceiverLocation = false;
+		FVector ReceiverLocation = FVector::ZeroVector;
+
+		// Filled by the worker
+		TArray<int32> EntityIndices;
+		TArray<uint8> Packet;
+		bool bDelta = false;
+		int32 EntitiesDeferred = 0;
+		FNetFieldBits FieldBits;
+		uint64 EncodeCycles = 0;
+
+		// Traffic stats entry for the packet this job produced
+		FNetPacketSample MakeSample() const;
+	};
+
+	// Relevancy, delta encoding and serialization for every job, across the task graph when bParallel is set;
+	// also drives headless load tests, which have no actors
+	static void EncodeClientSnapshots(TArrayView<FClientSnapshotJob> Jobs, const FWorldSnapshot& World,
+		const FWorldSnapshotEncodeCache& SharedEncodings, const UNetworkParamsData& Params, float UpdateInterval, bool bParallel);
 	
+	// Bytes, field groups and serialization cost per packet type, kept per client connection
+	void RecordClientTraffic(APocketStrikerPlayerController* Controller, ENetTrafficDirection Direction, const FNetPacketSample& Sample);
+	const FNetTrafficStats* GetClientTrafficStats(APocketStrikerPlayerController* Controller) const { return ClientTrafficStats.Find(Controller); }
+	const TMap<TWeakObjectPtr<APocketStrikerPlayerController>, FNetTrafficStats>& GetAllClientTrafficStats() const { return ClientTrafficStats; }
+	void ResetClientTrafficStats() { ClientTrafficStats.Reset(); }
+
+	// Network parameters shared by every client of this game state, or the class defaults if none are assigned
+	const UNetworkParamsData* GetNetworkParams() const;
+
+	// Snapshots per second an entity currently reaches a client with (measured over the last second)
+	float GetEntitySendRate(APocketStrikerPlayerController* Controller, uint32 EntityId) const;
+
+	// Record every input the fixed tick simulates, plus keyframes, until stopped; an empty filename picks
+	// Saved/Recordings/Match-<time>.psrec. Started in BeginPlay when bRecordMatches is set
+	bool StartMatchRecording(const FString& Filename = FString());
+	void StopMatchRecording();
+	const FMatchRecorder* GetMatchRecorder() const { return MatchTick.GetRecorder(); }
+
+	// Player and ball positions for the last LagCompensationMaxRewind seconds of simulation ticks
+	const FLagCompensationHistory& GetLagCompensationHistory() const { return MatchTick.GetLagCompensationHistory(); }
+
+	// When a client's input was made on the server clock, less the delay it renders interpolated entities behind
+	double EstimateClientViewTime(const FInputCommand& Command, bool bInterpolated) const { return MatchTick.EstimateClientViewTime(Command, bInterpolated); }
+
+	// IServerMatchWorld
+	virtual bool SimulateInput(uint32 EntityId, const FInputCommand& Command, float DeltaTime) override;
+	virtual void ExecuteActions(uint32 EntityId, const FInputCommand& Command, const FLagCompensationHistory* History) override;
+	virtual void GatherWorld(FWorldSnapshot& OutWorld) const override { GatherWorldSnapshot(OutWorld); }
+
 	// Configuration
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network")
 	float StateUpdateRate = 60.0f; // Updates per second
 
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Network")
+	UNetworkParamsData* NetworkParams;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network")
 	bool bEnableInputValidation = true;
 
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network", meta = (ToolTip = "Select and encode each client's snapshot on task graph workers"))
+	bool bParallelSnapshotEncoding = true;
+
 	// Debug info
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Debug")
 	int32 TotalInputsProcessed = 0;
@@ -44,8 +128,46 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Debug")
 	int32 InvalidInputsRejected = 0;
 
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Debug")
+	int32 DuplicateInputsDropped = 0;
+
+	// Input packets that failed their CRC32C and were dropped unread
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Debug")
+	int32 CorruptInputPacketsDropped = 0;
+
+	// Simulation ticks that found a client's input queue empty
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Debug")
+	int32 InputBufferUnderflows = 0;
+
+	// Simulation ticks that ran two queued inputs because a client's queue ran too deep
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Debug")
+	int32 InputBufferOverflows = 0;
+
+	// Inputs that never arrived and were replaced by the previous one
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Debug")
+	int32 InputsReplaced = 0;
+
+	// Deepest client input queue at the last simulation tick
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Debug")
+	int32 MaxInputBufferDepth = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Debug")
+	int32 FullSnapshotsSent = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Debug")
+	int32 DeltaSnapshotsSent = 0;
+
+	// Entities left out of a snapshot by the bandwidth budget
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Debug")
+	int32 EntitiesDeferred = 0;
+
+	// Client/entity pairs by send rate in Hz: <5, 5-10, 10-20, 20-30, 30-45, 45+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Debug")
+	TArray<int32> EntitySendRateHistogram;
+
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void Tick(float DeltaTime) override;
 
 private:
@@ -53,9 +175,49 @@ private:
 	float TimeSinceLastUpdate;
 	float UpdateInterval;
 
-	// Track acknowledged sequences per client
-	TMap<APocketStrikerPlayerController*, uint32> ClientAcknowledgedSequences;
+	// Input packets received since the last tick, not yet checksummed or unpacked
+	struct FPendingInputPacket
+	{
+		TWeakObjectPtr<APocketStrikerPlayerController> Controller;
+		TArray<uint8> Data;
+	};
+	TArray<FPendingInputPacket> PendingInputPackets;
+
+	// Verify every pending packet in one batch, then unpack and process the intact ones
+	void ProcessPendingInputPackets();
+
+	// Input queues, the fixed-step simulation, recording and lag compensation, shared with headless matches
+	FServerMatchTick MatchTick;
+	float SimulationAccumulator = 0.0f;
+
+	// The controller behind each player entity the match tick has inputs for
+	TMap<uint32, TWeakObjectPtr<APocketStrikerPlayerController>> EntityControllers;
+	APocketStrikerPlayerController* FindEntityController(uint32 EntityId) const;
+
+	// Mirror the match tick's counters into the debug properties
+	void CopyMatchTickStats();
+
+	// Sent snapshot history and acked baseline per client
+	// Keyed weakly, so a controller allocated where a departed one lived never inherits its baseline
+	TMap<TWeakObjectPtr<APocketStrikerPlayerController>, FClientSnapshotChannel> ClientSnapshotChannels;
+
+	// Reused every broadcast so the per-client arrays keep their allocations
+	TArray<FClientSnapshotJob> SnapshotJobs;
+
+	TMap<TWeakObjectPtr<APocketStrikerPlayerController>, FNetTrafficStats> ClientTrafficStats;
+
+	// Drop the channels and traffic stats of controllers that logged out
+	void PruneDepartedClients();
+
+	// Capture every player, the ball and possession once per broadcast
+	void GatherWorldSnapshot(FWorldSnapshot& OutSnapshot) const;
+	mutable TWeakObjectPtr<ABall> CachedBall;
+
+	// Grow each entity's priority for this client and pick entities by priority until the byte budget is spent
+	static void SelectSnapshotEntities(FClientSnapshotJob& Job, const FWorldSnapshot& World,
+		const FWorldSnapshotEncodeCache& SharedEncodings, const UNetworkParamsData& Params, float UpdateInterval);
 
-	// Helper to create state update packet for a player
-	FStateUpdatePacket CreateStateUpdate(APocketStrikerPlayerController* Controller, uint32 AckedSequence) const;
+	// Roll the per-entity send counts into rates and rebuild the histogram once per second
+	void UpdateSendRateHistogram();
+	float SendRateWindowTime;
 };
@@ -2,6 +2,23 @@
 
 #include "NetworkInterpolation.h"
 #include "GameFramework/Character.h"
+#include "../Gameplay/PocketStrikerPlayerController.h"
+
+namespace
+{
+	// Server time of the freshest state that could have arrived by now (synced server clock minus the one-way trip),
+	// once the local player's clock sync has a sample
+	bool GetSyncedArrivalServerTime(const UWorld* World, double& OutServerTime)
+	{
+		const APocketStrikerPlayerController* PC = World ? Cast<APocketStrikerPlayerController>(World->GetFirstPlayerController()) : nullptr;
+		if (PC && PC->IsLocalController() && PC->GetClockSync().IsSynchronized())
+		{
+			OutServerTime = PC->GetServerTime() - PC->GetClockSync().GetMinRTT() * 0.5;
+			return true;
+		}
+		return false;
+	}
+}
 
 UNetworkInterpolation::UNetworkInterpolation()
 {
@@ -14,15 +31,16 @@ void UNetworkInterpolation::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// Reserve space for state buffer
-	StateBuffer.Reserve(MaxBufferSize);
+	// Allocate the state ring once
+	ResizeBuffer(MaxBufferSize);
 	
-	// Initialize timing
+	// Initialize timing; the render clock starts with the first packet
 	if (UWorld* World = GetWorld())
 	{
 		LastPacketTime = World->GetTimeSeconds();
-		CurrentRenderTime = LastPacketTime - InterpolationDelay;
 	}
+	CurrentInterpolationDelay = InterpolationDelay;
+	TargetInterpolationDelay = InterpolationDelay;
 }
 
 void UNetworkInterpolation::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
@@ -37,19 +55,62 @@ void UNetworkInterpolation::TickComponent(float DeltaTime, ELevelTick TickType,
 	{
 		TimeSinceLastPacket = World->GetTimeSeconds() - LastPacketTime;
 	}
-	CurrentBufferSize = StateBuffer.Num();
+	CurrentBufferSize = BufferCount;
 }
 
 void UNetworkInterpolation::ApplyNetworkParams(float InInterpolationDelay, int32 InBufferSize)
 {
 	InterpolationDelay = InInterpolationDelay;
-	MaxBufferSize = InBufferSize;
+	if (InBufferSize != MaxBufferSize)
+	{
+		ResizeBuffer(InBufferSize);
+	}
+}
+
+void UNetworkInterpolation::ApplyAdaptiveDelayParams(bool bInAdaptive, float InMinDelay, float InMaxDelay, int32 InTargetBufferedPackets, float InJitterSafetyFactor, float InMaxTimeDilation)
+{
+	bAdaptiveDelay = bInAdaptive;
+	MinInterpolationDelay = InMinDelay;
+	MaxInterpolationDelay = FMath::Max(InMinDelay, InMaxDelay);
+	TargetBufferedPackets = InTargetBufferedPackets;
+	JitterSafetyFactor = InJitterSafetyFactor;
+	MaxTimeDilation = InMaxTimeDilation;
+}
+
+void UNetworkInterpolation::ResizeBuffer(int32 InBufferSize)
+{
+	MaxBufferSize = FMath::Max(2, InBufferSize);
+
+	// Keep the newest states across a resize
+	TArray<FStateUpdatePacket> Kept;
+	const int32 NumKept = FMath::Min(BufferCount, MaxBufferSize);
+	Kept.Reserve(NumKept);
+	for (int32 i = BufferCount - NumKept; i < BufferCount; ++i)
+	{
+		Kept.Add(GetBufferedState(i));
+	}
+
+	const int32 Capacity = FMath::RoundUpToPowerOfTwo(MaxBufferSize);
+	StateBuffer.Reset();
+	StateBuffer.SetNum(Capacity);
+	BufferMask = Capacity - 1;
+	BufferHead = 0;
+	BufferCount = 0;
+	BracketHint = 0;
+
+	for (int32 i = 0; i < Kept.Num(); ++i)
+	{
+		StateBuffer[i] = Kept[i];
+	}
+	BufferCount = Kept.Num();
 }
 
 void UNetworkInterpolation::AddServerState(const FStateUpdatePacket& State)
 {
-	// Add state to buffer
-	StateBuffer.Add(State);
+	if (StateBuffer.Num() == 0)
+	{
+		ResizeBuffer(MaxBufferSize);
+	}
 
 	// Update last packet time
 	if (UWorld* World = GetWorld())
@@ -57,19 +118,71 @@ void UNetworkInterpolation::AddServerState(const FStateUpdatePacket& State)
 		LastPacketTime = World->GetTimeSeconds();
 	}
 
-	// Sort buffer by timestamp (should already be sorted, but ensure it)
-	StateBuffer.Sort([](const FStateUpdatePacket& A, const FStateUpdatePacket& B)
+	const float PreviousNewestTimestamp = BufferCount > 0 ? GetBufferedState(BufferCount - 1).ServerTimestamp : 0.0f;
+	const bool bHadStates = BufferCount > 0;
+
+	// Find the insertion point from the newest end; in-order packets stop immediately
+	int32 InsertIndex = BufferCount;
+	while (InsertIndex > 0 && GetBufferedState(InsertIndex - 1).ServerTimestamp > State.ServerTimestamp)
+	{
+		--InsertIndex;
+	}
+
+	if (InsertIndex > 0 && GetBufferedState(InsertIndex - 1).ServerTimestamp == State.ServerTimestamp)
+	{
+		// Duplicate
+		GetBufferedState(InsertIndex - 1) = State;
+		return;
+	}
+
+	// Full: drop the oldest state, or the new one if it would be the oldest
+	if (BufferCount == MaxBufferSize)
 	{
-		return A.ServerTimestamp < B.ServerTimestamp;
-	});
+		if (InsertIndex == 0)
+		{
+			return;
+		}
 
-	// Trim old states
-	TrimOldStates();
+		BufferHead = (BufferHead + 1) & BufferMask;
+		--BufferCount;
+		--InsertIndex;
+		BracketHint = FMath::Max(0, BracketHint - 1);
+	}
+
+	// Shift the (usually zero) states newer than the packet up by one
+	for (int32 i = BufferCount; i > InsertIndex; --i)
+	{
+		GetBufferedState(i) = GetBufferedState(i - 1);
+	}
+	GetBufferedState(InsertIndex) = State;
+	++BufferCount;
+
+	// Only a new newest state says something about arrival timing
+	if (InsertIndex == BufferCount - 1)
+	{
+		if (bHadStates)
+		{
+			MeasureArrival(State, PreviousNewestTimestamp, LastPacketTime);
+		}
+		NewestArrivalTime = LastPacketTime;
+	}
+
+	if (!bRenderClockStarted)
+	{
+		bRenderClockStarted = true;
+		CurrentRenderTime = State.ServerTimestamp - InterpolationDelay;
+		CurrentInterpolationDelay = InterpolationDelay;
+	}
+
+	if (InsertIndex <= BracketHint)
+	{
+		BracketHint = FMath::Max(0, InsertIndex - 1);
+	}
 }
 
 void UNetworkInterpolation::UpdateInterpolation(float DeltaTime)
 {
-	if (StateBuffer.Num() < 2)
+	if (BufferCount < 2)
 	{
 		// Not enough states to interpolate
 		return;
@@ -82,99 +195,95 @@ void UNetworkInterpolation::UpdateInterpolation(float DeltaTime)
 	}
 
 	// Advance render time
-	CurrentRenderTime += DeltaTime;
+	UpdateRenderClock(DeltaTime);
 
 	// Get interpolated position
-	FVector InterpolatedPosition = GetInterpolatedPosition(CurrentRenderTime);
+	const FInterpolatedState Interpolated = Sample(CurrentRenderTime);
 	
 	// Apply to actor
-	Owner->SetActorLocation(InterpolatedPosition);
+	Owner->SetActorLocation(Interpolated.Position);
 }
 
-FVector UNetworkInterpolation::GetInterpolatedPosition(float RenderTime) const
+FInterpolatedState UNetworkInterpolation::Sample(float InterpolationTime) const
 {
-	if (StateBuffer.Num() == 0)
+	FInterpolatedState Result;
+	if (BufferCount == 0)
 	{
-		return FVector::ZeroVector;
+		return Result;
 	}
 
-	if (StateBuffer.Num() == 1)
+	if (BufferCount == 1)
 	{
-		return StateBuffer[0].AuthoritativePosition;
+		const FStateUpdatePacket& Only = GetBufferedState(0);
+		Result.Position = Only.AuthoritativePosition;
+		Result.Velocity = Only.AuthoritativeVelocity;
+		Result.Rotation = Only.AuthoritativeVelocity.IsNearlyZero() ? FRotator::ZeroRotator : Only.AuthoritativeVelocity.Rotation();
+		return Result;
 	}
 
-	// Get interpolation states
-	FStateUpdatePacket FromState, ToState;
-	float Alpha;
-	GetInterpolationStates(RenderTime, FromState, ToState, Alpha);
+	int32 FromIndex, ToIndex;
+	FindBracket(InterpolationTime, FromIndex, ToIndex);
+	const FStateUpdatePacket& FromState = GetBufferedState(FromIndex);
+	const FStateUpdatePacket& ToState = GetBufferedState(ToIndex);
 
-	// Interpolate position
-	return FMath::Lerp(FromState.AuthoritativePosition, ToState.AuthoritativePosition, Alpha);
-}
+	const float Duration = ToState.ServerTimestamp - FromState.ServerTimestamp;
+	const float Alpha = Duration > 0.0f ? FMath::Clamp((InterpolationTime - FromState.ServerTimestamp) / Duration, 0.0f, 1.0f) : 0.0f;
 
-FRotator UNetworkInterpolation::GetInterpolatedRotation(float RenderTime) const
-{
-	if (StateBuffer.Num() == 0)
+	// Cubic Hermite between the two positions, using the replicated velocities as end tangents
+	const FVector P0 = FromState.AuthoritativePosition;
+	const FVector P1 = ToState.AuthoritativePosition;
+	const FVector M0 = FromState.AuthoritativeVelocity * Duration;
+	const FVector M1 = ToState.AuthoritativeVelocity * Duration;
+
+	const float T = Alpha;
+	const float T2 = T * T;
+	const float T3 = T2 * T;
+	Result.Position = P0 * (2.0f * T3 - 3.0f * T2 + 1.0f) + M0 * (T3 - 2.0f * T2 + T) + P1 * (-2.0f * T3 + 3.0f * T2) + M1 * (T3 - T2);
+
+	// Velocity is the curve's derivative, so it always agrees with the rendered motion
+	if (Duration > 0.0f)
 	{
-		return FRotator::ZeroRotator;
+		Result.Velocity = (P0 * (6.0f * T2 - 6.0f * T) + M0 * (3.0f * T2 - 4.0f * T + 1.0f) + P1 * (-6.0f * T2 + 6.0f * T) + M1 * (3.0f * T2 - 2.0f * T)) / Duration;
 	}
-
-	if (StateBuffer.Num() == 1)
+	else
 	{
-		// Calculate rotation from velocity
-		FVector Velocity = StateBuffer[0].AuthoritativeVelocity;
-		if (!Velocity.IsNearlyZero())
-		{
-			return Velocity.Rotation();
-		}
-		return FRotator::ZeroRotator;
+		Result.Velocity = FromState.AuthoritativeVelocity;
 	}
 
-	// Get interpolation states
-	FStateUpdatePacket FromState, ToState;
-	float Alpha;
-	GetInterpolationStates(RenderTime, FromState, ToState, Alpha);
-
 	// Calculate rotations from velocities
-	FRotator FromRotation = FromState.AuthoritativeVelocity.IsNearlyZero() ? 
+	const FRotator FromRotation = FromState.AuthoritativeVelocity.IsNearlyZero() ?
 		FRotator::ZeroRotator : FromState.AuthoritativeVelocity.Rotation();
-	FRotator ToRotation = ToState.AuthoritativeVelocity.IsNearlyZero() ? 
+	const FRotator ToRotation = ToState.AuthoritativeVelocity.IsNearlyZero() ?
 		FRotator::ZeroRotator : ToState.AuthoritativeVelocity.Rotation();
+	Result.Rotation = FMath::Lerp(FromRotation, ToRotation, Alpha);
 
-	// Interpolate rotation
-	return FMath::Lerp(FromRotation, ToRotation, Alpha);
+	return Result;
 }
 
-FVector UNetworkInterpolation::GetInterpolatedVelocity(float RenderTime) const
+FVector UNetworkInterpolation::GetInterpolatedPosition(float InterpolationTime) const
 {
-	if (StateBuffer.Num() == 0)
-	{
-		return FVector::ZeroVector;
-	}
-
-	if (StateBuffer.Num() == 1)
-	{
-		return StateBuffer[0].AuthoritativeVelocity;
-	}
+	return Sample(InterpolationTime).Position;
+}
 
-	// Get interpolation states
-	FStateUpdatePacket FromState, ToState;
-	float Alpha;
-	GetInterpolationStates(RenderTime, FromState, ToState, Alpha);
+FRotator UNetworkInterpolation::GetInterpolatedRotation(float InterpolationTime) const
+{
+	return Sample(InterpolationTime).Rotation;
+}
 
-	// Interpolate velocity
-	return FMath::Lerp(FromState.AuthoritativeVelocity, ToState.AuthoritativeVelocity, Alpha);
+FVector UNetworkInterpolation::GetInterpolatedVelocity(float InterpolationTime) const
+{
+	return Sample(InterpolationTime).Velocity;
 }
 
 FVector UNetworkInterpolation::ExtrapolatePosition(float DeltaTime)
 {
-	if (!bEnableExtrapolation || StateBuffer.Num() == 0)
+	if (!bEnableExtrapolation || BufferCount == 0)
 	{
 		return FVector::ZeroVector;
 	}
 
 	// Use the latest state to extrapolate
-	const FStateUpdatePacket& LatestState = StateBuffer.Last();
+	const FStateUpdatePacket& LatestState = GetBufferedState(BufferCount - 1);
 	
 	// Extrapolate using velocity
 	FVector ExtrapolatedPosition = LatestState.AuthoritativePosition + 
@@ -183,58 +292,93 @@ FVector UNetworkInterpolation::ExtrapolatePosition(float DeltaTime)
 	return ExtrapolatedPosition;
 }
 
-void UNetworkInterpolation::GetInterpolationStates(float RenderTime, FStateUpdatePacket& OutFrom, FStateUpdatePacket& OutTo, float& OutAlpha) const
+void UNetworkInterpolation::MeasureArrival(const FStateUpdatePacket& State, float PreviousNewestTimestamp, float ArrivalTime)
 {
-	// Calculate target render time (current time - interpolation delay)
-	float TargetTime = RenderTime - InterpolationDelay;
+	const float ServerInterval = State.ServerTimestamp - PreviousNewestTimestamp;
+	const float ArrivalInterval = ArrivalTime - NewestArrivalTime;
 
-	// Find the two states to interpolate between
-	int32 FromIndex = -1;
-	int32 ToIndex = -1;
-
-	for (int32 i = 0; i < StateBuffer.Num() - 1; ++i)
+	if (MeasuredPacketInterval <= 0.0f)
 	{
-		if (StateBuffer[i].ServerTimestamp <= TargetTime && 
-			StateBuffer[i + 1].ServerTimestamp >= TargetTime)
-		{
-			FromIndex = i;
-			ToIndex = i + 1;
-			break;
-		}
+		MeasuredPacketInterval = ServerInterval;
+		return;
 	}
 
-	// Handle edge cases
-	if (FromIndex == -1)
+	// A gap well over the usual spacing means packets were lost (or deprioritized) in between
+	const bool bGap = ServerInterval > MeasuredPacketInterval * 1.5f;
+	MeasuredPacketLoss += ((bGap ? 1.0f : 0.0f) - MeasuredPacketLoss) / 32.0f;
+
+	// Interval from gap-free pairs only, so losses do not inflate it
+	if (!bGap)
 	{
-		// Target time is before all states, use first two
-		FromIndex = 0;
-		ToIndex = FMath::Min(1, StateBuffer.Num() - 1);
+		MeasuredPacketInterval += (ServerInterval - MeasuredPacketInterval) / 16.0f;
 	}
 
-	OutFrom = StateBuffer[FromIndex];
-	OutTo = StateBuffer[ToIndex];
+	// RFC 3550 interarrival jitter: deviation of arrival spacing from send spacing
+	const float Deviation = FMath::Abs(ArrivalInterval - ServerInterval);
+	MeasuredJitter += (Deviation - MeasuredJitter) / 16.0f;
+}
 
-	// Calculate interpolation alpha
-	float TimeDiff = OutTo.ServerTimestamp - OutFrom.ServerTimestamp;
-	if (TimeDiff > 0.0f)
+void UNetworkInterpolation::UpdateRenderClock(float DeltaTime)
+{
+	if (bAdaptiveDelay && MeasuredPacketInterval > 0.0f)
 	{
-		OutAlpha = (TargetTime - OutFrom.ServerTimestamp) / TimeDiff;
-		OutAlpha = FMath::Clamp(OutAlpha, 0.0f, 1.0f);
+		// Enough time to keep TargetBufferedPackets ahead, absorb jitter, and bridge a lost packet at ~10% loss
+		const float Target = MeasuredPacketInterval * TargetBufferedPackets
+			+ MeasuredJitter * JitterSafetyFactor
+			+ MeasuredPacketInterval * FMath::Min(1.0f, MeasuredPacketLoss * 10.0f);
+		TargetInterpolationDelay = FMath::Clamp(Target, MinInterpolationDelay, MaxInterpolationDelay);
 	}
 	else
 	{
-		OutAlpha = 0.0f;
+		TargetInterpolationDelay = InterpolationDelay;
 	}
+
+	// How far behind the freshest possible data the render time is; without clock sync, time the newest packet from its arrival
+	const UWorld* World = GetWorld();
+	double SyncedServerTime = 0.0;
+	const float Now = World ? World->GetTimeSeconds() : LastPacketTime;
+	const float EstimatedServerTime = GetSyncedArrivalServerTime(World, SyncedServerTime) ? static_cast<float>(SyncedServerTime)
+		: GetBufferedState(BufferCount - 1).ServerTimestamp + (Now - NewestArrivalTime);
+	const float MeasuredDelay = EstimatedServerTime - CurrentRenderTime;
+	CurrentInterpolationDelay += (MeasuredDelay - CurrentInterpolationDelay) * FMath::Min(1.0f, DeltaTime * 4.0f);
+
+	const float DelayError = CurrentInterpolationDelay - TargetInterpolationDelay;
+	if (FMath::Abs(DelayError) > MaxInterpolationDelay)
+	{
+		// Too far off to dilate (stall, clock jump): snap once
+		CurrentRenderTime = EstimatedServerTime - TargetInterpolationDelay;
+		CurrentInterpolationDelay = TargetInterpolationDelay;
+		TimeDilation = 1.0f;
+		return;
+	}
+
+	// Run the render clock slightly fast or slow until the delay matches; 1% speed per 10 ms of error
+	TimeDilation = 1.0f + FMath::Clamp(DelayError, -MaxTimeDilation, MaxTimeDilation);
+	CurrentRenderTime += DeltaTime * TimeDilation;
 }
 
-void UNetworkInterpolation::TrimOldStates()
+void UNetworkInterpolation::FindBracket(float TargetTime, int32& OutFromIndex, int32& OutToIndex) const
 {
-	if (StateBuffer.Num() <= MaxBufferSize)
+	// Before all states: use the first two
+	if (TargetTime <= GetBufferedState(0).ServerTimestamp)
 	{
-		return;
+		BracketHint = 0;
+	}
+	else
+	{
+		// Step back if the hint overshoots (a late packet or a rewound query), then forward to the bracket
+		int32 Index = FMath::Clamp(BracketHint, 0, BufferCount - 2);
+		while (Index > 0 && GetBufferedState(Index).ServerTimestamp > TargetTime)
+		{
+			--Index;
+		}
+		while (Index < BufferCount - 2 && GetBufferedState(Index + 1).ServerTimestamp < TargetTime)
+		{
+			++Index;
+		}
+		BracketHint = Index;
 	}
 
-	// Remove oldest states
-	int32 NumToRemove = StateBuffer.Num() - MaxBufferSize;
-	StateBuffer.RemoveAt(0, NumToRemove);
+	OutFromIndex = BracketHint;
+	OutToIndex = BracketHint + 1;
 }
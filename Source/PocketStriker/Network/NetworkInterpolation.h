@@ -7,6 +7,16 @@
 #include "NetworkTypes.h"
 #include "NetworkInterpolation.generated.h"
 
+/**
+ * One interpolated sample of a remote entity
+ */
+struct FInterpolatedState
+{
+	FVector Position = FVector::ZeroVector;
+	FRotator Rotation = FRotator::ZeroRotator;
+	FVector Velocity = FVector::ZeroVector;
+};
+
 /**
  * Remote entity interpolation component
  * Smooths remote player rendering with state buffering
@@ -24,20 +34,40 @@ public:
 	void AddServerState(const FStateUpdatePacket& State);
 	void UpdateInterpolation(float DeltaTime);
 	
-	// Interpolation
-	FVector GetInterpolatedPosition(float RenderTime) const;
-	FRotator GetInterpolatedRotation(float RenderTime) const;
-	FVector GetInterpolatedVelocity(float RenderTime) const;
+	// Interpolation at a server timestamp; Sample does one bracket lookup for all three outputs
+	FInterpolatedState Sample(float InterpolationTime) const;
+	FVector GetInterpolatedPosition(float InterpolationTime) const;
+	FRotator GetInterpolatedRotation(float InterpolationTime) const;
+	FVector GetInterpolatedVelocity(float InterpolationTime) const;
 	
 	// Extrapolation for packet loss
 	FVector ExtrapolatePosition(float DeltaTime);
 
 	// Apply network parameters
 	void ApplyNetworkParams(float InInterpolationDelay, int32 InBufferSize);
+	void ApplyAdaptiveDelayParams(bool bInAdaptive, float InMinDelay, float InMaxDelay, int32 InTargetBufferedPackets, float InJitterSafetyFactor, float InMaxTimeDilation);
 
 	// Configuration
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network", meta = (ToolTip = "Interpolation delay in seconds (default 100ms)"))
-	float InterpolationDelay = 0.1f;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network", meta = (ToolTip = "Interpolation delay in seconds (default 75ms); the starting delay when adaptive"))
+	float InterpolationDelay = 0.075f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network", meta = (ToolTip = "Derive the delay from measured packet interval, jitter and loss instead of using InterpolationDelay"))
+	bool bAdaptiveDelay = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network", meta = (ToolTip = "Lower bound of the adaptive delay in seconds"))
+	float MinInterpolationDelay = 0.02f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network", meta = (ToolTip = "Upper bound of the adaptive delay in seconds; larger errors snap instead of dilating"))
+	float MaxInterpolationDelay = 0.25f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network", meta = (ToolTip = "Packet intervals kept buffered ahead of the render time"))
+	int32 TargetBufferedPackets = 2;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network", meta = (ToolTip = "Multiples of the measured jitter added to the delay"))
+	float JitterSafetyFactor = 3.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network", meta = (ToolTip = "Largest render clock speed change used to move towards the target delay (0.05 = 5%)"))
+	float MaxTimeDilation = 0.05f;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network", meta = (ToolTip = "Maximum size of state buffer"))
 	int32 MaxBufferSize = 32;
@@ -52,20 +82,59 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Debug")
 	float TimeSinceLastPacket = 0.0f;
 
+	// Render delay currently applied (smoothed), in seconds
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Debug")
+	float CurrentInterpolationDelay = 0.0f;
+
+	// Delay the render clock is dilating towards, in seconds
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Debug")
+	float TargetInterpolationDelay = 0.0f;
+
+	// Smoothed packet inter-arrival jitter in seconds (RFC 3550 style)
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Debug")
+	float MeasuredJitter = 0.0f;
+
+	// Smoothed server-side spacing between received states in seconds
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Debug")
+	float MeasuredPacketInterval = 0.0f;
+
+	// Fraction of intervals with a missing packet (0-1)
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Debug")
+	float MeasuredPacketLoss = 0.0f;
+
+	// Render clock speed this frame (1 = real time)
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Debug")
+	float TimeDilation = 1.0f;
+
 protected:
 	virtual void BeginPlay() override;
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
 private:
-	// State buffer for interpolation
+	// Ring of states ordered by ServerTimestamp; BufferHead is the oldest, capacity is a power of two
 	UPROPERTY()
 	TArray<FStateUpdatePacket> StateBuffer;
 
+	int32 BufferHead = 0;
+	int32 BufferCount = 0;
+	int32 BufferMask = 0;
+
+	// Bracket found by the previous lookup; render time only moves forward, so the next search starts here
+	mutable int32 BracketHint = 0;
+
 	// Timing
 	float LastPacketTime;
+	float NewestArrivalTime = 0.0f;
+
+	// Server timestamp being rendered; advances with TimeDilation
 	float CurrentRenderTime;
+	bool bRenderClockStarted = false;
 
 	// Helper functions
-	void GetInterpolationStates(float RenderTime, FStateUpdatePacket& OutFrom, FStateUpdatePacket& OutTo, float& OutAlpha) const;
-	void TrimOldStates();
+	const FStateUpdatePacket& GetBufferedState(int32 Index) const { return StateBuffer[(BufferHead + Index) & BufferMask]; }
+	FStateUpdatePacket& GetBufferedState(int32 Index) { return StateBuffer[(BufferHead + Index) & BufferMask]; }
+	void ResizeBuffer(int32 InBufferSize);
+	void FindBracket(float TargetTime, int32& OutFromIndex, int32& OutToIndex) const;
+	void MeasureArrival(const FStateUpdatePacket& State, float PreviousNewestTimestamp, float ArrivalTime);
+	void UpdateRenderClock(float DeltaTime);
 };
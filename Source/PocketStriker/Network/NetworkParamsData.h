@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "Engine/DataAsset.h"
+#include "NetworkTypes.h"
+#include "NetworkConditioner.h"
 #include "NetworkParamsData.generated.h"
 
 /**
@@ -19,18 +21,105 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Prediction", meta = (ToolTip = "Distance threshold before correction in cm"))
 	float CorrectionThreshold = 10.0f;
 
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Prediction", meta = (ToolTip = "Velocity difference from the predicted state before correction in cm/s"))
+	float VelocityCorrectionThreshold = 30.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Prediction", meta = (ToolTip = "Stamina difference from the predicted state before correction"))
+	float StaminaCorrectionThreshold = 2.0f;
+
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Prediction", meta = (ToolTip = "Speed of correction smoothing"))
 	float SmoothingSpeed = 10.0f;
 
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interpolation", meta = (ToolTip = "Interpolation delay in seconds"))
-	float InterpolationDelay = 0.1f;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Prediction", meta = (ToolTip = "Correct small position and velocity errors by shifting the stored predictions instead of replaying unacknowledged inputs"))
+	bool bShiftSmallCorrections = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Prediction", meta = (ToolTip = "Largest position error at the acknowledged input corrected by shifting, in cm; larger ones replay"))
+	float MaxShiftPositionDelta = 50.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Prediction", meta = (ToolTip = "Largest velocity error at the acknowledged input corrected by shifting, in cm/s; larger ones replay"))
+	float MaxShiftVelocityDelta = 150.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interpolation", meta = (ToolTip = "Interpolation delay in seconds; the starting delay when adaptive"))
+	float InterpolationDelay = 0.075f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interpolation", meta = (ToolTip = "Derive the delay from measured packet interval, jitter and loss"))
+	bool bAdaptiveInterpolationDelay = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interpolation", meta = (ToolTip = "Lower bound of the adaptive delay in seconds", ClampMin = "0.0"))
+	float MinInterpolationDelay = 0.02f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interpolation", meta = (ToolTip = "Upper bound of the adaptive delay in seconds", ClampMin = "0.0"))
+	float MaxInterpolationDelay = 0.25f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interpolation", meta = (ToolTip = "Packet intervals kept buffered ahead of the render time", ClampMin = "1", ClampMax = "8"))
+	int32 TargetBufferedPackets = 2;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interpolation", meta = (ToolTip = "Multiples of the measured jitter added to the adaptive delay", ClampMin = "0.0"))
+	float JitterSafetyFactor = 3.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interpolation", meta = (ToolTip = "Largest render clock speed change used to reach the target delay (0.05 = 5%)", ClampMin = "0.0", ClampMax = "0.25"))
+	float MaxTimeDilation = 0.05f;
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interpolation", meta = (ToolTip = "Size of state buffer for interpolation"))
 	int32 StateBufferSize = 32;
 
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Debug", meta = (ToolTip = "Simulated latency in seconds"))
-	float SimulatedLatency = 0.0f;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input", meta = (ToolTip = "Number of most recent unacknowledged inputs repeated in every unreliable input packet", ClampMin = "1", ClampMax = "32"))
+	int32 InputRedundancyWindow = 4;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input", meta = (ToolTip = "Server simulation ticks per second; each tick consumes one queued input per client", ClampMin = "10", ClampMax = "240"))
+	float ServerTickRate = 60.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input", meta = (ToolTip = "Inputs the server keeps queued per client to absorb arrival jitter (each adds one tick of latency)", ClampMin = "0", ClampMax = "8"))
+	int32 InputBufferTargetDepth = 2;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input", meta = (ToolTip = "Queued inputs beyond the target depth before a tick runs two inputs", ClampMin = "1", ClampMax = "16"))
+	int32 InputBufferMaxExtraDepth = 4;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Quantization", meta = (ToolTip = "Field resolutions for the bit-packed input and state packets"))
+	FNetQuantizationSettings Quantization;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Snapshots", meta = (ToolTip = "Oldest acked snapshot (in snapshots) still used as a delta baseline before falling back to a full snapshot", ClampMin = "1", ClampMax = "31"))
+	int32 MaxBaselineAge = 30;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Snapshots", meta = (ToolTip = "Per-client snapshot bandwidth budget in bytes per second; lowest priority entities wait when it is reached", ClampMin = "500"))
+	int32 ClientBytesPerSecond = 16000;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Snapshots", meta = (ToolTip = "Priority added per broadcast for an entity standing on the receiving player, falling off with distance", ClampMin = "0.0"))
+	float PriorityReceiverDistanceWeight = 1.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Snapshots", meta = (ToolTip = "Priority added per broadcast for an entity standing on the ball, falling off with distance", ClampMin = "0.0"))
+	float PriorityBallDistanceWeight = 1.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Snapshots", meta = (ToolTip = "Priority added per broadcast for each second since the entity was last sent", ClampMin = "0.0"))
+	float PriorityStalenessWeight = 2.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Snapshots", meta = (ToolTip = "Distance in cm at which the distance priority terms have halved", ClampMin = "1.0"))
+	float PriorityDistanceFalloff = 1000.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Clock", meta = (ToolTip = "Seconds between clock sync pings once synchronized", ClampMin = "0.1"))
+	float ClockSyncInterval = 1.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Clock", meta = (ToolTip = "Samples gathered at the burst rate after joining", ClampMin = "1", ClampMax = "32"))
+	int32 ClockSyncBurstPings = 8;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Clock", meta = (ToolTip = "Seconds between clock sync pings during the initial burst", ClampMin = "0.02"))
+	float ClockSyncBurstInterval = 0.1f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rollback", meta = (ToolTip = "Deepest re-simulation in frames when a late input arrives in rollback mode; older inputs are dropped", ClampMin = "1", ClampMax = "30"))
+	int32 MaxRollbackFrames = 8;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "LagCompensation", meta = (ToolTip = "Judge tackle and kick range on the server where the ball was on the attacker's screen"))
+	bool bLagCompensation = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "LagCompensation", meta = (ToolTip = "Seconds of player and ball positions kept for rewinding; older view times are clamped to it", ClampMin = "0.1", ClampMax = "2.0"))
+	float LagCompensationMaxRewind = 1.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Recording", meta = (ToolTip = "Record every simulated input and periodic keyframes to Saved/Recordings on the server, for headless replay (perf.matchreplay, -run=MatchReplay)"))
+	bool bRecordMatches = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Recording", meta = (ToolTip = "Seconds between recorded keyframes; replays measure drift and resync at each one", ClampMin = "0.5"))
+	float RecordingKeyframeInterval = 5.0f;
 
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Debug", meta = (ToolTip = "Packet loss percentage (0-100)"))
-	float PacketLossPercentage = 0.0f;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Debug", meta = (ToolTip = "Latency, jitter, burst loss, reordering, duplication and bandwidth applied on owning clients to each direction of their traffic; inactive while every condition is zero"))
+	FNetworkConditionerSettings NetworkConditions;
 };
@@ -6,6 +6,7 @@
 #include "DrawDebugHelpers.h"
 #include "../Gameplay/PlayerMovementComponent.h"
 #include "../Gameplay/PlayerStateMachine.h"
+#include "../Gameplay/PocketStrikerCharacter.h"
 #include "../Gameplay/PocketStrikerPlayerController.h"
 
 UNetworkPrediction::UNetworkPrediction()
@@ -23,12 +24,17 @@ void UNetworkPrediction::BeginPlay()
 	if (Owner)
 	{
 		MovementComponent = Owner->FindComponentByClass<UPlayerMovementComponent>();
-		StateMachine = Owner->FindComponentByClass<UPlayerStateMachine>();
+
+		// The state machine is a subobject of the character, not a component
+		if (APocketStrikerCharacter* PocketStrikerCharacter = Cast<APocketStrikerCharacter>(Owner))
+		{
+			StateMachine = PocketStrikerCharacter->GetStateMachine();
+		}
 	}
 
-	// Reserve space for buffers
-	InputBuffer.Reserve(MaxInputBufferSize);
-	StateHistory.Reserve(MaxStateHistorySize);
+	// Allocate the state ring once; nothing is moved or reallocated after this
+	InputBuffer.SetCapacity(FMath::Max(MaxInputBufferSize, 1));
+	StateHistory.SetCapacity(FMath::Max(MaxStateHistorySize, 1));
 }
 
 void UNetworkPrediction::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
@@ -41,40 +47,27 @@ void UNetworkPrediction::TickComponent(float DeltaTime, ELevelTick TickType, FAc
 
 void UNetworkPrediction::BufferInput(const FInputPacket& Input)
 {
-	// Add input to buffer
+	// Extends the newest run when only the timestamp changed; the oldest input drops out once the buffer is full
 	InputBuffer.Add(Input);
-
-	// Trim buffer if it exceeds max size
-	if (InputBuffer.Num() > MaxInputBufferSize)
-	{
-		// Remove oldest inputs
-		int32 NumToRemove = InputBuffer.Num() - MaxInputBufferSize;
-		InputBuffer.RemoveAt(0, NumToRemove);
-	}
 }
 
 TArray<FInputPacket> UNetworkPrediction::GetUnacknowledgedInputs(uint32 LastAckedSequence) const
 {
 	TArray<FInputPacket> UnackedInputs;
+	UnackedInputs.Reserve(InputBuffer.Num());
 
-	for (const FInputPacket& Input : InputBuffer)
+	InputBuffer.ForEachAfter(LastAckedSequence, [&UnackedInputs](const FInputPacket& Input)
 	{
-		if (Input.SequenceNumber > LastAckedSequence)
-		{
-			UnackedInputs.Add(Input);
-		}
-	}
+		UnackedInputs.Add(Input);
+	});
 
 	return UnackedInputs;
 }
 
 void UNetworkPrediction::ClearAcknowledgedInputs(uint32 AckedSequence)
 {
-	// Remove all inputs up to and including the acknowledged sequence
-	InputBuffer.RemoveAll([AckedSequence](const FInputPacket& Input)
-	{
-		return Input.SequenceNumber <= AckedSequence;
-	});
+	// Release all inputs up to and including the acknowledged sequence
+	InputBuffer.ReleaseUpTo(AckedSequence);
 }
 
 void UNetworkPrediction::PredictMovement(float DeltaTime)
@@ -115,28 +108,15 @@ void UNetworkPrediction::SimulateInput(const FInputPacket& Input, float DeltaTim
 
 void UNetworkPrediction::SavePredictionState(uint32 SequenceNumber)
 {
-	FPredictionState State = CaptureCurrentState(SequenceNumber);
-	
-	// Add to history
-	StateHistory.Add(State);
-
-	// Trim history if it exceeds max size
-	if (StateHistory.Num() > MaxStateHistorySize)
-	{
-		int32 NumToRemove = StateHistory.Num() - MaxStateHistorySize;
-		StateHistory.RemoveAt(0, NumToRemove);
-	}
+	// Overwrites the oldest state once the history is full
+	StateHistory.Add(SequenceNumber, CaptureCurrentState(SequenceNumber));
 }
 
 FPredictionState UNetworkPrediction::GetStateAtSequence(uint32 SequenceNumber) const
 {
-	// Find state with matching sequence number
-	for (const FPredictionState& State : StateHistory)
+	if (const FPredictionState* State = StateHistory.Find(SequenceNumber))
 	{
-		if (State.SequenceNumber == SequenceNumber)
-		{
-			return State;
-		}
+		return *State;
 	}
 
 	// Return empty state if not found
@@ -145,11 +125,32 @@ FPredictionState UNetworkPrediction::GetStateAtSequence(uint32 SequenceNumber) c
 
 void UNetworkPrediction::ClearOldStates(uint32 OldestNeededSequence)
 {
-	// Remove states older than the oldest needed sequence
-	StateHistory.RemoveAll([OldestNeededSequence](const FPredictionState& State)
+	// Release states older than the oldest needed sequence
+	if (OldestNeededSequence > 0)
 	{
-		return State.SequenceNumber < OldestNeededSequence;
-	});
+		StateHistory.ReleaseUpTo(OldestNeededSequence - 1);
+	}
+}
+
+FVector UNetworkPrediction::ShiftStatesFrom(uint32 FromSequence, const FVector& PositionDelta, const FVector& VelocityDelta, float StepTime)
+{
+	if (!StateHistory.Find(FromSequence))
+	{
+		return FVector::ZeroVector;
+	}
+
+	// The server runs one input per fixed step, so a velocity error grows by one step's travel per sequence
+	FVector Shift = PositionDelta;
+	for (uint32 Sequence = FromSequence; Sequence <= StateHistory.GetNewestSequence(); ++Sequence)
+	{
+		if (FPredictionState* State = StateHistory.Find(Sequence))
+		{
+			Shift = PositionDelta + VelocityDelta * ((Sequence - FromSequence) * StepTime);
+			State->Position += Shift;
+			State->Velocity += VelocityDelta;
+		}
+	}
+	return Shift;
 }
 
 FPredictionState UNetworkPrediction::CaptureCurrentState(uint32 SequenceNumber) const
@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "NetworkTypes.h"
+#include "SequenceRingBuffer.h"
+#include "InputRunBuffer.h"
 #include "NetworkPrediction.generated.h"
 
 class UPlayerMovementComponent;
@@ -34,12 +36,20 @@ public:
 	// State tracking
 	void SavePredictionState(uint32 SequenceNumber);
 	FPredictionState GetStateAtSequence(uint32 SequenceNumber) const;
+	const FPredictionState* FindStateAtSequence(uint32 SequenceNumber) const { return StateHistory.Find(SequenceNumber); }
 	void ClearOldStates(uint32 OldestNeededSequence);
 
+	// Moves the stored prediction at FromSequence and every later one by an error measured at FromSequence: velocities
+	// by VelocityDelta, positions by PositionDelta plus VelocityDelta integrated over StepTime per sequence since.
+	// Returns the shift of the newest state, or zero when FromSequence has no stored state
+	FVector ShiftStatesFrom(uint32 FromSequence, const FVector& PositionDelta, const FVector& VelocityDelta, float StepTime);
+
 	// Configuration
+	// Sequences of unacknowledged input kept; held as runs, so memory follows how often the input changes
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network")
 	int32 MaxInputBufferSize = 128;
 
+	// Rounded up to a power of two when the history is allocated in BeginPlay
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network")
 	int32 MaxStateHistorySize = 128;
 
@@ -55,13 +65,11 @@ protected:
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
 private:
-	// Input buffer for unacknowledged inputs
-	UPROPERTY()
-	TArray<FInputPacket> InputBuffer;
+	// Unacknowledged inputs, run-length coded: a held stick is one entry
+	FInputRunBuffer InputBuffer;
 
-	// State history for reconciliation
-	UPROPERTY()
-	TArray<FPredictionState> StateHistory;
+	// State history for reconciliation, keyed by sequence number
+	TSequenceRingBuffer<FPredictionState> StateHistory;
 
 	// Current sequence number
 	uint32 CurrentSequence;
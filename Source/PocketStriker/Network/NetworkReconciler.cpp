@@ -3,9 +3,11 @@
 #include "NetworkReconciler.h"
 #include "NetworkPrediction.h"
 #include "GameFramework/Character.h"
+#include "Components/SkeletalMeshComponent.h"
 #include "DrawDebugHelpers.h"
 #include "../Gameplay/PlayerMovementComponent.h"
 #include "../Gameplay/PlayerStateMachine.h"
+#include "../Gameplay/PocketStrikerCharacter.h"
 #include "../Gameplay/PocketStrikerPlayerController.h"
 #include "../Tools/PerformanceProfiler.h"
 
@@ -26,7 +28,12 @@ void UNetworkReconciler::BeginPlay()
 	{
 		PredictionComponent = Owner->FindComponentByClass<UNetworkPrediction>();
 		MovementComponent = Owner->FindComponentByClass<UPlayerMovementComponent>();
-		StateMachine = Owner->FindComponentByClass<UPlayerStateMachine>();
+
+		// The state machine is a subobject of the character, not a component
+		if (APocketStrikerCharacter* PocketStrikerCharacter = Cast<APocketStrikerCharacter>(Owner))
+		{
+			StateMachine = PocketStrikerCharacter->GetStateMachine();
+		}
 	}
 }
 
@@ -39,28 +46,90 @@ void UNetworkReconciler::TickComponent(float DeltaTime, ELevelTick TickType, FAc
 	{
 		SmoothCorrection(SmoothingTarget, DeltaTime);
 	}
+
+	// Bleed off the mesh offset left by a shifted correction
+	if (!VisualCorrectionOffset.IsZero())
+	{
+		VisualCorrectionOffset *= FMath::Exp(-SmoothingSpeed * DeltaTime);
+		if (VisualCorrectionOffset.SizeSquared() < FMath::Square(0.1f))
+		{
+			VisualCorrectionOffset = FVector::ZeroVector;
+		}
+		ApplyVisualCorrectionOffset();
+	}
 }
 
-void UNetworkReconciler::ApplyNetworkParams(float InCorrectionThreshold, float InSmoothingSpeed)
+void UNetworkReconciler::ApplyNetworkParams(float InCorrectionThreshold, float InSmoothingSpeed, float InVelocityCorrectionThreshold, float InStaminaCorrectionThreshold)
 {
 	CorrectionThreshold = InCorrectionThreshold;
 	SmoothingSpeed = InSmoothingSpeed;
+	VelocityCorrectionThreshold = InVelocityCorrectionThreshold;
+	StaminaCorrectionThreshold = InStaminaCorrectionThreshold;
+}
+
+void UNetworkReconciler::ApplyCorrectionShiftParams(bool bInShiftSmallCorrections, float InMaxShiftPositionDelta, float InMaxShiftVelocityDelta, float InServerTickRate)
+{
+	bShiftSmallCorrections = bInShiftSmallCorrections;
+	MaxShiftPositionDelta = InMaxShiftPositionDelta;
+	MaxShiftVelocityDelta = InMaxShiftVelocityDelta;
+	ServerTickRate = InServerTickRate;
+}
+
+bool UNetworkReconciler::CanShiftCorrection(uint32 MispredictedFields, const FVector& PositionDelta, const FVector& VelocityDelta,
+	float MaxPositionDelta, float MaxVelocityDelta)
+{
+	// Stamina and player state gate what later inputs do (sprinting, tackles), so those need the inputs re-run
+	return (MispredictedFields & (MISPREDICTED_STAMINA | MISPREDICTED_STATE)) == 0
+		&& PositionDelta.SizeSquared() <= FMath::Square(MaxPositionDelta)
+		&& VelocityDelta.SizeSquared() <= FMath::Square(MaxVelocityDelta);
 }
 
 bool UNetworkReconciler::NeedsReconciliation(const FStateUpdatePacket& ServerState) const
+{
+	return GetMispredictedFields(ServerState) != 0;
+}
+
+uint32 UNetworkReconciler::GetMispredictedFields(const FStateUpdatePacket& ServerState) const
 {
 	AActor* Owner = GetOwner();
 	if (!Owner)
 	{
-		return false;
+		return 0;
 	}
 
-	// Calculate position error
-	FVector CurrentPosition = Owner->GetActorLocation();
-	float PositionError = FVector::Dist(CurrentPosition, ServerState.AuthoritativePosition);
+	// Compare against what we predicted for the acknowledged input, not the current position,
+	// which is already several inputs ahead under latency
+	const FPredictionState* Predicted = PredictionComponent ? PredictionComponent->FindStateAtSequence(ServerState.AcknowledgedSequence) : nullptr;
+	if (!Predicted)
+	{
+		const float PositionError = FVector::Dist(Owner->GetActorLocation(), ServerState.AuthoritativePosition);
+		return PositionError > CorrectionThreshold ? MISPREDICTED_POSITION : 0;
+	}
 
-	// Check if error exceeds threshold
-	return PositionError > CorrectionThreshold;
+	return ComparePrediction(*Predicted, ServerState, CorrectionThreshold, VelocityCorrectionThreshold, StaminaCorrectionThreshold);
+}
+
+uint32 UNetworkReconciler::ComparePrediction(const FPredictionState& Predicted, const FStateUpdatePacket& ServerState,
+	float PositionThreshold, float VelocityThreshold, float StaminaThreshold)
+{
+	uint32 Fields = 0;
+	if (FVector::Dist(Predicted.Position, ServerState.AuthoritativePosition) > PositionThreshold)
+	{
+		Fields |= MISPREDICTED_POSITION;
+	}
+	if (FVector::Dist(Predicted.Velocity, ServerState.AuthoritativeVelocity) > VelocityThreshold)
+	{
+		Fields |= MISPREDICTED_VELOCITY;
+	}
+	if (FMath::Abs(Predicted.Stamina - ServerState.AuthoritativeStamina) > StaminaThreshold)
+	{
+		Fields |= MISPREDICTED_STAMINA;
+	}
+	if (Predicted.State != ServerState.AuthoritativeState)
+	{
+		Fields |= MISPREDICTED_STATE;
+	}
+	return Fields;
 }
 
 void UNetworkReconciler::OnServerCorrection(const FStateUpdatePacket& Correction)
@@ -76,17 +145,31 @@ void UNetworkReconciler::OnServerCorrection(const FStateUpdatePacket& Correction
 		return;
 	}
 
+	TotalServerUpdates++;
+	if (!PredictionComponent->FindStateAtSequence(Correction.AcknowledgedSequence))
+	{
+		PredictionHistoryMisses++;
+	}
+
 	// Check if reconciliation is needed
-	if (!NeedsReconciliation(Correction))
+	const uint32 MispredictedFields = GetMispredictedFields(Correction);
+	if (MispredictedFields == 0)
 	{
-		// Small error, just acknowledge and continue
+		// Prediction matched within tolerance, just acknowledge and continue
 		if (APocketStrikerPlayerController* PC = Cast<APocketStrikerPlayerController>(Owner->GetInstigatorController()))
 		{
 			PC->AcknowledgeInput(Correction.AcknowledgedSequence);
 		}
+		PredictionComponent->ClearAcknowledgedInputs(Correction.AcknowledgedSequence);
+		PredictionComponent->ClearOldStates(Correction.AcknowledgedSequence);
 		return;
 	}
 
+	PositionMispredictions += (MispredictedFields & MISPREDICTED_POSITION) ? 1 : 0;
+	VelocityMispredictions += (MispredictedFields & MISPREDICTED_VELOCITY) ? 1 : 0;
+	StaminaMispredictions += (MispredictedFields & MISPREDICTED_STAMINA) ? 1 : 0;
+	StateMispredictions += (MispredictedFields & MISPREDICTED_STATE) ? 1 : 0;
+
 	// Calculate correction delta for debugging
 	FVector CurrentPosition = Owner->GetActorLocation();
 	LastCorrectionDelta = Correction.AuthoritativePosition - CurrentPosition;
@@ -100,14 +183,26 @@ void UNetworkReconciler::OnServerCorrection(const FStateUpdatePacket& Correction
 		Profiler->RecordNetworkCorrection(CorrectionMagnitude);
 	}
 
-	// Apply server state
-	Owner->SetActorLocation(Correction.AuthoritativePosition);
-	MovementComponent->Velocity = Correction.AuthoritativeVelocity;
-	MovementComponent->CurrentStamina = Correction.AuthoritativeStamina;
-	StateMachine->CurrentState = static_cast<EPlayerState>(Correction.AuthoritativeState);
+	const FPredictionState* Predicted = PredictionComponent->FindStateAtSequence(Correction.AcknowledgedSequence);
+	const FVector PositionDelta = Predicted ? Correction.AuthoritativePosition - Predicted->Position : FVector::ZeroVector;
+	const FVector VelocityDelta = Predicted ? Correction.AuthoritativeVelocity - Predicted->Velocity : FVector::ZeroVector;
+	if (bShiftSmallCorrections && Predicted && CanShiftCorrection(MispredictedFields, PositionDelta, VelocityDelta, MaxShiftPositionDelta, MaxShiftVelocityDelta))
+	{
+		ShiftCorrection(Correction, PositionDelta, VelocityDelta);
+	}
+	else
+	{
+		ReplayedCorrections++;
 
-	// Replay unacknowledged inputs
-	ReplayInputs(Correction.AuthoritativePosition, Correction.AcknowledgedSequence);
+		// Apply server state
+		Owner->SetActorLocation(Correction.AuthoritativePosition);
+		MovementComponent->Velocity = Correction.AuthoritativeVelocity;
+		MovementComponent->CurrentStamina = Correction.AuthoritativeStamina;
+		StateMachine->CurrentState = static_cast<EPlayerState>(Correction.AuthoritativeState);
+
+		// Replay unacknowledged inputs
+		ReplayInputs(Correction.AuthoritativePosition, Correction.AcknowledgedSequence);
+	}
 
 	// Acknowledge the input
 	if (APocketStrikerPlayerController* PC = Cast<APocketStrikerPlayerController>(Owner->GetInstigatorController()))
@@ -115,7 +210,8 @@ void UNetworkReconciler::OnServerCorrection(const FStateUpdatePacket& Correction
 		PC->AcknowledgeInput(Correction.AcknowledgedSequence);
 	}
 
-	// Clean up old prediction states
+	// Clean up acknowledged inputs and old prediction states
+	PredictionComponent->ClearAcknowledgedInputs(Correction.AcknowledgedSequence);
 	PredictionComponent->ClearOldStates(Correction.AcknowledgedSequence);
 }
 
@@ -142,16 +238,47 @@ void UNetworkReconciler::ReplayInputs(const FVector& CorrectedPosition, uint32 F
 	// Get all inputs after the acknowledged sequence
 	TArray<FInputPacket> UnackedInputs = PredictionComponent->GetUnacknowledgedInputs(FromSequence);
 
-	// Replay each input
+	// Replay each input with the server's fixed step, the one it simulates them with
+	const float DeltaTime = 1.0f / FMath::Max(ServerTickRate, 1.0f);
 	for (const FInputPacket& Input : UnackedInputs)
 	{
-		// Simulate this input
-		// Note: DeltaTime should ideally be stored with the input, using fixed timestep for now
-		float DeltaTime = 1.0f / 60.0f; // Assume 60 FPS
 		PredictionComponent->SimulateInput(Input, DeltaTime);
 	}
 }
 
+void UNetworkReconciler::ShiftCorrection(const FStateUpdatePacket& Correction, const FVector& PositionDelta, const FVector& VelocityDelta)
+{
+	AActor* Owner = GetOwner();
+	ShiftedCorrections++;
+
+	// Same error on every later prediction, with the velocity error integrated; the inputs are not re-run
+	const FVector Shift = PredictionComponent->ShiftStatesFrom(Correction.AcknowledgedSequence, PositionDelta, VelocityDelta,
+		1.0f / FMath::Max(ServerTickRate, 1.0f));
+	Owner->SetActorLocation(Owner->GetActorLocation() + Shift);
+	MovementComponent->Velocity += VelocityDelta;
+
+	// The capsule jumps to the corrected path; the mesh stays where it was drawn and catches up
+	if (bEnableSmoothing)
+	{
+		VisualCorrectionOffset -= Shift;
+		ApplyVisualCorrectionOffset();
+	}
+}
+
+void UNetworkReconciler::ApplyVisualCorrectionOffset()
+{
+	ACharacter* Character = Cast<ACharacter>(GetOwner());
+	USkeletalMeshComponent* Mesh = Character ? Character->GetMesh() : nullptr;
+	if (!Mesh)
+	{
+		return;
+	}
+
+	// Relative location is in the capsule's frame, which turns with the character
+	Mesh->SetRelativeLocation(Character->GetBaseTranslationOffset()
+		+ Character->GetActorTransform().InverseTransformVectorNoScale(VisualCorrectionOffset));
+}
+
 void UNetworkReconciler::SmoothCorrection(const FVector& TargetPosition, float DeltaTime)
 {
 	AActor* Owner = GetOwner();
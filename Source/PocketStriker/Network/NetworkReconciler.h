@@ -26,26 +26,65 @@ public:
 	// Correction handling
 	void OnServerCorrection(const FStateUpdatePacket& Correction);
 	bool NeedsReconciliation(const FStateUpdatePacket& ServerState) const;
+
+	// Fields whose predicted value at the acknowledged sequence is outside tolerance
+	static constexpr uint32 MISPREDICTED_POSITION = 1 << 0;
+	static constexpr uint32 MISPREDICTED_VELOCITY = 1 << 1;
+	static constexpr uint32 MISPREDICTED_STAMINA = 1 << 2;
+	static constexpr uint32 MISPREDICTED_STATE = 1 << 3;
+	uint32 GetMispredictedFields(const FStateUpdatePacket& ServerState) const;
+
+	// The field check itself, against the state predicted for ServerState.AcknowledgedSequence; shared with the load harness
+	static uint32 ComparePrediction(const FPredictionState& Predicted, const FStateUpdatePacket& ServerState,
+		float PositionThreshold, float VelocityThreshold, float StaminaThreshold);
+
+	// Fraction of server updates that triggered a correction
+	UFUNCTION(BlueprintCallable, Category = "Debug")
+	float GetCorrectionRate() const { return TotalServerUpdates > 0 ? static_cast<float>(TotalCorrections) / TotalServerUpdates : 0.0f; }
 	
 	// State replay
 	void ReplayInputs(const FVector& CorrectedPosition, uint32 FromSequence);
+
+	// Whether a misprediction is small enough to shift the stored predictions by instead of replaying: only position
+	// and velocity diverged, each within its limit
+	static bool CanShiftCorrection(uint32 MispredictedFields, const FVector& PositionDelta, const FVector& VelocityDelta,
+		float MaxPositionDelta, float MaxVelocityDelta);
 	
 	// Smoothing
 	void SmoothCorrection(const FVector& TargetPosition, float DeltaTime);
 
 	// Apply network parameters
-	void ApplyNetworkParams(float InCorrectionThreshold, float InSmoothingSpeed);
+	void ApplyNetworkParams(float InCorrectionThreshold, float InSmoothingSpeed, float InVelocityCorrectionThreshold, float InStaminaCorrectionThreshold);
+	void ApplyCorrectionShiftParams(bool bInShiftSmallCorrections, float InMaxShiftPositionDelta, float InMaxShiftVelocityDelta, float InServerTickRate);
 
 	// Configuration
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network", meta = (ToolTip = "Distance threshold before correction in cm"))
 	float CorrectionThreshold = 10.0f;
 
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network", meta = (ToolTip = "Velocity difference from the predicted state before correction in cm/s"))
+	float VelocityCorrectionThreshold = 30.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network", meta = (ToolTip = "Stamina difference from the predicted state before correction"))
+	float StaminaCorrectionThreshold = 2.0f;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network", meta = (ToolTip = "Speed of correction smoothing"))
 	float SmoothingSpeed = 10.0f;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network", meta = (ToolTip = "Enable visual smoothing for small corrections"))
 	bool bEnableSmoothing = true;
 
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network", meta = (ToolTip = "Correct small position and velocity errors by shifting the stored predictions instead of replaying unacknowledged inputs"))
+	bool bShiftSmallCorrections = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network", meta = (ToolTip = "Largest position error at the acknowledged input corrected by shifting, in cm"))
+	float MaxShiftPositionDelta = 50.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network", meta = (ToolTip = "Largest velocity error at the acknowledged input corrected by shifting, in cm/s"))
+	float MaxShiftVelocityDelta = 150.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network", meta = (ToolTip = "Server simulation rate; a shift carries the velocity error forward one server step per input"))
+	float ServerTickRate = 60.0f;
+
 	// Debug info
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Debug")
 	FVector LastCorrectionDelta;
@@ -56,6 +95,33 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Debug")
 	int32 TotalCorrections = 0;
 
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Debug")
+	int32 TotalServerUpdates = 0;
+
+	// Updates whose acked sequence had no stored prediction, checked against the current position instead
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Debug")
+	int32 PredictionHistoryMisses = 0;
+
+	// Corrections broken down by the field that diverged (one correction can count several)
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Debug")
+	int32 PositionMispredictions = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Debug")
+	int32 VelocityMispredictions = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Debug")
+	int32 StaminaMispredictions = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Debug")
+	int32 StateMispredictions = 0;
+
+	// Corrections handled by shifting the stored predictions, and by snapping and replaying inputs
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Debug")
+	int32 ShiftedCorrections = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Debug")
+	int32 ReplayedCorrections = 0;
+
 	// Path visualization
 	UFUNCTION(BlueprintCallable, Category = "Debug")
 	TArray<FVector> GetReconciledPath() const { return ReconciledPath; }
@@ -78,10 +144,19 @@ private:
 	UPROPERTY()
 	UPlayerStateMachine* StateMachine;
 
+	// Shifts the predictions from the acknowledged input on and moves the character with them
+	void ShiftCorrection(const FStateUpdatePacket& Correction, const FVector& PositionDelta, const FVector& VelocityDelta);
+
+	// Offsets the mesh from the capsule by VisualCorrectionOffset
+	void ApplyVisualCorrectionOffset();
+
 	// Smoothing state
 	FVector SmoothingTarget;
 	bool bIsSmoothing = false;
 
+	// Where the mesh is drawn relative to the simulated position after a shift, decaying at SmoothingSpeed
+	FVector VisualCorrectionOffset = FVector::ZeroVector;
+
 	// Path history for visualization
 	TArray<FVector> ReconciledPath;
 	static constexpr int32 MaxPathPoints = 100;
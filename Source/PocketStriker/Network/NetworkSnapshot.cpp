@@ -0,0 +1,352 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "NetworkSnapshot.h"
+#include "NetPacketChecksum.h"
+#include "Serialization/BitWriter.h"
+#include "Serialization/BitReader.h"
+
+void FEntitySnapshotState::Quantize(const FNetQuantizationSettings& Settings)
+{
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		Position[Axis] = FNetQuantize::DequantizePositionAxis(
+			FNetQuantize::QuantizePositionAxis(Position[Axis], Axis, Settings), Axis, Settings);
+		Velocity[Axis] = FNetQuantize::DequantizeVelocityAxis(
+			FNetQuantize::QuantizeVelocityAxis(Velocity[Axis], Settings), Settings);
+	}
+	Stamina = FNetQuantize::DequantizeStamina(FNetQuantize::QuantizeStamina(Stamina, Settings), Settings);
+	State = FMath::Min<uint8>(State, 7);
+}
+
+void FEntitySnapshotState::NetSerialize(FArchive& Ar, const FNetQuantizationSettings& Settings, FNetFieldBitCounter* Counter)
+{
+	FNetQuantize::SerializePosition(Ar, Position, Settings);
+	if (Counter)
+	{
+		Counter->Mark(ENetFieldGroup::Position);
+	}
+
+	FNetQuantize::SerializeVelocity(Ar, Velocity, Settings);
+	if (Counter)
+	{
+		Counter->Mark(ENetFieldGroup::Velocity);
+	}
+
+	uint32 StateValue = State;
+	Ar.SerializeInt(StateValue, 8);
+	State = static_cast<uint8>(StateValue);
+	if (Counter)
+	{
+		Counter->Mark(ENetFieldGroup::State);
+	}
+
+	FNetQuantize::SerializeStamina(Ar, Stamina, Settings);
+	if (Counter)
+	{
+		Counter->Mark(ENetFieldGroup::Stamina);
+	}
+}
+
+void FEntitySnapshotState::NetSerializeDelta(FArchive& Ar, const FEntitySnapshotState& Baseline, const FNetQuantizationSettings& Settings,
+	FNetFieldBitCounter* Counter)
+{
+	// Work out which fields differ from the baseline once quantized
+	uint32 FieldMask = 0;
+	if (Ar.IsSaving())
+	{
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			if (FNetQuantize::QuantizePositionAxis(Position[Axis], Axis, Settings) !=
+				FNetQuantize::QuantizePositionAxis(Baseline.Position[Axis], Axis, Settings))
+			{
+				FieldMask |= DELTA_POSITION_X << Axis;
+			}
+
+			if (FNetQuantize::QuantizeVelocityAxis(Velocity[Axis], Settings) !=
+				FNetQuantize::QuantizeVelocityAxis(Baseline.Velocity[Axis], Settings))
+			{
+				FieldMask |= DELTA_VELOCITY_X << Axis;
+			}
+		}
+
+		if (State != Baseline.State)
+		{
+			FieldMask |= DELTA_STATE;
+		}
+
+		if (FNetQuantize::QuantizeStamina(Stamina, Settings) != FNetQuantize::QuantizeStamina(Baseline.Stamina, Settings))
+		{
+			FieldMask |= DELTA_STAMINA;
+		}
+	}
+
+	Ar.SerializeInt(FieldMask, 1 << DELTA_FIELD_COUNT);
+	if (Counter)
+	{
+		Counter->Mark(ENetFieldGroup::Header);
+	}
+
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		if (FieldMask & (DELTA_POSITION_X << Axis))
+		{
+			FNetQuantize::SerializePositionAxis(Ar, Position[Axis], Axis, Settings);
+		}
+		else
+		{
+			Position[Axis] = Baseline.Position[Axis];
+		}
+	}
+	if (Counter)
+	{
+		Counter->Mark(ENetFieldGroup::Position);
+	}
+
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		if (FieldMask & (DELTA_VELOCITY_X << Axis))
+		{
+			FNetQuantize::SerializeVelocityAxis(Ar, Velocity[Axis], Settings);
+		}
+		else
+		{
+			Velocity[Axis] = Baseline.Velocity[Axis];
+		}
+	}
+	if (Counter)
+	{
+		Counter->Mark(ENetFieldGroup::Velocity);
+	}
+
+	if (FieldMask & DELTA_STATE)
+	{
+		uint32 StateValue = State;
+		Ar.SerializeInt(StateValue, 8);
+		State = static_cast<uint8>(StateValue);
+	}
+	else
+	{
+		State = Baseline.State;
+	}
+	if (Counter)
+	{
+		Counter->Mark(ENetFieldGroup::State);
+	}
+
+	if (FieldMask & DELTA_STAMINA)
+	{
+		FNetQuantize::SerializeStamina(Ar, Stamina, Settings);
+	}
+	else
+	{
+		Stamina = Baseline.Stamina;
+	}
+	if (Counter)
+	{
+		Counter->Mark(ENetFieldGroup::Stamina);
+	}
+}
+
+const FEntitySnapshotState* FWorldSnapshot::FindEntity(uint32 EntityId) const
+{
+	for (const FEntitySnapshotState& Entity : Entities)
+	{
+		if (Entity.EntityId == EntityId)
+		{
+			return &Entity;
+		}
+	}
+	return nullptr;
+}
+
+FStateUpdatePacket FWorldSnapshot::MakeStateUpdate(const FEntitySnapshotState& Entity) const
+{
+	FStateUpdatePacket Packet;
+	Packet.AcknowledgedSequence = AcknowledgedSequence;
+	Packet.ServerTimestamp = ServerTimestamp;
+	Packet.AuthoritativePosition = Entity.Position;
+	Packet.AuthoritativeVelocity = Entity.Velocity;
+	Packet.AuthoritativeState = Entity.State;
+	Packet.AuthoritativeStamina = Entity.Stamina;
+	return Packet;
+}
+
+FWorldSnapshotEncodeCache::FWorldSnapshotEncodeCache(FWorldSnapshot& World, const FNetQuantizationSettings& Settings)
+{
+	World.ServerTimestamp = FNetQuantize::QuantizeTimestamp(World.ServerTimestamp) / 1000.0f;
+
+	EncodedEntities.SetNum(World.Entities.Num());
+	for (int32 i = 0; i < World.Entities.Num(); ++i)
+	{
+		FEntitySnapshotState& Entity = World.Entities[i];
+		Entity.Quantize(Settings);
+
+		FBitWriter Writer(0, true);
+		FNetFieldBitCounter Counter(Writer, EncodedEntities[i].FieldBits);
+		Entity.NetSerialize(Writer, Settings, &Counter);
+
+		EncodedEntities[i].NumBits = Writer.GetNumBits();
+		EncodedEntities[i].Data = TArray<uint8>(Writer.GetData(), Writer.GetNumBytes());
+	}
+}
+
+void FWorldSnapshotEncodeCache::WriteFullEntity(FBitWriter& Writer, int32 EntityIndex) const
+{
+	const FEncodedEntity& Encoded = EncodedEntities[EntityIndex];
+	Writer.SerializeBits(const_cast<uint8*>(Encoded.Data.GetData()), Encoded.NumBits);
+}
+
+bool FWorldSnapshotCodec::Encode(FBitWriter& Writer, FClientSnapshotChannel& Channel, const FWorldSnapshot& World,
+	const FWorldSnapshotEncodeCache& SharedEncodings, const TArray<int32>& EntityIndices, uint32 AcknowledgedSequence,
+	uint32 MaxBaselineAge, const FNetQuantizationSettings& Settings, FNetFieldBits* OutFieldBits)
+{
+	FNetFieldBits LocalFieldBits;
+	FNetFieldBitCounter Counter(Writer, OutFieldBits ? *OutFieldBits : LocalFieldBits);
+	FNetPacketChecksum::Reserve(Writer);
+	Counter.Mark(ENetFieldGroup::Checksum);
+
+	uint32 SnapshotId = Channel.NextSnapshotId++;
+
+	// Use the acked baseline only while it is recent enough to still be in both histories
+	const uint32 BaselineAge = SnapshotId - Channel.LastAckedSnapshotId;
+	const uint32 MaxAge = FMath::Min(MaxBaselineAge, FWorldSnapshotHistory::Capacity - 1);
+	const FWorldSnapshot* Baseline = nullptr;
+	if (Channel.LastAckedSnapshotId != 0 && BaselineAge <= MaxAge)
+	{
+		Baseline = Channel.SentHistory.Find(Channel.LastAckedSnapshotId);
+	}
+
+	// Record exactly what this client receives, so later deltas compare against its view
+	FWorldSnapshot Sent;
+	Sent.AcknowledgedSequence = AcknowledgedSequence;
+	Sent.ServerTimestamp = World.ServerTimestamp;
+	Sent.PossessingEntityId = World.PossessingEntityId;
+
+	uint32 BaselineOffset = Baseline ? BaselineAge : 0;
+	Writer.SerializeIntPacked(SnapshotId);
+	Writer.SerializeIntPacked(BaselineOffset);
+
+	FNetQuantize::SerializeSequence(Writer, Sent.AcknowledgedSequence, Baseline ? Baseline->AcknowledgedSequence : 0);
+	if (Baseline)
+	{
+		FNetQuantize::SerializeTimestamp(Writer, Sent.ServerTimestamp, Baseline->ServerTimestamp);
+	}
+	else
+	{
+		FNetQuantize::SerializeTimestamp(Writer, Sent.ServerTimestamp);
+	}
+	Writer.SerializeIntPacked(Sent.PossessingEntityId);
+
+	uint32 EntityCount = FMath::Min(static_cast<uint32>(EntityIndices.Num()), MaxEntities);
+	Writer.SerializeIntPacked(EntityCount);
+	Counter.Mark(ENetFieldGroup::Header);
+
+	Sent.Entities.Reserve(EntityCount);
+	for (uint32 i = 0; i < EntityCount; ++i)
+	{
+		const int32 EntityIndex = EntityIndices[i];
+		FEntitySnapshotState& Entity = Sent.Entities.Add_GetRef(World.Entities[EntityIndex]);
+		Writer.SerializeIntPacked(Entity.EntityId);
+		Counter.Mark(ENetFieldGroup::Header);
+
+		const FEntitySnapshotState* EntityBaseline = Baseline ? Baseline->FindEntity(Entity.EntityId) : nullptr;
+		if (EntityBaseline)
+		{
+			const int64 DeltaStart = Counter.GetPosition();
+			Entity.NetSerializeDelta(Writer, *EntityBaseline, Settings, &Counter);
+			Counter.AddDeltaSaved(SharedEncodings.GetFullEntityBits(EntityIndex) - (Counter.GetPosition() - DeltaStart));
+		}
+		else
+		{
+			SharedEncodings.WriteFullEntity(Writer, EntityIndex);
+			Counter.Add(SharedEncodings.GetFullEntityFieldBits(EntityIndex));
+		}
+	}
+
+	FNetPacketChecksum::Seal(Writer);
+
+	Channel.SentHistory.Add(SnapshotId, Sent);
+
+	return Baseline != nullptr;
+}
+
+bool FWorldSnapshotCodec::Decode(FBitReader& Reader, const FWorldSnapshotHistory& ReceivedHistory,
+	const FNetQuantizationSettings& Settings, uint32& OutSnapshotId, FWorldSnapshot& OutSnapshot, FNetFieldBits* OutFieldBits)
+{
+	// Nothing is parsed out of a corrupt packet
+	if (!FNetPacketChecksum::Verify(MakeArrayView(Reader.GetData(), static_cast<int32>(Reader.GetNumBytes()))))
+	{
+		return false;
+	}
+
+	FNetFieldBits LocalFieldBits;
+	FNetFieldBitCounter Counter(Reader, OutFieldBits ? *OutFieldBits : LocalFieldBits);
+	FNetPacketChecksum::Skip(Reader);
+	Counter.Mark(ENetFieldGroup::Checksum);
+
+	uint32 SnapshotId = 0;
+	uint32 BaselineOffset = 0;
+	Reader.SerializeIntPacked(SnapshotId);
+	Reader.SerializeIntPacked(BaselineOffset);
+
+	if (Reader.IsError())
+	{
+		return false;
+	}
+
+	const FWorldSnapshot* Baseline = nullptr;
+	if (BaselineOffset != 0)
+	{
+		Baseline = ReceivedHistory.Find(SnapshotId - BaselineOffset);
+		if (!Baseline)
+		{
+			return false;
+		}
+	}
+
+	OutSnapshot.Entities.Reset();
+	FNetQuantize::SerializeSequence(Reader, OutSnapshot.AcknowledgedSequence, Baseline ? Baseline->AcknowledgedSequence : 0);
+	if (Baseline)
+	{
+		FNetQuantize::SerializeTimestamp(Reader, OutSnapshot.ServerTimestamp, Baseline->ServerTimestamp);
+	}
+	else
+	{
+		FNetQuantize::SerializeTimestamp(Reader, OutSnapshot.ServerTimestamp);
+	}
+	Reader.SerializeIntPacked(OutSnapshot.PossessingEntityId);
+
+	uint32 EntityCount = 0;
+	Reader.SerializeIntPacked(EntityCount);
+	Counter.Mark(ENetFieldGroup::Header);
+	if (Reader.IsError() || EntityCount > MaxEntities)
+	{
+		return false;
+	}
+
+	OutSnapshot.Entities.Reserve(EntityCount);
+	for (uint32 i = 0; i < EntityCount && !Reader.IsError(); ++i)
+	{
+		FEntitySnapshotState& Entity = OutSnapshot.Entities.AddDefaulted_GetRef();
+		Reader.SerializeIntPacked(Entity.EntityId);
+		Counter.Mark(ENetFieldGroup::Header);
+
+		const FEntitySnapshotState* EntityBaseline = Baseline ? Baseline->FindEntity(Entity.EntityId) : nullptr;
+		if (EntityBaseline)
+		{
+			Entity.NetSerializeDelta(Reader, *EntityBaseline, Settings, &Counter);
+		}
+		else
+		{
+			Entity.NetSerialize(Reader, Settings, &Counter);
+		}
+	}
+
+	if (Reader.IsError())
+	{
+		return false;
+	}
+
+	OutSnapshotId = SnapshotId;
+	return true;
+}
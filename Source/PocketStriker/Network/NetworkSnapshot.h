@@ -0,0 +1,204 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NetworkTypes.h"
+#include "NetTrafficStats.h"
+
+class FBitWriter;
+class FBitReader;
+
+/**
+ * Replicated state of one entity (player or ball) inside a world snapshot
+ */
+struct POCKETSTRIKER_API FEntitySnapshotState
+{
+	uint32 EntityId = 0;
+	FVector Position = FVector::ZeroVector;
+	FVector Velocity = FVector::ZeroVector;
+	uint8 State = 0; // EPlayerState as uint8, 0 for the ball
+	float Stamina = 0.0f;
+
+	// Snap fields to the quantization grid so the sender keeps what the receiver will see
+	void Quantize(const FNetQuantizationSettings& Settings);
+
+	// Full bit-packed encoding (EntityId is written by the snapshot); Counter, if given, is charged per field group
+	void NetSerialize(FArchive& Ar, const FNetQuantizationSettings& Settings, FNetFieldBitCounter* Counter = nullptr);
+
+	// Field-mask delta against a baseline both ends hold; unchanged fields cost one mask bit
+	void NetSerializeDelta(FArchive& Ar, const FEntitySnapshotState& Baseline, const FNetQuantizationSettings& Settings,
+		FNetFieldBitCounter* Counter = nullptr);
+
+	// Field mask bits used by NetSerializeDelta
+	static constexpr uint32 DELTA_POSITION_X = 1 << 0;
+	static constexpr uint32 DELTA_POSITION_Y = 1 << 1;
+	static constexpr uint32 DELTA_POSITION_Z = 1 << 2;
+	static constexpr uint32 DELTA_VELOCITY_X = 1 << 3;
+	static constexpr uint32 DELTA_VELOCITY_Y = 1 << 4;
+	static constexpr uint32 DELTA_VELOCITY_Z = 1 << 5;
+	static constexpr uint32 DELTA_STATE = 1 << 6;
+	static constexpr uint32 DELTA_STAMINA = 1 << 7;
+	static constexpr uint32 DELTA_FIELD_COUNT = 8;
+};
+
+/**
+ * Everything a client needs for one server tick: every relevant player, the ball and possession,
+ * plus the per-client input acknowledgement
+ */
+struct POCKETSTRIKER_API FWorldSnapshot
+{
+	// Entity ids: 0 is reserved for "none", the ball is 1, players are their PlayerId offset by 2
+	static constexpr uint32 InvalidEntityId = 0;
+	static constexpr uint32 BallEntityId = 1;
+	static uint32 MakePlayerEntityId(int32 PlayerId) { return static_cast<uint32>(PlayerId) + 2; }
+
+	uint32 AcknowledgedSequence = 0;
+	float ServerTimestamp = 0.0f;
+	uint32 PossessingEntityId = InvalidEntityId;
+	TArray<FEntitySnapshotState> Entities;
+
+	const FEntitySnapshotState* FindEntity(uint32 EntityId) const;
+
+	// Convert an entity into the packet type consumed by reconciliation and interpolation
+	FStateUpdatePacket MakeStateUpdate(const FEntitySnapshotState& Entity) const;
+};
+
+/**
+ * Fixed-size history of snapshots indexed by snapshot id
+ * Kept by the server for every snapshot it sends and by the client for every snapshot it receives,
+ * so both ends can resolve the same delta baseline
+ */
+template<typename SnapshotType, uint32 InCapacity>
+class TSnapshotHistory
+{
+public:
+	static constexpr uint32 Capacity = InCapacity;
+
+	void Add(uint32 SnapshotId, const SnapshotType& Snapshot)
+	{
+		FRecord& Record = Records[SnapshotId % Capacity];
+		Record.SnapshotId = SnapshotId;
+		Record.bValid = true;
+		Record.Snapshot = Snapshot;
+	}
+
+	const SnapshotType* Find(uint32 SnapshotId) const
+	{
+		const FRecord& Record = Records[SnapshotId % Capacity];
+
+		// A slot reused by a newer snapshot means the requested one has been overwritten
+		if (!Record.bValid || Record.SnapshotId != SnapshotId)
+		{
+			return nullptr;
+		}
+
+		return &Record.Snapshot;
+	}
+
+	void Reset()
+	{
+		for (FRecord& Record : Records)
+		{
+			Record.bValid = false;
+		}
+	}
+
+private:
+	struct FRecord
+	{
+		uint32 SnapshotId = 0;
+		bool bValid = false;
+		SnapshotType Snapshot;
+	};
+
+	FRecord Records[Capacity];
+};
+
+typedef TSnapshotHistory<FWorldSnapshot, 32> FWorldSnapshotHistory;
+
+/**
+ * Send priority of one entity towards one client
+ * The accumulator grows every broadcast the entity is left out and resets when it is sent
+ */
+struct FEntitySendPriority
+{
+	float Accumulator = 0.0f;
+	float TimeSinceLastSent = 0.0f;
+
+	// Sends in the current measurement window, and the rate measured over the last full window
+	int32 SendsInWindow = 0;
+	float SendRate = 0.0f;
+};
+
+/**
+ * Per-client snapshot bookkeeping on the server
+ */
+struct FClientSnapshotChannel
+{
+	// Snapshot ids start at 1 so 0 can mean "nothing acknowledged"
+	uint32 NextSnapshotId = 1;
+	uint32 LastAckedSnapshotId = 0;
+	FWorldSnapshotHistory SentHistory;
+
+	// Keyed by entity id
+	TMap<uint32, FEntitySendPriority> EntityPriorities;
+};
+
+/**
+ * Full encodings of every entity in the tick's world state
+ * Built once per tick and spliced into each client's packet wherever no delta baseline exists
+ */
+class POCKETSTRIKER_API FWorldSnapshotEncodeCache
+{
+public:
+	// Quantizes World in place, so the caller holds exactly what clients will decode
+	FWorldSnapshotEncodeCache(FWorldSnapshot& World, const FNetQuantizationSettings& Settings);
+
+	void WriteFullEntity(FBitWriter& Writer, int32 EntityIndex) const;
+
+	// Size of the full encoding; a delta never costs more than this plus its field mask
+	int64 GetFullEntityBits(int32 EntityIndex) const { return EncodedEntities[EntityIndex].NumBits; }
+
+	// The full encoding's bits split by field group
+	const FNetFieldBits& GetFullEntityFieldBits(int32 EntityIndex) const { return EncodedEntities[EntityIndex].FieldBits; }
+
+private:
+	struct FEncodedEntity
+	{
+		TArray<uint8> Data;
+		int64 NumBits = 0;
+		FNetFieldBits FieldBits;
+	};
+
+	TArray<FEncodedEntity> EncodedEntities;
+};
+
+/**
+ * Encodes world snapshots as per-entity field-mask deltas against the newest baseline the client acknowledged
+ * Wire format: CRC32C of the rest (FNetPacketChecksum), SnapshotId, SnapshotId - BaselineId (0 = full),
+ * acked input sequence, timestamp, possessing entity, entity count, then EntityId + full or delta state per entity
+ */
+struct POCKETSTRIKER_API FWorldSnapshotCodec
+{
+	// Server side: writes the listed entities of World for one client into an empty writer and records what was sent
+	// Returns true if a baseline was used, false if the snapshot went out in full
+	// OutFieldBits, if given, receives the packet's bits per field group and what delta encoding saved
+	static bool Encode(FBitWriter& Writer, FClientSnapshotChannel& Channel, const FWorldSnapshot& World,
+		const FWorldSnapshotEncodeCache& SharedEncodings, const TArray<int32>& EntityIndices, uint32 AcknowledgedSequence,
+		uint32 MaxBaselineAge, const FNetQuantizationSettings& Settings, FNetFieldBits* OutFieldBits = nullptr);
+
+	// Client side: reads a snapshot, resolving its baseline from the received history
+	// Fails if the packet is corrupt or references a baseline the client no longer holds
+	// OutFieldBits gets the split by field group only; what delta encoding saved is known to the encoder alone
+	static bool Decode(FBitReader& Reader, const FWorldSnapshotHistory& ReceivedHistory,
+		const FNetQuantizationSettings& Settings, uint32& OutSnapshotId, FWorldSnapshot& OutSnapshot,
+		FNetFieldBits* OutFieldBits = nullptr);
+
+	// Upper bound on entities per snapshot, guards the decoder against corrupt counts
+	static constexpr uint32 MaxEntities = 128;
+
+	// Conservative wire cost estimates used when packing a snapshot against a byte budget
+	static constexpr int64 HeaderBitsEstimate = 144;
+	static constexpr int64 EntityOverheadBitsEstimate = 8 + FEntitySnapshotState::DELTA_FIELD_COUNT;
+};
@@ -1,19 +1,41 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "NetworkTypes.h"
+#include "NetTrafficStats.h"
+#include "NetPacketChecksum.h"
+
+namespace
+{
+	// Fields copied back to back in Serialize order and hashed in one pass, so a swapped or shifted field changes the hash
+	template<int32 Capacity>
+	struct TChecksumImage
+	{
+		uint8 Bytes[Capacity];
+		int32 Num = 0;
+
+		template<typename T>
+		void Add(const T& Value)
+		{
+			checkSlow(Num + static_cast<int32>(sizeof(T)) <= Capacity);
+			FMemory::Memcpy(Bytes + Num, &Value, sizeof(T));
+			Num += sizeof(T);
+		}
+
+		uint32 Compute() const { return FNetCrc32C::Compute(Bytes, Num); }
+	};
+}
 
-// Simple checksum calculation using XOR of all data
 uint32 FInputPacket::CalculateChecksum() const
 {
-	uint32 Hash = 0;
-	Hash ^= SequenceNumber;
-	Hash ^= *reinterpret_cast<const uint32*>(&ClientTimestamp);
-	Hash ^= *reinterpret_cast<const uint32*>(&MovementInput.X);
-	Hash ^= *reinterpret_cast<const uint32*>(&MovementInput.Y);
-	Hash ^= *reinterpret_cast<const uint32*>(&LookInput.X);
-	Hash ^= *reinterpret_cast<const uint32*>(&LookInput.Y);
-	Hash ^= ActionFlags;
-	return Hash;
+	TChecksumImage<64> Image;
+	Image.Add(SequenceNumber);
+	Image.Add(ClientTimestamp);
+	Image.Add(MovementInput.X);
+	Image.Add(MovementInput.Y);
+	Image.Add(LookInput.X);
+	Image.Add(LookInput.Y);
+	Image.Add(ActionFlags);
+	return Image.Compute();
 }
 
 bool FInputPacket::IsValid() const
@@ -24,7 +46,11 @@ bool FInputPacket::IsValid() const
 		return false;
 	}
 
-	// Validate input ranges
+	return IsInRange();
+}
+
+bool FInputPacket::IsInRange() const
+{
 	if (MovementInput.X < -1.0f || MovementInput.X > 1.0f ||
 		MovementInput.Y < -1.0f || MovementInput.Y > 1.0f)
 	{
@@ -69,18 +95,18 @@ bool FInputPacket::Serialize(FArchive& Ar)
 
 uint32 FStateUpdatePacket::CalculateChecksum() const
 {
-	uint32 Hash = 0;
-	Hash ^= AcknowledgedSequence;
-	Hash ^= *reinterpret_cast<const uint32*>(&ServerTimestamp);
-	Hash ^= *reinterpret_cast<const uint32*>(&AuthoritativePosition.X);
-	Hash ^= *reinterpret_cast<const uint32*>(&AuthoritativePosition.Y);
-	Hash ^= *reinterpret_cast<const uint32*>(&AuthoritativePosition.Z);
-	Hash ^= *reinterpret_cast<const uint32*>(&AuthoritativeVelocity.X);
-	Hash ^= *reinterpret_cast<const uint32*>(&AuthoritativeVelocity.Y);
-	Hash ^= *reinterpret_cast<const uint32*>(&AuthoritativeVelocity.Z);
-	Hash ^= static_cast<uint32>(AuthoritativeState);
-	Hash ^= *reinterpret_cast<const uint32*>(&AuthoritativeStamina);
-	return Hash;
+	TChecksumImage<80> Image;
+	Image.Add(AcknowledgedSequence);
+	Image.Add(ServerTimestamp);
+	Image.Add(AuthoritativePosition.X);
+	Image.Add(AuthoritativePosition.Y);
+	Image.Add(AuthoritativePosition.Z);
+	Image.Add(AuthoritativeVelocity.X);
+	Image.Add(AuthoritativeVelocity.Y);
+	Image.Add(AuthoritativeVelocity.Z);
+	Image.Add(AuthoritativeState);
+	Image.Add(AuthoritativeStamina);
+	return Image.Compute();
 }
 
 bool FStateUpdatePacket::IsValid() const
@@ -91,6 +117,11 @@ bool FStateUpdatePacket::IsValid() const
 		return false;
 	}
 
+	return IsInRange();
+}
+
+bool FStateUpdatePacket::IsInRange() const
+{
 	// Validate stamina range
 	if (AuthoritativeStamina < 0.0f || AuthoritativeStamina > 200.0f)
 	{
@@ -135,3 +166,306 @@ bool FStateUpdatePacket::Serialize(FArchive& Ar)
 	
 	return true;
 }
+
+uint32 FNetQuantize::QuantizeAxis(double Value, const FNetQuantizationSettings& Settings)
+{
+	const double Scale = Settings.GetAxisScale();
+	const double Clamped = FMath::Clamp(Value, -1.0, 1.0);
+	return static_cast<uint32>(FMath::RoundToInt((Clamped + 1.0) * Scale));
+}
+
+double FNetQuantize::DequantizeAxis(uint32 Code, const FNetQuantizationSettings& Settings)
+{
+	const double Scale = Settings.GetAxisScale();
+	return static_cast<double>(Code) / Scale - 1.0;
+}
+
+void FNetQuantize::SerializeAxis(FArchive& Ar, double& Value, const FNetQuantizationSettings& Settings)
+{
+	// Codes run from 0 to 2 * Scale, which fits exactly in AxisBits
+	const uint32 CodeCount = static_cast<uint32>(Settings.GetAxisScale()) * 2 + 1;
+
+	uint32 Code = Ar.IsSaving() ? QuantizeAxis(Value, Settings) : 0;
+	Ar.SerializeInt(Code, CodeCount);
+	Value = DequantizeAxis(FMath::Min(Code, CodeCount - 1), Settings);
+}
+
+uint32 FNetQuantize::GetPositionAxisCodeCount(int32 Axis, const FNetQuantizationSettings& Settings)
+{
+	const double Range = FMath::Max(0.0, Settings.PitchMax[Axis] - Settings.PitchMin[Axis]);
+	const double Resolution = FMath::Max(Settings.PositionResolution, KINDA_SMALL_NUMBER);
+	return static_cast<uint32>(FMath::CeilToInt(Range / Resolution)) + 1;
+}
+
+uint32 FNetQuantize::QuantizePositionAxis(double Value, int32 Axis, const FNetQuantizationSettings& Settings)
+{
+	const double Resolution = FMath::Max(Settings.PositionResolution, KINDA_SMALL_NUMBER);
+	const double Clamped = FMath::Clamp(Value, Settings.PitchMin[Axis], Settings.PitchMax[Axis]);
+	const uint32 Code = static_cast<uint32>(FMath::RoundToInt((Clamped - Settings.PitchMin[Axis]) / Resolution));
+	return FMath::Min(Code, GetPositionAxisCodeCount(Axis, Settings) - 1);
+}
+
+double FNetQuantize::DequantizePositionAxis(uint32 Code, int32 Axis, const FNetQuantizationSettings& Settings)
+{
+	const double Resolution = FMath::Max(Settings.PositionResolution, KINDA_SMALL_NUMBER);
+	return Settings.PitchMin[Axis] + static_cast<double>(Code) * Resolution;
+}
+
+void FNetQuantize::SerializePositionAxis(FArchive& Ar, double& Value, int32 Axis, const FNetQuantizationSettings& Settings)
+{
+	const uint32 CodeCount = GetPositionAxisCodeCount(Axis, Settings);
+
+	uint32 Code = Ar.IsSaving() ? QuantizePositionAxis(Value, Axis, Settings) : 0;
+	Ar.SerializeInt(Code, CodeCount);
+	Value = DequantizePositionAxis(FMath::Min(Code, CodeCount - 1), Axis, Settings);
+}
+
+void FNetQuantize::SerializePosition(FArchive& Ar, FVector& Value, const FNetQuantizationSettings& Settings)
+{
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		SerializePositionAxis(Ar, Value[Axis], Axis, Settings);
+	}
+}
+
+uint32 FNetQuantize::GetVelocityAxisCodeCount(const FNetQuantizationSettings& Settings)
+{
+	const double Resolution = FMath::Max(Settings.VelocityResolution, KINDA_SMALL_NUMBER);
+	return static_cast<uint32>(FMath::CeilToInt(Settings.MaxQuantizedSpeed / Resolution)) * 2 + 1;
+}
+
+uint32 FNetQuantize::QuantizeVelocityAxis(double Value, const FNetQuantizationSettings& Settings)
+{
+	const double Resolution = FMath::Max(Settings.VelocityResolution, KINDA_SMALL_NUMBER);
+	const int32 Offset = static_cast<int32>(GetVelocityAxisCodeCount(Settings) / 2);
+	const int32 Steps = FMath::Clamp(FMath::RoundToInt(Value / Resolution), -Offset, Offset);
+	return static_cast<uint32>(Steps + Offset);
+}
+
+double FNetQuantize::DequantizeVelocityAxis(uint32 Code, const FNetQuantizationSettings& Settings)
+{
+	const double Resolution = FMath::Max(Settings.VelocityResolution, KINDA_SMALL_NUMBER);
+	const int32 Offset = static_cast<int32>(GetVelocityAxisCodeCount(Settings) / 2);
+	return static_cast<double>(static_cast<int32>(Code) - Offset) * Resolution;
+}
+
+void FNetQuantize::SerializeVelocityAxis(FArchive& Ar, double& Value, const FNetQuantizationSettings& Settings)
+{
+	const uint32 CodeCount = GetVelocityAxisCodeCount(Settings);
+
+	uint32 Code = Ar.IsSaving() ? QuantizeVelocityAxis(Value, Settings) : 0;
+	Ar.SerializeInt(Code, CodeCount);
+	Value = DequantizeVelocityAxis(FMath::Min(Code, CodeCount - 1), Settings);
+}
+
+void FNetQuantize::SerializeVelocity(FArchive& Ar, FVector& Value, const FNetQuantizationSettings& Settings)
+{
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		SerializeVelocityAxis(Ar, Value[Axis], Settings);
+	}
+}
+
+uint32 FNetQuantize::QuantizeStamina(float Value, const FNetQuantizationSettings& Settings)
+{
+	const float MaxStamina = FMath::Max(Settings.MaxQuantizedStamina, KINDA_SMALL_NUMBER);
+	const float Normalized = FMath::Clamp(Value / MaxStamina, 0.0f, 1.0f);
+	return static_cast<uint32>(FMath::RoundToInt(Normalized * Settings.GetStaminaSteps()));
+}
+
+float FNetQuantize::DequantizeStamina(uint32 Code, const FNetQuantizationSettings& Settings)
+{
+	return static_cast<float>(Code) / Settings.GetStaminaSteps() * Settings.MaxQuantizedStamina;
+}
+
+void FNetQuantize::SerializeStamina(FArchive& Ar, float& Value, const FNetQuantizationSettings& Settings)
+{
+	const uint32 CodeCount = Settings.GetStaminaSteps() + 1;
+
+	uint32 Code = Ar.IsSaving() ? QuantizeStamina(Value, Settings) : 0;
+	Ar.SerializeInt(Code, CodeCount);
+	Value = DequantizeStamina(FMath::Min(Code, CodeCount - 1), Settings);
+}
+
+void FNetQuantize::SerializeTimestamp(FArchive& Ar, float& Value)
+{
+	uint32 Milliseconds = Ar.IsSaving() ? QuantizeTimestamp(Value) : 0;
+	Ar.SerializeIntPacked(Milliseconds);
+	Value = static_cast<float>(Milliseconds) / 1000.0f;
+}
+
+void FNetQuantize::SerializeTimestamp(FArchive& Ar, float& Value, float BaseValue)
+{
+	const uint32 BaseMilliseconds = QuantizeTimestamp(BaseValue);
+	uint32 DeltaMilliseconds = Ar.IsSaving() ? QuantizeTimestamp(Value) - BaseMilliseconds : 0;
+	Ar.SerializeIntPacked(DeltaMilliseconds);
+	Value = static_cast<float>(BaseMilliseconds + DeltaMilliseconds) / 1000.0f;
+}
+
+void FNetQuantize::SerializeSequence(FArchive& Ar, uint32& Value, uint32 BaseSequence)
+{
+	// Unsigned wrap-around keeps this correct even if Value is behind BaseSequence
+	uint32 Delta = Ar.IsSaving() ? Value - BaseSequence : 0;
+	Ar.SerializeIntPacked(Delta);
+	Value = BaseSequence + Delta;
+}
+
+void FInputPacket::Quantize(const FNetQuantizationSettings& Settings)
+{
+	MovementInput.X = FNetQuantize::DequantizeAxis(FNetQuantize::QuantizeAxis(MovementInput.X, Settings), Settings);
+	MovementInput.Y = FNetQuantize::DequantizeAxis(FNetQuantize::QuantizeAxis(MovementInput.Y, Settings), Settings);
+	LookInput.X = FNetQuantize::DequantizeAxis(FNetQuantize::QuantizeAxis(LookInput.X, Settings), Settings);
+	LookInput.Y = FNetQuantize::DequantizeAxis(FNetQuantize::QuantizeAxis(LookInput.Y, Settings), Settings);
+	ClientTimestamp = FNetQuantize::QuantizeTimestamp(ClientTimestamp) / 1000.0f;
+	ActionFlags &= FLAG_MASK;
+}
+
+bool FInputPacket::NetSerializeQuantized(FArchive& Ar, const FNetQuantizationSettings& Settings, uint32 BaseSequence,
+	FNetFieldBitCounter* Counter)
+{
+	FNetQuantize::SerializeSequence(Ar, SequenceNumber, BaseSequence);
+	FNetQuantize::SerializeTimestamp(Ar, ClientTimestamp);
+	if (Counter)
+	{
+		Counter->Mark(ENetFieldGroup::Header);
+	}
+
+	FNetQuantize::SerializeAxis(Ar, MovementInput.X, Settings);
+	FNetQuantize::SerializeAxis(Ar, MovementInput.Y, Settings);
+	FNetQuantize::SerializeAxis(Ar, LookInput.X, Settings);
+	FNetQuantize::SerializeAxis(Ar, LookInput.Y, Settings);
+
+	uint32 Flags = ActionFlags & FLAG_MASK;
+	Ar.SerializeInt(Flags, FLAG_MASK + 1);
+	ActionFlags = Flags;
+	if (Counter)
+	{
+		Counter->Mark(ENetFieldGroup::Input);
+	}
+
+	// Integrity is the enclosing packet's CRC, checked before any input is read
+	return !Ar.IsLoading() || (!Ar.IsError() && IsInRange());
+}
+
+FInputRun FInputRun::FromInput(const FInputPacket& Input)
+{
+	FInputRun Run;
+	Run.FirstSequence = Input.SequenceNumber;
+	Run.Count = 1;
+	Run.FirstTimestampMs = FNetQuantize::QuantizeTimestamp(Input.ClientTimestamp);
+	Run.LastTimestampMs = Run.FirstTimestampMs;
+	Run.MovementInput = Input.MovementInput;
+	Run.LookInput = Input.LookInput;
+	Run.ActionFlags = Input.ActionFlags & FInputPacket::FLAG_MASK;
+	return Run;
+}
+
+bool FInputRun::CanAppend(const FInputPacket& Input) const
+{
+	return Count > 0
+		&& Input.SequenceNumber == GetLastSequence() + 1
+		&& (ActionFlags & ~HeldFlags) == 0
+		&& (Input.ActionFlags & FInputPacket::FLAG_MASK) == ActionFlags
+		&& Input.MovementInput == MovementInput
+		&& Input.LookInput == LookInput
+		&& FNetQuantize::QuantizeTimestamp(Input.ClientTimestamp) >= LastTimestampMs;
+}
+
+void FInputRun::Append(const FInputPacket& Input)
+{
+	++Count;
+	LastTimestampMs = FNetQuantize::QuantizeTimestamp(Input.ClientTimestamp);
+}
+
+FInputPacket FInputRun::GetInput(uint32 Sequence) const
+{
+	// Integer interpolation, so every end that expands the run gets the same timestamps
+	const uint32 Index = Sequence - FirstSequence;
+	const uint64 Span = LastTimestampMs - FirstTimestampMs;
+	const uint32 TimestampMs = Count > 1
+		? FirstTimestampMs + static_cast<uint32>((Span * Index + (Count - 1) / 2) / (Count - 1))
+		: FirstTimestampMs;
+
+	FInputPacket Input;
+	Input.SequenceNumber = Sequence;
+	Input.ClientTimestamp = TimestampMs / 1000.0f;
+	Input.MovementInput = MovementInput;
+	Input.LookInput = LookInput;
+	Input.ActionFlags = ActionFlags;
+	return Input;
+}
+
+void FInputRun::TrimFront(uint32 NewFirstSequence)
+{
+	const FInputPacket First = GetInput(NewFirstSequence);
+	Count -= NewFirstSequence - FirstSequence;
+	FirstSequence = NewFirstSequence;
+	FirstTimestampMs = FNetQuantize::QuantizeTimestamp(First.ClientTimestamp);
+}
+
+bool FInputRun::NetSerializeQuantized(FArchive& Ar, const FNetQuantizationSettings& Settings, uint32 BaseSequence,
+	FNetFieldBitCounter* Counter)
+{
+	FNetQuantize::SerializeSequence(Ar, FirstSequence, BaseSequence);
+
+	uint32 ExtraInputs = Ar.IsSaving() ? Count - 1 : 0;
+	Ar.SerializeIntPacked(ExtraInputs);
+	Count = ExtraInputs + 1;
+
+	Ar.SerializeIntPacked(FirstTimestampMs);
+	uint32 SpanMs = Ar.IsSaving() ? LastTimestampMs - FirstTimestampMs : 0;
+	if (Count > 1)
+	{
+		Ar.SerializeIntPacked(SpanMs);
+	}
+	LastTimestampMs = FirstTimestampMs + SpanMs;
+	if (Counter)
+	{
+		Counter->Mark(ENetFieldGroup::Header);
+	}
+
+	FNetQuantize::SerializeAxis(Ar, MovementInput.X, Settings);
+	FNetQuantize::SerializeAxis(Ar, MovementInput.Y, Settings);
+	FNetQuantize::SerializeAxis(Ar, LookInput.X, Settings);
+	FNetQuantize::SerializeAxis(Ar, LookInput.Y, Settings);
+
+	uint32 Flags = ActionFlags & FInputPacket::FLAG_MASK;
+	Ar.SerializeInt(Flags, FInputPacket::FLAG_MASK + 1);
+	ActionFlags = Flags;
+	if (Counter)
+	{
+		Counter->Mark(ENetFieldGroup::Input);
+	}
+
+	return !Ar.IsLoading() || (!Ar.IsError() && GetInput(FirstSequence).IsInRange());
+}
+
+void FStateUpdatePacket::Quantize(const FNetQuantizationSettings& Settings)
+{
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		AuthoritativePosition[Axis] = FNetQuantize::DequantizePositionAxis(
+			FNetQuantize::QuantizePositionAxis(AuthoritativePosition[Axis], Axis, Settings), Axis, Settings);
+		AuthoritativeVelocity[Axis] = FNetQuantize::DequantizeVelocityAxis(
+			FNetQuantize::QuantizeVelocityAxis(AuthoritativeVelocity[Axis], Settings), Settings);
+	}
+	AuthoritativeStamina = FNetQuantize::DequantizeStamina(FNetQuantize::QuantizeStamina(AuthoritativeStamina, Settings), Settings);
+	ServerTimestamp = FNetQuantize::QuantizeTimestamp(ServerTimestamp) / 1000.0f;
+}
+
+bool FStateUpdatePacket::NetSerializeQuantized(FArchive& Ar, const FNetQuantizationSettings& Settings, uint32 BaseSequence)
+{
+	FNetQuantize::SerializeSequence(Ar, AcknowledgedSequence, BaseSequence);
+	FNetQuantize::SerializeTimestamp(Ar, ServerTimestamp);
+	FNetQuantize::SerializePosition(Ar, AuthoritativePosition, Settings);
+	FNetQuantize::SerializeVelocity(Ar, AuthoritativeVelocity, Settings);
+
+	// EPlayerState has 6 values
+	uint32 State = AuthoritativeState;
+	Ar.SerializeInt(State, 8);
+	AuthoritativeState = static_cast<uint8>(State);
+
+	FNetQuantize::SerializeStamina(Ar, AuthoritativeStamina, Settings);
+
+	return !Ar.IsLoading() || (!Ar.IsError() && IsInRange());
+}
@@ -6,6 +6,93 @@
 #include "Serialization/Archive.h"
 #include "NetworkTypes.generated.h"
 
+class FNetFieldBitCounter;
+
+/**
+ * Quantization settings for the bit-packed packet path
+ * Each field type has a fixed resolution, so its reconstruction error is bounded
+ */
+USTRUCT(BlueprintType)
+struct FNetQuantizationSettings
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Quantization", meta = (ToolTip = "Lower corner of the pitch in cm, positions outside the bounds are clamped"))
+	FVector PitchMin = FVector(-6000.0f, -4000.0f, -500.0f);
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Quantization", meta = (ToolTip = "Upper corner of the pitch in cm, positions outside the bounds are clamped"))
+	FVector PitchMax = FVector(6000.0f, 4000.0f, 1500.0f);
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Quantization", meta = (ToolTip = "Position step in cm (0.1 = millimetre fixed-point)"))
+	float PositionResolution = 0.1f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Quantization", meta = (ToolTip = "Largest encodable speed per axis in cm/s"))
+	float MaxQuantizedSpeed = 2048.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Quantization", meta = (ToolTip = "Velocity step in cm/s"))
+	float VelocityResolution = 1.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Quantization", meta = (ToolTip = "Bits per stick axis", ClampMin = "2", ClampMax = "16"))
+	int32 AxisBits = 8;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Quantization", meta = (ToolTip = "Largest encodable stamina value"))
+	float MaxQuantizedStamina = 100.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Quantization", meta = (ToolTip = "Bits used for stamina", ClampMin = "2", ClampMax = "16"))
+	int32 StaminaBits = 7;
+
+	// Maximum reconstruction error per field (inside the encodable range)
+	float GetPositionErrorBound() const { return PositionResolution * 0.5f; }
+	float GetVelocityErrorBound() const { return VelocityResolution * 0.5f; }
+	float GetAxisErrorBound() const { return 0.5f / GetAxisScale(); }
+	float GetStaminaErrorBound() const { return 0.5f * MaxQuantizedStamina / GetStaminaSteps(); }
+	float GetTimestampErrorBound() const { return 0.0005f; }
+
+	// Axis codes are symmetric around zero so that a centred stick stays exactly zero
+	float GetAxisScale() const { return static_cast<float>((1 << (FMath::Clamp(AxisBits, 2, 16) - 1)) - 1); }
+	uint32 GetStaminaSteps() const { return (1u << FMath::Clamp(StaminaBits, 2, 16)) - 1; }
+};
+
+/**
+ * Field-level quantization helpers shared by the bit-packed packet paths
+ * Serialize* functions write the quantized code on save and leave the dequantized value in place,
+ * so both ends of the connection hold identical values afterwards
+ */
+struct POCKETSTRIKER_API FNetQuantize
+{
+	// Stick axes in [-1, 1]
+	static uint32 QuantizeAxis(double Value, const FNetQuantizationSettings& Settings);
+	static double DequantizeAxis(uint32 Code, const FNetQuantizationSettings& Settings);
+	static void SerializeAxis(FArchive& Ar, double& Value, const FNetQuantizationSettings& Settings);
+
+	// Positions in fixed-point steps inside the pitch bounds
+	static uint32 QuantizePositionAxis(double Value, int32 Axis, const FNetQuantizationSettings& Settings);
+	static double DequantizePositionAxis(uint32 Code, int32 Axis, const FNetQuantizationSettings& Settings);
+	static uint32 GetPositionAxisCodeCount(int32 Axis, const FNetQuantizationSettings& Settings);
+	static void SerializePositionAxis(FArchive& Ar, double& Value, int32 Axis, const FNetQuantizationSettings& Settings);
+	static void SerializePosition(FArchive& Ar, FVector& Value, const FNetQuantizationSettings& Settings);
+
+	// Velocities in fixed-point steps in [-MaxQuantizedSpeed, MaxQuantizedSpeed]
+	static uint32 QuantizeVelocityAxis(double Value, const FNetQuantizationSettings& Settings);
+	static double DequantizeVelocityAxis(uint32 Code, const FNetQuantizationSettings& Settings);
+	static uint32 GetVelocityAxisCodeCount(const FNetQuantizationSettings& Settings);
+	static void SerializeVelocityAxis(FArchive& Ar, double& Value, const FNetQuantizationSettings& Settings);
+	static void SerializeVelocity(FArchive& Ar, FVector& Value, const FNetQuantizationSettings& Settings);
+
+	// Stamina in [0, MaxQuantizedStamina]
+	static uint32 QuantizeStamina(float Value, const FNetQuantizationSettings& Settings);
+	static float DequantizeStamina(uint32 Code, const FNetQuantizationSettings& Settings);
+	static void SerializeStamina(FArchive& Ar, float& Value, const FNetQuantizationSettings& Settings);
+
+	// Timestamps in whole milliseconds, packed (optionally as a delta against a shared base)
+	static uint32 QuantizeTimestamp(float Value) { return static_cast<uint32>(FMath::Max(0, FMath::RoundToInt(Value * 1000.0f))); }
+	static void SerializeTimestamp(FArchive& Ar, float& Value);
+	static void SerializeTimestamp(FArchive& Ar, float& Value, float BaseValue);
+
+	// Sequence numbers as a packed delta against a base both ends agree on
+	static void SerializeSequence(FArchive& Ar, uint32& Value, uint32 BaseSequence);
+};
+
 /**
  * Input packet structure for client-to-server communication
  * Contains all input data with sequence numbering for prediction
@@ -38,6 +125,8 @@ struct FInputPacket
 	static constexpr uint32 FLAG_TACKLE = 1 << 1;
 	static constexpr uint32 FLAG_KICK = 1 << 2;
 	static constexpr uint32 FLAG_PASS = 1 << 3;
+	static constexpr uint32 FLAG_COUNT = 4;
+	static constexpr uint32 FLAG_MASK = (1 << FLAG_COUNT) - 1;
 
 	FInputPacket()
 		: SequenceNumber(0)
@@ -52,11 +141,62 @@ struct FInputPacket
 	// Serialization for network transmission
 	bool Serialize(FArchive& Ar);
 
-	// Calculate checksum for validation
+	// Bit-packed serialization for FBitWriter/FBitReader
+	// SequenceNumber is written as a delta against BaseSequence, which both ends must agree on
+	// Carries no checksum of its own: the packet around it has one CRC32C (FNetPacketChecksum)
+	// Counter, if given, is charged per field group
+	bool NetSerializeQuantized(FArchive& Ar, const FNetQuantizationSettings& Settings, uint32 BaseSequence = 0,
+		FNetFieldBitCounter* Counter = nullptr);
+
+	// Snap fields to the quantization grid so the sender simulates what the receiver will see
+	void Quantize(const FNetQuantizationSettings& Settings);
+
+	// CRC32C over the fields in Serialize order; only the legacy Serialize path sets Checksum
 	uint32 CalculateChecksum() const;
 
 	// Validate packet integrity
 	bool IsValid() const;
+
+	// The range checks of IsValid, for packets whose integrity was checked on the wire
+	bool IsInRange() const;
+};
+
+/**
+ * Consecutive inputs that differ only in their timestamps, held as one sequence range and one payload
+ * Timestamps are exact at both ends and interpolated in whole milliseconds in between. Inputs carrying an action
+ * other than sprint never join a run, so the timestamps lag compensation and ball prediction read stay exact
+ */
+struct POCKETSTRIKER_API FInputRun
+{
+	uint32 FirstSequence = 0;
+	uint32 Count = 0;
+	uint32 FirstTimestampMs = 0;
+	uint32 LastTimestampMs = 0;
+	FVector2D MovementInput = FVector2D::ZeroVector;
+	FVector2D LookInput = FVector2D::ZeroVector;
+	uint32 ActionFlags = 0;
+
+	// Flags that may be held across a run
+	static constexpr uint32 HeldFlags = FInputPacket::FLAG_SPRINT;
+
+	static FInputRun FromInput(const FInputPacket& Input);
+
+	uint32 GetLastSequence() const { return FirstSequence + Count - 1; }
+	bool Contains(uint32 Sequence) const { return Sequence - FirstSequence < Count; }
+
+	// Input is the next sequence with the same payload, so it can extend the run
+	bool CanAppend(const FInputPacket& Input) const;
+	void Append(const FInputPacket& Input);
+
+	// The input at Sequence, which the run must contain
+	FInputPacket GetInput(uint32 Sequence) const;
+
+	// Drops the inputs before NewFirstSequence, which the run must contain
+	void TrimFront(uint32 NewFirstSequence);
+
+	// Bit-packed: first sequence against BaseSequence, length, both end timestamps, then the payload once
+	bool NetSerializeQuantized(FArchive& Ar, const FNetQuantizationSettings& Settings, uint32 BaseSequence = 0,
+		FNetFieldBitCounter* Counter = nullptr);
 };
 
 /**
@@ -103,11 +243,22 @@ struct FStateUpdatePacket
 	// Serialization for network transmission
 	bool Serialize(FArchive& Ar);
 
-	// Calculate checksum for validation
+	// Bit-packed serialization for FBitWriter/FBitReader
+	// AcknowledgedSequence is written as a delta against BaseSequence, which both ends must agree on
+	// Carries no checksum of its own: the packet around it has one CRC32C (FNetPacketChecksum)
+	bool NetSerializeQuantized(FArchive& Ar, const FNetQuantizationSettings& Settings, uint32 BaseSequence = 0);
+
+	// Snap fields to the quantization grid so the sender keeps what the receiver will see
+	void Quantize(const FNetQuantizationSettings& Settings);
+
+	// CRC32C over the fields in Serialize order; only the legacy Serialize path sets Checksum
 	uint32 CalculateChecksum() const;
 
 	// Validate packet integrity
 	bool IsValid() const;
+
+	// The range checks of IsValid, for packets whose integrity was checked on the wire
+	bool IsInRange() const;
 };
 
 /**
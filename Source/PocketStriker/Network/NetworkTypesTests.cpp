@@ -0,0 +1,142 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "NetworkTypes.h"
+#include "Misc/AutomationTest.h"
+#include "Serialization/BitWriter.h"
+#include "Serialization/BitReader.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	// Writes Packet bit-packed and reads it back into a default-constructed packet
+	template<typename PacketType, typename... ArgTypes>
+	bool RoundTrip(const PacketType& Packet, PacketType& OutPacket, const FNetQuantizationSettings& Settings, ArgTypes... Args)
+	{
+		FBitWriter Writer(0, true);
+		PacketType Sent = Packet;
+		if (!Sent.NetSerializeQuantized(Writer, Settings, Args...) || Writer.IsError())
+		{
+			return false;
+		}
+
+		FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+		OutPacket = PacketType();
+		return OutPacket.NetSerializeQuantized(Reader, Settings, Args...) && !Reader.IsError() && Reader.GetBitsLeft() == 0;
+	}
+
+	// Values spread across the encodable range, including both ends
+	double Sample(FRandomStream& Random, double Min, double Max, int32 Index)
+	{
+		switch (Index)
+		{
+		case 0: return Min;
+		case 1: return Max;
+		case 2: return 0.0;
+		default: return Random.FRandRange(Min, Max);
+		}
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNetQuantizationRoundTripTest, "PocketStriker.Network.QuantizationRoundTrip",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FNetQuantizationRoundTripTest::RunTest(const FString& Parameters)
+{
+	const FNetQuantizationSettings Settings;
+	FRandomStream Random(0x5eed);
+	const int32 NumSamples = 2000;
+
+	// A little slack for float rounding on top of the half-step bound
+	const float Slack = 1.0e-4f;
+
+	float MaxPositionError = 0.0f;
+	float MaxVelocityError = 0.0f;
+	float MaxStaminaError = 0.0f;
+	float MaxServerTimeError = 0.0f;
+	for (int32 Index = 0; Index < NumSamples; ++Index)
+	{
+		FStateUpdatePacket State;
+		State.AcknowledgedSequence = 1000 + Index * 7;
+		State.ServerTimestamp = static_cast<float>(Sample(Random, 0.0, 3600.0, Index));
+		State.AuthoritativeState = static_cast<uint8>(Index % 8);
+		State.AuthoritativeStamina = static_cast<float>(Sample(Random, 0.0, Settings.MaxQuantizedStamina, Index));
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			State.AuthoritativePosition[Axis] = Sample(Random, Settings.PitchMin[Axis], Settings.PitchMax[Axis], Index);
+			State.AuthoritativeVelocity[Axis] = Sample(Random, -Settings.MaxQuantizedSpeed, Settings.MaxQuantizedSpeed, Index);
+		}
+
+		FStateUpdatePacket Received;
+		const uint32 BaseSequence = State.AcknowledgedSequence - 3;
+		if (!TestTrue(TEXT("State packet round-trips"), RoundTrip(State, Received, Settings, BaseSequence)))
+		{
+			return false;
+		}
+
+		TestEqual(TEXT("Acknowledged sequence is exact"), static_cast<int64>(Received.AcknowledgedSequence), static_cast<int64>(State.AcknowledgedSequence));
+		TestEqual(TEXT("Player state is exact"), static_cast<int32>(Received.AuthoritativeState), static_cast<int32>(State.AuthoritativeState));
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			MaxPositionError = FMath::Max(MaxPositionError,
+				static_cast<float>(FMath::Abs(Received.AuthoritativePosition[Axis] - State.AuthoritativePosition[Axis])));
+			MaxVelocityError = FMath::Max(MaxVelocityError,
+				static_cast<float>(FMath::Abs(Received.AuthoritativeVelocity[Axis] - State.AuthoritativeVelocity[Axis])));
+		}
+		MaxStaminaError = FMath::Max(MaxStaminaError, FMath::Abs(Received.AuthoritativeStamina - State.AuthoritativeStamina));
+		MaxServerTimeError = FMath::Max(MaxServerTimeError, FMath::Abs(Received.ServerTimestamp - State.ServerTimestamp));
+	}
+
+	float MaxAxisError = 0.0f;
+	float MaxClientTimeError = 0.0f;
+	for (int32 Index = 0; Index < NumSamples; ++Index)
+	{
+		FInputPacket Input;
+		Input.SequenceNumber = 500 + Index;
+		// Timestamps stay within the range a float holds to better than a millisecond
+		Input.ClientTimestamp = static_cast<float>(Sample(Random, 0.0, 3600.0, Index));
+		Input.MovementInput = FVector2D(Sample(Random, -1.0, 1.0, Index), Sample(Random, -1.0, 1.0, Index + 1));
+		Input.LookInput = FVector2D(Sample(Random, -1.0, 1.0, Index + 2), Sample(Random, -1.0, 1.0, Index + 3));
+		Input.ActionFlags = static_cast<uint32>(Index) & FInputPacket::FLAG_MASK;
+
+		FInputPacket Received;
+		if (!TestTrue(TEXT("Input packet round-trips"), RoundTrip(Input, Received, Settings, Input.SequenceNumber - 1, nullptr)))
+		{
+			return false;
+		}
+
+		TestEqual(TEXT("Input sequence is exact"), static_cast<int64>(Received.SequenceNumber), static_cast<int64>(Input.SequenceNumber));
+		TestEqual(TEXT("Action flags are exact"), static_cast<int64>(Received.ActionFlags), static_cast<int64>(Input.ActionFlags));
+		MaxAxisError = FMath::Max(MaxAxisError, static_cast<float>(FMath::Abs(Received.MovementInput.X - Input.MovementInput.X)));
+		MaxAxisError = FMath::Max(MaxAxisError, static_cast<float>(FMath::Abs(Received.MovementInput.Y - Input.MovementInput.Y)));
+		MaxAxisError = FMath::Max(MaxAxisError, static_cast<float>(FMath::Abs(Received.LookInput.X - Input.LookInput.X)));
+		MaxAxisError = FMath::Max(MaxAxisError, static_cast<float>(FMath::Abs(Received.LookInput.Y - Input.LookInput.Y)));
+		MaxClientTimeError = FMath::Max(MaxClientTimeError, FMath::Abs(Received.ClientTimestamp - Input.ClientTimestamp));
+
+		// A centred stick must stay exactly centred
+		if (Input.MovementInput.X == 0.0)
+		{
+			TestEqual(TEXT("Centred axis stays zero"), Received.MovementInput.X, 0.0);
+		}
+	}
+
+	TestTrue(FString::Printf(TEXT("Position error %.4f within %.4f"), MaxPositionError, Settings.GetPositionErrorBound()),
+		MaxPositionError <= Settings.GetPositionErrorBound() + Slack);
+	TestTrue(FString::Printf(TEXT("Velocity error %.4f within %.4f"), MaxVelocityError, Settings.GetVelocityErrorBound()),
+		MaxVelocityError <= Settings.GetVelocityErrorBound() + Slack);
+	TestTrue(FString::Printf(TEXT("Stamina error %.4f within %.4f"), MaxStaminaError, Settings.GetStaminaErrorBound()),
+		MaxStaminaError <= Settings.GetStaminaErrorBound() + Slack);
+	TestTrue(FString::Printf(TEXT("Axis error %.5f within %.5f"), MaxAxisError, Settings.GetAxisErrorBound()),
+		MaxAxisError <= Settings.GetAxisErrorBound() + Slack);
+
+	// At an hour a float is only good to a quarter millisecond, so allow for its rounding as well
+	const float TimestampSlack = 3600.0f * FLT_EPSILON;
+	TestTrue(FString::Printf(TEXT("Server timestamp error %.5f within %.5f"), MaxServerTimeError, Settings.GetTimestampErrorBound()),
+		MaxServerTimeError <= Settings.GetTimestampErrorBound() + TimestampSlack);
+	TestTrue(FString::Printf(TEXT("Client timestamp error %.5f within %.5f"), MaxClientTimeError, Settings.GetTimestampErrorBound()),
+		MaxClientTimeError <= Settings.GetTimestampErrorBound() + TimestampSlack);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,158 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "RollbackSession.h"
+
+void FMatchStateArena::Init(int32 MinCapacity)
+{
+	const int32 Capacity = FMath::RoundUpToPowerOfTwo(FMath::Max(MinCapacity, 2));
+	Snapshots.SetNum(Capacity);
+	Mask = Capacity - 1;
+
+	for (FMatchSimState& Snapshot : Snapshots)
+	{
+		Snapshot.Frame = INDEX_NONE;
+	}
+}
+
+void FMatchStateArena::Save(const FMatchSimState& State)
+{
+	FMemory::Memcpy(&Snapshots[State.Frame & Mask], &State, sizeof(FMatchSimState));
+}
+
+bool FMatchStateArena::Restore(int32 Frame, FMatchSimState& OutState) const
+{
+	const FMatchSimState& Snapshot = Snapshots[Frame & Mask];
+	if (Snapshot.Frame != Frame)
+	{
+		return false;
+	}
+
+	FMemory::Memcpy(&OutState, &Snapshot, sizeof(FMatchSimState));
+	return true;
+}
+
+void FRollbackSession::Init(const FMatchSimState& InitialState, const FMatchSimTuning& InTuning, int32 InMaxRollbackFrames, float InFixedDeltaTime)
+{
+	State = InitialState;
+	Tuning = InTuning;
+	MaxRollbackFrames = FMath::Max(1, InMaxRollbackFrames);
+	FixedDeltaTime = InFixedDeltaTime;
+
+	// One snapshot per frame in the window plus the current one
+	Arena.Init(MaxRollbackFrames + 1);
+
+	// Inputs are kept for the rollback window and may arrive up to the same distance ahead
+	const int32 InputCapacity = FMath::RoundUpToPowerOfTwo(2 * (MaxRollbackFrames + 1));
+	InputFrames.Reset();
+	InputFrames.SetNum(InputCapacity);
+	InputMask = InputCapacity - 1;
+
+	PendingRollbackFrame = INDEX_NONE;
+	TotalRollbacks = 0;
+	TotalFramesResimulated = 0;
+	MaxRollbackDepth = 0;
+	InputsDropped = 0;
+}
+
+bool FRollbackSession::AddInput(int32 PlayerIndex, int32 Frame, const FInputCommand& Input)
+{
+	if (PlayerIndex < 0 || PlayerIndex >= State.NumPlayers)
+	{
+		return false;
+	}
+
+	// The slot for Frame must not overwrite one still inside the rollback window
+	const int32 OldestFrame = State.Frame - MaxRollbackFrames;
+	if (Frame < OldestFrame || Frame >= OldestFrame + InputFrames.Num())
+	{
+		InputsDropped++;
+		return false;
+	}
+
+	FInputFrame& Slot = GetInputFrame(Frame);
+	const uint32 PlayerBit = 1u << PlayerIndex;
+	if (Slot.ConfirmedMask & PlayerBit)
+	{
+		// Redundant resend
+		return true;
+	}
+
+	// Already simulated on a prediction; only a wrong one needs a rollback
+	if (Frame < State.Frame && !InputsMatch(Slot.Inputs[PlayerIndex], Input))
+	{
+		PendingRollbackFrame = PendingRollbackFrame == INDEX_NONE ? Frame : FMath::Min(PendingRollbackFrame, Frame);
+	}
+
+	Slot.Inputs[PlayerIndex] = Input;
+	Slot.ConfirmedMask |= PlayerBit;
+	return true;
+}
+
+void FRollbackSession::AdvanceFrame()
+{
+	if (PendingRollbackFrame != INDEX_NONE)
+	{
+		const int32 TargetFrame = State.Frame;
+		if (Arena.Restore(PendingRollbackFrame, State))
+		{
+			const int32 Depth = TargetFrame - PendingRollbackFrame;
+			TotalRollbacks++;
+			TotalFramesResimulated += Depth;
+			MaxRollbackDepth = FMath::Max(MaxRollbackDepth, Depth);
+
+			while (State.Frame < TargetFrame)
+			{
+				SimulateFrame();
+			}
+		}
+		else
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Rollback: no snapshot for frame %d, keeping current state"), PendingRollbackFrame);
+		}
+
+		PendingRollbackFrame = INDEX_NONE;
+	}
+
+	SimulateFrame();
+}
+
+void FRollbackSession::SimulateFrame()
+{
+	const int32 Frame = State.Frame;
+	Arena.Save(State);
+
+	FInputFrame& Slot = GetInputFrame(Frame);
+	for (int32 i = 0; i < State.NumPlayers; ++i)
+	{
+		if (!(Slot.ConfirmedMask & (1u << i)))
+		{
+			Slot.Inputs[i] = PredictInput(i, Frame);
+		}
+	}
+
+	FMatchSimulation::Step(State, Slot.Inputs, FixedDeltaTime, Tuning);
+}
+
+FRollbackSession::FInputFrame& FRollbackSession::GetInputFrame(int32 Frame)
+{
+	FInputFrame& Slot = InputFrames[Frame & InputMask];
+	if (Slot.Frame != Frame)
+	{
+		Slot = FInputFrame();
+		Slot.Frame = Frame;
+	}
+	return Slot;
+}
+
+FInputCommand FRollbackSession::PredictInput(int32 PlayerIndex, int32 Frame) const
+{
+	// The previous frame holds either the confirmed input or the prediction carried forward from the last one
+	const FInputFrame& Previous = InputFrames[(Frame - 1) & InputMask];
+	return Previous.Frame == Frame - 1 ? Previous.Inputs[PlayerIndex] : FInputCommand();
+}
+
+bool FRollbackSession::InputsMatch(const FInputCommand& A, const FInputCommand& B)
+{
+	// Only the fields the simulation reads
+	return A.MovementInput == B.MovementInput && A.ActionFlags == B.ActionFlags;
+}
@@ -0,0 +1,88 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "../Gameplay/GameplayTypes.h"
+#include "../Gameplay/MatchSimulation.h"
+
+/**
+ * Preallocated ring of whole-match snapshots, one per frame
+ * Save and restore are a single memcpy into a fixed slot; nothing allocates after Init
+ */
+class POCKETSTRIKER_API FMatchStateArena
+{
+public:
+	// Capacity is rounded up to a power of two
+	void Init(int32 MinCapacity);
+
+	// Stores State under State.Frame, overwriting the snapshot one capacity older
+	void Save(const FMatchSimState& State);
+
+	// Copies the snapshot taken at the start of Frame; false if it has been overwritten
+	bool Restore(int32 Frame, FMatchSimState& OutState) const;
+
+	int32 GetCapacity() const { return Snapshots.Num(); }
+
+private:
+	TArray<FMatchSimState> Snapshots;
+	int32 Mask = 0;
+};
+
+/**
+ * Rollback netcode driver over FMatchSimulation
+ * Every frame runs on the best known inputs; missing remote inputs are predicted by repeating the last
+ * confirmed one. When a late input disagrees with what was predicted, the next AdvanceFrame restores the
+ * snapshot of that frame and re-simulates up to the present, at most MaxRollbackFrames deep
+ * Library only: no actor, RPC or params switch drives it yet; live matches use the server-authoritative path
+ */
+class POCKETSTRIKER_API FRollbackSession
+{
+public:
+	void Init(const FMatchSimState& InitialState, const FMatchSimTuning& InTuning, int32 InMaxRollbackFrames, float InFixedDeltaTime);
+
+	// Confirms PlayerIndex's input for Frame; frames already simulated with a different prediction are rolled back
+	// Returns false when Frame is older than the rollback window (or too far ahead) and the input was dropped
+	bool AddInput(int32 PlayerIndex, int32 Frame, const FInputCommand& Input);
+
+	// Applies any pending rollback, then simulates the current frame
+	void AdvanceFrame();
+
+	const FMatchSimState& GetState() const { return State; }
+	int32 GetCurrentFrame() const { return State.Frame; }
+	int32 GetMaxRollbackFrames() const { return MaxRollbackFrames; }
+
+	// Stats
+	int32 TotalRollbacks = 0;
+	int32 TotalFramesResimulated = 0;
+	int32 MaxRollbackDepth = 0;
+	int32 InputsDropped = 0;
+
+private:
+	struct FInputFrame
+	{
+		int32 Frame = INDEX_NONE;
+		uint32 ConfirmedMask = 0;
+		FInputCommand Inputs[FMatchSimState::MaxPlayers];
+	};
+
+	// Fills the input slot for Frame (predicting unconfirmed players), saves the snapshot and steps
+	void SimulateFrame();
+
+	FInputFrame& GetInputFrame(int32 Frame);
+	FInputCommand PredictInput(int32 PlayerIndex, int32 Frame) const;
+
+	static bool InputsMatch(const FInputCommand& A, const FInputCommand& B);
+
+	FMatchSimState State;
+	FMatchSimTuning Tuning;
+	FMatchStateArena Arena;
+	TArray<FInputFrame> InputFrames;
+	int32 InputMask = 0;
+
+	int32 MaxRollbackFrames = 8;
+	float FixedDeltaTime = 1.0f / 60.0f;
+
+	// Earliest frame whose prediction turned out wrong, or INDEX_NONE
+	int32 PendingRollbackFrame = INDEX_NONE;
+};
@@ -0,0 +1,149 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Fixed-capacity ring buffer keyed by sequence number
+ * Capacity is rounded up to a power of two so the slot is Sequence & Mask
+ * Insert, lookup and releasing everything up to a sequence are O(1) and never move elements;
+ * once full, adding a newer sequence overwrites the oldest one
+ * Sequences are expected to increase (gaps are fine); call Reset before reusing old sequence numbers
+ */
+template<typename ElementType>
+class TSequenceRingBuffer
+{
+public:
+	explicit TSequenceRingBuffer(uint32 MinCapacity = 128)
+	{
+		SetCapacity(MinCapacity);
+	}
+
+	// Reallocates and clears; only call outside of the hot path (e.g. BeginPlay)
+	void SetCapacity(uint32 MinCapacity)
+	{
+		const uint32 Capacity = FMath::RoundUpToPowerOfTwo(FMath::Max(MinCapacity, 2u));
+		Slots.SetNum(Capacity);
+		Mask = Capacity - 1;
+		Reset();
+	}
+
+	uint32 GetCapacity() const { return Mask + 1; }
+
+	// Stores Element under Sequence; returns nullptr if Sequence is older than the retained window
+	ElementType* Add(uint32 Sequence, const ElementType& Element)
+	{
+		if (IsEmpty())
+		{
+			OldestSequence = Sequence;
+			NewestSequence = Sequence;
+			bEmpty = false;
+		}
+		else if (Sequence < OldestSequence)
+		{
+			return nullptr;
+		}
+		else if (Sequence > NewestSequence)
+		{
+			NewestSequence = Sequence;
+
+			// Slide the window forward over whatever the new sequence overwrites
+			if (NewestSequence - OldestSequence > Mask)
+			{
+				OldestSequence = NewestSequence - Mask;
+			}
+		}
+
+		FSlot& Slot = Slots[Sequence & Mask];
+		Slot.Sequence = Sequence;
+		Slot.bValid = true;
+		Slot.Element = Element;
+		return &Slot.Element;
+	}
+
+	const ElementType* Find(uint32 Sequence) const
+	{
+		if (IsEmpty() || Sequence < OldestSequence || Sequence > NewestSequence)
+		{
+			return nullptr;
+		}
+
+		// Gaps in the sequence leave slots holding older (or no) entries
+		const FSlot& Slot = Slots[Sequence & Mask];
+		return Slot.bValid && Slot.Sequence == Sequence ? &Slot.Element : nullptr;
+	}
+
+	ElementType* Find(uint32 Sequence)
+	{
+		return const_cast<ElementType*>(static_cast<const TSequenceRingBuffer*>(this)->Find(Sequence));
+	}
+
+	// Drops every sequence up to and including Sequence
+	void ReleaseUpTo(uint32 Sequence)
+	{
+		if (IsEmpty() || Sequence < OldestSequence)
+		{
+			return;
+		}
+
+		if (Sequence >= NewestSequence)
+		{
+			bEmpty = true;
+			return;
+		}
+
+		OldestSequence = Sequence + 1;
+	}
+
+	void Reset()
+	{
+		for (FSlot& Slot : Slots)
+		{
+			Slot.bValid = false;
+		}
+		OldestSequence = 0;
+		NewestSequence = 0;
+		bEmpty = true;
+	}
+
+	bool IsEmpty() const { return bEmpty; }
+
+	// Span of the retained window, including any gaps
+	int32 Num() const { return IsEmpty() ? 0 : static_cast<int32>(NewestSequence - OldestSequence + 1); }
+
+	uint32 GetOldestSequence() const { return OldestSequence; }
+	uint32 GetNewestSequence() const { return NewestSequence; }
+
+	// Visits stored entries with sequence > AfterSequence, oldest first
+	template<typename FunctorType>
+	void ForEachAfter(uint32 AfterSequence, FunctorType&& Functor) const
+	{
+		if (IsEmpty() || AfterSequence >= NewestSequence)
+		{
+			return;
+		}
+
+		for (uint32 Sequence = FMath::Max(OldestSequence, AfterSequence + 1); Sequence <= NewestSequence; ++Sequence)
+		{
+			if (const ElementType* Element = Find(Sequence))
+			{
+				Functor(*Element);
+			}
+		}
+	}
+
+private:
+	struct FSlot
+	{
+		uint32 Sequence = 0;
+		bool bValid = false;
+		ElementType Element;
+	};
+
+	TArray<FSlot> Slots;
+	uint32 Mask = 0;
+	uint32 OldestSequence = 0;
+	uint32 NewestSequence = 0;
+	bool bEmpty = true;
+};
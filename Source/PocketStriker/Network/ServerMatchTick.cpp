@@ -0,0 +1,173 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ServerMatchTick.h"
+#include "NetworkGameState.h"
+#include "NetworkParamsData.h"
+#include "NetPacketChecksum.h"
+#include "NetTrafficStats.h"
+
+void FServerMatchTick::Init(const UNetworkParamsData& InParams, float InTickRate)
+{
+	Params = &InParams;
+	TickRate = FMath::Max(InTickRate, 1.0f);
+	TickCount = 0;
+	Clients.Reset();
+	Stats = FServerMatchTickStats();
+	LagCompensation.Init(GetTickInterval(), Params->LagCompensationMaxRewind, FWorldSnapshotCodec::MaxEntities);
+}
+
+void FServerMatchTick::VerifyInputPackets(TArrayView<const TArrayView<const uint8>> Packets, TArrayView<bool> OutIntact)
+{
+	SCOPE_CYCLE_COUNTER(STAT_NetPacketVerify);
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(PacketVerify, NetTrafficChannel);
+	Stats.CorruptInputPacketsDropped += FNetPacketChecksum::VerifyMany(Packets, OutIntact);
+}
+
+bool FServerMatchTick::QueueInput(uint32 EntityId, const FInputPacket& Input)
+{
+	if (bValidateInputs && !ANetworkGameState::IsInputPacketValid(Input))
+	{
+		Stats.InvalidInputsRejected++;
+		return false;
+	}
+
+	FInputCommand Command;
+	Command.SequenceNumber = Input.SequenceNumber;
+	Command.ClientTimestamp = Input.ClientTimestamp;
+	Command.MovementInput = Input.MovementInput;
+	Command.LookInput = Input.LookInput;
+	Command.ActionFlags = Input.ActionFlags;
+
+	// Inputs arrive several times through the redundant input stream; queue each sequence once
+	if (!Clients.FindOrAdd(EntityId).InputBuffer.Add(Command))
+	{
+		Stats.DuplicateInputsDropped++;
+		return false;
+	}
+	return true;
+}
+
+void FServerMatchTick::Step(IServerMatchWorld& World, double Time)
+{
+	check(Params);
+	const float DeltaTime = GetTickInterval();
+
+	// Keyframes hold the world before this tick's inputs, which are recorded as they are simulated
+	TickCount++;
+	if (Recorder.IsValid())
+	{
+		Recorder->BeginTick(TickCount);
+		if (Recorder->NeedsKeyframe())
+		{
+			FWorldSnapshot Keyframe;
+			World.GatherWorld(Keyframe);
+			Recorder->RecordKeyframe(Keyframe);
+		}
+	}
+
+	const FLagCompensationHistory* History = Params->bLagCompensation && LagCompensation.GetNumTicks() > 0 ? &LagCompensation : nullptr;
+
+	int32 Underflows = 0;
+	int32 Overflows = 0;
+	int32 Replaced = 0;
+	Stats.MaxInputBufferDepth = 0;
+	for (TPair<uint32, FClient>& Pair : Clients)
+	{
+		const uint32 EntityId = Pair.Key;
+		FClient& Client = Pair.Value;
+		FInputJitterBuffer& Buffer = Client.InputBuffer;
+		Buffer.Configure(Params->InputBufferTargetDepth, Params->InputBufferMaxExtraDepth);
+		Stats.MaxInputBufferDepth = FMath::Max(Stats.MaxInputBufferDepth, Buffer.GetDepth());
+
+		FInputCommand Commands[FInputJitterBuffer::MaxInputsPerTick];
+		const int32 NumCommands = Buffer.Consume(Commands);
+
+		Underflows += Buffer.Underflows;
+		Overflows += Buffer.Overflows;
+		Replaced += Buffer.MissingInputs;
+
+		const float InputDeltaTime = FInputJitterBuffer::GetStepPerInput(DeltaTime, NumCommands);
+		for (int32 CommandIndex = 0; CommandIndex < NumCommands; ++CommandIndex)
+		{
+			const FInputCommand& Command = Commands[CommandIndex];
+			if (!World.SimulateInput(EntityId, Command, InputDeltaTime))
+			{
+				break;
+			}
+			Stats.TotalInputsProcessed++;
+
+			if (Recorder.IsValid())
+			{
+				Recorder->RecordInput(EntityId, Command);
+			}
+
+			if (Command.ActionFlags & (FInputCommand::FLAG_TACKLE | FInputCommand::FLAG_KICK | FInputCommand::FLAG_PASS))
+			{
+				SCOPE_CYCLE_COUNTER(STAT_NetLagCompensation);
+				World.ExecuteActions(EntityId, Command, History);
+			}
+		}
+
+		if (NumCommands > 0)
+		{
+			Client.AcknowledgedSequence = Buffer.GetLastConsumedSequence();
+		}
+	}
+
+	Stats.InputBufferUnderflows = Underflows;
+	Stats.InputBufferOverflows = Overflows;
+	Stats.InputsReplaced = Replaced;
+
+	World.FinishStep(DeltaTime);
+
+	// Where everything ended up, for rewinding later inputs
+	{
+		SCOPE_CYCLE_COUNTER(STAT_NetLagCompensation);
+		StepWorld.Entities.Reset();
+		World.GatherWorld(StepWorld);
+		LagCompensation.BeginTick(Time);
+		for (const FEntitySnapshotState& Entity : StepWorld.Entities)
+		{
+			LagCompensation.RecordPosition(Entity.EntityId, Entity.Position);
+		}
+	}
+}
+
+uint32 FServerMatchTick::GetAcknowledgedSequence(uint32 EntityId) const
+{
+	const FClient* Client = Clients.Find(EntityId);
+	return Client ? Client->AcknowledgedSequence : 0;
+}
+
+double FServerMatchTick::EstimateClientViewTime(const FInputCommand& Command, bool bInterpolated) const
+{
+	// Input timestamps are already on the server clock (FClockSync). Interpolated entities are drawn one
+	// interpolation delay behind that; the adaptive delay is not sent, so the configured one stands in for it
+	const double ViewTime = Command.ClientTimestamp - (bInterpolated && Params ? Params->InterpolationDelay : 0.0f);
+	return LagCompensation.ClampTime(ViewTime);
+}
+
+bool FServerMatchTick::StartRecording(const FString& Filename)
+{
+	check(Params);
+
+	FMatchRecordingHeader Header;
+	Header.TickRate = TickRate;
+	Header.KeyframeIntervalTicks = FMath::Max(1, FMath::RoundToInt(Params->RecordingKeyframeInterval * TickRate));
+	Header.Quantization = Params->Quantization;
+	Header.StartTime = FDateTime::UtcNow();
+
+	TUniquePtr<FMatchRecorder> NewRecorder = MakeUnique<FMatchRecorder>();
+	if (!NewRecorder->Open(Filename, Header))
+	{
+		return false;
+	}
+
+	Recorder = MoveTemp(NewRecorder);
+	return true;
+}
+
+SIZE_T FServerMatchTick::GetAllocatedSize() const
+{
+	return Clients.GetAllocatedSize() + LagCompensation.GetAllocatedSize() + StepWorld.Entities.GetAllocatedSize();
+}
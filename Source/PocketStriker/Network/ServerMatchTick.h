@@ -0,0 +1,127 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NetworkTypes.h"
+#include "NetworkSnapshot.h"
+#include "InputJitterBuffer.h"
+#include "MatchRecording.h"
+#include "LagCompensation.h"
+
+class UNetworkParamsData;
+
+/**
+ * What FServerMatchTick needs from the match it runs: the actors of a game world, or the plain state of a headless match
+ * Players are named by their snapshot entity id
+ */
+class POCKETSTRIKER_API IServerMatchWorld
+{
+public:
+	virtual ~IServerMatchWorld() = default;
+
+	// Steps one player through one input with the fixed step; false when the player has nothing to move
+	virtual bool SimulateInput(uint32 EntityId, const FInputCommand& Command, float DeltaTime) = 0;
+
+	// Resolves the tackle, kick or pass an input carries. History is set when lag compensation is on and has rows;
+	// range is then judged where the attacker saw the ball (FServerMatchTick::EstimateClientViewTime)
+	virtual void ExecuteActions(uint32 EntityId, const FInputCommand& Command, const FLagCompensationHistory* History) = 0;
+
+	// Moves what the inputs do not (a headless ball) once every input of the step has run
+	virtual void FinishStep(float DeltaTime) {}
+
+	// Every player and the ball, for recording keyframes and lag-compensation rows
+	virtual void GatherWorld(FWorldSnapshot& OutWorld) const = 0;
+};
+
+/**
+ * Input and simulation counters of one match
+ */
+struct POCKETSTRIKER_API FServerMatchTickStats
+{
+	int32 TotalInputsProcessed = 0;
+	int32 InvalidInputsRejected = 0;
+	int32 DuplicateInputsDropped = 0;
+
+	// Input packets that failed their CRC32C and were dropped unread
+	int32 CorruptInputPacketsDropped = 0;
+
+	// Summed over the current clients' queues since they joined
+	int32 InputBufferUnderflows = 0;
+	int32 InputBufferOverflows = 0;
+	int32 InputsReplaced = 0;
+
+	// Deepest client input queue at the last step
+	int32 MaxInputBufferDepth = 0;
+};
+
+/**
+ * The authoritative per-match server tick, shared by ANetworkGameState and FHeadlessMatch
+ * Owns what a match does with its inputs between receiving them and broadcasting the result: batch packet checks,
+ * validation and de-duplication into each client's FInputJitterBuffer, the fixed-step consume and simulate,
+ * compensated actions, recording and the lag-compensation history. The owner supplies the world (IServerMatchWorld)
+ * and does its own snapshot broadcast
+ */
+class POCKETSTRIKER_API FServerMatchTick
+{
+public:
+	// Sets the fixed step and clears every client, counter and the history; Params must outlive the tick
+	void Init(const UNetworkParamsData& InParams, float InTickRate);
+
+	float GetTickRate() const { return TickRate; }
+	float GetTickInterval() const { return 1.0f / TickRate; }
+
+	// Checks a batch of packed input payloads in one pass; OutIntact gets one entry per payload
+	void VerifyInputPackets(TArrayView<const TArrayView<const uint8>> Packets, TArrayView<bool> OutIntact);
+
+	// Validates an unpacked input and queues it for its player, once per sequence; false if it was rejected or a duplicate
+	bool QueueInput(uint32 EntityId, const FInputPacket& Input);
+
+	// Range checks applied by QueueInput
+	bool bValidateInputs = true;
+
+	// One fixed step ending at Time on the server clock: records a keyframe when one is due, consumes each client's
+	// inputs for the step (two sharing it when its queue runs too deep), simulates and acts on each, and adds the history row
+	void Step(IServerMatchWorld& World, double Time);
+
+	// Newest input sequence simulated for a player, zero before the first
+	uint32 GetAcknowledgedSequence(uint32 EntityId) const;
+
+	// Forgets a player that left; its lag-compensation column is reused once it leaves the window
+	void RemoveClient(uint32 EntityId) { Clients.Remove(EntityId); }
+
+	int32 GetTickCount() const { return TickCount; }
+	const FServerMatchTickStats& GetStats() const { return Stats; }
+
+	// When a client's input was made on the server clock, less the delay it renders interpolated entities behind
+	double EstimateClientViewTime(const FInputCommand& Command, bool bInterpolated) const;
+	const FLagCompensationHistory& GetLagCompensationHistory() const { return LagCompensation; }
+
+	// Records every input the steps simulate, plus keyframes, until stopped
+	bool StartRecording(const FString& Filename);
+	void StopRecording() { Recorder.Reset(); }
+	const FMatchRecorder* GetRecorder() const { return Recorder.Get(); }
+
+	// Client queues, the history and the world buffer
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	struct FClient
+	{
+		FInputJitterBuffer InputBuffer;
+		uint32 AcknowledgedSequence = 0;
+	};
+
+	const UNetworkParamsData* Params = nullptr;
+	float TickRate = 60.0f;
+	int32 TickCount = 0;
+
+	TMap<uint32, FClient> Clients;
+	FServerMatchTickStats Stats;
+
+	TUniquePtr<FMatchRecorder> Recorder;
+	FLagCompensationHistory LagCompensation;
+
+	// Reused every step for the history row
+	FWorldSnapshot StepWorld;
+};
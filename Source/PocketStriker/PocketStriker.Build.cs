@@ -28,6 +28,11 @@ public class PocketStriker : ModuleRules
 			"AnimGraphRuntime"
 		});
 
+		// Fixed-point player simulation (movement, stamina, action timers), bit-identical across compilers and CPUs
+		// Verify with the perf.simhash console command
+		bool bDeterministicSimulation = false;
+		PublicDefinitions.Add("POCKETSTRIKER_DETERMINISTIC_SIM=" + (bDeterministicSimulation ? "1" : "0"));
+
 		// Module organization
 		PublicIncludePaths.AddRange(new string[]
 		{
@@ -126,6 +126,12 @@ void UDesignerPanel::RegisterNetworkParameters()
 	ExposeParameter(TEXT("Network.Prediction"), TEXT("CorrectionThreshold"), 1.0f, 100.0f);
 	CurrentParameters.Add(TEXT("CorrectionThreshold"), NetworkParamsData->CorrectionThreshold);
 
+	ExposeParameter(TEXT("Network.Prediction"), TEXT("VelocityCorrectionThreshold"), 1.0f, 200.0f);
+	CurrentParameters.Add(TEXT("VelocityCorrectionThreshold"), NetworkParamsData->VelocityCorrectionThreshold);
+
+	ExposeParameter(TEXT("Network.Prediction"), TEXT("StaminaCorrectionThreshold"), 0.5f, 20.0f);
+	CurrentParameters.Add(TEXT("StaminaCorrectionThreshold"), NetworkParamsData->StaminaCorrectionThreshold);
+
 	ExposeParameter(TEXT("Network.Prediction"), TEXT("SmoothingSpeed"), 1.0f, 50.0f);
 	CurrentParameters.Add(TEXT("SmoothingSpeed"), NetworkParamsData->SmoothingSpeed);
 
@@ -138,10 +144,13 @@ void UDesignerPanel::RegisterNetworkParameters()
 
 	// Register debug parameters
 	ExposeParameter(TEXT("Network.Debug"), TEXT("SimulatedLatency"), 0.0f, 500.0f);
-	CurrentParameters.Add(TEXT("SimulatedLatency"), NetworkParamsData->SimulatedLatency);
+	CurrentParameters.Add(TEXT("SimulatedLatency"), NetworkParamsData->NetworkConditions.LatencyMs);
+
+	ExposeParameter(TEXT("Network.Debug"), TEXT("SimulatedJitter"), 0.0f, 100.0f);
+	CurrentParameters.Add(TEXT("SimulatedJitter"), NetworkParamsData->NetworkConditions.JitterMs);
 
 	ExposeParameter(TEXT("Network.Debug"), TEXT("PacketLossPercentage"), 0.0f, 50.0f);
-	CurrentParameters.Add(TEXT("PacketLossPercentage"), NetworkParamsData->PacketLossPercentage);
+	CurrentParameters.Add(TEXT("PacketLossPercentage"), NetworkParamsData->NetworkConditions.PacketLossPercentage);
 }
 
 void UDesignerPanel::ExposeParameter(const FString& Category, const FString& Name, float MinValue, float MaxValue)
@@ -202,11 +211,14 @@ void UDesignerPanel::ApplyParameterToDataAsset(const FString& Name, float Value)
 	if (NetworkParamsData)
 	{
 		if (Name == TEXT("CorrectionThreshold")) NetworkParamsData->CorrectionThreshold = Value;
+		else if (Name == TEXT("VelocityCorrectionThreshold")) NetworkParamsData->VelocityCorrectionThreshold = Value;
+		else if (Name == TEXT("StaminaCorrectionThreshold")) NetworkParamsData->StaminaCorrectionThreshold = Value;
 		else if (Name == TEXT("SmoothingSpeed")) NetworkParamsData->SmoothingSpeed = Value;
 		else if (Name == TEXT("InterpolationDelay")) NetworkParamsData->InterpolationDelay = Value;
 		else if (Name == TEXT("StateBufferSize")) NetworkParamsData->StateBufferSize = static_cast<int32>(Value);
-		else if (Name == TEXT("SimulatedLatency")) NetworkParamsData->SimulatedLatency = Value;
-		else if (Name == TEXT("PacketLossPercentage")) NetworkParamsData->PacketLossPercentage = Value;
+		else if (Name == TEXT("SimulatedLatency")) NetworkParamsData->NetworkConditions.LatencyMs = Value;
+		else if (Name == TEXT("SimulatedJitter")) NetworkParamsData->NetworkConditions.JitterMs = Value;
+		else if (Name == TEXT("PacketLossPercentage")) NetworkParamsData->NetworkConditions.PacketLossPercentage = Value;
 	}
 }
 
@@ -241,11 +253,14 @@ float UDesignerPanel::GetParameterFromDataAsset(const FString& Name) const
 	if (NetworkParamsData)
 	{
 		if (Name == TEXT("CorrectionThreshold")) return NetworkParamsData->CorrectionThreshold;
+		if (Name == TEXT("VelocityCorrectionThreshold")) return NetworkParamsData->VelocityCorrectionThreshold;
+		if (Name == TEXT("StaminaCorrectionThreshold")) return NetworkParamsData->StaminaCorrectionThreshold;
 		if (Name == TEXT("SmoothingSpeed")) return NetworkParamsData->SmoothingSpeed;
 		if (Name == TEXT("InterpolationDelay")) return NetworkParamsData->InterpolationDelay;
 		if (Name == TEXT("StateBufferSize")) return static_cast<float>(NetworkParamsData->StateBufferSize);
-		if (Name == TEXT("SimulatedLatency")) return NetworkParamsData->SimulatedLatency;
-		if (Name == TEXT("PacketLossPercentage")) return NetworkParamsData->PacketLossPercentage;
+		if (Name == TEXT("SimulatedLatency")) return NetworkParamsData->NetworkConditions.LatencyMs;
+		if (Name == TEXT("SimulatedJitter")) return NetworkParamsData->NetworkConditions.JitterMs;
+		if (Name == TEXT("PacketLossPercentage")) return NetworkParamsData->NetworkConditions.PacketLossPercentage;
 	}
 
 	return 0.0f;
@@ -0,0 +1,51 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "MatchReplayCommandlet.h"
+#include "MatchReplayer.h"
+
+UMatchReplayCommandlet::UMatchReplayCommandlet()
+{
+	IsClient = false;
+	IsServer = true;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UMatchReplayCommandlet::Main(const FString& Params)
+{
+	FString Filename;
+	if (!FParse::Value(*Params, TEXT("file="), Filename))
+	{
+		UE_LOG(LogTemp, Error, TEXT("MatchReplay: Usage: -run=MatchReplay -file=<recording> [-noresync] [-repeat=N]"));
+		return 1;
+	}
+
+	FMatchReplayConfig Config;
+	Config.bResyncAtKeyframes = !FParse::Param(*Params, TEXT("noresync"));
+	int32 Repeat = 1;
+	FParse::Value(*Params, TEXT("repeat="), Repeat);
+
+	uint64 FirstHash = 0;
+	for (int32 Run = 0; Run < FMath::Max(1, Repeat); ++Run)
+	{
+		const FMatchReplayReport Report = FMatchReplayer::Run(Filename, Config);
+		Report.Log();
+		if (!Report.bLoaded)
+		{
+			return 1;
+		}
+
+		if (Run == 0)
+		{
+			FirstHash = Report.FinalHash;
+		}
+		else if (Report.FinalHash != FirstHash)
+		{
+			UE_LOG(LogTemp, Error, TEXT("MatchReplay: run %d ended on %016llx, run 0 on %016llx; the replay is not deterministic"),
+				Run, Report.FinalHash, FirstHash);
+			return 1;
+		}
+	}
+
+	return 0;
+}
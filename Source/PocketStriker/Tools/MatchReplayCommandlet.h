@@ -0,0 +1,23 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MatchReplayCommandlet.generated.h"
+
+/**
+ * Replays a match recording headless, for desync hunts and simulation regression checks
+ * UnrealEditor-Cmd PocketStriker -run=MatchReplay -file=Saved/Recordings/Match.psrec [-noresync] [-repeat=2]
+ * With -repeat every run must end on the same hash; returns non-zero if they differ or the file cannot be read
+ */
+UCLASS()
+class POCKETSTRIKER_API UMatchReplayCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMatchReplayCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
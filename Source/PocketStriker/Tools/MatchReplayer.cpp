@@ -0,0 +1,206 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "MatchReplayer.h"
+#include "../Gameplay/GameplayTypes.h"
+#include "../Network/MatchRecording.h"
+#include "../Network/NetworkSnapshot.h"
+#include "../Network/NetTrafficStats.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "HAL/IConsoleManager.h"
+
+FMatchReplayReport FMatchReplayer::Run(const FString& Filename, const FMatchReplayConfig& Config)
+{
+	FMatchReplayReport Report;
+
+	const double RunStart = FPlatformTime::Seconds();
+	FMatchRecordingReader Reader;
+	if (!Reader.Open(Filename))
+	{
+		return Report;
+	}
+	Report.bLoaded = true;
+	Report.FileBytes = Reader.GetNumBytes();
+
+	const FMatchRecordingHeader& Header = Reader.GetHeader();
+	const float TickInterval = 1.0f / Header.TickRate;
+	const FBoundsCollisionResolver Resolver(FBox(Header.Quantization.PitchMin, Header.Quantization.PitchMax));
+
+	TMap<uint32, FMovementSimState> Players;
+	TArray<double> TickTimes;
+	double DriftSum = 0.0;
+	int64 DriftSamples = 0;
+	int32 FirstTick = INDEX_NONE;
+	int32 LastTick = 0;
+
+	FMatchRecordingFrame Frame;
+	for (;;)
+	{
+		const double DecodeStart = FPlatformTime::Seconds();
+		const bool bRead = Reader.ReadFrame(Frame);
+		Report.DecodeSeconds += FPlatformTime::Seconds() - DecodeStart;
+		if (!bRead)
+		{
+			break;
+		}
+
+		FirstTick = FirstTick == INDEX_NONE ? Frame.Tick : FirstTick;
+		LastTick = Frame.Tick;
+		Report.Ticks++;
+
+		const double SimulateStart = FPlatformTime::Seconds();
+
+		if (Frame.bHasKeyframe)
+		{
+			Report.Keyframes++;
+			for (const FEntitySnapshotState& Entity : Frame.Keyframe.Entities)
+			{
+				if (Entity.EntityId == FWorldSnapshot::BallEntityId)
+				{
+					continue;
+				}
+
+				FMovementSimState* State = Players.Find(Entity.EntityId);
+				if (State)
+				{
+					const double Drift = FVector::Dist(State->Position, Entity.Position);
+					DriftSum += Drift;
+					DriftSamples++;
+					if (Drift > Report.MaxDrift)
+					{
+						Report.MaxDrift = Drift;
+						Report.MaxDriftTick = Frame.Tick;
+					}
+					if (!Config.bResyncAtKeyframes)
+					{
+						continue;
+					}
+				}
+				else
+				{
+					State = &Players.Add(Entity.EntityId);
+				}
+
+				State->Position = Entity.Position;
+				State->Velocity = Entity.Velocity;
+				State->Stamina = Entity.Stamina;
+			}
+		}
+
+		// Recorded inputs are exactly the ones the server consumed, so a player without one did not move this tick
+		for (const TPair<uint32, FInputCommand>& Input : Frame.Inputs)
+		{
+			FMovementSimState* State = Players.Find(Input.Key);
+			if (!State)
+			{
+				Report.InputsSkipped++;
+				continue;
+			}
+
+			*State = FMovementSimulation::RegenerateStamina(
+				FMovementSimulation::Step(*State, Input.Value, TickInterval, Config.Tuning, &Resolver), TickInterval, Config.Tuning);
+			Report.InputsReplayed++;
+		}
+
+		const double SimulateTime = FPlatformTime::Seconds() - SimulateStart;
+		Report.SimulateSeconds += SimulateTime;
+		TickTimes.Add(SimulateTime * 1000000.0);
+	}
+
+	Report.bTruncated = Reader.IsError();
+	Report.WallSeconds = FPlatformTime::Seconds() - RunStart;
+	Report.Players = Players.Num();
+	Report.MatchSeconds = FirstTick == INDEX_NONE ? 0.0 : (LastTick - FirstTick + 1) * static_cast<double>(TickInterval);
+	Report.SpeedFactor = Report.WallSeconds > 0.0 ? Report.MatchSeconds / Report.WallSeconds : 0.0;
+	Report.MeanDrift = DriftSamples > 0 ? DriftSum / DriftSamples : 0.0;
+	Report.BytesPerMinute = Report.MatchSeconds > 0.0 ? Report.FileBytes * 60.0 / Report.MatchSeconds : 0.0;
+
+	double TickSum = 0.0;
+	for (double Time : TickTimes)
+	{
+		TickSum += Time;
+	}
+	TickTimes.Sort();
+	Report.TickMeanMicroseconds = TickTimes.Num() > 0 ? TickSum / TickTimes.Num() : 0.0;
+	Report.TickP99Microseconds = FNetTrafficStats::GetPercentile(TickTimes, 0.99);
+
+	Players.KeySort(TLess<uint32>());
+	uint64 Hash = 0xcbf29ce484222325ull;
+	for (const TPair<uint32, FMovementSimState>& Player : Players)
+	{
+		Hash = FMovementSimulation::HashState(Player.Value, Hash ^ Player.Key);
+	}
+	Report.FinalHash = Hash;
+
+	return Report;
+}
+
+void FMatchReplayReport::Log() const
+{
+	if (!bLoaded)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Match replay: recording could not be loaded"));
+		return;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Match replay: %d ticks (%.1f s of match), %d players, %d keyframes, %lld inputs replayed, %lld skipped%s"),
+		Ticks, MatchSeconds, Players, Keyframes, InputsReplayed, InputsSkipped, bTruncated ? TEXT(", truncated") : TEXT(""));
+	UE_LOG(LogTemp, Log, TEXT("Match replay: %.3f s wall (decode %.3f s, simulate %.3f s), %.0fx real time; tick mean %.2f us, p99 %.2f us"),
+		WallSeconds, DecodeSeconds, SimulateSeconds, SpeedFactor, TickMeanMicroseconds, TickP99Microseconds);
+	UE_LOG(LogTemp, Log, TEXT("Match replay: keyframe drift mean %.3f cm, max %.3f cm (tick %d); %lld bytes, %.1f KB per match minute; final hash %016llx"),
+		MeanDrift, MaxDrift, MaxDriftTick, FileBytes, BytesPerMinute / 1024.0, FinalHash);
+}
+
+#if !UE_BUILD_SHIPPING
+
+namespace
+{
+	void RunMatchReplay(const TArray<FString>& Args)
+	{
+		FString Filename = Args.Num() > 0 && Args[0] != TEXT("noresync") ? Args[0] : FString();
+		FMatchReplayConfig Config;
+		Config.bResyncAtKeyframes = !Args.Contains(TEXT("noresync"));
+
+		if (Filename.IsEmpty())
+		{
+			const FString Directory = FPaths::ProjectSavedDir() / TEXT("Recordings");
+			TArray<FString> Recordings;
+			IFileManager::Get().FindFiles(Recordings, *(Directory / TEXT("*.psrec")), true, false);
+
+			FDateTime Newest = FDateTime::MinValue();
+			for (const FString& Recording : Recordings)
+			{
+				const FDateTime Modified = IFileManager::Get().GetTimeStamp(*(Directory / Recording));
+				if (Modified > Newest)
+				{
+					Newest = Modified;
+					Filename = Directory / Recording;
+				}
+			}
+
+			if (Filename.IsEmpty())
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Match replay: no recordings in %s"), *Directory);
+				return;
+			}
+		}
+
+		const FMatchReplayReport First = FMatchReplayer::Run(Filename, Config);
+		First.Log();
+		if (!First.bLoaded)
+		{
+			return;
+		}
+
+		const FMatchReplayReport Second = FMatchReplayer::Run(Filename, Config);
+		UE_LOG(LogTemp, Log, TEXT("Match replay: second run %s (%016llx)"),
+			Second.FinalHash == First.FinalHash ? TEXT("matches") : TEXT("DIFFERS"), Second.FinalHash);
+	}
+
+	FAutoConsoleCommand MatchReplayCommand(
+		TEXT("perf.matchreplay"),
+		TEXT("Replay a match recording headless twice, report speed and keyframe drift, and check both runs end on the same hash. Usage: perf.matchreplay [file (newest in Saved/Recordings)] [noresync]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunMatchReplay));
+}
+
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,72 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "../Gameplay/MovementSimulation.h"
+
+/**
+ * How a recording is replayed
+ */
+struct POCKETSTRIKER_API FMatchReplayConfig
+{
+	// Snap every player to each keyframe after measuring drift; off lets drift build up over the whole match
+	bool bResyncAtKeyframes = true;
+
+	FMovementSimTuning Tuning;
+};
+
+/**
+ * What one replay measured
+ */
+struct POCKETSTRIKER_API FMatchReplayReport
+{
+	bool bLoaded = false;
+
+	// The file ended without its end record (the server stopped mid-match); everything before the cut was replayed
+	bool bTruncated = false;
+
+	int32 Ticks = 0;
+	int32 Players = 0;
+	int32 Keyframes = 0;
+	int64 InputsReplayed = 0;
+
+	// Inputs for a player no keyframe had introduced yet (joined since the last keyframe)
+	int64 InputsSkipped = 0;
+
+	// Match time covered and what replaying it cost
+	double MatchSeconds = 0.0;
+	double WallSeconds = 0.0;
+	double DecodeSeconds = 0.0;
+	double SimulateSeconds = 0.0;
+	double TickMeanMicroseconds = 0.0;
+	double TickP99Microseconds = 0.0;
+
+	// Match seconds replayed per wall second
+	double SpeedFactor = 0.0;
+
+	// Replayed player positions against each keyframe after the first, cm
+	double MeanDrift = 0.0;
+	double MaxDrift = 0.0;
+	int32 MaxDriftTick = 0;
+
+	// Every player's final state, in entity id order
+	uint64 FinalHash = 0;
+
+	int64 FileBytes = 0;
+	double BytesPerMinute = 0.0;
+
+	void Log() const;
+};
+
+/**
+ * Replays a match recording (FMatchRecorder) through the headless server simulation, as fast as it decodes
+ * Players start from the first keyframe they appear in and step once per recorded input with FMovementSimulation
+ * against the pitch bounds, the model FNetLoadHarness serves with; the ball is carried by the keyframes.
+ * Nothing is paced, so a match replays many times faster than real time
+ */
+class POCKETSTRIKER_API FMatchReplayer
+{
+public:
+	static FMatchReplayReport Run(const FString& Filename, const FMatchReplayConfig& Config);
+};
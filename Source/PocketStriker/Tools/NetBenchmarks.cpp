@@ -0,0 +1,555 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "../Network/InputRunBuffer.h"
+#include "../Network/NetPacketChecksum.h"
+#include "../Network/NetworkConditioner.h"
+#include "../Network/LagCompensation.h"
+#include "../Network/RollbackSession.h"
+#include "../Network/NetworkSnapshot.h"
+#include "../Network/NetTrafficStats.h"
+#include "../Network/NetworkParamsData.h"
+#include "../Gameplay/PocketStrikerPlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+
+#if !UE_BUILD_SHIPPING
+
+// perf.* benchmarks for the network primitives; they run on synthetic data and are left out of shipping builds
+namespace
+{
+	void RunInputRunBenchmark(const TArray<FString>& Args)
+	{
+		const int32 NumTicks = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 36000;
+		const int32 HoldTicks = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 20;
+		const UNetworkParamsData* Params = GetDefault<UNetworkParamsData>();
+		const FNetQuantizationSettings& Settings = Params->Quantization;
+		const int32 Window = FMath::Clamp(Params->InputRedundancyWindow, 1, static_cast<int32>(APocketStrikerPlayerController::MaxRedundantInputs));
+
+		// A player who holds each stick position for about HoldTicks, with a 60 Hz frame time that wobbles
+		// and acknowledgements a 100 ms round trip behind
+		const int32 AckDelayTicks = 6;
+		FRandomStream Random(1);
+		FInputRunBuffer Buffer(64);
+		TMap<uint32, FInputPacket> Sent;
+		FInputPacket Held;
+		double ClientTime = 0.0;
+
+		int64 RunBytes = 0;
+		int64 SingleBytes = 0;
+		int64 RunsSent = 0;
+		int32 PeakRuns = 0;
+		SIZE_T PeakAllocated = 0;
+		int32 PayloadMismatches = 0;
+		int32 ActionTimestampMismatches = 0;
+		uint32 MaxTimestampErrorMs = 0;
+		double PackSeconds = 0.0;
+		double UnpackSeconds = 0.0;
+
+		TArray<FInputRun> Runs;
+		TArray<FInputRun> Singles;
+		TArray<FInputPacket> Unpacked;
+		for (int32 Tick = 1; Tick <= NumTicks; ++Tick)
+		{
+			ClientTime += Random.FRandRange(15.0f, 18.5f) / 1000.0;
+			if (Random.FRand() < 1.0f / HoldTicks)
+			{
+				Held.MovementInput = Random.FRand() < 0.2f ? FVector2D::ZeroVector : FVector2D(Random.FRandRange(-1.0f, 1.0f), Random.FRandRange(-1.0f, 1.0f));
+			}
+			if (Random.FRand() < 0.01f)
+			{
+				Held.ActionFlags ^= FInputPacket::FLAG_SPRINT;
+			}
+
+			FInputPacket Input = Held;
+			Input.SequenceNumber = Tick;
+			Input.ClientTimestamp = static_cast<float>(ClientTime);
+			if (Random.FRand() < 0.01f)
+			{
+				Input.ActionFlags |= FInputPacket::FLAG_KICK;
+			}
+			Input.Quantize(Settings);
+			Buffer.Add(Input);
+			Sent.Add(Input.SequenceNumber, Input);
+
+			const uint32 Acked = Tick > AckDelayTicks ? static_cast<uint32>(Tick - AckDelayTicks) : 0;
+			Buffer.ReleaseUpTo(Acked);
+			PeakRuns = FMath::Max(PeakRuns, Buffer.NumRuns());
+			PeakAllocated = FMath::Max(PeakAllocated, Buffer.GetAllocatedSize());
+
+			double Start = FPlatformTime::Seconds();
+			Buffer.GetRunsAfter(Acked, Window, Runs);
+			const TArray<uint8> Packet = APocketStrikerPlayerController::PackInputRuns(Runs, Settings);
+			PackSeconds += FPlatformTime::Seconds() - Start;
+			RunBytes += Packet.Num();
+			RunsSent += Runs.Num();
+
+			Singles.Reset();
+			for (const FInputRun& Run : Runs)
+			{
+				for (uint32 Sequence = Run.FirstSequence; Sequence <= Run.GetLastSequence(); ++Sequence)
+				{
+					Singles.Add(FInputRun::FromInput(Run.GetInput(Sequence)));
+				}
+			}
+			SingleBytes += APocketStrikerPlayerController::PackInputRuns(Singles, Settings).Num();
+
+			Start = FPlatformTime::Seconds();
+			Unpacked.Reset();
+			APocketStrikerPlayerController::UnpackInputs(Packet, Settings, Unpacked);
+			UnpackSeconds += FPlatformTime::Seconds() - Start;
+
+			for (const FInputPacket& Received : Unpacked)
+			{
+				const FInputPacket& Original = Sent.FindChecked(Received.SequenceNumber);
+				if (Received.MovementInput != Original.MovementInput || Received.LookInput != Original.LookInput || Received.ActionFlags != Original.ActionFlags)
+				{
+					PayloadMismatches++;
+				}
+
+				const uint32 ErrorMs = static_cast<uint32>(FMath::Abs(static_cast<int64>(FNetQuantize::QuantizeTimestamp(Received.ClientTimestamp))
+					- static_cast<int64>(FNetQuantize::QuantizeTimestamp(Original.ClientTimestamp))));
+				MaxTimestampErrorMs = FMath::Max(MaxTimestampErrorMs, ErrorMs);
+				if (ErrorMs > 0 && (Original.ActionFlags & ~FInputRun::HeldFlags) != 0)
+				{
+					ActionTimestampMismatches++;
+				}
+			}
+		}
+
+		UE_LOG(LogTemp, Log, TEXT("Input run bench: %d ticks, stick held ~%d ticks, window %d: %.1f runs per packet"),
+			NumTicks, HoldTicks, Window, static_cast<double>(RunsSent) / NumTicks);
+		UE_LOG(LogTemp, Log, TEXT("Input run bench: %.1f bytes per packet coalesced, %.1f one run per input (%.0f%% saved); pack %.0f ns, unpack %.0f ns"),
+			static_cast<double>(RunBytes) / NumTicks, static_cast<double>(SingleBytes) / NumTicks,
+			SingleBytes > 0 ? 100.0 * (1.0 - static_cast<double>(RunBytes) / SingleBytes) : 0.0,
+			PackSeconds * 1e9 / NumTicks, UnpackSeconds * 1e9 / NumTicks);
+		UE_LOG(LogTemp, Log, TEXT("Input run bench: buffer peak %d runs, %llu bytes (one slot per sequence: %llu); payload mismatches %d, max timestamp error %u ms, action timestamp mismatches %d"),
+			PeakRuns, static_cast<uint64>(PeakAllocated), static_cast<uint64>(Buffer.GetCapacity() * sizeof(FInputPacket)),
+			PayloadMismatches, MaxTimestampErrorMs, ActionTimestampMismatches);
+	}
+
+	FAutoConsoleCommand InputRunBenchmarkCommand(
+		TEXT("perf.inputrunbench"),
+		TEXT("Send a synthetic input stream through the run-length input buffer and packets, check the expanded inputs and compare against one run per input. Usage: perf.inputrunbench [ticks] [holdticks]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunInputRunBenchmark));
+
+	void RunChecksumBenchmark(const TArray<FString>& Args)
+	{
+		const int32 NumPackets = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 4096;
+		FRandomStream Random(Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 1);
+
+		const char* CheckInput = "123456789";
+		const uint32 CheckCrc = FNetCrc32C::Compute(CheckInput, 9);
+		if (CheckCrc != FNetCrc32C::CheckValue)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Checksum benchmark: %s CRC32C gave 0x%08x for the check string, expected 0x%08x"),
+				FNetCrc32C::GetImplementationName(), CheckCrc, FNetCrc32C::CheckValue);
+			return;
+		}
+
+		// Real input packets, each carrying a full redundancy window
+		const UNetworkParamsData* Params = GetDefault<UNetworkParamsData>();
+		const int32 Window = FMath::Clamp(Params->InputRedundancyWindow, 1, static_cast<int32>(APocketStrikerPlayerController::MaxRedundantInputs));
+		TArray<TArray<uint8>> Packets;
+		Packets.Reserve(NumPackets);
+		TArray<FInputCommand> Inputs;
+		Inputs.SetNum(Window);
+		int64 TotalBytes = 0;
+		for (int32 PacketIndex = 0; PacketIndex < NumPackets; ++PacketIndex)
+		{
+			for (int32 i = 0; i < Window; ++i)
+			{
+				FInputCommand& Input = Inputs[i];
+				Input.SequenceNumber = PacketIndex + i + 1;
+				Input.ClientTimestamp = Input.SequenceNumber / 60.0f;
+				Input.MovementInput = FVector2D(Random.FRandRange(-1.0f, 1.0f), Random.FRandRange(-1.0f, 1.0f));
+				Input.LookInput = FVector2D(Random.FRandRange(-1.0f, 1.0f), Random.FRandRange(-1.0f, 1.0f));
+				Input.ActionFlags = Random.RandHelper(FInputPacket::FLAG_MASK + 1);
+			}
+			TotalBytes += Packets.Add_GetRef(APocketStrikerPlayerController::PackInputs(Inputs, Params->Quantization)).Num();
+		}
+
+		TArray<TArrayView<const uint8>> Views;
+		for (const TArray<uint8>& Packet : Packets)
+		{
+			Views.Add(Packet);
+		}
+		TArray<bool> Intact;
+		Intact.SetNumUninitialized(NumPackets);
+
+		// One packet at a time, as a client checks snapshots, then a server tick's worth at once
+		const int32 Repeats = 16;
+		int32 NumFailed = 0;
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 Repeat = 0; Repeat < Repeats; ++Repeat)
+		{
+			for (const TArrayView<const uint8>& View : Views)
+			{
+				NumFailed += FNetPacketChecksum::Verify(View) ? 0 : 1;
+			}
+		}
+		const double SingleNs = (FPlatformTime::Seconds() - StartTime) * 1e9 / (static_cast<double>(Repeats) * NumPackets);
+
+		const int32 BatchSize = 64;
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Repeat = 0; Repeat < Repeats; ++Repeat)
+		{
+			for (int32 First = 0; First < NumPackets; First += BatchSize)
+			{
+				const int32 Count = FMath::Min(BatchSize, NumPackets - First);
+				NumFailed += FNetPacketChecksum::VerifyMany(MakeArrayView(Views).Slice(First, Count), MakeArrayView(Intact).Slice(First, Count));
+			}
+		}
+		const double BatchNs = (FPlatformTime::Seconds() - StartTime) * 1e9 / (static_cast<double>(Repeats) * NumPackets);
+
+		// Flip 1-3 random bits anywhere in the packet, checksum included
+		int32 Undetected = 0;
+		for (TArray<uint8>& Packet : Packets)
+		{
+			const int32 NumFlips = 1 + Random.RandHelper(3);
+			for (int32 Flip = 0; Flip < NumFlips; ++Flip)
+			{
+				const int32 Bit = Random.RandHelper(Packet.Num() * 8);
+				Packet[Bit / 8] ^= static_cast<uint8>(1 << (Bit % 8));
+			}
+			Undetected += FNetPacketChecksum::Verify(Packet) ? 1 : 0;
+		}
+
+		UE_LOG(LogTemp, Log, TEXT("Checksum benchmark: %s CRC32C, %d input packets of %d inputs (%.1f bytes avg)"),
+			FNetCrc32C::GetImplementationName(), NumPackets, Window, static_cast<double>(TotalBytes) / NumPackets);
+		UE_LOG(LogTemp, Log, TEXT("Checksum benchmark: verify %.1f ns/packet one at a time, %.1f ns/packet in batches of %d"),
+			SingleNs, BatchNs, BatchSize);
+		if (NumFailed > 0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Checksum benchmark: %d intact packets FAILED verification"), NumFailed);
+		}
+		if (Undetected > 0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Checksum benchmark: %d of %d corrupted packets went UNDETECTED"), Undetected, NumPackets);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Log, TEXT("Checksum benchmark: all %d packets with 1-3 flipped bits were rejected"), NumPackets);
+		}
+	}
+
+	FAutoConsoleCommand ChecksumBenchmarkCommand(
+		TEXT("perf.crcbench"),
+		TEXT("Check the CRC32C implementation, time per-packet and batched verification of real input packets, and count detected bit flips. Usage: perf.crcbench [packets] [seed]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunChecksumBenchmark));
+
+	void RunConditionerBenchmark(const TArray<FString>& Args)
+	{
+		const float Seconds = Args.Num() > 0 ? FMath::Max(1.0f, FCString::Atof(*Args[0])) : 60.0f;
+		const float SendInterval = 1.0f / 60.0f;
+		const int32 NumPackets = FMath::CeilToInt(Seconds / SendInterval);
+		const int32 PayloadBytes = 48;
+
+		FNetworkConditionerSettings Settings = GetDefault<UNetworkParamsData>()->NetworkConditions;
+		if (!Settings.IsActive())
+		{
+			// A congested mobile link
+			Settings.LatencyMs = 60.0f;
+			Settings.JitterMs = 15.0f;
+			Settings.JitterDistribution = ENetJitterDistribution::Normal;
+			Settings.PacketLossPercentage = 1.0f;
+			Settings.BurstStartPercentage = 1.0f;
+			Settings.ReorderPercentage = 2.0f;
+			Settings.DuplicatePercentage = 1.0f;
+			Settings.BandwidthKbps = 256.0f;
+		}
+		if (Args.Num() > 1)
+		{
+			Settings.Seed = FCString::Atoi(*Args[1]);
+		}
+
+		struct FRunResult
+		{
+			uint32 DeliveryHash = 0;
+			TArray<double> DelaysMs;
+			int32 OutOfOrder = 0;
+			int32 Missing = 0;
+			int32 LongestLossRun = 0;
+			FNetworkConditionerStats Stats;
+			double ElapsedMs = 0.0;
+		};
+
+		auto Run = [&Settings, NumPackets, SendInterval, PayloadBytes]()
+		{
+			FRunResult Result;
+			FNetworkConditioner Conditioner;
+			Conditioner.Configure(Settings);
+			Conditioner.Reset();
+
+			TArray<uint8> Payload;
+			Payload.SetNumZeroed(PayloadBytes);
+			TArray<double> SendTimes;
+			SendTimes.SetNumZeroed(NumPackets);
+			TArray<bool> Received;
+			Received.SetNumZeroed(NumPackets);
+			int32 NewestReceived = INDEX_NONE;
+
+			auto OnDeliver = [&](double Now)
+			{
+				return [&, Now](uint8 Channel, const TArray<uint8>& Delivered)
+				{
+					int32 Index = 0;
+					FMemory::Memcpy(&Index, Delivered.GetData(), sizeof(Index));
+					Result.DelaysMs.Add((Now - SendTimes[Index]) * 1000.0);
+					Result.OutOfOrder += Index < NewestReceived ? 1 : 0;
+					NewestReceived = FMath::Max(NewestReceived, Index);
+					Received[Index] = true;
+
+					const uint32 Record[2] = { static_cast<uint32>(Index), static_cast<uint32>(FMath::RoundToInt(Now * 1000.0)) };
+					Result.DeliveryHash = FCrc::MemCrc32(Record, sizeof(Record), Result.DeliveryHash);
+				};
+			};
+
+			const double StartTime = FPlatformTime::Seconds();
+
+			// Send one packet per tick, then keep ticking until the queue is empty
+			int32 Tick = 0;
+			for (; Tick < NumPackets || Conditioner.GetNumQueued() > 0; ++Tick)
+			{
+				const double Now = Tick * SendInterval;
+				if (Tick < NumPackets)
+				{
+					SendTimes[Tick] = Now;
+					FMemory::Memcpy(Payload.GetData(), &Tick, sizeof(Tick));
+					Conditioner.Submit(0, Payload, Now);
+				}
+				Conditioner.Drain(Now, OnDeliver(Now));
+			}
+			Result.ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+			int32 LossRun = 0;
+			for (bool bReceived : Received)
+			{
+				LossRun = bReceived ? 0 : LossRun + 1;
+				Result.Missing += bReceived ? 0 : 1;
+				Result.LongestLossRun = FMath::Max(Result.LongestLossRun, LossRun);
+			}
+
+			Result.Stats = Conditioner.GetStats();
+			return Result;
+		};
+
+		FRunResult First = Run();
+		const FRunResult Second = Run();
+
+		First.DelaysMs.Sort();
+
+		const FNetworkConditionerStats& Stats = First.Stats;
+		UE_LOG(LogTemp, Log, TEXT("Conditioner benchmark: seed %d, %d packets over %.0f s, latency %.0f ms, jitter %.0f ms, loss %.1f%% (bursts %.1f%%), reorder %.1f%%, duplicate %.1f%%, %.0f kbit/s"),
+			Settings.Seed, NumPackets, Seconds, Settings.LatencyMs, Settings.JitterMs, Settings.PacketLossPercentage, Settings.BurstStartPercentage,
+			Settings.ReorderPercentage, Settings.DuplicatePercentage, Settings.BandwidthKbps);
+		UE_LOG(LogTemp, Log, TEXT("Conditioner benchmark: delivered %d, lost %d, queue dropped %d, missing %.2f%% (longest run %d), reordered %d, duplicated %d, out of order on arrival %d"),
+			Stats.PacketsDelivered, Stats.PacketsLost, Stats.PacketsQueueDropped, NumPackets > 0 ? First.Missing * 100.0f / NumPackets : 0.0f,
+			First.LongestLossRun, Stats.PacketsReordered, Stats.PacketsDuplicated, First.OutOfOrder);
+		UE_LOG(LogTemp, Log, TEXT("Conditioner benchmark: delay avg %.1f ms, p50 %.1f ms, p99 %.1f ms, max %.1f ms; %.3f ms to run"),
+			Stats.GetAverageDelay() * 1000.0, FNetTrafficStats::GetPercentile(First.DelaysMs, 0.5), FNetTrafficStats::GetPercentile(First.DelaysMs, 0.99), Stats.MaxDelay * 1000.0, First.ElapsedMs);
+
+		if (First.DeliveryHash == Second.DeliveryHash)
+		{
+			UE_LOG(LogTemp, Log, TEXT("Conditioner benchmark: second run with the same seed delivered identically (0x%08x)"), First.DeliveryHash);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Error, TEXT("Conditioner benchmark: second run with the same seed DIFFERED (0x%08x vs 0x%08x)"), First.DeliveryHash, Second.DeliveryHash);
+		}
+	}
+
+	FAutoConsoleCommand ConditionerBenchmarkCommand(
+		TEXT("perf.netconditionbench"),
+		TEXT("Push a 60 Hz packet stream through the network conditioner (NetworkConditions, or a bad-network preset when those are off) twice and check both runs match. Usage: perf.netconditionbench [seconds] [seed]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunConditionerBenchmark));
+
+	void RunRewindBenchmark(const TArray<FString>& Args)
+	{
+		const int32 NumEntities = Args.Num() > 0 ? FMath::Clamp(FCString::Atoi(*Args[0]), 1, static_cast<int32>(FWorldSnapshotCodec::MaxEntities)) : 17;
+		const int32 NumQueries = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 100000;
+		const UNetworkParamsData* Params = GetDefault<UNetworkParamsData>();
+		const float TickInterval = 1.0f / FMath::Max(Params->ServerTickRate, 1.0f);
+
+		// Straight lines at up to sprint speed, so the interpolated answer is known exactly
+		FRandomStream Random(1);
+		TArray<FVector> Starts;
+		TArray<FVector> Velocities;
+		for (int32 i = 0; i < NumEntities; ++i)
+		{
+			Starts.Add(FVector(Random.FRandRange(-5000.0f, 5000.0f), Random.FRandRange(-3000.0f, 3000.0f), 0.0f));
+			Velocities.Add(FVector(Random.FRandRange(-900.0f, 900.0f), Random.FRandRange(-900.0f, 900.0f), 0.0f));
+		}
+
+		FLagCompensationHistory History;
+		History.Init(TickInterval, Params->LagCompensationMaxRewind, FWorldSnapshotCodec::MaxEntities);
+
+		// Two windows' worth, so the ring has wrapped
+		const int32 NumTicks = FMath::CeilToInt(2.0f * Params->LagCompensationMaxRewind / TickInterval);
+		const double RecordStart = FPlatformTime::Seconds();
+		for (int32 Tick = 0; Tick < NumTicks; ++Tick)
+		{
+			const double Time = Tick * static_cast<double>(TickInterval);
+			History.BeginTick(Time);
+			for (int32 i = 0; i < NumEntities; ++i)
+			{
+				History.RecordPosition(FWorldSnapshot::MakePlayerEntityId(i), Starts[i] + Velocities[i] * Time);
+			}
+		}
+		const double RecordNs = (FPlatformTime::Seconds() - RecordStart) * 1e9 / NumTicks;
+
+		TArray<double> QueryTimes;
+		TArray<int32> QueryEntities;
+		QueryTimes.SetNumUninitialized(NumQueries);
+		QueryEntities.SetNumUninitialized(NumQueries);
+		for (int32 i = 0; i < NumQueries; ++i)
+		{
+			QueryTimes[i] = Random.FRandRange(History.GetOldestTime(), History.GetNewestTime());
+			QueryEntities[i] = Random.RandRange(0, NumEntities - 1);
+		}
+
+		double Checksum = 0.0;
+		const double QueryStart = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumQueries; ++i)
+		{
+			FVector Position;
+			if (History.SamplePosition(FWorldSnapshot::MakePlayerEntityId(QueryEntities[i]), QueryTimes[i], Position))
+			{
+				Checksum += Position.X;
+			}
+		}
+		const double QueryNs = (FPlatformTime::Seconds() - QueryStart) * 1e9 / NumQueries;
+
+		double MaxError = 0.0;
+		for (int32 i = 0; i < FMath::Min(NumQueries, 10000); ++i)
+		{
+			FVector Position = FVector::ZeroVector;
+			History.SamplePosition(FWorldSnapshot::MakePlayerEntityId(QueryEntities[i]), QueryTimes[i], Position);
+			const FVector Expected = Starts[QueryEntities[i]] + Velocities[QueryEntities[i]] * QueryTimes[i];
+			MaxError = FMath::Max(MaxError, FVector::Dist(Position, Expected));
+		}
+
+		UE_LOG(LogTemp, Log, TEXT("Rewind bench: %d entities, %d ticks kept (%.2f s), %llu bytes"),
+			NumEntities, History.GetNumTicks(), History.GetNewestTime() - History.GetOldestTime(), static_cast<uint64>(History.GetAllocatedSize()));
+		UE_LOG(LogTemp, Log, TEXT("Rewind bench: record %.0f ns per tick, query %.1f ns, max error %.4f cm (checksum %.0f)"),
+			RecordNs, QueryNs, MaxError, Checksum);
+	}
+
+	FAutoConsoleCommand RewindBenchmarkCommand(
+		TEXT("perf.rewindbench"),
+		TEXT("Fill the lag compensation history with entities on straight paths, time rewind queries and check them against the true positions. Usage: perf.rewindbench [entities] [queries]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunRewindBenchmark));
+
+	void RunRollbackBenchmark(const TArray<FString>& Args)
+	{
+		const int32 NumPlayers = Args.Num() > 0 ? FMath::Clamp(FCString::Atoi(*Args[0]), 2, FMatchSimState::MaxPlayers) : FMatchSimState::MaxPlayers;
+		const int32 NumFrames = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 3600;
+		const int32 MaxRollbackFrames = GetDefault<UNetworkParamsData>()->MaxRollbackFrames;
+		const float DeltaTime = 1.0f / 60.0f;
+		const int32 RemotePlayer = NumPlayers - 1;
+
+		// Two lines of players facing each other across the centre spot
+		FMatchSimState InitialState;
+		InitialState.NumPlayers = NumPlayers;
+		for (int32 i = 0; i < NumPlayers; ++i)
+		{
+			InitialState.Players[i].Movement.Position = FVector((i % 2 ? 1.0f : -1.0f) * 500.0f, (i / 2) * 400.0f - 600.0f, 0.0f);
+		}
+		const FMatchSimTuning Tuning;
+
+		// A new direction every frame so every late remote input disagrees with its prediction
+		auto MakeInput = [](int32 PlayerIndex, int32 Frame)
+		{
+			FInputCommand Input;
+			const float Angle = Frame * 0.05f + PlayerIndex;
+			Input.MovementInput = FVector2D(FMath::Cos(Angle), FMath::Sin(Angle));
+			Input.ActionFlags = (Frame / 90) % 2 ? FInputCommand::FLAG_SPRINT : 0;
+			if (Frame % 45 == PlayerIndex)
+			{
+				Input.ActionFlags |= (PlayerIndex % 2) ? FInputCommand::FLAG_TACKLE : FInputCommand::FLAG_KICK;
+			}
+			return Input;
+		};
+
+		FRollbackSession Session;
+		Session.Init(InitialState, Tuning, MaxRollbackFrames, DeltaTime);
+
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			for (int32 i = 0; i < RemotePlayer; ++i)
+			{
+				Session.AddInput(i, Frame, MakeInput(i, Frame));
+			}
+
+			const int32 LateFrame = Frame - MaxRollbackFrames;
+			if (LateFrame >= 0)
+			{
+				Session.AddInput(RemotePlayer, LateFrame, MakeInput(RemotePlayer, LateFrame));
+			}
+
+			Session.AdvanceFrame();
+		}
+		const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+		// Confirm every outstanding input and step once more; the result must match a run with perfect inputs
+		for (int32 i = 0; i < NumPlayers; ++i)
+		{
+			for (int32 Frame = FMath::Max(0, NumFrames - MaxRollbackFrames); Frame <= NumFrames; ++Frame)
+			{
+				Session.AddInput(i, Frame, MakeInput(i, Frame));
+			}
+		}
+		Session.AdvanceFrame();
+
+		FMatchSimState Reference = InitialState;
+		TArray<FInputCommand> Inputs;
+		Inputs.SetNum(NumPlayers);
+		while (Reference.Frame < Session.GetCurrentFrame())
+		{
+			for (int32 i = 0; i < NumPlayers; ++i)
+			{
+				Inputs[i] = MakeInput(i, Reference.Frame);
+			}
+			FMatchSimulation::Step(Reference, Inputs.GetData(), DeltaTime, Tuning);
+		}
+		const bool bMatches = FMatchSimulation::HashState(Reference) == FMatchSimulation::HashState(Session.GetState());
+
+		// Raw snapshot cost, independent of simulation
+		FMatchStateArena Arena;
+		Arena.Init(MaxRollbackFrames + 1);
+		FMatchSimState Restored;
+		const int32 NumCopies = 100000;
+		const double CopyStartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumCopies; ++i)
+		{
+			Reference.Frame = i;
+			Arena.Save(Reference);
+			Arena.Restore(i, Restored);
+		}
+		const double CopyNs = (FPlatformTime::Seconds() - CopyStartTime) * 1e9 / NumCopies;
+
+		const int32 SimulatedFrames = NumFrames + Session.TotalFramesResimulated;
+		UE_LOG(LogTemp, Log, TEXT("Rollback benchmark: %d players, %d frames, %d rollbacks (max depth %d), %d frames re-simulated in %.3f ms"),
+			NumPlayers, NumFrames, Session.TotalRollbacks, Session.MaxRollbackDepth, Session.TotalFramesResimulated, ElapsedMs);
+		UE_LOG(LogTemp, Log, TEXT("Rollback benchmark: %.2f us per simulated frame, %.2f us per rollback, %.0f ns per snapshot save+restore (%d bytes)"),
+			SimulatedFrames > 0 ? ElapsedMs * 1000.0 / SimulatedFrames : 0.0,
+			Session.TotalRollbacks > 0 ? ElapsedMs * 1000.0 / Session.TotalRollbacks : 0.0,
+			CopyNs, static_cast<int32>(sizeof(FMatchSimState)));
+
+		if (bMatches)
+		{
+			UE_LOG(LogTemp, Log, TEXT("Rollback benchmark: final state matches the simulation with perfect inputs"));
+		}
+		else
+		{
+			UE_LOG(LogTemp, Error, TEXT("Rollback benchmark: final state DIVERGED from the simulation with perfect inputs"));
+		}
+	}
+
+	FAutoConsoleCommand RollbackBenchmarkCommand(
+		TEXT("perf.rollbackbench"),
+		TEXT("Time rollback re-simulation with one remote player always arriving late and mispredicted. Usage: perf.rollbackbench [players] [frames]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunRollbackBenchmark));
+}
+
+#endif // !UE_BUILD_SHIPPING
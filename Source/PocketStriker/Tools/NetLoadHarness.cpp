@@ -0,0 +1,470 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "NetLoadHarness.h"
+#include "../Gameplay/GameplayTypes.h"
+#include "../Gameplay/MovementSimulation.h"
+#include "../Gameplay/PocketStrikerPlayerController.h"
+#include "../Network/MatchHost.h"
+#include "../Network/NetworkParamsData.h"
+#include "../Network/NetworkReconciler.h"
+#include "../Network/NetworkSnapshot.h"
+#include "../Network/SequenceRingBuffer.h"
+#include "HAL/PlatformMemory.h"
+#include "Math/RandomStream.h"
+#include "Misc/Paths.h"
+#include "Serialization/BitReader.h"
+#include "HAL/IConsoleManager.h"
+
+namespace
+{
+	// Scripted bot: wanders with a slowly turning stick, sprints in stretches, presses an action now and then
+	struct FBotClient
+	{
+		int32 MatchIndex = 0;
+		int32 ConnectionIndex = 0;
+		uint32 EntityId = 0;
+		FRandomStream Random;
+		float Heading = 0.0f;
+		float TurnRate = 0.0f;
+		bool bSprinting = false;
+
+		uint32 NextSequence = 1;
+		uint32 LastAckedSequence = 0;
+		TSequenceRingBuffer<FInputCommand> Inputs { 64 };
+		TSequenceRingBuffer<FMovementSimState> PredictedStates { 64 };
+		FMovementSimState State;
+
+		FWorldSnapshotHistory ReceivedSnapshots;
+		uint32 LastReceivedSnapshotId = 0;
+
+		FNetworkConditioner Uplink;
+		FNetworkConditioner Downlink;
+
+		int32 Corrections = 0;
+		int32 ShiftedCorrections = 0;
+		double CorrectionErrorSum = 0.0;
+		int64 UplinkBytes = 0;
+		int64 DownlinkBytes = 0;
+		int32 SnapshotsUndecodable = 0;
+
+		FInputCommand MakeInput(float Timestamp)
+		{
+			if (Random.FRand() < 0.02f)
+			{
+				TurnRate = Random.FRandRange(-3.0f, 3.0f);
+			}
+			if (Random.FRand() < 0.01f)
+			{
+				bSprinting = !bSprinting;
+			}
+			Heading += TurnRate / 60.0f;
+
+			FInputCommand Input;
+			Input.SequenceNumber = NextSequence++;
+			Input.ClientTimestamp = Timestamp;
+			Input.MovementInput = FVector2D(FMath::Cos(Heading), FMath::Sin(Heading));
+			Input.ActionFlags = bSprinting ? FInputCommand::FLAG_SPRINT : 0;
+
+			const float ActionRoll = Random.FRand();
+			if (ActionRoll < 0.005f)
+			{
+				Input.ActionFlags |= FInputCommand::FLAG_KICK;
+			}
+			else if (ActionRoll < 0.01f)
+			{
+				Input.ActionFlags |= FInputCommand::FLAG_PASS;
+			}
+			else if (ActionRoll < 0.015f)
+			{
+				Input.ActionFlags |= FInputCommand::FLAG_TACKLE;
+			}
+			return Input;
+		}
+	};
+
+	// Quantize an input to the wire resolution, as the controller does before predicting with it
+	FInputCommand QuantizeInput(const FInputCommand& Input, const FNetQuantizationSettings& Settings)
+	{
+		FInputPacket Packet;
+		Packet.SequenceNumber = Input.SequenceNumber;
+		Packet.ClientTimestamp = Input.ClientTimestamp;
+		Packet.MovementInput = Input.MovementInput;
+		Packet.LookInput = Input.LookInput;
+		Packet.ActionFlags = Input.ActionFlags;
+		Packet.Quantize(Settings);
+
+		FInputCommand Quantized = Input;
+		Quantized.ClientTimestamp = Packet.ClientTimestamp;
+		Quantized.MovementInput = Packet.MovementInput;
+		Quantized.LookInput = Packet.LookInput;
+		return Quantized;
+	}
+
+	FMovementSimState StepMovement(const FMovementSimState& State, const FInputCommand& Input, float DeltaTime,
+		const FMovementSimTuning& Tuning, const IMovementCollisionResolver& Resolver)
+	{
+		return FMovementSimulation::RegenerateStamina(FMovementSimulation::Step(State, Input, DeltaTime, Tuning, &Resolver), DeltaTime, Tuning);
+	}
+
+	// Bots have no state machine, so the player state stays Idle (0) on both ends
+	FPredictionState MakePredictionState(const FMovementSimState& State)
+	{
+		FPredictionState Predicted;
+		Predicted.Position = State.Position;
+		Predicted.Velocity = State.Velocity;
+		Predicted.Stamina = State.Stamina;
+		return Predicted;
+	}
+
+	FStateUpdatePacket MakeStateUpdate(const FEntitySnapshotState& Entity, uint32 AcknowledgedSequence)
+	{
+		FStateUpdatePacket Update;
+		Update.AcknowledgedSequence = AcknowledgedSequence;
+		Update.AuthoritativePosition = Entity.Position;
+		Update.AuthoritativeVelocity = Entity.Velocity;
+		Update.AuthoritativeState = Entity.State;
+		Update.AuthoritativeStamina = Entity.Stamina;
+		return Update;
+	}
+}
+
+FNetLoadHarnessReport FNetLoadHarness::Run(const FNetLoadHarnessConfig& Config, const UNetworkParamsData& Params)
+{
+	const int32 NumMatches = FMath::Clamp(Config.NumMatches, 1, MaxMatches);
+	const int32 NumClients = FMath::Clamp(Config.NumClients, 1, MaxClients);
+	const int32 NumBots = NumMatches * NumClients;
+	const float TickInterval = 1.0f / FMath::Max(Config.ServerTickRate, 1.0f);
+	const int32 NumTicks = FMath::Max(1, FMath::RoundToInt(Config.DurationSeconds / TickInterval));
+	const FNetQuantizationSettings& Settings = Params.Quantization;
+	const FMovementSimTuning Tuning;
+	const FBoundsCollisionResolver Resolver(FBox(Settings.PitchMin, Settings.PitchMax));
+	const int32 RedundancyWindow = FMath::Clamp(Params.InputRedundancyWindow, 1, static_cast<int32>(APocketStrikerPlayerController::MaxRedundantInputs));
+	const bool bShiftCorrections = Config.bShiftSmallCorrections;
+
+	const int64 MemoryBefore = static_cast<int64>(FPlatformMemory::GetStats().UsedPhysical);
+
+	FMatchHostSharedData SharedData;
+	SharedData.Params = &Params;
+	SharedData.TickRate = FMath::Max(Config.ServerTickRate, 1.0f);
+	SharedData.SnapshotRate = Config.SnapshotRate;
+	FMatchHost Host(SharedData);
+
+	for (int32 MatchIndex = 0; MatchIndex < NumMatches; ++MatchIndex)
+	{
+		FHeadlessMatch& Match = Host.CreateMatch();
+		if (!Config.RecordingFilename.IsEmpty())
+		{
+			Match.StartRecording(NumMatches > 1
+				? FString::Printf(TEXT("%s-m%d.%s"), *FPaths::GetBaseFilename(Config.RecordingFilename, false), Match.GetMatchId(), *FPaths::GetExtension(Config.RecordingFilename))
+				: Config.RecordingFilename);
+		}
+	}
+
+	TArray<FBotClient> Bots;
+	Bots.SetNum(NumBots);
+
+	for (int32 i = 0; i < NumBots; ++i)
+	{
+		FBotClient& Bot = Bots[i];
+		Bot.MatchIndex = i / NumClients;
+		Bot.Random.Initialize(Config.Seed * 7919 + i);
+		Bot.Heading = Bot.Random.FRandRange(0.0f, UE_TWO_PI);
+
+		// Spread each match's bots over its pitch in a grid
+		const int32 Slot = i % NumClients;
+		const int32 Columns = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(NumClients)));
+		Bot.State.Position = FVector((Slot % Columns) * 600.0f - Columns * 300.0f, (Slot / Columns) * 600.0f - Columns * 300.0f, 0.0f);
+
+		FHeadlessMatch& Match = Host.GetMatch(Bot.MatchIndex);
+		Bot.ConnectionIndex = Match.AddConnection(Bot.State.Position);
+		Bot.EntityId = Match.GetConnection(Bot.ConnectionIndex).EntityId;
+
+		// Independent streams per client and direction so one bot's losses do not mirror another's
+		FNetworkConditionerSettings Uplink = Config.Conditions;
+		Uplink.Seed = Config.Seed + i * 2;
+		Bot.Uplink.Configure(Uplink);
+
+		FNetworkConditionerSettings Downlink = Config.Conditions;
+		Downlink.Seed = Config.Seed + i * 2 + 1;
+		Bot.Downlink.Configure(Downlink);
+	}
+
+	TArray<double> TickTimes;
+	TArray<double> MatchTickTimes;
+	TArray<double> EncodeTimes;
+	TickTimes.Reserve(NumTicks);
+	MatchTickTimes.Reserve(NumTicks * NumMatches);
+
+	FNetLoadHarnessReport Report;
+	Report.NumMatches = NumMatches;
+	Report.NumClients = NumClients;
+	Report.ServerTicks = NumTicks;
+	Report.DurationSeconds = NumTicks * TickInterval;
+
+	for (int32 Tick = 0; Tick < NumTicks; ++Tick)
+	{
+		const double Now = Tick * TickInterval;
+
+		// Clients: receive, then predict and send this tick's input
+		for (FBotClient& Bot : Bots)
+		{
+			Bot.Downlink.Drain(Now, [&Bot, &Settings, &Params, &Tuning, &Resolver, TickInterval, Now, bShiftCorrections](uint8 Channel, const TArray<uint8>& Payload)
+			{
+				FBitReader Reader(const_cast<uint8*>(Payload.GetData()), Payload.Num() * 8);
+				uint32 SnapshotId = 0;
+				FWorldSnapshot Snapshot;
+				if (!FWorldSnapshotCodec::Decode(Reader, Bot.ReceivedSnapshots, Settings, SnapshotId, Snapshot))
+				{
+					Bot.SnapshotsUndecodable++;
+					return;
+				}
+
+				Bot.ReceivedSnapshots.Add(SnapshotId, Snapshot);
+				TArray<uint8> Ack;
+				Ack.Append(reinterpret_cast<const uint8*>(&SnapshotId), sizeof(SnapshotId));
+				Bot.Uplink.Submit(FHeadlessMatch::ChannelSnapshotAck, Ack, Now);
+
+				if (SnapshotId <= Bot.LastReceivedSnapshotId)
+				{
+					return;
+				}
+				Bot.LastReceivedSnapshotId = SnapshotId;
+
+				// Reconcile: compare the server's result for the acknowledged input with what was predicted for it
+				const FEntitySnapshotState* Own = Snapshot.FindEntity(Bot.EntityId);
+				const uint32 Acked = Snapshot.AcknowledgedSequence;
+				if (!Own || Acked <= Bot.LastAckedSequence)
+				{
+					return;
+				}
+
+				if (const FMovementSimState* Predicted = Bot.PredictedStates.Find(Acked))
+				{
+					// The same per-field check the reconciler runs, so velocity and stamina errors correct here too
+					const uint32 Fields = UNetworkReconciler::ComparePrediction(MakePredictionState(*Predicted), MakeStateUpdate(*Own, Acked),
+						Params.CorrectionThreshold, Params.VelocityCorrectionThreshold, Params.StaminaCorrectionThreshold);
+					if (Fields != 0)
+					{
+						Bot.Corrections++;
+						Bot.CorrectionErrorSum += FVector::Dist(Predicted->Position, Own->Position);
+
+						const FVector PositionDelta = Own->Position - Predicted->Position;
+						const FVector VelocityDelta = Own->Velocity - Predicted->Velocity;
+						if (bShiftCorrections && UNetworkReconciler::CanShiftCorrection(Fields, PositionDelta, VelocityDelta, Params.MaxShiftPositionDelta, Params.MaxShiftVelocityDelta))
+						{
+							// Shift every later prediction by the error, as UNetworkPrediction::ShiftStatesFrom does
+							Bot.ShiftedCorrections++;
+							for (uint32 Sequence = Acked; Sequence <= Bot.PredictedStates.GetNewestSequence(); ++Sequence)
+							{
+								if (FMovementSimState* Stored = Bot.PredictedStates.Find(Sequence))
+								{
+									Stored->Position += PositionDelta + VelocityDelta * ((Sequence - Acked) * TickInterval);
+									Stored->Velocity += VelocityDelta;
+									Bot.State = *Stored;
+								}
+							}
+						}
+						else
+						{
+							// Rewind to the server state and replay everything it has not seen
+							FMovementSimState Corrected = *Predicted;
+							Corrected.Position = Own->Position;
+							Corrected.Velocity = Own->Velocity;
+							Corrected.Stamina = Own->Stamina;
+							Bot.Inputs.ForEachAfter(Acked, [&](const FInputCommand& Input)
+							{
+								Corrected = StepMovement(Corrected, Input, TickInterval, Tuning, Resolver);
+								Bot.PredictedStates.Add(Input.SequenceNumber, Corrected);
+							});
+							Bot.State = Corrected;
+						}
+					}
+				}
+
+				Bot.LastAckedSequence = Acked;
+				Bot.Inputs.ReleaseUpTo(Acked);
+			});
+
+			const FInputCommand Input = QuantizeInput(Bot.MakeInput(Now), Settings);
+			Bot.Inputs.Add(Input.SequenceNumber, Input);
+			Bot.State = StepMovement(Bot.State, Input, TickInterval, Tuning, Resolver);
+			Bot.PredictedStates.Add(Input.SequenceNumber, Bot.State);
+
+			TArray<FInputCommand> Window;
+			Bot.Inputs.ForEachAfter(Bot.LastAckedSequence, [&Window](const FInputCommand& Unacked)
+			{
+				Window.Add(Unacked);
+			});
+			const int32 First = FMath::Max(0, Window.Num() - RedundancyWindow);
+			const TArray<uint8> Packet = APocketStrikerPlayerController::PackInputs(MakeArrayView(Window).Slice(First, Window.Num() - First), Settings);
+			Bot.UplinkBytes += Packet.Num();
+			Bot.Uplink.Submit(FHeadlessMatch::ChannelInputs, Packet, Now);
+
+			FHeadlessMatch& Match = Host.GetMatch(Bot.MatchIndex);
+			Bot.Uplink.Drain(Now, [&Match, &Bot](uint8 Channel, const TArray<uint8>& Payload)
+			{
+				Match.Receive(Bot.ConnectionIndex, Channel, TArray<uint8>(Payload));
+			});
+		}
+
+		// Server tick: every match, side by side
+		Host.Tick(Config.bParallelEncoding);
+		TickTimes.Add(Host.GetLastTickMs());
+
+		for (int32 MatchIndex = 0; MatchIndex < NumMatches; ++MatchIndex)
+		{
+			const FHeadlessMatch& Match = Host.GetMatch(MatchIndex);
+			MatchTickTimes.Add(Match.GetLastTickMs());
+			if (!Match.DidLastTickBroadcast())
+			{
+				continue;
+			}
+
+			EncodeTimes.Add(Match.GetLastEncodeMs());
+			const TConstArrayView<ANetworkGameState::FClientSnapshotJob> Jobs = Match.GetSnapshotJobs();
+			for (int32 ConnectionIndex = 0; ConnectionIndex < Jobs.Num(); ++ConnectionIndex)
+			{
+				const ANetworkGameState::FClientSnapshotJob& Job = Jobs[ConnectionIndex];
+				Report.DeltaSnapshots += Job.bDelta ? 1 : 0;
+				Report.FullSnapshots += Job.bDelta ? 0 : 1;
+				Report.EntitiesDeferred += Job.EntitiesDeferred;
+
+				const FNetPacketSample Sample = Job.MakeSample();
+				Report.SnapshotTraffic.Packets++;
+				Report.SnapshotTraffic.Bytes += Sample.Bytes;
+				Report.SnapshotTraffic.RawBytes += Sample.RawBytes;
+				Report.SnapshotTraffic.FieldBits.Add(Sample.FieldBits);
+				Report.SnapshotTraffic.SerializeSeconds += FPlatformTime::ToSeconds64(Sample.Cycles);
+
+				FBotClient& Bot = Bots[MatchIndex * NumClients + ConnectionIndex];
+				Bot.DownlinkBytes += Job.Packet.Num();
+				Bot.Downlink.Submit(0, Job.Packet, Now);
+			}
+		}
+	}
+
+	Report.ProcessMemoryDelta = static_cast<int64>(FPlatformMemory::GetStats().UsedPhysical) - MemoryBefore;
+
+	// Tick cost
+	double TickSum = 0.0;
+	for (double Time : TickTimes)
+	{
+		TickSum += Time;
+	}
+	TickTimes.Sort();
+	MatchTickTimes.Sort();
+	EncodeTimes.Sort();
+	Report.TickMeanMs = TickSum / TickTimes.Num();
+	Report.TickP50Ms = FNetTrafficStats::GetPercentile(TickTimes, 0.5);
+	Report.TickP99Ms = FNetTrafficStats::GetPercentile(TickTimes, 0.99);
+	Report.TickMaxMs = TickTimes.Last();
+	Report.MatchTickP50Ms = FNetTrafficStats::GetPercentile(MatchTickTimes, 0.5);
+	Report.MatchTickP99Ms = FNetTrafficStats::GetPercentile(MatchTickTimes, 0.99);
+	Report.EncodeP50Ms = FNetTrafficStats::GetPercentile(EncodeTimes, 0.5);
+	Report.EncodeP99Ms = FNetTrafficStats::GetPercentile(EncodeTimes, 0.99);
+
+	// Traffic and reconciliation
+	int64 UplinkBytes = 0;
+	int64 DownlinkBytes = 0;
+	int32 Corrections = 0;
+	int32 ShiftedCorrections = 0;
+	double CorrectionErrorSum = 0.0;
+	for (const FBotClient& Bot : Bots)
+	{
+		UplinkBytes += Bot.UplinkBytes;
+		DownlinkBytes += Bot.DownlinkBytes;
+		Corrections += Bot.Corrections;
+		ShiftedCorrections += Bot.ShiftedCorrections;
+		CorrectionErrorSum += Bot.CorrectionErrorSum;
+		Report.SnapshotsUndecodable += Bot.SnapshotsUndecodable;
+	}
+
+	const double ClientSeconds = NumBots * Report.DurationSeconds;
+	Report.UplinkBytesPerClient = UplinkBytes / ClientSeconds;
+	Report.DownlinkBytesPerClient = DownlinkBytes / ClientSeconds;
+	Report.CorrectionsPerClientPerSecond = Corrections / ClientSeconds;
+	Report.MeanCorrectionError = Corrections > 0 ? CorrectionErrorSum / Corrections : 0.0;
+	Report.ShiftedCorrectionShare = Corrections > 0 ? static_cast<double>(ShiftedCorrections) / Corrections : 0.0;
+
+	// Server bookkeeping
+	int64 ServerBytes = 0;
+	for (int32 MatchIndex = 0; MatchIndex < NumMatches; ++MatchIndex)
+	{
+		const FHeadlessMatch& Match = Host.GetMatch(MatchIndex);
+		ServerBytes += Match.GetAllocatedSize();
+		Report.BallKicks += Match.GetKickCount();
+		Report.InputUnderflows += Match.GetTickStats().InputBufferUnderflows;
+		Report.InputsReplaced += Match.GetTickStats().InputsReplaced;
+	}
+	Report.ServerBytesPerClient = ServerBytes / NumBots;
+	Report.ServerBytesPerMatch = ServerBytes / NumMatches;
+
+	return Report;
+}
+
+void FNetLoadHarnessReport::Log() const
+{
+	UE_LOG(LogTemp, Log, TEXT("Net load: %d match(es) of %d clients, %d server ticks (%.0f s)"), NumMatches, NumClients, ServerTicks, DurationSeconds);
+	UE_LOG(LogTemp, Log, TEXT("Net load: server tick mean %.3f ms, p50 %.3f ms, p99 %.3f ms, max %.3f ms; per match p50 %.3f ms, p99 %.3f ms; snapshot encode p50 %.3f ms, p99 %.3f ms"),
+		TickMeanMs, TickP50Ms, TickP99Ms, TickMaxMs, MatchTickP50Ms, MatchTickP99Ms, EncodeP50Ms, EncodeP99Ms);
+	UE_LOG(LogTemp, Log, TEXT("Net load: per client %.0f B/s up, %.0f B/s down; snapshots %d delta / %d full, %d undecodable, %d entities deferred"),
+		UplinkBytesPerClient, DownlinkBytesPerClient, DeltaSnapshots, FullSnapshots, SnapshotsUndecodable, EntitiesDeferred);
+
+	const int64 SnapshotBits = SnapshotTraffic.FieldBits.GetTotal();
+	FString Fields;
+	for (int32 Group = 0; Group < static_cast<int32>(ENetFieldGroup::Count); ++Group)
+	{
+		if (SnapshotBits > 0 && SnapshotTraffic.FieldBits.Bits[Group] > 0)
+		{
+			Fields += FString::Printf(TEXT(" %s %.1f%%"), FNetTrafficStats::GetFieldGroupName(static_cast<ENetFieldGroup>(Group)),
+				100.0 * SnapshotTraffic.FieldBits.Bits[Group] / SnapshotBits);
+		}
+	}
+	UE_LOG(LogTemp, Log, TEXT("Net load: snapshots raw/wire %.2fx (quantization %.2fx, delta %.2fx), fields:%s"),
+		SnapshotTraffic.GetCompressionRatio(), SnapshotTraffic.GetQuantizationRatio(), SnapshotTraffic.GetDeltaRatio(), *Fields);
+	UE_LOG(LogTemp, Log, TEXT("Net load: %.3f corrections per client per second (mean error %.1f cm, %.0f%% shifted), %d input underflows, %d inputs replaced, %d ball kicks"),
+		CorrectionsPerClientPerSecond, MeanCorrectionError, ShiftedCorrectionShare * 100.0, InputUnderflows, InputsReplaced, BallKicks);
+	UE_LOG(LogTemp, Log, TEXT("Net load: ~%.1f KB server state per client, ~%.1f KB per match, process memory %+.1f MB (%+.2f MB per match)"),
+		ServerBytesPerClient / 1024.0, ServerBytesPerMatch / 1024.0, ProcessMemoryDelta / (1024.0 * 1024.0),
+		ProcessMemoryDelta / (1024.0 * 1024.0 * FMath::Max(NumMatches, 1)));
+}
+
+#if !UE_BUILD_SHIPPING
+
+namespace
+{
+	void RunNetLoad(const TArray<FString>& Args)
+	{
+		const UNetworkParamsData* Params = GetDefault<UNetworkParamsData>();
+
+		FNetLoadHarnessConfig Config;
+		Config.Conditions = Params->NetworkConditions;
+		Config.DurationSeconds = Args.Num() > 1 ? FMath::Max(1.0f, FCString::Atof(*Args[1])) : 10.0f;
+		Config.Seed = Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 1;
+		Config.NumMatches = Args.Num() > 3 ? FMath::Clamp(FCString::Atoi(*Args[3]), 1, FNetLoadHarness::MaxMatches) : 1;
+		Config.bShiftSmallCorrections = Params->bShiftSmallCorrections && !Args.Contains(TEXT("noshift"));
+
+		TArray<int32> ClientCounts;
+		if (Args.Num() > 0 && Args[0] != TEXT("sweep"))
+		{
+			ClientCounts.Add(FMath::Clamp(FCString::Atoi(*Args[0]), 1, FNetLoadHarness::MaxClients));
+		}
+		else
+		{
+			ClientCounts = { 2, 4, 8, 16, 32, 64 };
+		}
+
+		for (int32 NumClients : ClientCounts)
+		{
+			Config.NumClients = NumClients;
+			FNetLoadHarness::Run(Config, *Params).Log();
+		}
+	}
+
+	FAutoConsoleCommand NetLoadCommand(
+		TEXT("perf.netload"),
+		TEXT("Run headless bot clients against the server snapshot and input path with the current NetworkConditions, optionally in several matches hosted side by side. Usage: perf.netload [clients per match|sweep] [seconds] [seed] [matches] [noshift]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunNetLoad));
+}
+
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,113 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "../Network/NetworkConditioner.h"
+#include "../Network/NetTrafficStats.h"
+
+class UNetworkParamsData;
+
+/**
+ * Load test configuration: how many matches and bot clients, for how long, over what network
+ */
+struct POCKETSTRIKER_API FNetLoadHarnessConfig
+{
+	// Matches hosted side by side in the one process, and bot clients in each
+	int32 NumMatches = 1;
+	int32 NumClients = 8;
+	float DurationSeconds = 30.0f;
+
+	// Server simulation rate and snapshot broadcast rate, Hz
+	float ServerTickRate = 60.0f;
+	float SnapshotRate = 60.0f;
+
+	// Seeds the bots' scripted input and every conditioner (each client and direction gets its own stream)
+	int32 Seed = 1;
+
+	// Ticks the matches (or a lone match's snapshot encoding) across the task graph
+	bool bParallelEncoding = true;
+
+	// Applied to every client's uplink and downlink
+	FNetworkConditionerSettings Conditions;
+
+	// Bots correct small errors by shifting their stored predictions (UNetworkReconciler's shift mode) instead of replaying
+	bool bShiftSmallCorrections = true;
+
+	// When set, the server side records the run (FMatchRecorder) for FMatchReplayer; one file per match
+	FString RecordingFilename;
+};
+
+/**
+ * What one load test run measured
+ */
+struct POCKETSTRIKER_API FNetLoadHarnessReport
+{
+	int32 NumMatches = 0;
+	int32 NumClients = 0;
+	int32 ServerTicks = 0;
+	float DurationSeconds = 0.0f;
+
+	// Server tick cost (receive, validate, simulate, gather, encode) for every match together, ms
+	double TickMeanMs = 0.0;
+	double TickP50Ms = 0.0;
+	double TickP99Ms = 0.0;
+	double TickMaxMs = 0.0;
+
+	// One match's tick on its worker, ms
+	double MatchTickP50Ms = 0.0;
+	double MatchTickP99Ms = 0.0;
+
+	// Snapshot selection and encoding share of the ticks that broadcast, ms
+	double EncodeP50Ms = 0.0;
+	double EncodeP99Ms = 0.0;
+
+	// Payload bytes per client per second
+	double UplinkBytesPerClient = 0.0;
+	double DownlinkBytesPerClient = 0.0;
+
+	// Client-side reconciliation
+	double CorrectionsPerClientPerSecond = 0.0;
+	double MeanCorrectionError = 0.0;
+	double ShiftedCorrectionShare = 0.0;
+
+	// Every snapshot sent: bytes, raw size and field-group split, for the quantization and delta ratios
+	FNetPacketTypeStats SnapshotTraffic;
+
+	int32 FullSnapshots = 0;
+	int32 DeltaSnapshots = 0;
+	int32 SnapshotsUndecodable = 0;
+	int32 InputUnderflows = 0;
+	int32 InputsReplaced = 0;
+	int32 EntitiesDeferred = 0;
+	int32 BallKicks = 0;
+
+	// Server-side bookkeeping (channels, histories, input queues, encode buffers), estimated from container sizes
+	int64 ServerBytesPerClient = 0;
+	int64 ServerBytesPerMatch = 0;
+
+	// Change in process physical memory across the run
+	int64 ProcessMemoryDelta = 0;
+
+	void Log() const;
+};
+
+/**
+ * Headless capacity test for the authoritative server
+ * N scripted bot clients per match run in-process with no sockets. Each tick they predict locally, pack their
+ * redundant input window exactly as the player controller does, and send it through a network conditioner. The
+ * server side is an FMatchHost running every match as an FHeadlessMatch: it runs the game's own FServerMatchTick
+ * (validation, jitter buffers, lag-compensated kicks) at the fixed rate, and encodes every client's snapshot with
+ * ANetworkGameState::EncodeClientSnapshots. Snapshots travel back through the conditioner; bots decode,
+ * acknowledge and reconcile against their predictions
+ * Movement uses FMovementSimulation against the pitch bounds rather than character collision
+ */
+class POCKETSTRIKER_API FNetLoadHarness
+{
+public:
+	static FNetLoadHarnessReport Run(const FNetLoadHarnessConfig& Config, const UNetworkParamsData& Params);
+
+	// Largest bot count per match; every bot and the ball must fit in one snapshot (FWorldSnapshotCodec::MaxEntities)
+	static constexpr int32 MaxClients = 64;
+	static constexpr int32 MaxMatches = 256;
+};
@@ -0,0 +1,63 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "NetLoadTestCommandlet.h"
+#include "NetLoadHarness.h"
+#include "../Network/NetworkParamsData.h"
+#include "Misc/Paths.h"
+
+UNetLoadTestCommandlet::UNetLoadTestCommandlet()
+{
+	IsClient = false;
+	IsServer = true;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UNetLoadTestCommandlet::Main(const FString& Params)
+{
+	const UNetworkParamsData* NetworkParams = GetDefault<UNetworkParamsData>();
+
+	FNetLoadHarnessConfig Config;
+	Config.Conditions = NetworkParams->NetworkConditions;
+	FParse::Value(*Params, TEXT("seconds="), Config.DurationSeconds);
+	FParse::Value(*Params, TEXT("seed="), Config.Seed);
+	FParse::Value(*Params, TEXT("matches="), Config.NumMatches);
+	Config.NumMatches = FMath::Clamp(Config.NumMatches, 1, FNetLoadHarness::MaxMatches);
+	FParse::Value(*Params, TEXT("latency="), Config.Conditions.LatencyMs);
+	FParse::Value(*Params, TEXT("jitter="), Config.Conditions.JitterMs);
+	FParse::Value(*Params, TEXT("loss="), Config.Conditions.PacketLossPercentage);
+	Config.bParallelEncoding = !FParse::Param(*Params, TEXT("serial"));
+	Config.bShiftSmallCorrections = NetworkParams->bShiftSmallCorrections && !FParse::Param(*Params, TEXT("noshift"));
+	FString RecordingFilename;
+	FParse::Value(*Params, TEXT("record="), RecordingFilename);
+
+	TArray<int32> ClientCounts;
+	int32 NumClients = 0;
+	if (FParse::Value(*Params, TEXT("clients="), NumClients) && !FParse::Param(*Params, TEXT("sweep")))
+	{
+		ClientCounts.Add(FMath::Clamp(NumClients, 1, FNetLoadHarness::MaxClients));
+	}
+	else
+	{
+		ClientCounts = { 2, 4, 8, 16, 32, 64 };
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("NetLoadTest: %d match(es), %.0f s per run, seed %d, latency %.0f ms, jitter %.0f ms, loss %.1f%%, %s encoding"),
+		Config.NumMatches, Config.DurationSeconds, Config.Seed, Config.Conditions.LatencyMs, Config.Conditions.JitterMs,
+		Config.Conditions.PacketLossPercentage, Config.bParallelEncoding ? TEXT("parallel") : TEXT("serial"));
+
+	for (int32 Count : ClientCounts)
+	{
+		Config.NumClients = Count;
+		if (!RecordingFilename.IsEmpty())
+		{
+			// One recording per run of a sweep
+			Config.RecordingFilename = ClientCounts.Num() > 1
+				? FString::Printf(TEXT("%s-%d.%s"), *FPaths::GetBaseFilename(RecordingFilename, false), Count, *FPaths::GetExtension(RecordingFilename))
+				: RecordingFilename;
+		}
+		FNetLoadHarness::Run(Config, *NetworkParams).Log();
+	}
+
+	return 0;
+}
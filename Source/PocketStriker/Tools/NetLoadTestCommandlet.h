@@ -0,0 +1,28 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "NetLoadTestCommandlet.generated.h"
+
+/**
+ * Headless server capacity test for build machines
+ * UnrealEditor-Cmd PocketStriker -run=NetLoadTest [-clients=N | -sweep] [-matches=1] [-seconds=30] [-seed=1]
+ *     [-latency=ms] [-jitter=ms] [-loss=percent] [-serial] [-noshift] [-record=file]
+ * Without -clients it sweeps 2, 4, 8, 16, 32 and 64 bots per match; -matches hosts that many matches in one
+ * process at once (FMatchHost). Network conditions default to the NetworkConditions of the default network
+ * params; the flags override them. -record writes a match recording of each run for -run=MatchReplay
+ * (suffixed with the bot count in a sweep, and with the match id when hosting several). -noshift makes the bots
+ * replay every correction instead of shifting small ones
+ */
+UCLASS()
+class POCKETSTRIKER_API UNetLoadTestCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UNetLoadTestCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -9,8 +9,12 @@
 #include "Kismet/GameplayStatics.h"
 #include "DrawDebugHelpers.h"
 #include "../Network/NetworkDebugger.h"
+#include "../Gameplay/PocketStrikerPlayerController.h"
 #include "../Network/NetworkPrediction.h"
 #include "../Network/NetworkReconciler.h"
+#include "../Network/NetworkInterpolation.h"
+#include "../Network/NetworkGameState.h"
+#include "EngineUtils.h"
 #include "../AI/AIControllerFootball.h"
 #include "../AI/FootballAIUtility.h"
 #include "../Animation/MotionMatcher.h"
@@ -40,6 +44,8 @@ void APocketStrikerDebugHUD::DrawHUD()
 	DrawFrameTimings(Canvas);
 	DrawNetworkStats(Canvas);
 	DrawLastCorrection(Canvas);
+	DrawInterpolationDelay(Canvas);
+	DrawBandwidthStats(Canvas);
 	DrawAIStates(Canvas);
 	DrawMotionMatchingInfo(Canvas);
 	DrawInputBuffer(Canvas);
@@ -170,22 +176,9 @@ void APocketStrikerDebugHUD::DrawNetworkStats(UCanvas* InCanvas)
 		return;
 	}
 
-	// Try to find network debugger in the world
-	UNetworkDebugger* NetworkDebugger = nullptr;
-	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
-	{
-		AActor* Actor = *It;
-		if (Actor)
-		{
-			TArray<UActorComponent*> Components;
-			Actor->GetComponents(UNetworkDebugger::StaticClass(), Components);
-			if (Components.Num() > 0)
-			{
-				NetworkDebugger = Cast<UNetworkDebugger>(Components[0]);
-				break;
-			}
-		}
-	}
+	// The owning controller holds the network debugger and its conditioner
+	APocketStrikerPlayerController* PocketStrikerController = Cast<APocketStrikerPlayerController>(GetOwningPlayerController());
+	UNetworkDebugger* NetworkDebugger = PocketStrikerController ? PocketStrikerController->GetNetworkDebugger() : nullptr;
 
 	float YPos = 100.0f;
 	
@@ -249,21 +242,8 @@ void APocketStrikerDebugHUD::DrawLastCorrection(UCanvas* InCanvas)
 	if (Reconciler)
 	{
 		// Get last correction info from network debugger
-		UNetworkDebugger* NetworkDebugger = nullptr;
-		for (TActorIterator<AActor> It(GetWorld()); It; ++It)
-		{
-			AActor* Actor = *It;
-			if (Actor)
-			{
-				TArray<UActorComponent*> Components;
-				Actor->GetComponents(UNetworkDebugger::StaticClass(), Components);
-				if (Components.Num() > 0)
-				{
-					NetworkDebugger = Cast<UNetworkDebugger>(Components[0]);
-					break;
-				}
-			}
-		}
+		APocketStrikerPlayerController* PocketStrikerController = Cast<APocketStrikerPlayerController>(PC);
+		UNetworkDebugger* NetworkDebugger = PocketStrikerController ? PocketStrikerController->GetNetworkDebugger() : nullptr;
 
 		if (NetworkDebugger)
 		{
@@ -279,6 +259,148 @@ void APocketStrikerDebugHUD::DrawLastCorrection(UCanvas* InCanvas)
 	}
 }
 
+void APocketStrikerDebugHUD::DrawInterpolationDelay(UCanvas* InCanvas)
+{
+	if (!InCanvas)
+	{
+		return;
+	}
+
+	// Report the first remote player that is interpolating
+	APlayerController* PC = GetOwningPlayerController();
+	APawn* LocalPawn = PC ? PC->GetPawn() : nullptr;
+	UNetworkInterpolation* Interpolation = nullptr;
+	for (TActorIterator<APawn> It(GetWorld()); It; ++It)
+	{
+		if (*It != LocalPawn)
+		{
+			Interpolation = It->FindComponentByClass<UNetworkInterpolation>();
+			if (Interpolation && Interpolation->CurrentBufferSize > 0)
+			{
+				break;
+			}
+			Interpolation = nullptr;
+		}
+	}
+
+	if (!Interpolation)
+	{
+		return;
+	}
+
+	// Between the network stats and the last correction line
+	float YPos = 205.0f;
+
+	FString DelayText = FString::Printf(TEXT("Interp Delay: %.0f ms (target %.0f ms, x%.3f)"),
+		Interpolation->CurrentInterpolationDelay * 1000.0f, Interpolation->TargetInterpolationDelay * 1000.0f, Interpolation->TimeDilation);
+	DrawText(DelayText, FLinearColor::Cyan, 10.0f, YPos, nullptr, 0.9f);
+	YPos += 16.0f;
+
+	FString JitterText = FString::Printf(TEXT("Jitter: %.1f ms  Interval: %.1f ms  Gaps: %.1f%%"),
+		Interpolation->MeasuredJitter * 1000.0f, Interpolation->MeasuredPacketInterval * 1000.0f, Interpolation->MeasuredPacketLoss * 100.0f);
+	DrawText(JitterText, FLinearColor::Gray, 10.0f, YPos, nullptr, 0.9f);
+}
+
+void APocketStrikerDebugHUD::DrawBandwidthStats(UCanvas* InCanvas)
+{
+	if (!InCanvas)
+	{
+		return;
+	}
+
+	APocketStrikerPlayerController* PocketStrikerController = Cast<APocketStrikerPlayerController>(GetOwningPlayerController());
+	UNetworkDebugger* NetworkDebugger = PocketStrikerController ? PocketStrikerController->GetNetworkDebugger() : nullptr;
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	// Right-hand column, clear of the network and AI sections
+	const float XPos = InCanvas->ClipX - 520.0f;
+	float YPos = 100.0f;
+
+	DrawText(TEXT("=== BANDWIDTH ==="), FLinearColor::White, XPos, YPos, nullptr, 1.3f);
+	YPos += 25.0f;
+
+	if (NetworkDebugger)
+	{
+		const FNetTrafficStats& Traffic = NetworkDebugger->GetTrafficStats();
+		FString RateText = FString::Printf(TEXT("Up: %.2f KB/s  Down: %.2f KB/s"),
+			Traffic.GetBytesPerSecond(ENetTrafficDirection::Sent, Now) / 1024.0, Traffic.GetBytesPerSecond(ENetTrafficDirection::Received, Now) / 1024.0);
+		DrawText(RateText, FLinearColor::Cyan, XPos, YPos, nullptr, 1.0f);
+		YPos += 18.0f;
+
+		// The two streams that carry nearly all the bytes, with their rolling size and serialization cost
+		const TPair<ENetTrafficDirection, ENetPacketType> Streams[] =
+		{
+			{ ENetTrafficDirection::Received, ENetPacketType::Snapshot },
+			{ ENetTrafficDirection::Sent, ENetPacketType::Inputs }
+		};
+		for (const TPair<ENetTrafficDirection, ENetPacketType>& Stream : Streams)
+		{
+			const FNetPacketTypeStats& Totals = Traffic.GetTotals(Stream.Key, Stream.Value);
+			if (Totals.Packets == 0)
+			{
+				continue;
+			}
+
+			const FNetRollingTrafficStats Rolling = Traffic.GetRolling(Stream.Key, Stream.Value, Now);
+			FString StreamText = FString::Printf(TEXT("%s: %.0f/%.0f B p50/p99  %.1f/%.1f us  raw/wire %.1fx"),
+				FNetTrafficStats::GetPacketTypeName(Stream.Value), Rolling.SizeP50, Rolling.SizeP99,
+				Rolling.SerializeP50Us, Rolling.SerializeP99Us, Totals.GetCompressionRatio());
+			DrawText(StreamText, FLinearColor::White, XPos, YPos, nullptr, 0.9f);
+			YPos += 16.0f;
+
+			const int64 TotalBits = Totals.FieldBits.GetTotal();
+			FString FieldText = TEXT("  ");
+			for (int32 Group = 0; Group < static_cast<int32>(ENetFieldGroup::Count); ++Group)
+			{
+				if (TotalBits > 0 && Totals.FieldBits.Bits[Group] > 0)
+				{
+					FieldText += FString::Printf(TEXT("%s %.0f%%  "), FNetTrafficStats::GetFieldGroupName(static_cast<ENetFieldGroup>(Group)),
+						100.0 * Totals.FieldBits.Bits[Group] / TotalBits);
+				}
+			}
+			DrawText(FieldText, FLinearColor::Gray, XPos, YPos, nullptr, 0.8f);
+			YPos += 16.0f;
+		}
+	}
+
+	// On the server, every connection's snapshot stream and what quantization and deltas save on it
+	ANetworkGameState* NetworkGameState = nullptr;
+	if (GetWorld()->GetNetMode() != NM_Client)
+	{
+		TActorIterator<ANetworkGameState> It(GetWorld());
+		NetworkGameState = It ? *It : nullptr;
+	}
+
+	if (NetworkGameState && NetworkGameState->GetAllClientTrafficStats().Num() > 0)
+	{
+		double OutRate = 0.0;
+		double InRate = 0.0;
+		double WorstEncodeP99 = 0.0;
+		FNetPacketTypeStats Snapshots;
+		for (const auto& Pair : NetworkGameState->GetAllClientTrafficStats())
+		{
+			const FNetTrafficStats& Traffic = Pair.Value;
+			OutRate += Traffic.GetBytesPerSecond(ENetTrafficDirection::Sent, Now);
+			InRate += Traffic.GetBytesPerSecond(ENetTrafficDirection::Received, Now);
+			WorstEncodeP99 = FMath::Max(WorstEncodeP99, Traffic.GetRolling(ENetTrafficDirection::Sent, ENetPacketType::Snapshot, Now).SerializeP99Us);
+
+			const FNetPacketTypeStats& ClientSnapshots = Traffic.GetTotals(ENetTrafficDirection::Sent, ENetPacketType::Snapshot);
+			Snapshots.Bytes += ClientSnapshots.Bytes;
+			Snapshots.RawBytes += ClientSnapshots.RawBytes;
+			Snapshots.FieldBits.Add(ClientSnapshots.FieldBits);
+		}
+
+		const int32 NumClients = NetworkGameState->GetAllClientTrafficStats().Num();
+		FString ServerText = FString::Printf(TEXT("Server (%d clients): out %.2f KB/s  in %.2f KB/s"), NumClients, OutRate / 1024.0, InRate / 1024.0);
+		DrawText(ServerText, FLinearColor::Cyan, XPos, YPos, nullptr, 1.0f);
+		YPos += 18.0f;
+
+		FString RatioText = FString::Printf(TEXT("Snapshots: quantization %.1fx  delta %.1fx  encode p99 %.1f us"),
+			Snapshots.GetQuantizationRatio(), Snapshots.GetDeltaRatio(), WorstEncodeP99);
+		DrawText(RatioText, FLinearColor::White, XPos, YPos, nullptr, 0.9f);
+	}
+}
+
 void APocketStrikerDebugHUD::DrawAIStates(UCanvas* InCanvas)
 {
 	if (!InCanvas)
@@ -25,6 +25,8 @@ public:
 	// Network metrics
 	void DrawNetworkStats(UCanvas* Canvas);
 	void DrawLastCorrection(UCanvas* Canvas);
+	void DrawInterpolationDelay(UCanvas* Canvas);
+	void DrawBandwidthStats(UCanvas* Canvas);
 	
 	// AI debug
 	void DrawAIStates(UCanvas* Canvas);
@@ -0,0 +1,135 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "../Gameplay/MovementSimulation.h"
+#include "../Gameplay/BallSimulation.h"
+#include "../Gameplay/GameplayTypes.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+
+#if !UE_BUILD_SHIPPING
+
+// perf.* benchmarks and the determinism hash for the standalone simulations; left out of shipping builds
+namespace
+{
+	void RunMovementBenchmark(const TArray<FString>& Args)
+	{
+		const int32 NumSteps = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 100000;
+
+		// Circle-strafing with periodic sprint exercises acceleration, clamping and stamina every step
+		const FMovementSimTuning Tuning;
+		const FBoundsCollisionResolver Resolver(FBox(FVector(-6000.0f, -4000.0f, 0.0f), FVector(6000.0f, 4000.0f, 0.0f)));
+		FMovementSimState State;
+		FInputCommand Input;
+		const float DeltaTime = 1.0f / 60.0f;
+
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumSteps; ++i)
+		{
+			const float Angle = i * 0.01f;
+			Input.MovementInput = FVector2D(FMath::Cos(Angle), FMath::Sin(Angle));
+			Input.ActionFlags = (i / 120) % 2 ? FInputCommand::FLAG_SPRINT : 0;
+			State = FMovementSimulation::Step(State, Input, DeltaTime, Tuning, &Resolver);
+		}
+		const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+		UE_LOG(LogTemp, Log, TEXT("Movement benchmark: %d steps in %.3f ms (%.0f steps/ms), final position %s"),
+			NumSteps, ElapsedMs, ElapsedMs > 0.0 ? NumSteps / ElapsedMs : 0.0, *State.Position.ToString());
+	}
+
+	void RunSimulationHash(const TArray<FString>& Args)
+	{
+		const uint32 Seed = Args.Num() > 0 ? static_cast<uint32>(FCString::Strtoui64(*Args[0], nullptr, 10)) : FMovementSimulation::GoldenSeed;
+		const int32 NumSteps = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : FMovementSimulation::GoldenSteps;
+
+		const uint64 Hash = FMovementSimulation::RunHashSequence(Seed, NumSteps);
+		UE_LOG(LogTemp, Log, TEXT("Simulation hash (seed %u, %d steps): 0x%016llx"), Seed, NumSteps, Hash);
+
+		if (Seed != FMovementSimulation::GoldenSeed || NumSteps != FMovementSimulation::GoldenSteps)
+		{
+			return;
+		}
+
+#if POCKETSTRIKER_DETERMINISTIC_SIM
+		if (Hash == FMovementSimulation::GoldenHash)
+		{
+			UE_LOG(LogTemp, Log, TEXT("Simulation hash matches golden 0x%016llx"), FMovementSimulation::GoldenHash);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Error, TEXT("Simulation DESYNC: expected golden 0x%016llx"), FMovementSimulation::GoldenHash);
+		}
+#else
+		UE_LOG(LogTemp, Log, TEXT("Float build: golden hash only applies with POCKETSTRIKER_DETERMINISTIC_SIM=1"));
+#endif
+	}
+
+	FAutoConsoleCommand MovementBenchmarkCommand(
+		TEXT("perf.movementbench"),
+		TEXT("Time the standalone movement simulation. Usage: perf.movementbench [steps]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunMovementBenchmark));
+
+	FAutoConsoleCommand SimulationHashCommand(
+		TEXT("perf.simhash"),
+		TEXT("Hash a long seeded input stream through the movement simulation and check it against the golden hash. Usage: perf.simhash [seed] [steps]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunSimulationHash));
+
+	void RunBallBenchmark(const TArray<FString>& Args)
+	{
+		const int32 NumKicks = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 1000;
+		const int32 NumEvaluations = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 100000;
+		const FBallSimTuning Tuning;
+
+		// Kicks from anywhere on the pitch, along the ground and lofted, up to the default max kick force
+		FRandomStream Random(1);
+		TArray<FBallFlightState> Launches;
+		for (int32 i = 0; i < NumKicks; ++i)
+		{
+			FBallFlightState Start;
+			Start.Position = FVector(Random.FRandRange(-5800.0f, 5800.0f), Random.FRandRange(-3800.0f, 3800.0f), Tuning.GetRestHeight());
+			const FVector Direction(Random.FRandRange(-1.0f, 1.0f), Random.FRandRange(-1.0f, 1.0f), Random.FRandRange(0.0f, 0.8f));
+			Launches.Add(FBallSimulation::Kick(Start, Direction, Random.FRandRange(200.0f, 2000.0f), Tuning));
+		}
+
+		double Checksum = 0.0;
+		const double EvaluateStart = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumEvaluations; ++i)
+		{
+			Checksum += FBallSimulation::Evaluate(Launches[i % NumKicks], (i % 600) / 60.0, Tuning).Position.X;
+		}
+		const double EvaluateNs = (FPlatformTime::Seconds() - EvaluateStart) * 1e9 / NumEvaluations;
+
+		// A keyframe relaunches from the evaluated state; following it has to land where the original launch does
+		double MaxRebaseError = 0.0;
+		double MaxOutside = 0.0;
+		double LongestFlight = 0.0;
+		for (const FBallFlightState& Launch : Launches)
+		{
+			const double Split = Random.FRandRange(0.0f, 3.0f);
+			const double Total = Split + Random.FRandRange(0.0f, 3.0f);
+			const FBallFlightState Direct = FBallSimulation::Evaluate(Launch, Total, Tuning);
+			const FBallFlightState Rebased = FBallSimulation::Evaluate(FBallSimulation::Evaluate(Launch, Split, Tuning), Total - Split, Tuning);
+			MaxRebaseError = FMath::Max(MaxRebaseError, FVector::Dist(Direct.Position, Rebased.Position));
+
+			const FVector2D Flat(Direct.Position);
+			MaxOutside = FMath::Max(MaxOutside, FVector2D::Distance(Tuning.PitchBounds.GetClosestPointTo(Flat), Flat));
+
+			double Time = 0.0;
+			while (Time < 60.0 && !FBallSimulation::IsAtRest(FBallSimulation::Evaluate(Launch, Time, Tuning), Tuning))
+			{
+				Time += 0.25;
+			}
+			LongestFlight = FMath::Max(LongestFlight, Time);
+		}
+
+		UE_LOG(LogTemp, Log, TEXT("Ball bench: %d kicks, evaluate %.1f ns (checksum %.0f)"), NumKicks, EvaluateNs, Checksum);
+		UE_LOG(LogTemp, Log, TEXT("Ball bench: keyframe rebase error max %.4f cm, furthest outside pitch %.4f cm, longest flight to rest %.2f s"),
+			MaxRebaseError, MaxOutside, LongestFlight);
+	}
+
+	FAutoConsoleCommand BallBenchmarkCommand(
+		TEXT("perf.ballbench"),
+		TEXT("Evaluate random kicks with the deterministic ball model, time it and check that rebasing a launch mid-flight (a correction keyframe) does not move the ball. Usage: perf.ballbench [kicks] [evaluations]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunBallBenchmark));
+}
+
+#endif // !UE_BUILD_SHIPPING